@@ -0,0 +1,110 @@
+from __future__ import print_function
+import time
+import unittest
+import numpy
+import vtk, qt, ctk, slicer
+from slicer.ScriptedLoadableModule import *
+
+#
+# CLIImageTransferPerformanceTest
+#
+
+class CLIImageTransferPerformanceTest(ScriptedLoadableModule):
+  def __init__(self, parent):
+    ScriptedLoadableModule.__init__(self, parent)
+    parent.title = "CLIImageTransferPerformanceTest"
+    parent.categories = ["Testing.TestCases"]
+    parent.dependencies = ["GaussianBlurImageFilter"]
+    parent.contributors = ["Slicer Community"]
+    parent.helpText = """
+    This is a self test that measures the time spent transferring a large
+    volume to and from a CLI: in memory, through temporary files and through
+    shared memory files.
+    """
+    parent.acknowledgementText = """"""
+
+#
+# CLIImageTransferPerformanceTestWidget
+#
+
+class CLIImageTransferPerformanceTestWidget(ScriptedLoadableModuleWidget):
+
+  def setup(self):
+    ScriptedLoadableModuleWidget.setup(self)
+
+#
+# CLIImageTransferPerformanceTestTest
+#
+
+class CLIImageTransferPerformanceTestTest(ScriptedLoadableModuleTest):
+
+  def setUp(self):
+    """ Reset the state for testing.
+    """
+    slicer.mrmlScene.Clear(0)
+
+  def runTest(self):
+    """Run as few or as many tests as needed here.
+    """
+    self.setUp()
+    self.test_CLIImageTransferPerformance()
+
+  def createVolume(self, dimensions):
+    imageData = vtk.vtkImageData()
+    imageData.SetDimensions(dimensions)
+    imageData.AllocateScalars(vtk.VTK_SHORT, 1)
+    volumeNode = slicer.mrmlScene.AddNewNodeByClass("vtkMRMLScalarVolumeNode", "Input")
+    volumeNode.SetAndObserveImageData(imageData)
+    voxels = slicer.util.arrayFromVolume(volumeNode)
+    j, i = numpy.ogrid[0:dimensions[1], 0:dimensions[0]]
+    for k in range(dimensions[2]):
+      voxels[k] = ((i // 16) ^ (j // 8) ^ k) % 256
+    return volumeNode
+
+  def runBlur(self, inputVolumeNode, outputVolumeNode, inMemory, sharedMemory):
+    cliLogic = slicer.modules.gaussianblurimagefilter.logic()
+    allowInMemoryTransfer = cliLogic.GetAllowInMemoryTransfer()
+    allowSharedMemoryTransfer = cliLogic.GetAllowSharedMemoryTransfer()
+    cliLogic.SetAllowInMemoryTransfer(inMemory)
+    cliLogic.SetAllowSharedMemoryTransfer(sharedMemory)
+    parameters = {"inputVolume": inputVolumeNode, "outputVolume": outputVolumeNode, "sigma": 2.0}
+    startTime = time.time()
+    cliNode = slicer.cli.runSync(slicer.modules.gaussianblurimagefilter, None, parameters)
+    elapsedTime = time.time() - startTime
+    cliLogic.SetAllowInMemoryTransfer(allowInMemoryTransfer)
+    cliLogic.SetAllowSharedMemoryTransfer(allowSharedMemoryTransfer)
+    self.assertEqual(cliNode.GetStatusString(), 'Completed')
+    slicer.mrmlScene.RemoveNode(cliNode)
+    return elapsedTime
+
+  def test_CLIImageTransferPerformance(self):
+    self.delayDisplay('Running CLI image transfer performance test')
+
+    # 4MB volume, large enough to compare the transfer modes while
+    # keeping the test fast
+    dimensions = [256, 256, 64]
+    inputVolumeNode = self.createVolume(dimensions)
+    outputVolumeNode = slicer.mrmlScene.AddNewNodeByClass("vtkMRMLScalarVolumeNode", "Output")
+
+    expectedVoxels = None
+    for name, inMemory, sharedMemory in [
+        ("in memory", 1, 0),
+        ("temporary files", 0, 0),
+        ("shared memory files", 0, 1)]:
+      elapsedTime = self.runBlur(inputVolumeNode, outputVolumeNode, inMemory, sharedMemory)
+      print("GaussianBlurImageFilter on %dx%dx%d volume, transfer %s: %.2fs" % (dimensions[0], dimensions[1], dimensions[2], name, elapsedTime))
+
+      # All transfers must produce the same volume
+      voxels = slicer.util.arrayFromVolume(outputVolumeNode)
+      self.assertEqual(voxels.shape, (dimensions[2], dimensions[1], dimensions[0]))
+      checksum = (voxels[dimensions[2] // 2].copy(), voxels.sum(dtype=numpy.int64))
+      if expectedVoxels is None:
+        expectedVoxels = checksum
+      else:
+        self.assertTrue(numpy.array_equal(checksum[0], expectedVoxels[0]))
+        self.assertEqual(checksum[1], expectedVoxels[1])
+
+    # The input voxels must be left untouched by the in-memory transfer
+    self.assertEqual(slicer.util.arrayFromVolume(inputVolumeNode)[3, 40, 100], ((100 // 16) ^ (40 // 8) ^ 3) % 256)
+
+    self.delayDisplay('CLI image transfer performance test passed !')
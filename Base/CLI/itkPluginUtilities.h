@@ -5,9 +5,13 @@
 #include <itkContinuousIndex.h>
 #include <itkImage.h>
 #include <itkImageFileReader.h>
+#include <itkImageFileWriter.h>
+#include <itkImportImageContainer.h>
+#include <itkMetaDataObject.h>
 #include <itkPluginFilterWatcher.h>
 
 // STD includes
+#include <cstdio>
 #include <vector>
 #include <string>
 
@@ -86,6 +90,119 @@ namespace itk
       }
   }
 
+  //-----------------------------------------------------------------------------
+  /// Pixel container importing a buffer that is owned by another object.
+  /// The owner is kept alive as long as the container exists.
+  template <typename TElementIdentifier, typename TElement>
+  class SharedBufferImageContainer : public ImportImageContainer<TElementIdentifier, TElement>
+  {
+  public:
+    typedef SharedBufferImageContainer Self;
+    typedef ImportImageContainer<TElementIdentifier, TElement> Superclass;
+    typedef SmartPointer<Self> Pointer;
+    itkNewMacro(Self);
+    itkTypeMacro(SharedBufferImageContainer, ImportImageContainer);
+
+    void SetBufferOwner(LightObject* owner) { this->m_BufferOwner = owner; }
+
+  protected:
+    SharedBufferImageContainer() = default;
+    ~SharedBufferImageContainer() override = default;
+
+  private:
+    LightObject::Pointer m_BufferOwner;
+  };
+
+  //-----------------------------------------------------------------------------
+  /// Read the image \a fileName. When Slicer passes a MRML node
+  /// ("slicer:" file name) of the same pixel type, the returned image
+  /// shares the voxels of the node instead of holding a copy. The image
+  /// must then be treated as read-only (e.g. turn off in-place filtering).
+  template <class TImage>
+  typename TImage::Pointer ReadPluginImage(const std::string& fileName)
+  {
+    typedef itk::ImageFileReader<TImage> ReaderType;
+    typename ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName(fileName.c_str());
+    reader->UpdateOutputInformation();
+
+    typename TImage::Pointer image = reader->GetOutput();
+    ImageIOBase* imageIO = reader->GetImageIO();
+    std::string bufferPointer;
+    void* buffer = nullptr;
+    if (imageIO->GetPixelType() == ImageIOBase::SCALAR
+        && imageIO->GetNumberOfComponents() == 1
+        && imageIO->GetComponentType() == ImageIOBase::MapPixelType<typename TImage::PixelType>::CType
+        && ExposeMetaData<std::string>(imageIO->GetMetaDataDictionary(),
+                                       "MRMLIDImageIO_BufferPointer", bufferPointer)
+        && sscanf(bufferPointer.c_str(), "%p", &buffer) == 1 && buffer)
+      {
+      // The image IO holds a reference to the voxels of the node, the pixel
+      // container keeps the image IO so that the voxels are not released
+      // while the image exists.
+      typedef SharedBufferImageContainer<typename TImage::PixelContainer::ElementIdentifier,
+        typename TImage::PixelType> ContainerType;
+      typename ContainerType::Pointer container = ContainerType::New();
+      container->SetBufferOwner(imageIO);
+      container->SetImportPointer(static_cast<typename TImage::PixelType*>(buffer),
+        image->GetLargestPossibleRegion().GetNumberOfPixels(), false);
+      image->DisconnectPipeline();
+      image->SetBufferedRegion(image->GetLargestPossibleRegion());
+      image->SetPixelContainer(container);
+      return image;
+      }
+
+    reader->Update();
+    image->DisconnectPipeline();
+    return image;
+  }
+
+  //-----------------------------------------------------------------------------
+  /// Write \a image to \a fileName. When Slicer passes a MRML node
+  /// ("slicer:" file name), the node adopts the voxels of the image
+  /// instead of copying them and the image is released.
+  template <class TImage>
+  void WritePluginImage(TImage* image, const std::string& fileName, bool useCompression = true)
+  {
+    typedef itk::ImageFileWriter<TImage> WriterType;
+    typename WriterType::Pointer writer = WriterType::New();
+    writer->SetFileName(fileName.c_str());
+    writer->SetInput(image);
+    writer->SetUseCompression(useCompression);
+
+    MetaDataDictionary& dictionary = image->GetMetaDataDictionary();
+    char bufferPointer[64];
+    sprintf(bufferPointer, "%p", static_cast<void*>(image->GetBufferPointer()));
+    bool canAdopt = fileName.find("slicer:") == 0
+      && image->GetPixelContainer()->GetContainerManageMemory()
+      && image->GetBufferedRegion() == image->GetLargestPossibleRegion();
+    if (canAdopt)
+      {
+      EncapsulateMetaData<std::string>(dictionary, "MRMLIDImageIO_AdoptBuffer", bufferPointer);
+      }
+    try
+      {
+      writer->Update();
+      }
+    catch (...)
+      {
+      dictionary.Erase("MRMLIDImageIO_AdoptBuffer");
+      throw;
+      }
+    dictionary.Erase("MRMLIDImageIO_AdoptBuffer");
+
+    std::string adoptedBuffer;
+    if (canAdopt
+        && ExposeMetaData<std::string>(writer->GetImageIO()->GetMetaDataDictionary(),
+                                       "MRMLIDImageIO_BufferAdopted", adoptedBuffer)
+        && adoptedBuffer == bufferPointer)
+      {
+      // The node now owns the voxels
+      image->GetPixelContainer()->ContainerManageMemoryOff();
+      image->Initialize();
+      }
+  }
+
 } // end namespace itk
 
 #endif
@@ -0,0 +1,343 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Slicer includes
+#include "vtkSlicerApplicationLogic.h"
+#include "vtkSlicerTask.h"
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLCoreTestingUtilities.h"
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+class vtkSlicerTaskTestLogic : public vtkMRMLAbstractLogic
+{
+public:
+  static vtkSlicerTaskTestLogic *New();
+  vtkTypeMacro(vtkSlicerTaskTestLogic, vtkMRMLAbstractLogic);
+
+  /// Wait until the number of running blocking tasks reaches
+  /// RequiredNumberOfRunningTasks or Released is set.
+  void BlockingTask(void* vtkNotUsed(clientData))
+    {
+    std::unique_lock<std::mutex> lock(this->Lock);
+    ++this->NumberOfRunningTasks;
+    this->Condition.notify_all();
+    bool ready = this->Condition.wait_for(lock, std::chrono::seconds(10), [this]
+      { return this->Released || this->NumberOfRunningTasks >= this->RequiredNumberOfRunningTasks; });
+    if (ready)
+      {
+      ++this->NumberOfCompletedTasks;
+      }
+    --this->NumberOfRunningTasks;
+    this->Condition.notify_all();
+    }
+
+  /// Record the task ID passed as client data
+  void RecordTask(void* clientData)
+    {
+    std::lock_guard<std::mutex> lock(this->Lock);
+    this->ExecutedTaskIDs.push_back(*static_cast<int*>(clientData));
+    this->Condition.notify_all();
+    }
+
+  /// Wait until the predicate is true, return false on timeout
+  template <class Predicate>
+  bool WaitFor(Predicate predicate)
+    {
+    std::unique_lock<std::mutex> lock(this->Lock);
+    return this->Condition.wait_for(lock, std::chrono::seconds(10), predicate);
+    }
+
+  void Release()
+    {
+    std::lock_guard<std::mutex> lock(this->Lock);
+    this->Released = true;
+    this->Condition.notify_all();
+    }
+
+  std::mutex Lock;
+  std::condition_variable Condition;
+  int NumberOfRunningTasks{0};
+  int NumberOfCompletedTasks{0};
+  int RequiredNumberOfRunningTasks{1};
+  bool Released{false};
+  std::vector<int> ExecutedTaskIDs;
+};
+
+vtkStandardNewMacro(vtkSlicerTaskTestLogic);
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+bool ScheduleTask(vtkSlicerApplicationLogic* appLogic, vtkSlicerTaskTestLogic* logic,
+  vtkMRMLAbstractLogic::TaskFunctionPointer function, void* clientData,
+  int type = vtkSlicerTask::Processing, int priority = 0)
+{
+  vtkNew<vtkSlicerTask> task;
+  task->SetType(type);
+  task->SetPriority(priority);
+  task->SetTaskFunction(logic, function, clientData);
+  return appLogic->ScheduleTask(task.GetPointer());
+}
+
+//-----------------------------------------------------------------------------
+int TestConcurrentTasks()
+{
+  vtkNew<vtkSlicerApplicationLogic> appLogic;
+  vtkNew<vtkSlicerTaskTestLogic> logic;
+
+  // Not scheduled if the threads are not started
+  CHECK_BOOL(ScheduleTask(appLogic, logic, (vtkMRMLAbstractLogic::TaskFunctionPointer)
+    &vtkSlicerTaskTestLogic::BlockingTask, nullptr), false);
+
+  appLogic->SetNumberOfProcessingThreads(3);
+  appLogic->CreateProcessingThread();
+
+  // Each task waits for the others to be running
+  logic->RequiredNumberOfRunningTasks = 3;
+  for (int i = 0; i < 3; ++i)
+    {
+    CHECK_BOOL(ScheduleTask(appLogic, logic, (vtkMRMLAbstractLogic::TaskFunctionPointer)
+      &vtkSlicerTaskTestLogic::BlockingTask, nullptr), true);
+    }
+  CHECK_BOOL(logic->WaitFor([&]{ return logic->NumberOfCompletedTasks == 3; }), true);
+
+  appLogic->TerminateProcessingThread();
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+int TestTaskPriority()
+{
+  vtkNew<vtkSlicerApplicationLogic> appLogic;
+  vtkNew<vtkSlicerTaskTestLogic> logic;
+  appLogic->SetNumberOfProcessingThreads(1);
+  appLogic->CreateProcessingThread();
+
+  // Keep the processing thread busy while the other tasks are scheduled
+  logic->RequiredNumberOfRunningTasks = 2;
+  ScheduleTask(appLogic, logic, (vtkMRMLAbstractLogic::TaskFunctionPointer)
+    &vtkSlicerTaskTestLogic::BlockingTask, nullptr);
+  CHECK_BOOL(logic->WaitFor([&]{ return logic->NumberOfRunningTasks == 1; }), true);
+
+  int taskIDs[4] = { 0, 1, 2, 3 };
+  int priorities[4] = { 0, 5, 1, 5 };
+  for (int i = 0; i < 4; ++i)
+    {
+    ScheduleTask(appLogic, logic, (vtkMRMLAbstractLogic::TaskFunctionPointer)
+      &vtkSlicerTaskTestLogic::RecordTask, &taskIDs[i], vtkSlicerTask::Processing, priorities[i]);
+    }
+  CHECK_INT(appLogic->GetNumberOfScheduledTasks(vtkSlicerTask::Processing), 4);
+
+  // A networking task is not delayed by the running processing task
+  int networkingTaskID = 10;
+  ScheduleTask(appLogic, logic, (vtkMRMLAbstractLogic::TaskFunctionPointer)
+    &vtkSlicerTaskTestLogic::RecordTask, &networkingTaskID, vtkSlicerTask::Networking);
+  CHECK_BOOL(logic->WaitFor([&]{ return logic->ExecutedTaskIDs.size() == 1; }), true);
+  CHECK_INT(logic->ExecutedTaskIDs[0], networkingTaskID);
+
+  logic->Release();
+  CHECK_BOOL(logic->WaitFor([&]{ return logic->ExecutedTaskIDs.size() == 5; }), true);
+  CHECK_INT(logic->ExecutedTaskIDs[1], 1);
+  CHECK_INT(logic->ExecutedTaskIDs[2], 3);
+  CHECK_INT(logic->ExecutedTaskIDs[3], 2);
+  CHECK_INT(logic->ExecutedTaskIDs[4], 0);
+
+  // Tasks of undefined type cannot be scheduled
+  TESTING_OUTPUT_ASSERT_ERRORS_BEGIN();
+  CHECK_BOOL(ScheduleTask(appLogic, logic, (vtkMRMLAbstractLogic::TaskFunctionPointer)
+    &vtkSlicerTaskTestLogic::RecordTask, &taskIDs[0], vtkSlicerTask::Undefined), false);
+  TESTING_OUTPUT_ASSERT_ERRORS_END();
+
+  appLogic->TerminateProcessingThread();
+  CHECK_BOOL(ScheduleTask(appLogic, logic, (vtkMRMLAbstractLogic::TaskFunctionPointer)
+    &vtkSlicerTaskTestLogic::RecordTask, &taskIDs[0]), false);
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+int TestTaskLatency()
+{
+  vtkNew<vtkSlicerApplicationLogic> appLogic;
+  vtkNew<vtkSlicerTaskTestLogic> logic;
+  appLogic->CreateProcessingThread();
+
+  const int numberOfTasks = 20;
+  int taskID = 0;
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  for (int i = 0; i < numberOfTasks; ++i)
+    {
+    ScheduleTask(appLogic, logic, (vtkMRMLAbstractLogic::TaskFunctionPointer)
+      &vtkSlicerTaskTestLogic::RecordTask, &taskID);
+    CHECK_BOOL(logic->WaitFor([&]{ return static_cast<int>(logic->ExecutedTaskIDs.size()) == i + 1; }), true);
+    }
+  timer->StopTimer();
+  std::cout << "Average time from scheduling to completion of a task: "
+            << timer->GetElapsedTime() / numberOfTasks * 1000.0 << " ms" << std::endl;
+
+  appLogic->TerminateProcessingThread();
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+int TestRequestProcessing()
+{
+  vtkNew<vtkSlicerApplicationLogic> appLogic;
+  vtkNew<vtkMRMLCoreTestingUtilities::vtkMRMLNodeCallback> callback;
+  appLogic->AddObserver(vtkSlicerApplicationLogic::RequestModifiedEvent, callback.GetPointer());
+  vtkNew<vtkObject> objects[3];
+
+  // Not queued if the threads are not started
+  CHECK_INT(appLogic->RequestModified(objects[0].GetPointer()), 0);
+
+  appLogic->CreateProcessingThread();
+  appLogic->ProcessModified();
+  callback->ResetNumberOfEvents();
+
+  // Only the first request posted to the idle queue wakes up the main thread
+  appLogic->RequestModified(objects[0].GetPointer());
+  appLogic->RequestModified(objects[0].GetPointer());
+  appLogic->RequestModified(objects[1].GetPointer());
+  appLogic->RequestModified(objects[2].GetPointer());
+  CHECK_INT(callback->GetNumberOfEvents(vtkSlicerApplicationLogic::RequestModifiedEvent), 1);
+  CHECK_INT(appLogic->GetModifiedQueueSize(), 4);
+
+  // All requests are processed in one batch, without polling afterward
+  vtkMTimeType requestTime = objects[2]->GetMTime();
+  appLogic->ResetRequestStatistics();
+  appLogic->ProcessModified();
+  CHECK_INT(appLogic->GetModifiedQueueSize(), 0);
+  for (int i = 0; i < 3; ++i)
+    {
+    CHECK_BOOL(objects[i]->GetMTime() > requestTime, true);
+    }
+  CHECK_INT(callback->GetNumberOfEvents(vtkSlicerApplicationLogic::RequestModifiedEvent), 1);
+  CHECK_INT(appLogic->GetNumberOfProcessedRequests(), 4);
+  CHECK_INT(appLogic->GetMaximumRequestQueueSize(), 4);
+  CHECK_BOOL(appLogic->GetAverageRequestWaitTime() >= 0.0, true);
+  CHECK_BOOL(appLogic->GetMaximumRequestWaitTime() >= appLogic->GetAverageRequestWaitTime(), true);
+
+  // Without time budget, one request is processed per call and the
+  // processing of the others is requested again.
+  appLogic->SetMaximumRequestProcessingTime(0.0);
+  for (int i = 0; i < 3; ++i)
+    {
+    appLogic->RequestModified(objects[i].GetPointer());
+    }
+  CHECK_INT(callback->GetNumberOfEvents(vtkSlicerApplicationLogic::RequestModifiedEvent), 2);
+  appLogic->ProcessModified();
+  CHECK_INT(appLogic->GetModifiedQueueSize(), 2);
+  CHECK_INT(callback->GetNumberOfEvents(vtkSlicerApplicationLogic::RequestModifiedEvent), 3);
+  appLogic->ProcessModified();
+  appLogic->ProcessModified();
+  CHECK_INT(appLogic->GetModifiedQueueSize(), 0);
+  CHECK_INT(callback->GetNumberOfEvents(vtkSlicerApplicationLogic::RequestModifiedEvent), 4);
+  CHECK_INT(appLogic->GetNumberOfProcessedRequests(), 7);
+
+  appLogic->TerminateProcessingThread();
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+struct WakeUpRecord
+{
+  int NumberOfWakeUps = 0;
+  int RequestEvent = 0;
+  std::thread::id ThreadID;
+};
+
+//-----------------------------------------------------------------------------
+void RecordWakeUp(int requestEvent, void* clientData)
+{
+  WakeUpRecord* record = reinterpret_cast<WakeUpRecord*>(clientData);
+  ++record->NumberOfWakeUps;
+  record->RequestEvent = requestEvent;
+  record->ThreadID = std::this_thread::get_id();
+}
+
+//-----------------------------------------------------------------------------
+int TestRequestWakeUpFromThread()
+{
+  vtkNew<vtkSlicerApplicationLogic> appLogic;
+  vtkNew<vtkMRMLCoreTestingUtilities::vtkMRMLNodeCallback> callback;
+  appLogic->AddObserver(vtkSlicerApplicationLogic::RequestModifiedEvent, callback.GetPointer());
+  vtkNew<vtkObject> object;
+  appLogic->CreateProcessingThread();
+  appLogic->ProcessModified();
+  callback->ResetNumberOfEvents();
+
+  // Without wake-up callback, no event is invoked from another thread...
+  std::thread requestThread([&appLogic, &object]
+    { appLogic->RequestModified(object.GetPointer()); });
+  requestThread.join();
+  CHECK_INT(callback->GetNumberOfEvents(vtkSlicerApplicationLogic::RequestModifiedEvent), 0);
+  CHECK_INT(appLogic->GetModifiedQueueSize(), 1);
+  // ... and the next request posted from the main thread wakes it up.
+  appLogic->RequestModified(object.GetPointer());
+  CHECK_INT(callback->GetNumberOfEvents(vtkSlicerApplicationLogic::RequestModifiedEvent), 1);
+  appLogic->ProcessModified();
+  CHECK_INT(appLogic->GetModifiedQueueSize(), 0);
+  callback->ResetNumberOfEvents();
+
+  // The wake-up callback is called from the thread that posts the request
+  // instead of invoking the event.
+  WakeUpRecord record;
+  appLogic->SetRequestWakeUpCallback(RecordWakeUp, &record);
+  std::thread::id requestThreadID;
+  std::thread callbackThread([&appLogic, &object, &requestThreadID]
+    {
+    requestThreadID = std::this_thread::get_id();
+    appLogic->RequestModified(object.GetPointer());
+    appLogic->RequestModified(object.GetPointer());
+    });
+  callbackThread.join();
+  CHECK_INT(record.NumberOfWakeUps, 1);
+  CHECK_INT(record.RequestEvent, vtkSlicerApplicationLogic::RequestModifiedEvent);
+  CHECK_BOOL(record.ThreadID == requestThreadID, true);
+  CHECK_INT(callback->GetNumberOfEvents(vtkSlicerApplicationLogic::RequestModifiedEvent), 0);
+  appLogic->ProcessModified();
+  CHECK_INT(appLogic->GetModifiedQueueSize(), 0);
+  CHECK_INT(callback->GetNumberOfEvents(vtkSlicerApplicationLogic::RequestModifiedEvent), 0);
+
+  appLogic->SetRequestWakeUpCallback(nullptr, nullptr);
+  appLogic->TerminateProcessingThread();
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int vtkSlicerApplicationLogicTaskTest1(int , char * [])
+{
+  CHECK_EXIT_SUCCESS(TestConcurrentTasks());
+  CHECK_EXIT_SUCCESS(TestTaskPriority());
+  CHECK_EXIT_SUCCESS(TestTaskLatency());
+  CHECK_EXIT_SUCCESS(TestRequestProcessing());
+  CHECK_EXIT_SUCCESS(TestRequestWakeUpFromThread());
+  return EXIT_SUCCESS;
+}
@@ -28,12 +28,15 @@
 // VTK includes
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
+#include <vtkTimerLog.h>
 
 // ITKSYS includes
 #include <itksys/SystemTools.hxx>
 
 // STD includes
 #include <algorithm>
+#include <condition_variable>
+#include <thread>
 
 #ifdef ITK_USE_PTHREADS
 # include <unistd.h>
@@ -46,10 +49,59 @@
 #include "vtkSlicerApplicationLogicRequests.h"
 
 //----------------------------------------------------------------------------
-class ProcessingTaskQueue : public std::queue<vtkSmartPointer<vtkSlicerTask> > {};
-class ModifiedQueue : public std::queue<vtkSmartPointer<vtkObject> > {};
-class ReadDataQueue : public std::queue<DataRequest*> {};
-class WriteDataQueue : public std::queue<DataRequest*> {};
+struct ScheduledTask
+{
+  vtkSmartPointer<vtkSlicerTask> Task;
+  int Priority;
+  unsigned long ScheduleOrder;
+
+  /// std::priority_queue runs the "largest" task first: highest priority,
+  /// then earliest scheduled.
+  bool operator<(const ScheduledTask& other) const
+    {
+    if (this->Priority != other.Priority)
+      {
+      return this->Priority < other.Priority;
+      }
+    return this->ScheduleOrder > other.ScheduleOrder;
+    }
+};
+
+//----------------------------------------------------------------------------
+class ProcessingTaskQueue : public std::priority_queue<ScheduledTask>
+{
+public:
+  /// Notified when a task is scheduled or the threads are terminated
+  std::condition_variable TaskAvailableCondition;
+};
+
+//----------------------------------------------------------------------------
+struct ModifiedRequest
+{
+  vtkSmartPointer<vtkObject> Object;
+  /// Time (vtkTimerLog::GetUniversalTime()) when the request was queued
+  double RequestTime;
+};
+
+//----------------------------------------------------------------------------
+class ModifiedQueue : public std::queue<ModifiedRequest>
+{
+public:
+  /// Set when the main thread has been asked to process the queue and
+  /// has not emptied it yet. Protected by the queue lock.
+  bool WakeUpRequested{false};
+};
+
+//----------------------------------------------------------------------------
+class DataRequestQueue : public std::queue<DataRequest*>
+{
+public:
+  /// Set when the main thread has been asked to process the queue and
+  /// has not emptied it yet. Protected by the queue lock.
+  bool WakeUpRequested{false};
+};
+class ReadDataQueue : public DataRequestQueue {};
+class WriteDataQueue : public DataRequestQueue {};
 
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSlicerApplicationLogic);
@@ -58,8 +110,10 @@ vtkStandardNewMacro(vtkSlicerApplicationLogic);
 vtkSlicerApplicationLogic::vtkSlicerApplicationLogic()
 {
   this->ProcessingThreader = itk::PlatformMultiThreader::New();
-  this->ProcessingThreadId = -1;
+  this->NumberOfProcessingThreads = 4;
+  this->NumberOfNetworkingThreads = 1;
   this->ProcessingThreadActive = false;
+  this->NumberOfTasksScheduled = 0;
 
   this->ModifiedQueueActive = false;
 
@@ -67,46 +121,43 @@ vtkSlicerApplicationLogic::vtkSlicerApplicationLogic()
 
   this->WriteDataQueueActive = false;
 
-  this->InternalTaskQueue = new ProcessingTaskQueue;
+  this->InternalProcessingTaskQueue = new ProcessingTaskQueue;
+  this->InternalNetworkingTaskQueue = new ProcessingTaskQueue;
   this->InternalModifiedQueue = new ModifiedQueue;
 
   this->InternalReadDataQueue = new ReadDataQueue;
   this->InternalWriteDataQueue = new WriteDataQueue;
 
+  this->MaximumRequestProcessingTime = 0.05;
+  this->ResetRequestStatistics();
+
+  this->RequestWakeUpCallback = nullptr;
+  this->RequestWakeUpClientData = nullptr;
+  this->MainThreadID = std::this_thread::get_id();
+
   this->UserInformation = vtkPersonInformation::New();
 }
 
 //----------------------------------------------------------------------------
 vtkSlicerApplicationLogic::~vtkSlicerApplicationLogic()
 {
-  // Note that TerminateThread does not kill a thread, it only waits
-  // for the thread to finish.  We need to signal the thread that we
-  // want to terminate
-  if (this->ProcessingThreadId != -1 && this->ProcessingThreader)
-    {
-    // Signal the processingThread that we are terminating.
-    this->ProcessingThreadActiveLock.lock();
-    this->ProcessingThreadActive = false;
-    this->ProcessingThreadActiveLock.unlock();
+  this->TerminateProcessingThread();
 
-    // Wait for the thread to finish and clean up the state of the threader
-    this->ProcessingThreader->TerminateThread( this->ProcessingThreadId );
+  delete this->InternalProcessingTaskQueue;
+  delete this->InternalNetworkingTaskQueue;
 
-    this->ProcessingThreadId = -1;
-    }
-
-  delete this->InternalTaskQueue;
-
-  this->ModifiedQueueLock.lock();
-  while (!(*this->InternalModifiedQueue).empty())
+  delete this->InternalModifiedQueue;
+  while (!this->InternalReadDataQueue->empty())
     {
-    vtkObject *obj = (*this->InternalModifiedQueue).front();
-    (*this->InternalModifiedQueue).pop();
-    obj->Delete(); // decrement ref count
+    delete this->InternalReadDataQueue->front();
+    this->InternalReadDataQueue->pop();
     }
-  this->ModifiedQueueLock.unlock();
-  delete this->InternalModifiedQueue;
   delete this->InternalReadDataQueue;
+  while (!this->InternalWriteDataQueue->empty())
+    {
+    delete this->InternalWriteDataQueue->front();
+    this->InternalWriteDataQueue->pop();
+    }
   delete this->InternalWriteDataQueue;
 
   this->UserInformation->Delete();
@@ -115,9 +166,88 @@ vtkSlicerApplicationLogic::~vtkSlicerApplicationLogic()
 //----------------------------------------------------------------------------
 unsigned int vtkSlicerApplicationLogic::GetReadDataQueueSize()
 {
+  std::lock_guard<std::mutex> lock(this->ReadDataQueueLock);
   return static_cast<unsigned int>( (*this->InternalReadDataQueue).size() );
 }
 
+//----------------------------------------------------------------------------
+unsigned int vtkSlicerApplicationLogic::GetModifiedQueueSize()
+{
+  std::lock_guard<std::mutex> lock(this->ModifiedQueueLock);
+  return static_cast<unsigned int>( (*this->InternalModifiedQueue).size() );
+}
+
+//----------------------------------------------------------------------------
+unsigned int vtkSlicerApplicationLogic::GetWriteDataQueueSize()
+{
+  std::lock_guard<std::mutex> lock(this->WriteDataQueueLock);
+  return static_cast<unsigned int>( (*this->InternalWriteDataQueue).size() );
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerApplicationLogic::GetAverageRequestWaitTime()
+{
+  if (this->NumberOfProcessedRequests == 0)
+    {
+    return 0.0;
+    }
+  return this->TotalRequestWaitTime / this->NumberOfProcessedRequests;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerApplicationLogic::ResetRequestStatistics()
+{
+  this->NumberOfProcessedRequests = 0;
+  this->TotalRequestWaitTime = 0.0;
+  this->MaximumRequestWaitTime = 0.0;
+  this->MaximumRequestQueueSize = 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerApplicationLogic::UpdateRequestStatistics(double requestTime)
+{
+  double waitTime = vtkTimerLog::GetUniversalTime() - requestTime;
+  ++this->NumberOfProcessedRequests;
+  this->TotalRequestWaitTime += waitTime;
+  this->MaximumRequestWaitTime = std::max(this->MaximumRequestWaitTime, waitTime);
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerApplicationLogic::SetRequestWakeUpCallback(
+  RequestWakeUpCallbackType callback, void* clientData)
+{
+  std::lock_guard<std::mutex> lock(this->RequestWakeUpCallbackLock);
+  this->RequestWakeUpCallback = callback;
+  this->RequestWakeUpClientData = clientData;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerApplicationLogic::CanWakeUpMainThread()
+{
+  std::lock_guard<std::mutex> lock(this->RequestWakeUpCallbackLock);
+  return this->RequestWakeUpCallback != nullptr
+    || std::this_thread::get_id() == this->MainThreadID;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerApplicationLogic::WakeUpMainThread(int requestEvent)
+{
+  std::unique_lock<std::mutex> lock(this->RequestWakeUpCallbackLock);
+  RequestWakeUpCallbackType callback = this->RequestWakeUpCallback;
+  void* clientData = this->RequestWakeUpClientData;
+  lock.unlock();
+
+  if (callback)
+    {
+    callback(requestEvent, clientData);
+    }
+  else if (std::this_thread::get_id() == this->MainThreadID)
+    {
+    int delay = 0;
+    this->InvokeEvent(requestEvent, &delay);
+    }
+}
+
 //-----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::SetMRMLSceneDataIO(vtkMRMLScene* newMRMLScene,
                                                    vtkMRMLRemoteIOLogic *remoteIOLogic,
@@ -171,41 +301,40 @@ void vtkSlicerApplicationLogic::PrintSelf(ostream& os, vtkIndent indent)
   this->vtkObject::PrintSelf(os, indent);
 
   os << indent << "SlicerApplicationLogic:             " << this->GetClassName() << "\n";
+  os << indent << "NumberOfProcessingThreads: " << this->NumberOfProcessingThreads << "\n";
+  os << indent << "NumberOfNetworkingThreads: " << this->NumberOfNetworkingThreads << "\n";
+  os << indent << "MaximumRequestProcessingTime: " << this->MaximumRequestProcessingTime << "\n";
+  os << indent << "NumberOfProcessedRequests: " << this->NumberOfProcessedRequests << "\n";
+  os << indent << "AverageRequestWaitTime: " << this->GetAverageRequestWaitTime() << "\n";
+  os << indent << "MaximumRequestWaitTime: " << this->MaximumRequestWaitTime << "\n";
+  os << indent << "MaximumRequestQueueSize: " << this->MaximumRequestQueueSize << "\n";
 }
 
 //----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::CreateProcessingThread()
 {
-  if (this->ProcessingThreadId == -1)
+  if (this->ProcessingThreadIDs.empty())
     {
-    this->ProcessingThreadActiveLock.lock();
+    this->ProcessingTaskQueueLock.lock();
     this->ProcessingThreadActive = true;
-    this->ProcessingThreadActiveLock.unlock();
-
-    this->ProcessingThreadId
-      = this->ProcessingThreader
-      ->SpawnThread(vtkSlicerApplicationLogic::ProcessingThreaderCallback,
-                    this);
-
-    // Start four network threads (TODO: make the number of threads a setting)
-    this->NetworkingThreadIDs.push_back ( this->ProcessingThreader
-          ->SpawnThread(vtkSlicerApplicationLogic::NetworkingThreaderCallback,
-                    this) );
-    /*
-     * TODO: it looks like curl is not thread safe by default
-     * - maybe there's a setting that cmcurl can have
-     *   similar to the --enable-threading of the standard curl build
-     *
-    this->NetworkingThreadIDs.push_back ( this->ProcessingThreader
-          ->SpawnThread(vtkSlicerApplicationLogic::NetworkingThreaderCallback,
-                    this) );
-    this->NetworkingThreadIDs.push_back ( this->ProcessingThreader
-          ->SpawnThread(vtkSlicerApplicationLogic::NetworkingThreaderCallback,
-                    this) );
-    this->NetworkingThreadIDs.push_back ( this->ProcessingThreader
-          ->SpawnThread(vtkSlicerApplicationLogic::NetworkingThreaderCallback,
-                    this) );
-    */
+    this->ProcessingTaskQueueLock.unlock();
+
+    for (int i = 0; i < this->NumberOfProcessingThreads; ++i)
+      {
+      this->ProcessingThreadIDs.push_back( this->ProcessingThreader
+        ->SpawnThread(vtkSlicerApplicationLogic::ProcessingThreaderCallback,
+                      this) );
+      }
+
+    // TODO: it looks like curl is not thread safe by default
+    // - maybe there's a setting that cmcurl can have
+    //   similar to the --enable-threading of the standard curl build
+    for (int i = 0; i < this->NumberOfNetworkingThreads; ++i)
+      {
+      this->NetworkingThreadIDs.push_back( this->ProcessingThreader
+        ->SpawnThread(vtkSlicerApplicationLogic::NetworkingThreaderCallback,
+                      this) );
+      }
 
     // Setup the communication channel back to the main thread
     this->ModifiedQueueActiveLock.lock();
@@ -218,17 +347,28 @@ void vtkSlicerApplicationLogic::CreateProcessingThread()
     this->WriteDataQueueActive = true;
     this->WriteDataQueueActiveLock.unlock();
 
-    int delay = 1000;
-    this->InvokeEvent(vtkSlicerApplicationLogic::RequestModifiedEvent, &delay);
-    this->InvokeEvent(vtkSlicerApplicationLogic::RequestReadDataEvent, &delay);
-    this->InvokeEvent(vtkSlicerApplicationLogic::RequestWriteDataEvent, &delay);
+    // Process requests left over from a previous activation. New requests
+    // wake up the main thread when they are posted.
+    this->ModifiedQueueLock.lock();
+    this->InternalModifiedQueue->WakeUpRequested = true;
+    this->ModifiedQueueLock.unlock();
+    this->ReadDataQueueLock.lock();
+    this->InternalReadDataQueue->WakeUpRequested = true;
+    this->ReadDataQueueLock.unlock();
+    this->WriteDataQueueLock.lock();
+    this->InternalWriteDataQueue->WakeUpRequested = true;
+    this->WriteDataQueueLock.unlock();
+
+    this->WakeUpMainThread(vtkSlicerApplicationLogic::RequestModifiedEvent);
+    this->WakeUpMainThread(vtkSlicerApplicationLogic::RequestReadDataEvent);
+    this->WakeUpMainThread(vtkSlicerApplicationLogic::RequestWriteDataEvent);
     }
 }
 
 //----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::TerminateProcessingThread()
 {
-  if (this->ProcessingThreadId != -1)
+  if (!this->ProcessingThreadIDs.empty())
     {
     this->ModifiedQueueActiveLock.lock();
     this->ModifiedQueueActive = false;
@@ -242,22 +382,37 @@ void vtkSlicerApplicationLogic::TerminateProcessingThread()
     this->WriteDataQueueActive = false;
     this->WriteDataQueueActiveLock.unlock();
 
-    this->ProcessingThreadActiveLock.lock();
+    // Signal the threads that we are terminating. Scheduled tasks
+    // that have not started yet are discarded.
+    this->ProcessingTaskQueueLock.lock();
     this->ProcessingThreadActive = false;
-    this->ProcessingThreadActiveLock.unlock();
-
-    this->ProcessingThreader->TerminateThread( this->ProcessingThreadId );
-    this->ProcessingThreadId = -1;
+    while (!this->InternalProcessingTaskQueue->empty())
+      {
+      this->InternalProcessingTaskQueue->pop();
+      }
+    while (!this->InternalNetworkingTaskQueue->empty())
+      {
+      this->InternalNetworkingTaskQueue->pop();
+      }
+    this->ProcessingTaskQueueLock.unlock();
+    this->InternalProcessingTaskQueue->TaskAvailableCondition.notify_all();
+    this->InternalNetworkingTaskQueue->TaskAvailableCondition.notify_all();
 
+    // Note that TerminateThread does not kill a thread, it only waits
+    // for the thread to finish (running tasks are completed).
     std::vector<int>::const_iterator idIterator;
-    idIterator = this->NetworkingThreadIDs.begin();
-    while (idIterator != this->NetworkingThreadIDs.end())
+    for (idIterator = this->ProcessingThreadIDs.begin();
+      idIterator != this->ProcessingThreadIDs.end(); ++idIterator)
+      {
+      this->ProcessingThreader->TerminateThread( *idIterator );
+      }
+    this->ProcessingThreadIDs.clear();
+    for (idIterator = this->NetworkingThreadIDs.begin();
+      idIterator != this->NetworkingThreadIDs.end(); ++idIterator)
       {
       this->ProcessingThreader->TerminateThread( *idIterator );
-      ++idIterator;
       }
     this->NetworkingThreadIDs.clear();
-
     }
 }
 
@@ -300,50 +455,10 @@ vtkSlicerApplicationLogic
 //----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::ProcessProcessingTasks()
 {
-  int active = true;
-  vtkSmartPointer<vtkSlicerTask> task = nullptr;
-
-  while (active)
-    {
-    // Check to see if we should be shutting down
-    this->ProcessingThreadActiveLock.lock();
-    active = this->ProcessingThreadActive;
-    this->ProcessingThreadActiveLock.unlock();
-
-    if (active)
-      {
-      // pull a task off the queue
-      this->ProcessingTaskQueueLock.lock();
-      if ((*this->InternalTaskQueue).size() > 0)
-        {
-        // std::cout << "Number of queued tasks: " << (*this->InternalTaskQueue).size() << std::endl;
-
-        // only handle processing tasks in this thread
-        task = (*this->InternalTaskQueue).front();
-        if ( task->GetType() == vtkSlicerTask::Processing )
-          {
-          (*this->InternalTaskQueue).pop();
-          }
-        else
-          {
-          task = nullptr;
-          }
-        }
-      this->ProcessingTaskQueueLock.unlock();
-
-      // process the task (should this be in a separate thread?)
-      if (task)
-        {
-        task->Execute();
-        task = nullptr;
-        }
-      }
-
-    // busy wait
-    itksys::SystemTools::Delay(100);
-    }
+  this->ProcessTasks(vtkSlicerTask::Processing);
 }
 
+//----------------------------------------------------------------------------
 itk::ITK_THREAD_RETURN_TYPE
 vtkSlicerApplicationLogic
 ::NetworkingThreaderCallback( void *arg )
@@ -382,66 +497,90 @@ vtkSlicerApplicationLogic
 //----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::ProcessNetworkingTasks()
 {
-  int active = true;
-  vtkSmartPointer<vtkSlicerTask> task = nullptr;
+  this->ProcessTasks(vtkSlicerTask::Networking);
+}
+
+//----------------------------------------------------------------------------
+ProcessingTaskQueue* vtkSlicerApplicationLogic::GetTaskQueue(int taskType)
+{
+  switch (taskType)
+    {
+    case vtkSlicerTask::Processing: return this->InternalProcessingTaskQueue;
+    case vtkSlicerTask::Networking: return this->InternalNetworkingTaskQueue;
+    default: return nullptr;
+    }
+}
 
-  while (active)
+//----------------------------------------------------------------------------
+void vtkSlicerApplicationLogic::ProcessTasks(int taskType)
+{
+  ProcessingTaskQueue* taskQueue = this->GetTaskQueue(taskType);
+  if (!taskQueue)
     {
-    // Check to see if we should be shutting down
-    this->ProcessingThreadActiveLock.lock();
-    active = this->ProcessingThreadActive;
-    this->ProcessingThreadActiveLock.unlock();
+    return;
+    }
 
-    if (active)
+  while (true)
+    {
+    vtkSmartPointer<vtkSlicerTask> task;
       {
-      // pull a task off the queue
-      this->ProcessingTaskQueueLock.lock();
-      if ((*this->InternalTaskQueue).size() > 0)
+      // Sleep until a task is scheduled or the threads are terminated
+      std::unique_lock<std::mutex> lock(this->ProcessingTaskQueueLock);
+      while (this->ProcessingThreadActive && taskQueue->empty())
         {
-        // std::cout << "Number of queued tasks: " << (*this->InternalTaskQueue).size() << std::endl;
-        task = (*this->InternalTaskQueue).front();
-        if ( task->GetType() == vtkSlicerTask::Networking )
-          {
-          (*this->InternalTaskQueue).pop();
-          }
-        else
-          {
-          task = nullptr;
-          }
+        taskQueue->TaskAvailableCondition.wait(lock);
         }
-      this->ProcessingTaskQueueLock.unlock();
-
-      // process the task (should this be in a separate thread?)
-      if (task)
+      if (!this->ProcessingThreadActive)
         {
-        task->Execute();
-        task = nullptr;
+        return;
         }
+      task = taskQueue->top().Task;
+      taskQueue->pop();
       }
 
-    // busy wait
-    itksys::SystemTools::Delay(100);
+    task->Execute();
     }
 }
 
 //----------------------------------------------------------------------------
 int vtkSlicerApplicationLogic::ScheduleTask( vtkSlicerTask *task )
 {
-  // only schedule a task if the processing task is up
-  this->ProcessingThreadActiveLock.lock();
-  int active = this->ProcessingThreadActive;
-  this->ProcessingThreadActiveLock.unlock();
-  if (!active)
+  ProcessingTaskQueue* taskQueue = task ? this->GetTaskQueue(task->GetType()) : nullptr;
+  if (!taskQueue)
     {
+    vtkErrorMacro("ScheduleTask: task type must be Processing or Networking");
     return false;
     }
 
-  this->ProcessingTaskQueueLock.lock();
-  (*this->InternalTaskQueue).push( task );
-  this->ProcessingTaskQueueLock.unlock();
+  std::unique_lock<std::mutex> lock(this->ProcessingTaskQueueLock);
+  // only schedule a task if the processing threads are up
+  if (!this->ProcessingThreadActive)
+    {
+    return false;
+    }
+  ScheduledTask scheduledTask;
+  scheduledTask.Task = task;
+  scheduledTask.Priority = task->GetPriority();
+  scheduledTask.ScheduleOrder = this->NumberOfTasksScheduled++;
+  taskQueue->push(scheduledTask);
+  lock.unlock();
+
+  taskQueue->TaskAvailableCondition.notify_one();
   return true;
 }
 
+//----------------------------------------------------------------------------
+int vtkSlicerApplicationLogic::GetNumberOfScheduledTasks(int taskType)
+{
+  ProcessingTaskQueue* taskQueue = this->GetTaskQueue(taskType);
+  if (!taskQueue)
+    {
+    return 0;
+    }
+  std::lock_guard<std::mutex> lock(this->ProcessingTaskQueueLock);
+  return static_cast<int>(taskQueue->size());
+}
+
 //----------------------------------------------------------------------------
 vtkMTimeType vtkSlicerApplicationLogic::RequestModified(vtkObject *obj)
 {
@@ -455,120 +594,105 @@ vtkMTimeType vtkSlicerApplicationLogic::RequestModified(vtkObject *obj)
     return 0;
     }
 
-  obj->Register(this);
+  ModifiedRequest request;
+  request.Object = obj;
+  request.RequestTime = vtkTimerLog::GetUniversalTime();
+
   this->ModifiedQueueLock.lock();
   this->RequestTimeStamp.Modified();
   vtkMTimeType uid = this->RequestTimeStamp.GetMTime();
-  (*this->InternalModifiedQueue).push(obj);
+  (*this->InternalModifiedQueue).push(request);
+  // only the first request posted to an idle queue wakes up the main thread
+  bool wakeUp = !this->InternalModifiedQueue->WakeUpRequested && this->CanWakeUpMainThread();
+  if (wakeUp)
+    {
+    this->InternalModifiedQueue->WakeUpRequested = true;
+    }
   this->ModifiedQueueLock.unlock();
+
+  if (wakeUp)
+    {
+    this->WakeUpMainThread(vtkSlicerApplicationLogic::RequestModifiedEvent);
+    }
   return uid;
 }
 
 //----------------------------------------------------------------------------
-vtkMTimeType vtkSlicerApplicationLogic::RequestReadFile(const char *refNode, const char *filename, int displayData, int deleteFile)
+vtkMTimeType vtkSlicerApplicationLogic::QueueDataRequest(int requestEvent, DataRequest* request)
 {
-  // only request to read a file if the ReadData queue is up
-  this->ReadDataQueueActiveLock.lock();
-  int active = this->ReadDataQueueActive;
-  this->ReadDataQueueActiveLock.unlock();
+  bool readData = (requestEvent == vtkSlicerApplicationLogic::RequestReadDataEvent);
+  std::mutex& activeLock = readData ? this->ReadDataQueueActiveLock : this->WriteDataQueueActiveLock;
+  std::mutex& queueLock = readData ? this->ReadDataQueueLock : this->WriteDataQueueLock;
+  DataRequestQueue* queue = readData ?
+    static_cast<DataRequestQueue*>(this->InternalReadDataQueue) :
+    static_cast<DataRequestQueue*>(this->InternalWriteDataQueue);
+
+  // only queue the request if the queue is up
+  activeLock.lock();
+  int active = readData ? this->ReadDataQueueActive : this->WriteDataQueueActive;
+  activeLock.unlock();
   if (!active)
-  {
+    {
     // could not request the record be added to the queue
+    delete request;
     return 0;
-  }
+    }
+
+  request->SetRequestTime(vtkTimerLog::GetUniversalTime());
 
-  this->ReadDataQueueLock.lock();
+  queueLock.lock();
   this->RequestTimeStamp.Modified();
   vtkMTimeType uid = this->RequestTimeStamp.GetMTime();
-  (*this->InternalReadDataQueue).push(
-    new ReadDataRequestFile(refNode, filename, displayData, deleteFile, uid));
-  this->ReadDataQueueLock.unlock();
+  request->SetUID(uid);
+  queue->push(request);
+  // only the first request posted to an idle queue wakes up the main thread
+  bool wakeUp = !queue->WakeUpRequested && this->CanWakeUpMainThread();
+  if (wakeUp)
+    {
+    queue->WakeUpRequested = true;
+    }
+  queueLock.unlock();
+
+  if (wakeUp)
+    {
+    this->WakeUpMainThread(requestEvent);
+    }
   return uid;
 }
 
 //----------------------------------------------------------------------------
-vtkMTimeType vtkSlicerApplicationLogic::RequestUpdateParentTransform(const std::string &refNode, const std::string& parentTransformNode)
+vtkMTimeType vtkSlicerApplicationLogic::RequestReadFile(const char *refNode, const char *filename, int displayData, int deleteFile)
 {
-  // only request to read a file if the ReadData queue is up
-  this->ReadDataQueueActiveLock.lock();
-  int active = this->ReadDataQueueActive;
-  this->ReadDataQueueActiveLock.unlock();
-  if (!active)
-    {
-    // could not request the record be added to the queue
-    return 0;
-    }
+  return this->QueueDataRequest(vtkSlicerApplicationLogic::RequestReadDataEvent,
+    new ReadDataRequestFile(refNode, filename, displayData, deleteFile));
+}
 
-  this->ReadDataQueueLock.lock();
-  this->RequestTimeStamp.Modified();
-  vtkMTimeType uid = this->RequestTimeStamp.GetMTime();
-  (*this->InternalReadDataQueue).push(new ReadDataRequestUpdateParentTransform(refNode, parentTransformNode, uid));
-  this->ReadDataQueueLock.unlock();
-  return uid;
+//----------------------------------------------------------------------------
+vtkMTimeType vtkSlicerApplicationLogic::RequestUpdateParentTransform(const std::string &refNode, const std::string& parentTransformNode)
+{
+  return this->QueueDataRequest(vtkSlicerApplicationLogic::RequestReadDataEvent,
+    new ReadDataRequestUpdateParentTransform(refNode, parentTransformNode));
 }
 
 //----------------------------------------------------------------------------
 vtkMTimeType vtkSlicerApplicationLogic::RequestUpdateSubjectHierarchyLocation(const std::string &updatedNode, const std::string& siblingNode)
 {
-  // only request to read a file if the ReadData queue is up
-  this->ReadDataQueueActiveLock.lock();
-  int active = this->ReadDataQueueActive;
-  this->ReadDataQueueActiveLock.unlock();
-  if (!active)
-    {
-    // could not request the record be added to the queue
-    return 0;
-    }
-
-  this->ReadDataQueueLock.lock();
-  this->RequestTimeStamp.Modified();
-  vtkMTimeType uid = this->RequestTimeStamp.GetMTime();
-  (*this->InternalReadDataQueue).push(new ReadDataRequestUpdateSubjectHierarchyLocation(updatedNode, siblingNode, uid));
-  this->ReadDataQueueLock.unlock();
-  return uid;
+  return this->QueueDataRequest(vtkSlicerApplicationLogic::RequestReadDataEvent,
+    new ReadDataRequestUpdateSubjectHierarchyLocation(updatedNode, siblingNode));
 }
 
 //----------------------------------------------------------------------------
 vtkMTimeType vtkSlicerApplicationLogic::RequestAddNodeReference(const std::string &referencingNode, const std::string& referencedNode, const std::string& role)
 {
-  // only request to read a file if the ReadData queue is up
-  this->ReadDataQueueActiveLock.lock();
-  int active = this->ReadDataQueueActive;
-  this->ReadDataQueueActiveLock.unlock();
-  if (!active)
-    {
-    // could not request the record be added to the queue
-    return 0;
-    }
-
-  this->ReadDataQueueLock.lock();
-  this->RequestTimeStamp.Modified();
-  vtkMTimeType uid = this->RequestTimeStamp.GetMTime();
-  (*this->InternalReadDataQueue).push(new ReadDataRequestAddNodeReference(referencingNode, referencedNode, role, uid));
-  this->ReadDataQueueLock.unlock();
-  return uid;
+  return this->QueueDataRequest(vtkSlicerApplicationLogic::RequestReadDataEvent,
+    new ReadDataRequestAddNodeReference(referencingNode, referencedNode, role));
 }
 
 //----------------------------------------------------------------------------
 vtkMTimeType vtkSlicerApplicationLogic::RequestWriteData(const char *refNode, const char *filename)
 {
-  // only request to write a file if the WriteData queue is up
-  this->WriteDataQueueActiveLock.lock();
-  int active = this->WriteDataQueueActive;
-  this->WriteDataQueueActiveLock.unlock();
-  if (!active)
-    {
-    // could not request the record be added to the queue
-    return 0;
-    }
-
-  this->WriteDataQueueLock.lock();
-  this->RequestTimeStamp.Modified();
-  vtkMTimeType uid = this->RequestTimeStamp.GetMTime();
-  (*this->InternalWriteDataQueue).push(
-    new WriteDataRequestFile(refNode, filename, uid) );
-  this->WriteDataQueueLock.unlock();
-  return uid;
+  return this->QueueDataRequest(vtkSlicerApplicationLogic::RequestWriteDataEvent,
+    new WriteDataRequestFile(refNode, filename));
 }
 
 //----------------------------------------------------------------------------
@@ -578,23 +702,8 @@ vtkMTimeType vtkSlicerApplicationLogic::RequestReadScene(
     std::vector<std::string> &sourceIDs,
     int displayData, int deleteFile)
 {
-  // only request to read a file if the ReadData queue is up
-  this->ReadDataQueueActiveLock.lock();
-  int active = this->ReadDataQueueActive;
-  this->ReadDataQueueActiveLock.unlock();
-  if (!active)
-    {
-    // could not request the record be added to the queue
-    return 0;
-    }
-
-  this->ReadDataQueueLock.lock();
-  this->RequestTimeStamp.Modified();
-  vtkMTimeType uid = this->RequestTimeStamp.GetMTime();
-  (*this->InternalReadDataQueue).push(
-    new ReadDataRequestScene(targetIDs, sourceIDs, filename, displayData, deleteFile, uid));
-  this->ReadDataQueueLock.unlock();
-  return uid;
+  return this->QueueDataRequest(vtkSlicerApplicationLogic::RequestReadDataEvent,
+    new ReadDataRequestScene(targetIDs, sourceIDs, filename, displayData, deleteFile));
 }
 
 //----------------------------------------------------------------------------
@@ -609,118 +718,142 @@ void vtkSlicerApplicationLogic::ProcessModified()
     return;
     }
 
-  vtkSmartPointer<vtkObject> obj = nullptr;
-  // pull an object off the queue to modify
-  this->ModifiedQueueLock.lock();
-  if ((*this->InternalModifiedQueue).size() > 0)
+  double startTime = vtkTimerLog::GetUniversalTime();
+  bool firstRequest = true;
+  bool moreRequests = false;
+  while (true)
     {
-    obj = (*this->InternalModifiedQueue).front();
-    (*this->InternalModifiedQueue).pop();
+    vtkSmartPointer<vtkObject> obj;
+    // pull an object off the queue to modify
+    this->ModifiedQueueLock.lock();
+    if (firstRequest)
+      {
+      this->MaximumRequestQueueSize = std::max(this->MaximumRequestQueueSize,
+        static_cast<int>(this->InternalModifiedQueue->size()));
+      }
+    if (this->InternalModifiedQueue->empty())
+      {
+      // next request will wake up the main thread
+      this->InternalModifiedQueue->WakeUpRequested = false;
+      }
+    else if (!firstRequest
+      && vtkTimerLog::GetUniversalTime() - startTime >= this->MaximumRequestProcessingTime)
+      {
+      moreRequests = true;
+      }
+    else
+      {
+      obj = this->InternalModifiedQueue->front().Object;
+      this->UpdateRequestStatistics(this->InternalModifiedQueue->front().RequestTime);
+      this->InternalModifiedQueue->pop();
 
-    // pop off any extra copies of the same object to save some updates
-    while (!(*this->InternalModifiedQueue).empty()
-           && (obj == (*this->InternalModifiedQueue).front()))
+      // pop off any extra copies of the same object to save some updates
+      while (!this->InternalModifiedQueue->empty()
+             && (obj == this->InternalModifiedQueue->front().Object))
+        {
+        this->UpdateRequestStatistics(this->InternalModifiedQueue->front().RequestTime);
+        this->InternalModifiedQueue->pop();
+        }
+      }
+    this->ModifiedQueueLock.unlock();
+
+    if (!obj)
       {
-      (*this->InternalModifiedQueue).pop();
-      obj->Delete(); // decrement ref count
+      break;
       }
+    firstRequest = false;
+    obj->Modified();
     }
-  this->ModifiedQueueLock.unlock();
 
-  // Modify the object
-  //  - decrement reference count that was increased when it was added to the queue
-  if (obj.GetPointer())
+  if (moreRequests)
     {
-    obj->Modified();
-    obj->Delete();
-    obj = nullptr;
+    // process the remaining requests in the next event loop iteration
+    this->WakeUpMainThread(vtkSlicerApplicationLogic::RequestModifiedEvent);
     }
-
-  // schedule the next timer sooner in case there is stuff in the queue
-  // otherwise for a while later
-  int delay = (*this->InternalModifiedQueue).size() > 0 ? 0: 200;
-  this->InvokeEvent(vtkSlicerApplicationLogic::RequestModifiedEvent, &delay);
 }
 
 //----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::ProcessReadData()
 {
-  // Check to see if we should be shutting down
-  this->ReadDataQueueActiveLock.lock();
-  int active = this->ReadDataQueueActive;
-  this->ReadDataQueueActiveLock.unlock();
-  if (!active)
-    {
-    return;
-    }
-
-  // pull an object off the queue
-  DataRequest* req = nullptr;
-  this->ReadDataQueueLock.lock();
-  if ((*this->InternalReadDataQueue).size() > 0)
-    {
-    req = (*this->InternalReadDataQueue).front();
-    (*this->InternalReadDataQueue).pop();
-    }
-  this->ReadDataQueueLock.unlock();
-
-  vtkMTimeType uid = 0;
-  if (req)
-    {
-    uid = req->GetUID();
-    req->Execute(this);
-    delete req;
-    }
-
-  int delay = (*this->InternalReadDataQueue).size() > 0 ? 0: 200;
-  // schedule the next timer sooner in case there is stuff in the queue
-  // otherwise for a while later
-  this->InvokeEvent(vtkSlicerApplicationLogic::RequestReadDataEvent, &delay);
-  if (uid)
-    {
-    this->InvokeEvent(vtkSlicerApplicationLogic::RequestProcessedEvent,
-                      reinterpret_cast<void*>(uid));
-    }
+  this->ProcessDataRequests(vtkSlicerApplicationLogic::RequestReadDataEvent);
 }
 
 //----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::ProcessWriteData()
 {
+  this->ProcessDataRequests(vtkSlicerApplicationLogic::RequestWriteDataEvent);
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerApplicationLogic::ProcessDataRequests(int requestEvent)
+{
+  bool readData = (requestEvent == vtkSlicerApplicationLogic::RequestReadDataEvent);
+  std::mutex& activeLock = readData ? this->ReadDataQueueActiveLock : this->WriteDataQueueActiveLock;
+  std::mutex& queueLock = readData ? this->ReadDataQueueLock : this->WriteDataQueueLock;
+  DataRequestQueue* queue = readData ?
+    static_cast<DataRequestQueue*>(this->InternalReadDataQueue) :
+    static_cast<DataRequestQueue*>(this->InternalWriteDataQueue);
+
   // Check to see if we should be shutting down
-  this->WriteDataQueueActiveLock.lock();
-  int active = this->WriteDataQueueActive;
-  this->WriteDataQueueActiveLock.unlock();
+  activeLock.lock();
+  int active = readData ? this->ReadDataQueueActive : this->WriteDataQueueActive;
+  activeLock.unlock();
   if (!active)
     {
     return;
     }
 
-  // pull an object off the queue
-  DataRequest *req = nullptr;
-  this->WriteDataQueueLock.lock();
-  if ((*this->InternalWriteDataQueue).size() > 0)
+  double startTime = vtkTimerLog::GetUniversalTime();
+  bool firstRequest = true;
+  bool moreRequests = false;
+  while (true)
     {
-    req = (*this->InternalWriteDataQueue).front();
-    (*this->InternalWriteDataQueue).pop();
-    }
-  this->WriteDataQueueLock.unlock();
+    // pull a request off the queue
+    DataRequest* req = nullptr;
+    queueLock.lock();
+    if (firstRequest)
+      {
+      this->MaximumRequestQueueSize = std::max(this->MaximumRequestQueueSize,
+        static_cast<int>(queue->size()));
+      }
+    if (queue->empty())
+      {
+      // next request will wake up the main thread
+      queue->WakeUpRequested = false;
+      }
+    else if (!firstRequest
+      && vtkTimerLog::GetUniversalTime() - startTime >= this->MaximumRequestProcessingTime)
+      {
+      moreRequests = true;
+      }
+    else
+      {
+      req = queue->front();
+      queue->pop();
+      }
+    queueLock.unlock();
 
-  if (req)
-  {
+    if (!req)
+      {
+      break;
+      }
+    firstRequest = false;
+    this->UpdateRequestStatistics(req->GetRequestTime());
     vtkMTimeType uid = req->GetUID();
     req->Execute(this);
     delete req;
-
-    // schedule the next timer sooner in case there is stuff in the queue
-    // otherwise for a while later
-    int delay = (*this->InternalWriteDataQueue).size() > 0 ? 0 : 200;
-    this->InvokeEvent(vtkSlicerApplicationLogic::RequestWriteDataEvent, &delay);
     if (uid)
       {
       this->InvokeEvent(vtkSlicerApplicationLogic::RequestProcessedEvent,
-        reinterpret_cast<void*>(uid));
+                        reinterpret_cast<void*>(uid));
       }
-  }
+    }
+
+  if (moreRequests)
+    {
+    // process the remaining requests in the next event loop iteration
+    this->WakeUpMainThread(requestEvent);
+    }
 }
 
 //----------------------------------------------------------------------------
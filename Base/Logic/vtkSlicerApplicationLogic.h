@@ -32,6 +32,8 @@
 
 // STL includes
 #include <mutex>
+#include <thread>
+#include <vector>
 
 class vtkMRMLSelectionNode;
 class vtkMRMLInteractionNode;
@@ -39,6 +41,7 @@ class vtkMRMLRemoteIOLogic;
 class vtkDataIOManagerLogic;
 class vtkPersonInformation;
 class vtkSlicerTask;
+class DataRequest;
 class ModifiedQueue;
 class ProcessingTaskQueue;
 class ReadDataQueue;
@@ -72,12 +75,39 @@ class VTK_SLICER_BASE_LOGIC_EXPORT vtkSlicerApplicationLogic
   /// (display it in the Fiducials GUI)
   void PropagateFiducialListSelection();
 
-  /// Create a thread for processing
+  /// Create the threads that run processing and networking tasks
   void CreateProcessingThread();
 
-  /// Shutdown the processing thread
+  /// Shutdown the processing and networking threads.
+  /// Tasks that have not started yet are discarded.
   void TerminateProcessingThread();
+
+  /// Number of threads running processing tasks (such as CLI modules).
+  /// Up to this number of processing tasks run concurrently. Tasks may look
+  /// up nodes of the scene (the scene indices are rebuilt under a lock), but
+  /// must request the modifications to be done in the main thread.
+  /// Changes take effect the next time CreateProcessingThread() is called.
+  /// Default is 4.
+  vtkSetClampMacro(NumberOfProcessingThreads, int, 1, 64);
+  vtkGetMacro(NumberOfProcessingThreads, int);
+
+  /// Number of threads running networking tasks.
+  /// Changes take effect the next time CreateProcessingThread() is called.
+  /// Default is 1, as remote data transfer is not thread-safe.
+  vtkSetClampMacro(NumberOfNetworkingThreads, int, 1, 64);
+  vtkGetMacro(NumberOfNetworkingThreads, int);
+
+  /// Return the number of tasks of type \a taskType (vtkSlicerTask::Processing
+  /// or vtkSlicerTask::Networking) that are scheduled but not started yet.
+  int GetNumberOfScheduledTasks(int taskType);
   /// List of events potentially fired by the application logic
+  /// RequestModifiedEvent, RequestReadDataEvent and RequestWriteDataEvent
+  /// ask the application to call ProcessModified(), ProcessReadData() and
+  /// ProcessWriteData() in the main thread. A pointer to the delay (int, in ms)
+  /// is passed as callData. These events are only invoked from the main thread
+  /// (the thread that created the application logic) and only when no
+  /// request wake-up callback is set.
+  /// \sa SetRequestWakeUpCallback()
   enum RequestEvents
     {
       RequestModifiedEvent = vtkMRMLApplicationLogic::RequestInvokeEvent + 1,
@@ -90,9 +120,24 @@ class VTK_SLICER_BASE_LOGIC_EXPORT vtkSlicerApplicationLogic
       RequestProcessedEvent
     };
 
-  /// Schedule a task to run in the processing thread. Returns true if
-  /// task was successfully scheduled. ScheduleTask() is called from the
-  /// main thread to run something in the processing thread.
+  /// Function called to wake up the main thread when a request is posted to
+  /// an idle Modified, ReadData or WriteData queue, or when requests remain
+  /// after processing. \a requestEvent is RequestModifiedEvent,
+  /// RequestReadDataEvent or RequestWriteDataEvent.
+  /// The function is called from the thread that posted the request, it must
+  /// be thread-safe and only post the processing (ProcessModified(),
+  /// ProcessReadData() or ProcessWriteData()) to the main thread event loop.
+  /// Without callback, requests posted from other threads than the main
+  /// thread are only processed when the main thread processes the queue.
+  typedef void (*RequestWakeUpCallbackType)(int requestEvent, void* clientData);
+  void SetRequestWakeUpCallback(RequestWakeUpCallbackType callback, void* clientData);
+
+  /// Schedule a task to run in a processing or networking thread, depending
+  /// on the task type. Returns true if task was successfully scheduled.
+  /// ScheduleTask() is called from the main thread to run something in the
+  /// processing thread. Tasks of higher priority start first, tasks of the
+  /// same priority start in the order they are scheduled.
+  /// \sa vtkSlicerTask::SetPriority()
   int ScheduleTask( vtkSlicerTask* );
 
   /// Request a Modified call on an object.  This method allows a
@@ -146,6 +191,11 @@ class VTK_SLICER_BASE_LOGIC_EXPORT vtkSlicerApplicationLogic
   /// multiple items are being returned and have all been returned).
   unsigned int GetReadDataQueueSize();
 
+  /// Return the number of pending Modified requests.
+  unsigned int GetModifiedQueueSize();
+
+  /// Return the number of pending write requests.
+  unsigned int GetWriteDataQueueSize();
 
   /// Request that data be written from a file to a remote destination.
   /// Return the request UID (monotonically increasing) of the request or 0 if
@@ -170,21 +220,45 @@ class VTK_SLICER_BASE_LOGIC_EXPORT vtkSlicerApplicationLogic
                        int displayData = false,
                        int deleteFile = false);
 
-  /// Process a request on the Modified queue.  This method is called
+  /// Process the requests on the Modified queue.  This method is called
   /// in the main thread of the application because calls to Modified()
   /// can cause an update to the GUI. (Method needs to be public to fit
   /// in the event callback chain.)
+  /// \sa MaximumRequestProcessingTime
   void ProcessModified();
 
-  /// Process a request to read data and set it on a referenced node.
+  /// Process the requests to read data and set it on a referenced node.
   /// This method is called in the main thread of the application
   /// because calls to load data will cause a Modified() on a node
   /// which can force a render.
+  /// \sa MaximumRequestProcessingTime
   void ProcessReadData();
 
-  /// Process a request to write data from a referenced node.
+  /// Process the requests to write data from a referenced node.
+  /// \sa MaximumRequestProcessingTime
   void ProcessWriteData();
 
+  /// Maximum time (in seconds) spent processing requests in one call of
+  /// ProcessModified(), ProcessReadData() or ProcessWriteData(). At least
+  /// one request is processed per call. If requests remain when the time
+  /// is up, the corresponding Request...Event is invoked again so that they
+  /// are processed in the next iteration of the application event loop.
+  /// Default is 0.05s.
+  vtkSetMacro(MaximumRequestProcessingTime, double);
+  vtkGetMacro(MaximumRequestProcessingTime, double);
+
+  /// Number of requests processed in the main thread since the last call
+  /// of ResetRequestStatistics().
+  vtkGetMacro(NumberOfProcessedRequests, int);
+  /// Average and maximum time (in seconds) requests have waited in a queue
+  /// before being processed in the main thread.
+  double GetAverageRequestWaitTime();
+  vtkGetMacro(MaximumRequestWaitTime, double);
+  /// Largest number of pending requests found in a queue when starting to process it.
+  vtkGetMacro(MaximumRequestQueueSize, int);
+  /// Reset the request processing statistics.
+  void ResetRequestStatistics();
+
   /// These routings act as place holders so that test scripts can
   /// turn on and off tracing.  These are just hooks
   /// for use with external tracing tool (such as AQTime)
@@ -232,12 +306,19 @@ protected:
    /// Callback used by a MultiThreader to start a networking thread
   static itk::ITK_THREAD_RETURN_TYPE NetworkingThreaderCallback( void * );
 
-  /// Task processing loop that is run in the processing thread
+  /// Task processing loop that is run in the processing threads
   void ProcessProcessingTasks();
 
-  /// Networking Task processing loop that is run in a networking thread
+  /// Networking Task processing loop that is run in the networking threads
   void ProcessNetworkingTasks();
 
+  /// Run tasks of type \a taskType as they are scheduled, until the
+  /// processing threads are terminated.
+  void ProcessTasks(int taskType);
+
+  /// Return the queue of tasks of type \a taskType, nullptr if the type is invalid.
+  ProcessingTaskQueue* GetTaskQueue(int taskType);
+
   /// Process a request to read data into a scene.  This method is
   /// called by ProcessReadData() in the application main thread
   /// because calls to load data will cause a Modified() on a node
@@ -245,12 +326,31 @@ protected:
   void ProcessReadSceneData( ReadDataRequest &req );
   void ProcessWriteSceneData( WriteDataRequest &req );
 
+  /// Add a request to the read (if \a requestEvent is RequestReadDataEvent)
+  /// or write data queue and wake up the main thread if needed.
+  /// Return the request UID or 0 (and delete the request) if the queue is
+  /// not active.
+  vtkMTimeType QueueDataRequest(int requestEvent, DataRequest* request);
+
+  /// Process the requests of the read or write data queue.
+  void ProcessDataRequests(int requestEvent);
+
+  /// Update statistics before processing a request queued at \a requestTime.
+  void UpdateRequestStatistics(double requestTime);
+
+  /// Return true if WakeUpMainThread() can be called from the current thread.
+  bool CanWakeUpMainThread();
+  /// Ask the main thread to process the queue of \a requestEvent, using the
+  /// wake-up callback if any, or invoking \a requestEvent in the main thread.
+  /// VTK events are never invoked from other threads.
+  void WakeUpMainThread(int requestEvent);
+
 private:
   vtkSlicerApplicationLogic(const vtkSlicerApplicationLogic&);
   void operator=(const vtkSlicerApplicationLogic&);
 
   itk::PlatformMultiThreader::Pointer ProcessingThreader;
-  std::mutex ProcessingThreadActiveLock;
+  /// Protects the task queues and ProcessingThreadActive
   std::mutex ProcessingTaskQueueLock;
   std::mutex ModifiedQueueActiveLock;
   std::mutex ModifiedQueueLock;
@@ -258,19 +358,33 @@ private:
   std::mutex ReadDataQueueLock;
   std::mutex WriteDataQueueActiveLock;
   std::mutex WriteDataQueueLock;
+  std::mutex RequestWakeUpCallbackLock;
+  RequestWakeUpCallbackType RequestWakeUpCallback;
+  void* RequestWakeUpClientData;
+  std::thread::id MainThreadID;
   vtkTimeStamp RequestTimeStamp;
-  int ProcessingThreadId;
+  std::vector<int> ProcessingThreadIDs;
   std::vector<int> NetworkingThreadIDs;
+  int NumberOfProcessingThreads;
+  int NumberOfNetworkingThreads;
   int ProcessingThreadActive;
+  unsigned long NumberOfTasksScheduled;
   int ModifiedQueueActive;
   int ReadDataQueueActive;
   int WriteDataQueueActive;
 
-  ProcessingTaskQueue* InternalTaskQueue;
+  ProcessingTaskQueue* InternalProcessingTaskQueue;
+  ProcessingTaskQueue* InternalNetworkingTaskQueue;
   ModifiedQueue*       InternalModifiedQueue;
   ReadDataQueue*       InternalReadDataQueue;
   WriteDataQueue*      InternalWriteDataQueue;
 
+  double MaximumRequestProcessingTime;
+  int NumberOfProcessedRequests;
+  double TotalRequestWaitTime;
+  double MaximumRequestWaitTime;
+  int MaximumRequestQueueSize;
+
   vtkPersonInformation* UserInformation;
 
   /// For use with external tracing tool (such as AQTime)
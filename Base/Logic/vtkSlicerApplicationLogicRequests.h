@@ -26,11 +26,13 @@ public:
   DataRequest()
   {
     m_UID = 0;
+    m_RequestTime = 0.0;
   }
 
   DataRequest(int uid)
   {
     m_UID = uid;
+    m_RequestTime = 0.0;
   }
 
   virtual ~DataRequest()  = default;
@@ -38,9 +40,15 @@ public:
   virtual void Execute(vtkSlicerApplicationLogic*) {};
 
   int GetUID()const{return m_UID;}
+  void SetUID(vtkMTimeType uid){m_UID = uid;}
+
+  /// Time (vtkTimerLog::GetUniversalTime()) when the request was queued
+  double GetRequestTime()const{return m_RequestTime;}
+  void SetRequestTime(double requestTime){m_RequestTime = requestTime;}
 
 protected:
   vtkMTimeType m_UID;
+  double m_RequestTime;
 };
 
 //----------------------------------------------------------------------------
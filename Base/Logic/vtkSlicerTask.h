@@ -38,6 +38,12 @@ public:
   void SetTypeToProcessing() {this->SetType(vtkSlicerTask::Processing);};
   void SetTypeToNetworking() {this->SetType(vtkSlicerTask::Networking);};
 
+  ///
+  /// Priority of the task. Scheduled tasks of higher priority are started
+  /// before tasks of lower priority. Default is 0.
+  vtkSetMacro(Priority, int);
+  vtkGetMacro(Priority, int);
+
   const char* GetTypeAsString( ) {
     switch (this->Type)
       {
@@ -60,6 +66,7 @@ private:
   void *TaskClientData;
 
   int Type;
+  int Priority;
 
 };
 #endif
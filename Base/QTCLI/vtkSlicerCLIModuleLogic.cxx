@@ -30,9 +30,11 @@
 #include <vtkMRMLStorageNode.h>
 #include <vtkMRMLModelStorageNode.h>
 #include <vtkMRMLTransformNode.h>
+#include <vtkMRMLVolumeNode.h>
 
 // VTK includes
 #include <vtkCallbackCommand.h>
+#include <vtkImageData.h>
 #include <vtkIntArray.h>
 #include <vtkMultiThreader.h>
 #include <vtkNew.h>
@@ -64,6 +66,9 @@
 #include <sys/types.h>
 #include <unistd.h>
 #endif
+#ifdef __linux__
+#include <sys/statvfs.h>
+#endif
 
 //----------------------------------------------------------------------------
 struct DigitsToCharacters
@@ -82,6 +87,12 @@ struct DigitsToCharacters
 typedef std::pair<vtkSlicerCLIModuleLogic *, vtkMRMLCommandLineModuleNode *> LogicNodePair;
 class MRMLIDMap : public std::map<std::string, std::string> {};
 
+//----------------------------------------------------------------------------
+// Shared object modules run in the application process and their output is
+// captured by redirecting the standard streams, which are process-wide.
+// Only one of them can run at a time, even if tasks run concurrently.
+static std::mutex SharedObjectModuleExecutionLock;
+
 //---------------------------------------------------------------------------
 class vtkSlicerCLIRescheduleCallback : public vtkCallbackCommand
 {
@@ -199,6 +210,7 @@ public:
   ModuleDescription DefaultModuleDescription;
   int DeleteTemporaryFiles;
   int AllowInMemoryTransfer;
+  int AllowSharedMemoryTransfer;
 
   int RedirectModuleStreams;
 
@@ -229,6 +241,7 @@ public:
 
   void SetLastRequest(vtkMRMLCommandLineModuleNode* node, vtkMTimeType requestUID)
   {
+    std::lock_guard<std::mutex> lock(this->LastRequestsLock);
     RequestType::iterator it = std::find_if(
       this->LastRequests.begin(), this->LastRequests.end(), FindRequest(node));
     if (it == this->LastRequests.end())
@@ -243,6 +256,7 @@ public:
   }
   vtkMTimeType GetLastRequest(vtkMRMLCommandLineModuleNode* node)
   {
+    std::lock_guard<std::mutex> lock(this->LastRequestsLock);
     RequestType::iterator it = std::find_if(
       this->LastRequests.begin(), this->LastRequests.end(), FindRequest(node));
     return (it != this->LastRequests.end())? it->first : 0;
@@ -285,6 +299,9 @@ public:
   /// List of read data/scene requests of the CLI nodes
   /// being executed with their.
   RequestType LastRequests;
+  /// Protects LastRequests, CLI nodes of the logic may be executed
+  /// concurrently in different processing threads.
+  std::mutex LastRequestsLock;
 
   vtkSmartPointer<vtkSlicerCLIRescheduleCallback> RescheduleCallback;
   vtkSmartPointer<vtkSlicerCLIOneShotCallbackCallback>OneShotCallbackCallback;
@@ -300,6 +317,7 @@ vtkSlicerCLIModuleLogic::vtkSlicerCLIModuleLogic()
 
   this->Internal->DeleteTemporaryFiles = 1;
   this->Internal->AllowInMemoryTransfer = 1;
+  this->Internal->AllowSharedMemoryTransfer = 0;
   this->Internal->RedirectModuleStreams = 1;
   this->Internal->RescheduleCallback =
     vtkSmartPointer<vtkSlicerCLIRescheduleCallback>::New();
@@ -403,6 +421,22 @@ int vtkSlicerCLIModuleLogic::GetAllowInMemoryTransfer() const
   return this->Internal->AllowInMemoryTransfer;
 }
 
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::SetAllowSharedMemoryTransfer(int value)
+{
+  vtkDebugMacro(<< this->GetClassName() << " (" << this << "): setting AllowSharedMemoryTransfer to " << value);
+  if (this->Internal->AllowSharedMemoryTransfer != value)
+    {
+    this->Internal->AllowSharedMemoryTransfer = value;
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCLIModuleLogic::GetAllowSharedMemoryTransfer() const
+{
+  return this->Internal->AllowSharedMemoryTransfer;
+}
+
 //----------------------------------------------------------------------------
 void vtkSlicerCLIModuleLogic::RedirectModuleStreamsOn()
 {
@@ -479,6 +513,40 @@ vtkSlicerCLIModuleLogic
   return fname;
 }
 
+//----------------------------------------------------------------------------
+std::string
+vtkSlicerCLIModuleLogic
+::GetImageExchangeDirectory(size_t imageSize)
+{
+  std::string temporaryDirectory = ".";
+  vtkSlicerApplicationLogic* appLogic = this->GetApplicationLogic();
+  if (appLogic)
+    {
+    temporaryDirectory = appLogic->GetTemporaryPath();
+    }
+#ifdef __linux__
+  // tmpfs is backed by RAM (and swap): only use it if the images fit and
+  // leaves a quarter of it free for the other processes.
+  const char* sharedMemoryDirectory = "/dev/shm";
+  struct statvfs sharedMemoryStats;
+  if (this->GetAllowSharedMemoryTransfer()
+      && access(sharedMemoryDirectory, W_OK) == 0
+      && statvfs(sharedMemoryDirectory, &sharedMemoryStats) == 0)
+    {
+    unsigned long long blockSize = sharedMemoryStats.f_frsize;
+    unsigned long long available = sharedMemoryStats.f_bavail * blockSize;
+    unsigned long long margin = sharedMemoryStats.f_blocks * blockSize / 4;
+    if (available >= imageSize + margin)
+      {
+      return sharedMemoryDirectory;
+      }
+    }
+#else
+  (void)imageSize;
+#endif
+  return temporaryDirectory;
+}
+
 //----------------------------------------------------------------------------
 std::string
 vtkSlicerCLIModuleLogic
@@ -486,7 +554,9 @@ vtkSlicerCLIModuleLogic
                              const std::string& type,
                              const std::string& name,
                              const std::vector<std::string>& extensions,
-                             CommandLineModuleType commandType)
+                             CommandLineModuleType commandType,
+                             const std::string& executionTag,
+                             size_t imageExchangeSize)
 {
   std::string fname = name;
   std::string pid;
@@ -508,14 +578,9 @@ vtkSlicerCLIModuleLogic
   // The filename will point to the Temporary directory defined for
   // Slicer. The filename will be unique to the process (multiple
   // running instances of slicer will not collide).  The filename
-  // will be unique to the node in the process (the same node will be
-  // encoded to the same filename every time within that running
-  // instance of Slicer).  This last point is an optimization to
-  // minimize the number of times a file is written when running a
-  // module.  However, if we change the execution model such that more
-  // than one module can run at the same time within the same Slicer
-  // process, then this encoding will need to be changed to be unique
-  // per module execution.
+  // will be unique to the node in the process and, if an execution
+  // tag is given, to the module execution (modules running at the same
+  // time within the same Slicer process will not collide).
   //
 
   // Encode process id into a string.  To avoid confusing the
@@ -548,7 +613,11 @@ vtkSlicerCLIModuleLogic
     {
     temporaryDirectory = appLogic->GetTemporaryPath();
     }
-  fname = temporaryDirectory + "/" + pid + "_" + fname;
+  std::string execution = executionTag;
+  std::transform(execution.begin(), execution.end(),
+                 execution.begin(), DigitsToCharacters());
+  fname = temporaryDirectory + "/" + pid + "_"
+    + (execution.empty() ? std::string() : execution + "_") + fname;
 
   if (tag == "image")
     {
@@ -558,6 +627,14 @@ vtkSlicerCLIModuleLogic
       {
       // If running an executable
 
+      // Exchange the image through shared memory if all the exchanged
+      // images fit. If no size is known, shared memory is not used.
+      if (this->GetAllowSharedMemoryTransfer() && imageExchangeSize > 0)
+        {
+        fname = this->GetImageExchangeDirectory(imageExchangeSize)
+          + fname.substr(temporaryDirectory.size());
+        }
+
       // Use default fname construction, tack on extension
       std::string ext = ".nrrd";
       if (extensions.size() != 0)
@@ -913,6 +990,11 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
     = this->ConstructTemporarySceneFileName(miniscene.GetPointer());
   miniscene->SetRootDirectory(vtksys::SystemTools::GetParentDirectory(minisceneFilename.c_str()).c_str());
 
+  // Several modules may run at the same time (see vtkSlicerApplicationLogic::ScheduleTask()),
+  // the miniscene address identifies this execution in temporary file names.
+  char executionTag[64];
+  sprintf(executionTag, "%p", miniscene.GetPointer());
+
   // vector of files to delete
   std::set<std::string> filesToDelete;
 
@@ -923,6 +1005,51 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
     = node0->GetModuleDescription().GetParameterGroups().end();
   std::vector<ModuleParameterGroup>::iterator pgit;
 
+  // Total size of the images exchanged with the module, used to choose where
+  // to exchange them. The size of the largest input image is used as estimate
+  // of the size of the output images, whose node usually has no image yet.
+  size_t largestInputImageSize = 0;
+  size_t imageExchangeSize = 0;
+  std::vector<size_t> outputImageSizes;
+  for (pgit = pgbeginit; pgit != pgendit; ++pgit)
+    {
+    std::vector<ModuleParameter>::const_iterator pit;
+    for (pit = (*pgit).GetParameters().begin(); pit != (*pgit).GetParameters().end(); ++pit)
+      {
+      if ((*pit).GetTag() != "image"
+          || ((*pit).GetChannel() != "input" && (*pit).GetChannel() != "output"))
+        {
+        continue;
+        }
+      std::string id = (*pit).GetValue();
+      if ((*pit).GetHidden() == "true")
+        {
+        id = this->FindHiddenNodeID(node0->GetModuleDescription(), *pit);
+        }
+      vtkMRMLVolumeNode* volumeNode =
+        vtkMRMLVolumeNode::SafeDownCast(this->GetMRMLScene()->GetNodeByID(id.c_str()));
+      if (!volumeNode)
+        {
+        continue;
+        }
+      size_t imageSize = volumeNode->GetImageData() ?
+        static_cast<size_t>(volumeNode->GetImageData()->GetActualMemorySize()) * 1024 : 0;
+      if ((*pit).GetChannel() == "input")
+        {
+        largestInputImageSize = std::max(largestInputImageSize, imageSize);
+        imageExchangeSize += imageSize;
+        }
+      else
+        {
+        outputImageSizes.push_back(imageSize);
+        }
+      }
+    }
+  for (size_t outputImageSize : outputImageSizes)
+    {
+    imageExchangeSize += std::max(outputImageSize, largestInputImageSize);
+    }
+
   // Make a pass over the parameters and establish which parameters
   // have images or geometry or transforms or tables or point files that need to be written
   // before execution or loaded upon completion.
@@ -963,7 +1090,9 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
                                              (*pit).GetType(),
                                              id,
                                              (*pit).GetFileExtensions(),
-                                             commandType);
+                                             commandType,
+                                             executionTag,
+                                             imageExchangeSize);
 
         filesToDelete.insert(fname);
         if ((*pit).GetChannel() == "input")
@@ -1273,7 +1402,7 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
       code << alphanum[rand() % (sizeof(alphanum)-1)];
       }
     std::string returnFile = temporaryDirectory + "/" + pidString.str()
-      + "_" + code.str() + ".params";
+      + "_" + executionTag + "_" + code.str() + ".params";
 
     commandLineAsString.push_back( returnFile );
 
@@ -2155,6 +2284,7 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
     // Run as a shared object module
     //
     //
+    std::lock_guard<std::mutex> sharedObjectModuleLock(SharedObjectModuleExecutionLock);
 
     std::ostringstream coutstringstream;
     std::ostringstream cerrstringstream;
@@ -2754,16 +2884,22 @@ void vtkSlicerCLIModuleLogic::ProcessMRMLLogicsEvents(vtkObject* caller,
       event == vtkSlicerApplicationLogic::RequestProcessedEvent)
     {
     vtkMTimeType uid = reinterpret_cast<vtkMTimeType>(callData);
+    vtkMRMLCommandLineModuleNode* node = nullptr;
+    this->Internal->LastRequestsLock.lock();
     vtkInternal::RequestType::iterator it =
       std::find_if(this->Internal->LastRequests.begin(),
       this->Internal->LastRequests.end(), vtkInternal::FindRequest(uid));
     if (it != this->Internal->LastRequests.end())
       {
-      vtkMRMLCommandLineModuleNode* node = it->second;
+      node = it->second;
+      this->Internal->LastRequests.erase(it);
+      }
+    this->Internal->LastRequestsLock.unlock();
+    if (node)
+      {
       // If the status is not Completing, then there should be no request made
       // on the application logic.
       assert(node->GetStatus() == vtkMRMLCommandLineModuleNode::Completing);
-      this->Internal->LastRequests.erase(it);
       // we are not interested in any request anymore because the cli node is
       // Completed.
 
@@ -2890,6 +3026,10 @@ void vtkSlicerCLIModuleLogic::AddCompleteModelHierarchyToMiniScene(vtkMRMLScene
   mhnd->GetAllChildrenNodes(hnodes);
   hnodes.insert(hnodes.begin(), mhnd);  // add the current node to the front of the vector
 
+  // same execution tag as in ApplyTask()
+  char executionTag[64];
+  sprintf(executionTag, "%p", miniscene);
+
   // copy the entire hierarchy into the miniscene, we assume the nodes are ordered such that parents appear before children
   for (std::vector<vtkMRMLHierarchyNode*>::iterator it = hnodes.begin(); it != hnodes.end(); ++it)
     {
@@ -2958,7 +3098,7 @@ void vtkSlicerCLIModuleLogic::AddCompleteModelHierarchyToMiniScene(vtkMRMLScene
         if (msnd)
           {
           vtkMRMLModelStorageNode *s = vtkMRMLModelStorageNode::SafeDownCast(miniscene->CopyNode(msnd));
-          std::string fname = this->ConstructTemporaryFileName("geometry", "", tmcp->GetID(), std::vector<std::string>(), CommandLineModule);
+          std::string fname = this->ConstructTemporaryFileName("geometry", "", tmcp->GetID(), std::vector<std::string>(), CommandLineModule, executionTag);
           s->SetFileName(fname.c_str());
           filesToDelete.insert(fname);
           tmcp->SetAndObserveStorageNodeID( s->GetID());
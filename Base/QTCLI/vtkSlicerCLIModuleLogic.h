@@ -80,6 +80,14 @@ public:
   void SetAllowInMemoryTransfer(int value);
   int GetAllowInMemoryTransfer() const;
 
+  /// Control use of shared memory for the images exchanged with executable
+  /// CLIs: when enabled and if there is enough room, the temporary image
+  /// files are created in a RAM-backed directory (e.g. /dev/shm) instead of
+  /// the temporary directory so that volumes never touch the disk.
+  /// Disabled by default.
+  void SetAllowSharedMemoryTransfer(int value);
+  int GetAllowSharedMemoryTransfer() const;
+
   /// For debugging, control redirection of cout and cerr
   virtual void RedirectModuleStreamsOn();
   virtual void RedirectModuleStreamsOff();
@@ -123,12 +131,23 @@ protected:
   void ProcessMRMLLogicsEvents(vtkObject*, long unsigned int, void*) override;
 
 
+  /// Temporary file names contain \a executionTag (if not empty) to make
+  /// them unique to a module execution.
+  /// \a imageExchangeSize (in bytes) is the estimated total size of the
+  /// input and output images exchanged with the module.
   std::string ConstructTemporaryFileName(const std::string& tag,
                                          const std::string& type,
                                          const std::string& name,
                                      const std::vector<std::string>& extensions,
-                                     CommandLineModuleType commandType);
+                                     CommandLineModuleType commandType,
+                                     const std::string& executionTag = std::string(),
+                                     size_t imageExchangeSize = 0);
   std::string ConstructTemporarySceneFileName(vtkMRMLScene *scene);
+
+  /// Directory where to exchange images totaling \a imageSize bytes with
+  /// an executable CLI: the shared memory directory if allowed and large
+  /// enough, the temporary directory otherwise.
+  std::string GetImageExchangeDirectory(size_t imageSize);
   std::string FindHiddenNodeID(const ModuleDescription& d,
                                const ModuleParameter& p);
 
@@ -86,6 +86,7 @@
 
 // MRML includes
 #include <vtkCacheManager.h>
+#include <vtkEventBroker.h>
 #include <vtkMRMLCrosshairNode.h>
 #ifdef Slicer_BUILD_CLI_SUPPORT
 # include <vtkMRMLCommandLineModuleNode.h>
@@ -122,6 +123,36 @@
 #include <ctkDICOMDatabase.h>
 #endif
 
+namespace
+{
+
+//-----------------------------------------------------------------------------
+// Called from the thread that posted a request to the application logic:
+// the queue is processed in the next event loop iteration of the main
+// thread, no VTK event is invoked and no polling timer is involved.
+void WakeUpAppLogicRequestProcessing(int requestEvent, void* clientData)
+{
+  const char* processSlot = nullptr;
+  switch(requestEvent)
+    {
+    case vtkSlicerApplicationLogic::RequestModifiedEvent:
+      processSlot = "processAppLogicModified";
+      break;
+    case vtkSlicerApplicationLogic::RequestReadDataEvent:
+      processSlot = "processAppLogicReadData";
+      break;
+    case vtkSlicerApplicationLogic::RequestWriteDataEvent:
+      processSlot = "processAppLogicWriteData";
+      break;
+    default:
+      return;
+    }
+  QMetaObject::invokeMethod(reinterpret_cast<qSlicerCoreApplication*>(clientData),
+                            processSlot, Qt::QueuedConnection);
+}
+
+} // end of anonymous namespace
+
 //-----------------------------------------------------------------------------
 // qSlicerCoreApplicationPrivate methods
 
@@ -161,6 +192,7 @@ qSlicerCoreApplicationPrivate::~qSlicerCoreApplicationPrivate()
 #endif
 
   this->AppLogic->TerminateProcessingThread();
+  this->AppLogic->SetRequestWakeUpCallback(nullptr, nullptr);
 }
 
 //-----------------------------------------------------------------------------
@@ -307,18 +339,19 @@ void qSlicerCoreApplicationPrivate::init()
                  q, SLOT(requestInvokeEvent(vtkObject*,void*)), 0.0, Qt::DirectConnection);
   q->connect(q, SIGNAL(invokeEventRequested(unsigned int,void*,unsigned long,void*)),
              q, SLOT(scheduleInvokeEvent(unsigned int,void*,unsigned long,void*)), Qt::AutoConnection);
-  q->qvtkConnect(this->AppLogic, vtkSlicerApplicationLogic::RequestModifiedEvent,
-              q, SLOT(onSlicerApplicationLogicRequest(vtkObject*,void*,ulong)));
-  q->qvtkConnect(this->AppLogic, vtkSlicerApplicationLogic::RequestReadDataEvent,
-              q, SLOT(onSlicerApplicationLogicRequest(vtkObject*,void*,ulong)));
-  q->qvtkConnect(this->AppLogic, vtkSlicerApplicationLogic::RequestWriteDataEvent,
-              q, SLOT(onSlicerApplicationLogicRequest(vtkObject*,void*,ulong)));
+  // Requests are posted from the processing threads: the main thread is
+  // woken up by posting the processing to its event loop.
+  this->AppLogic->SetRequestWakeUpCallback(WakeUpAppLogicRequestProcessing, q);
   q->qvtkConnect(this->AppLogic, vtkMRMLApplicationLogic::PauseRenderEvent,
               q, SLOT(pauseRender()));
   q->qvtkConnect(this->AppLogic, vtkMRMLApplicationLogic::ResumeRenderEvent,
               q, SLOT(resumeRender()));
   q->qvtkConnect(this->AppLogic->GetUserInformation(), vtkCommand::ModifiedEvent,
     q, SLOT(onUserInformationModified()));
+  // Observations queued by the event broker (asynchronous or coalescing
+  // event mode) are processed from the event loop.
+  q->qvtkConnect(vtkEventBroker::GetInstance(), vtkEventBroker::RequestProcessEventQueueEvent,
+    q, SLOT(onEventBrokerProcessEventQueueRequested()));
 
   vtkMRMLThreeDViewDisplayableManagerFactory::GetInstance()->SetMRMLApplicationLogic(
     this->AppLogic.GetPointer());
@@ -1634,34 +1667,6 @@ void qSlicerCoreApplication
   timer->deleteLater();
 }
 
-//-----------------------------------------------------------------------------
-void qSlicerCoreApplication
-::onSlicerApplicationLogicRequest(vtkObject* appLogic, void* delay, unsigned long event)
-{
-  Q_D(qSlicerCoreApplication);
-  Q_ASSERT(d->AppLogic.GetPointer() == vtkSlicerApplicationLogic::SafeDownCast(appLogic));
-  Q_UNUSED(appLogic);
-  Q_UNUSED(d);
-  int delayInMs = *reinterpret_cast<int *>(delay);
-  switch(event)
-    {
-    case vtkSlicerApplicationLogic::RequestModifiedEvent:
-      QTimer::singleShot(delayInMs,
-                         this, SLOT(processAppLogicModified()));
-      break;
-    case vtkSlicerApplicationLogic::RequestReadDataEvent:
-      QTimer::singleShot(delayInMs,
-                         this, SLOT(processAppLogicReadData()));
-      break;
-    case vtkSlicerApplicationLogic::RequestWriteDataEvent:
-      QTimer::singleShot(delayInMs,
-                         this, SLOT(processAppLogicWriteData()));
-      break;
-    default:
-      break;
-    }
-}
-
 //-----------------------------------------------------------------------------
 void qSlicerCoreApplication::processAppLogicModified()
 {
@@ -1683,6 +1688,21 @@ void qSlicerCoreApplication::processAppLogicWriteData()
   d->AppLogic->ProcessWriteData();
 }
 
+//-----------------------------------------------------------------------------
+void qSlicerCoreApplication::onEventBrokerProcessEventQueueRequested()
+{
+  // Process the queue once the pending events (e.g. mouse moves) are handled,
+  // so that repeated modifications are delivered only once.
+  // The request may come from a worker thread, post it to the main thread.
+  QMetaObject::invokeMethod(this, "processEventBrokerQueue", Qt::QueuedConnection);
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCoreApplication::processEventBrokerQueue()
+{
+  vtkEventBroker::GetInstance()->ProcessEventQueue();
+}
+
 //-----------------------------------------------------------------------------
 void qSlicerCoreApplication::terminate(int returnCode)
 {
@@ -505,11 +505,18 @@ protected slots:
 
   virtual void onSlicerApplicationLogicModified();
   virtual void onUserInformationModified();
-  void onSlicerApplicationLogicRequest(vtkObject*, void* , unsigned long);
+  /// Process the Modified, ReadData or WriteData queue of the application
+  /// logic. Posted to the event loop when a request wakes up the main thread.
+  /// \sa vtkSlicerApplicationLogic::SetRequestWakeUpCallback()
   void processAppLogicModified();
   void processAppLogicReadData();
   void processAppLogicWriteData();
 
+  /// Called when the event broker has observations to process in its event queue.
+  /// \sa vtkEventBroker::RequestProcessEventQueueEvent, processEventBrokerQueue()
+  void onEventBrokerProcessEventQueueRequested();
+  void processEventBrokerQueue();
+
   /// Set the ReturnCode flag and call QCoreApplication::exit()
   void terminate(int exitCode = qSlicerCoreApplication::ExitSuccess);
 
@@ -519,7 +526,6 @@ protected slots:
   /// Called when the application logic requests a delayed event invocation.
   /// When the singleton application logic fires the RequestInvokeEvent,
   /// \sa invokeEvent(), vtkMRMLApplicationLogic::InvokeRequest
-  /// \sa onSlicerApplicationLogicRequest(), processAppLogicModified()
   void requestInvokeEvent(vtkObject* caller, void* callData);
 
   /// a timer is created, and on timeout, \a invokeEvent() is called to
@@ -722,6 +722,19 @@ QList<qSlicerFileWriter*> qSlicerCoreIOManager::writers(const qSlicerIO::IOFileT
   return res;
 }
 
+//-----------------------------------------------------------------------------
+QList<qSlicerFileWriter*> qSlicerCoreIOManager::writers(
+  const qSlicerIO::IOFileType& fileType, const qSlicerIO::IOProperties& parameters)const
+{
+  Q_D(const qSlicerCoreIOManager);
+  const QList<qSlicerFileWriter*> res = d->writers(fileType, parameters);
+  foreach(qSlicerFileWriter* writer, res)
+    {
+    writer->setMRMLScene(d->currentScene());
+    }
+  return res;
+}
+
 //-----------------------------------------------------------------------------
 qSlicerFileReader* qSlicerCoreIOManager::reader(const QString& ioDescription)const
 {
@@ -131,6 +131,13 @@ public:
   Q_INVOKABLE bool saveNodes(qSlicerIO::IOFileType fileType,
                              const qSlicerIO::IOProperties& parameters);
 
+  /// Returns the writers that saveNodes() would try, in order, to save the
+  /// file described by \a parameters ("fileName" and "nodeID").
+  /// The writers are associated with the current scene.
+  /// \sa saveNodes()
+  QList<qSlicerFileWriter*> writers(const qSlicerIO::IOFileType& fileType,
+                                    const qSlicerIO::IOProperties& parameters)const;
+
   /// Save a scene corresponding to \a fileName
   /// This function is provided for convenience and is equivalent to call
   /// saveNodes function with QString("SceneFile") with the fileName
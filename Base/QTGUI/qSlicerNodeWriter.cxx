@@ -126,19 +126,39 @@ bool qSlicerNodeWriter::write(const qSlicerIO::IOProperties& properties)
 {
   this->setWrittenNodes(QStringList());
 
+  vtkMRMLStorageNode* snode = this->prepareStorageNode(properties);
+  if (snode == nullptr)
+    {
+    return false;
+    }
+  vtkMRMLStorableNode* node = vtkMRMLStorableNode::SafeDownCast(
+    this->getNodeByID(properties["nodeID"].toString().toUtf8().data()));
+  bool res = snode->WriteData(node);
+
+  if (res)
+    {
+    this->setWrittenNodes(QStringList() << node->GetID());
+    }
+
+  return res;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLStorageNode* qSlicerNodeWriter::prepareStorageNode(const qSlicerIO::IOProperties& properties)
+{
   Q_ASSERT(!properties["nodeID"].toString().isEmpty());
 
   vtkMRMLStorableNode* node = vtkMRMLStorableNode::SafeDownCast(
     this->getNodeByID(properties["nodeID"].toString().toUtf8().data()));
   if (!this->canWriteObject(node))
     {
-    return false;
+    return nullptr;
     }
   vtkMRMLStorageNode* snode = qSlicerCoreIOManager::createAndAddDefaultStorageNode(node);
   if (snode == nullptr)
     {
     qDebug() << "No storage node for node" << properties["nodeID"].toString();
-    return false;
+    return nullptr;
     }
 
   Q_ASSERT(!properties["fileName"].toString().isEmpty());
@@ -160,14 +180,7 @@ bool qSlicerNodeWriter::write(const qSlicerIO::IOProperties& properties)
       snode->SetCompressionParameter(properties["compressionParameter"].toString().toStdString());
       }
     }
-  bool res = snode->WriteData(node);
-
-  if (res)
-    {
-    this->setWrittenNodes(QStringList() << node->GetID());
-    }
-
-  return res;
+  return snode;
 }
 
 //-----------------------------------------------------------------------------
@@ -26,6 +26,7 @@
 #include "qSlicerFileWriter.h"
 class qSlicerNodeWriterPrivate;
 class vtkMRMLNode;
+class vtkMRMLStorageNode;
 
 /// Utility class that is ready to use for most of the nodes.
 class Q_SLICER_BASE_QTGUI_EXPORT qSlicerNodeWriter
@@ -64,6 +65,13 @@ public:
   /// Create a storage node if the storable node doesn't have any.
   bool write(const qSlicerIO::IOProperties& properties) override;
 
+  /// Set the file name, file format and compression options of the storage
+  /// node of the node referenced by "nodeID", without writing the file.
+  /// Create a storage node if the storable node doesn't have any.
+  /// Return the storage node, nullptr if the node can't be written.
+  /// \sa write()
+  vtkMRMLStorageNode* prepareStorageNode(const qSlicerIO::IOProperties& properties);
+
   virtual vtkMRMLNode* getNodeByID(const char *id)const;
 
   /// Return a qSlicerIONodeWriterOptionsWidget
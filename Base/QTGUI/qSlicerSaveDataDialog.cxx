@@ -27,6 +27,7 @@
 #include <QRegExp>
 #include <QRegExpValidator>
 #include <QSettings>
+#include <QThread>
 
 /// CTK includes
 #include <ctkCheckableHeaderView.h>
@@ -37,6 +38,7 @@
 #include "qSlicerApplication.h"
 #include "qSlicerCoreIOManager.h"
 #include "qSlicerFileWriterOptionsWidget.h"
+#include "qSlicerNodeWriter.h"
 #include "qSlicerSaveDataDialog_p.h"
 #include "qSlicerLayoutManager.h"
 #include "qMRMLUtils.h"
@@ -50,6 +52,7 @@
 #include <vtkDataFileFormatHelper.h> // for GetFileExtensionFromFormatString()
 //#include <vtkMRMLHierarchyNode.h>
 #include <vtkMRMLScene.h>
+#include <vtkMRMLStorableNode.h>
 #include <vtkMRMLStorageNode.h>
 #include <vtkMRMLSceneViewNode.h>
 
@@ -59,7 +62,9 @@
 #include <vtkImageData.h>
 
 // STD includes
+#include <algorithm>
 #include <cstring> // for strlen
+#include <vector>
 
 namespace
 {
@@ -819,6 +824,8 @@ bool qSlicerSaveDataDialogPrivate::save()
 bool qSlicerSaveDataDialogPrivate::saveNodes()
 {
   QMessageBox::StandardButton forceOverwrite = QMessageBox::Ignore;
+  QList<int> rows;
+  QList<qSlicerIO::IOFileType> fileTypes;
   QList<qSlicerIO::IOProperties> files;
   const int sceneRow = this->findSceneRow();
   for (int row = 0; row < this->FileWidget->rowCount(); ++row)
@@ -831,7 +838,6 @@ bool qSlicerSaveDataDialogPrivate::saveNodes()
 
     QTableWidgetItem* selectItem = this->FileWidget->item(row, SelectColumn);
     QTableWidgetItem* nodeNameItem = this->FileWidget->item(row, NodeNameColumn);
-    QTableWidgetItem* nodeStatusItem = this->FileWidget->item(row, NodeStatusColumn);
 
     Q_ASSERT(selectItem);
     Q_ASSERT(nodeNameItem);
@@ -887,7 +893,7 @@ bool qSlicerSaveDataDialogPrivate::saveNodes()
         }
       }
 
-    // save the node
+    // collect the node, it is saved below
     qSlicerCoreIOManager* coreIOManager =
       qSlicerCoreApplication::application()->coreIOManager();
     Q_ASSERT(coreIOManager);
@@ -902,25 +908,93 @@ bool qSlicerSaveDataDialogPrivate::saveNodes()
     savingParameters["nodeID"] = QString(node->GetID());
     savingParameters["fileName"] = file.absoluteFilePath();
     savingParameters["fileFormat"] = format;
-    bool res = coreIOManager->saveNodes(fileType, savingParameters);
+    rows << row;
+    fileTypes << fileType;
+    files << savingParameters;
+    }
 
-    // node has failed to be written
-    if (!res)
+  // Data files of nodes that are saved by the generic node writer into
+  // storage nodes supporting it are written concurrently. Consecutive files
+  // are written in small batches so that declining to continue after a
+  // failure does not start writing the next ones.
+  qSlicerCoreIOManager* coreIOManager =
+    qSlicerCoreApplication::application()->coreIOManager();
+  const int batchSize = std::max(2, QThread::idealThreadCount());
+  int fileIndex = 0;
+  while (fileIndex < files.count())
+    {
+    const int batchStart = fileIndex;
+    std::vector<vtkMRMLStorageNode*> storageNodes;
+    std::vector<vtkMRMLStorableNode*> storableNodes;
+    for (int batchFileIndex = batchStart;
+         batchFileIndex < files.count() && static_cast<int>(storageNodes.size()) < batchSize;
+         ++batchFileIndex)
       {
-      QMessageBox::StandardButton answer =
-        QMessageBox::question(this, tr("Saving node..."),
-                              tr("Cannot write data file: %1.\n"
-                                 "Do you want to continue saving?").arg(file.absoluteFilePath()),
-                              QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes);
-      if (answer == QMessageBox::No)
+      QList<qSlicerFileWriter*> writers = coreIOManager->writers(fileTypes[batchFileIndex], files[batchFileIndex]);
+      // Writers deriving from qSlicerNodeWriter may write more than the storage node does
+      if (writers.isEmpty() ||
+          writers[0]->metaObject() != &qSlicerNodeWriter::staticMetaObject)
         {
-        return false;
+        break;
         }
+      qSlicerNodeWriter* nodeWriter = qobject_cast<qSlicerNodeWriter*>(writers[0]);
+      vtkMRMLStorageNode* storageNode = nodeWriter->prepareStorageNode(files[batchFileIndex]);
+      if (!storageNode || !storageNode->CanWriteDataConcurrently())
+        {
+        break;
+        }
+      storageNodes.push_back(storageNode);
+      storableNodes.push_back(vtkMRMLStorableNode::SafeDownCast(
+        nodeWriter->getNodeByID(files[batchFileIndex]["nodeID"].toString().toUtf8().data())));
       }
+    std::vector<int> concurrentResults;
+    if (storageNodes.size() > 1)
+      {
+      concurrentResults = this->MRMLScene->WriteStorableNodesData(storageNodes, storableNodes);
+      }
+    const int batchEnd = batchStart + std::max(1, static_cast<int>(concurrentResults.size()));
+
+    for (; fileIndex < batchEnd; ++fileIndex)
+      {
+      const int row = rows[fileIndex];
+      QTableWidgetItem* nodeNameItem = this->FileWidget->item(row, NodeNameColumn);
+      QTableWidgetItem* nodeStatusItem = this->FileWidget->item(row, NodeStatusColumn);
+
+      // save the node, files that failed to be written concurrently are saved
+      // with the other writers of their file type
+      bool res = (!concurrentResults.empty() && concurrentResults[fileIndex - batchStart] != 0);
+      if (!res)
+        {
+        res = coreIOManager->saveNodes(fileTypes[fileIndex], files[fileIndex]);
+        }
 
-    // clean up node after saving
-    nodeNameItem->setCheckState(Qt::Unchecked);
-    nodeStatusItem->setText("Not Modified");
+      // node has failed to be written
+      if (!res)
+        {
+        QMessageBox::StandardButton answer =
+          QMessageBox::question(this, tr("Saving node..."),
+                                tr("Cannot write data file: %1.\n"
+                                   "Do you want to continue saving?").arg(files[fileIndex]["fileName"].toString()),
+                                QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes);
+        if (answer == QMessageBox::No)
+          {
+          // files of the batch that are already written are saved
+          for (int writtenIndex = fileIndex + 1; writtenIndex < batchEnd; ++writtenIndex)
+            {
+            if (concurrentResults[writtenIndex - batchStart])
+              {
+              this->FileWidget->item(rows[writtenIndex], NodeNameColumn)->setCheckState(Qt::Unchecked);
+              this->FileWidget->item(rows[writtenIndex], NodeStatusColumn)->setText("Not Modified");
+              }
+            }
+          return false;
+          }
+        }
+
+      // clean up node after saving
+      nodeNameItem->setCheckState(Qt::Unchecked);
+      nodeStatusItem->setText("Not Modified");
+      }
     }
   return true;
 }
@@ -0,0 +1,277 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkEventBroker.h"
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkObservation.h"
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <vector>
+
+namespace
+{
+
+int CallbackCount = 0;
+int QueueRequestCount = 0;
+vtkObservation* ObservationToRemove = nullptr;
+
+//---------------------------------------------------------------------------
+void CountingCallback(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eid),
+  void* vtkNotUsed(clientData), void* vtkNotUsed(callData))
+{
+  ++CallbackCount;
+}
+
+//---------------------------------------------------------------------------
+void RemovingCallback(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eid),
+  void* vtkNotUsed(clientData), void* vtkNotUsed(callData))
+{
+  ++CallbackCount;
+  vtkEventBroker::GetInstance()->RemoveObservation(ObservationToRemove);
+  ObservationToRemove = nullptr;
+}
+
+//---------------------------------------------------------------------------
+std::vector<vtkObject*> InvokedSubjects;
+void RecordingCallback(vtkObject* caller, unsigned long vtkNotUsed(eid),
+  void* vtkNotUsed(clientData), void* vtkNotUsed(callData))
+{
+  InvokedSubjects.push_back(caller);
+}
+
+//---------------------------------------------------------------------------
+void ProcessingCallback(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eid),
+  void* vtkNotUsed(clientData), void* vtkNotUsed(callData))
+{
+  ++CallbackCount;
+  // process the rest of the queue from the callback
+  vtkEventBroker::GetInstance()->ProcessEventQueue();
+}
+
+//---------------------------------------------------------------------------
+void ModifyingCallback(vtkObject* caller, unsigned long vtkNotUsed(eid),
+  void* vtkNotUsed(clientData), void* vtkNotUsed(callData))
+{
+  ++CallbackCount;
+  if (CallbackCount == 1)
+    {
+    caller->Modified();
+    }
+}
+
+//---------------------------------------------------------------------------
+void QueueRequestCallback(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eid),
+  void* vtkNotUsed(clientData), void* vtkNotUsed(callData))
+{
+  ++QueueRequestCount;
+}
+
+//---------------------------------------------------------------------------
+int TestCoalescingMode()
+{
+  vtkEventBroker* broker = vtkEventBroker::GetInstance();
+  vtkNew<vtkCallbackCommand> callback;
+  callback->SetCallback(CountingCallback);
+  vtkNew<vtkCallbackCommand> queueRequestCallback;
+  queueRequestCallback->SetCallback(QueueRequestCallback);
+
+  vtkNew<vtkObject> observer;
+  vtkNew<vtkObject> subject;
+  broker->AddObservation(subject, vtkCommand::ModifiedEvent, observer, callback);
+  broker->AddObservation(subject, vtkCommand::StartEvent, observer, callback);
+  broker->AddObservation(broker, vtkEventBroker::RequestProcessEventQueueEvent, observer, queueRequestCallback);
+
+  broker->SetEventModeToCoalescing();
+  CHECK_STRING(broker->GetEventModeAsString(), "Coalescing");
+  CallbackCount = 0;
+  QueueRequestCount = 0;
+
+  // Repeated modifications are delivered once
+  for (int i = 0; i < 10; ++i)
+    {
+    subject->Modified();
+    }
+  CHECK_INT(CallbackCount, 0);
+  CHECK_INT(broker->GetNumberOfQueuedObservations(), 1);
+  CHECK_INT(QueueRequestCount, 1);
+
+  // Other events are not deferred
+  subject->InvokeEvent(vtkCommand::StartEvent);
+  CHECK_INT(CallbackCount, 1);
+
+  broker->ProcessEventQueue();
+  CHECK_INT(CallbackCount, 2);
+  CHECK_INT(broker->GetNumberOfQueuedObservations(), 0);
+
+  // The application is notified again when the queue gets filled
+  subject->Modified();
+  CHECK_INT(QueueRequestCount, 2);
+  broker->ProcessEventQueue();
+  CHECK_INT(CallbackCount, 3);
+
+  // Synchronous observers are not deferred
+  broker->SetObserverSynchronous(observer, true);
+  subject->Modified();
+  CHECK_INT(CallbackCount, 4);
+  CHECK_INT(broker->GetNumberOfQueuedObservations(), 0);
+  broker->SetObserverSynchronous(observer, false);
+
+  broker->SetEventModeToSynchronous();
+  subject->Modified();
+  CHECK_INT(CallbackCount, 5);
+
+  broker->RemoveObservations(observer);
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int TestRemoveDuringQueueProcessing()
+{
+  vtkEventBroker* broker = vtkEventBroker::GetInstance();
+  vtkNew<vtkCallbackCommand> callback;
+  callback->SetCallback(CountingCallback);
+  vtkNew<vtkCallbackCommand> removingCallback;
+  removingCallback->SetCallback(RemovingCallback);
+
+  vtkNew<vtkObject> observer;
+  vtkNew<vtkObject> subject1;
+  vtkNew<vtkObject> subject2;
+  vtkNew<vtkObject> subject3;
+  broker->AddObservation(subject1, vtkCommand::ModifiedEvent, observer, removingCallback);
+  ObservationToRemove = broker->AddObservation(subject2, vtkCommand::ModifiedEvent, observer, callback);
+  broker->AddObservation(subject3, vtkCommand::ModifiedEvent, observer, callback);
+
+  broker->SetEventModeToCoalescing();
+  CallbackCount = 0;
+  subject1->Modified();
+  subject2->Modified();
+  subject3->Modified();
+  CHECK_INT(broker->GetNumberOfQueuedObservations(), 3);
+
+  // Observation of subject2 is removed while subject1 is processed,
+  // subject3 must still be processed.
+  broker->ProcessEventQueue();
+  CHECK_INT(CallbackCount, 2);
+  CHECK_INT(broker->GetNumberOfQueuedObservations(), 0);
+  CHECK_NULL(ObservationToRemove);
+  broker->SetEventModeToSynchronous();
+
+  broker->RemoveObservations(observer);
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int TestCoalescingOrder()
+{
+  vtkEventBroker* broker = vtkEventBroker::GetInstance();
+  vtkNew<vtkCallbackCommand> callback;
+  callback->SetCallback(RecordingCallback);
+
+  vtkNew<vtkObject> observer;
+  vtkNew<vtkObject> subject1;
+  vtkNew<vtkObject> subject2;
+  broker->AddObservation(subject1, vtkCommand::ModifiedEvent, observer, callback);
+  broker->AddObservation(subject1, vtkCommand::StartEvent, observer, callback);
+  broker->AddObservation(subject2, vtkCommand::ModifiedEvent, observer, callback);
+
+  broker->SetEventModeToCoalescing();
+  InvokedSubjects.clear();
+  subject1->Modified();
+  subject2->Modified();
+  subject1->Modified();
+  // not queued, invoked before the queued modifications
+  subject1->InvokeEvent(vtkCommand::StartEvent);
+  CHECK_INT(static_cast<int>(InvokedSubjects.size()), 1);
+  CHECK_POINTER(InvokedSubjects[0], subject1.GetPointer());
+
+  // The coalesced modification of subject1 keeps its first position
+  broker->ProcessEventQueue();
+  CHECK_INT(static_cast<int>(InvokedSubjects.size()), 3);
+  CHECK_POINTER(InvokedSubjects[1], subject1.GetPointer());
+  CHECK_POINTER(InvokedSubjects[2], subject2.GetPointer());
+  broker->SetEventModeToSynchronous();
+
+  broker->RemoveObservations(observer);
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int TestNestedQueueProcessing()
+{
+  vtkEventBroker* broker = vtkEventBroker::GetInstance();
+  vtkNew<vtkCallbackCommand> callback;
+  callback->SetCallback(CountingCallback);
+  vtkNew<vtkCallbackCommand> processingCallback;
+  processingCallback->SetCallback(ProcessingCallback);
+
+  vtkNew<vtkObject> observer;
+  vtkNew<vtkObject> subject1;
+  vtkNew<vtkObject> subject2;
+  vtkNew<vtkObject> subject3;
+  broker->AddObservation(subject1, vtkCommand::ModifiedEvent, observer, processingCallback);
+  broker->AddObservation(subject2, vtkCommand::ModifiedEvent, observer, callback);
+  broker->AddObservation(subject3, vtkCommand::ModifiedEvent, observer, callback);
+
+  broker->SetEventModeToCoalescing();
+  CallbackCount = 0;
+  subject1->Modified();
+  subject2->Modified();
+  subject3->Modified();
+
+  // subject2 and subject3 are processed from the callback of subject1,
+  // each observation is invoked once.
+  broker->ProcessEventQueue();
+  CHECK_INT(CallbackCount, 3);
+  CHECK_INT(broker->GetNumberOfQueuedObservations(), 0);
+  CHECK_NULL(broker->DequeueObservation());
+
+  broker->SetEventModeToSynchronous();
+
+  broker->RemoveObservations(observer);
+
+  // An observation whose subject is modified while it is invoked is queued
+  // again and invoked once more.
+  vtkNew<vtkCallbackCommand> modifyingCallback;
+  modifyingCallback->SetCallback(ModifyingCallback);
+  broker->AddObservation(subject1, vtkCommand::ModifiedEvent, observer, modifyingCallback);
+  broker->SetEventModeToCoalescing();
+  CallbackCount = 0;
+  subject1->Modified();
+  broker->ProcessEventQueue();
+  CHECK_INT(CallbackCount, 2);
+  CHECK_INT(broker->GetNumberOfQueuedObservations(), 0);
+  broker->SetEventModeToSynchronous();
+
+  broker->RemoveObservations(observer);
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkEventBrokerEventModeTest(int vtkNotUsed(argc), char * vtkNotUsed(argv) [])
+{
+  CHECK_EXIT_SUCCESS(TestCoalescingMode());
+  CHECK_EXIT_SUCCESS(TestRemoveDuringQueueProcessing());
+  CHECK_EXIT_SUCCESS(TestCoalescingOrder());
+  CHECK_EXIT_SUCCESS(TestNestedQueueProcessing());
+  return EXIT_SUCCESS;
+}
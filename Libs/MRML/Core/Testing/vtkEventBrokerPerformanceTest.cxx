@@ -0,0 +1,197 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkEventBroker.h"
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkObservation.h"
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <vector>
+
+namespace
+{
+
+int CallbackCount = 0;
+
+//---------------------------------------------------------------------------
+void CountingCallback(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eid),
+  void* vtkNotUsed(clientData), void* vtkNotUsed(callData))
+{
+  ++CallbackCount;
+}
+
+//---------------------------------------------------------------------------
+std::vector<vtkSmartPointer<vtkObject> > CreateObjects(int numberOfObjects)
+{
+  std::vector<vtkSmartPointer<vtkObject> > objects;
+  for (int i = 0; i < numberOfObjects; ++i)
+    {
+    objects.push_back(vtkSmartPointer<vtkObject>::New());
+    }
+  return objects;
+}
+
+//---------------------------------------------------------------------------
+int TestObservationsConsistency()
+{
+  vtkEventBroker* broker = vtkEventBroker::GetInstance();
+  int initialNumberOfObservations = broker->GetNumberOfObservations();
+
+  vtkNew<vtkCallbackCommand> callback;
+  callback->SetCallback(CountingCallback);
+  vtkSmartPointer<vtkObject> observer = vtkSmartPointer<vtkObject>::New();
+  std::vector<vtkSmartPointer<vtkObject> > subjects = CreateObjects(10);
+  for (size_t i = 0; i < subjects.size(); ++i)
+    {
+    broker->AddObservation(subjects[i], vtkCommand::ModifiedEvent, observer, callback);
+    }
+  broker->AddObservation(subjects[0], vtkCommand::StartEvent, observer, callback);
+  CHECK_INT(broker->GetNumberOfObservations(), initialNumberOfObservations + 11);
+  CHECK_BOOL(broker->GetObservationExist(subjects[0], vtkCommand::StartEvent, observer, callback), true);
+  CHECK_BOOL(broker->GetObservationExist(subjects[1], vtkCommand::StartEvent, observer, callback), false);
+  CHECK_INT(static_cast<int>(broker->GetObservations(subjects[0], 0, observer).size()), 2);
+  // without filter, all the observations of the subject are returned
+  CHECK_INT(static_cast<int>(broker->GetObservations(subjects[0]).size()), 2);
+  CHECK_INT(static_cast<int>(broker->GetSubjectObservations(subjects[0]).size()), 2);
+  CHECK_INT(static_cast<int>(broker->GetObservations(subjects[0], 0, nullptr, nullptr, 1).size()), 1);
+  CHECK_BOOL(broker->GetObservationExist(subjects[1]), true);
+  CHECK_BOOL(broker->GetObservationExist(observer), false);
+  CHECK_INT(static_cast<int>(broker->GetSubjectObservations(observer).size()), 0);
+
+  // Removal keeps the remaining observations reachable
+  broker->RemoveObservations(subjects[0], vtkCommand::ModifiedEvent, observer);
+  CHECK_INT(broker->GetNumberOfObservations(), initialNumberOfObservations + 10);
+  CHECK_BOOL(broker->GetObservationExist(subjects[0], vtkCommand::ModifiedEvent, observer), false);
+  CHECK_BOOL(broker->GetObservationExist(subjects[0], vtkCommand::StartEvent, observer), true);
+  CallbackCount = 0;
+  for (size_t i = 0; i < subjects.size(); ++i)
+    {
+    subjects[i]->Modified();
+    }
+  CHECK_INT(CallbackCount, 9);
+
+  // Queued observations are removed from the event queue
+  broker->SetEventModeToAsynchronous();
+  CallbackCount = 0;
+  for (size_t i = 0; i < subjects.size(); ++i)
+    {
+    subjects[i]->Modified();
+    }
+  CHECK_INT(broker->GetNumberOfQueuedObservations(), 9);
+  broker->RemoveObservations(subjects[1], observer);
+  CHECK_INT(broker->GetNumberOfQueuedObservations(), 8);
+  broker->SetEventModeToSynchronous();
+  CHECK_INT(CallbackCount, 8);
+  CHECK_INT(broker->GetNumberOfQueuedObservations(), 0);
+
+  // Deleting a subject removes its observations
+  subjects[2] = nullptr;
+  CHECK_INT(broker->GetNumberOfObservations(), initialNumberOfObservations + 8);
+
+  // Deleting the observer removes all its observations
+  observer = nullptr;
+  CHECK_INT(broker->GetNumberOfObservations(), initialNumberOfObservations);
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int TestObservationsPerformance(int numberOfObservations)
+{
+  vtkEventBroker* broker = vtkEventBroker::GetInstance();
+  int initialNumberOfObservations = broker->GetNumberOfObservations();
+
+  vtkNew<vtkCallbackCommand> callback;
+  callback->SetCallback(CountingCallback);
+  vtkSmartPointer<vtkObject> observer = vtkSmartPointer<vtkObject>::New();
+  std::vector<vtkSmartPointer<vtkObject> > subjects = CreateObjects(numberOfObservations);
+  vtkNew<vtkTimerLog> timer;
+
+  // Add
+  timer->StartTimer();
+  for (int i = 0; i < numberOfObservations; ++i)
+    {
+    broker->AddObservation(subjects[i], vtkCommand::ModifiedEvent, observer, callback);
+    }
+  timer->StopTimer();
+  double addTime = timer->GetElapsedTime();
+  CHECK_INT(broker->GetNumberOfObservations(), initialNumberOfObservations + numberOfObservations);
+
+  // Query
+  timer->StartTimer();
+  for (int i = 0; i < numberOfObservations; ++i)
+    {
+    if (!broker->GetObservationExist(subjects[i], vtkCommand::ModifiedEvent, observer, callback))
+      {
+      std::cerr << "Line " << __LINE__ << ": observation " << i << " not found" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  timer->StopTimer();
+  double queryTime = timer->GetElapsedTime();
+
+  // Dispatch
+  CallbackCount = 0;
+  timer->StartTimer();
+  for (int i = 0; i < numberOfObservations; ++i)
+    {
+    subjects[i]->Modified();
+    }
+  timer->StopTimer();
+  double dispatchTime = timer->GetElapsedTime();
+  CHECK_INT(CallbackCount, numberOfObservations);
+
+  // Remove half of the observations one by one
+  timer->StartTimer();
+  for (int i = 0; i < numberOfObservations; i += 2)
+    {
+    broker->RemoveObservations(subjects[i], vtkCommand::ModifiedEvent, observer, callback);
+    }
+  timer->StopTimer();
+  double removeTime = timer->GetElapsedTime();
+  CHECK_INT(broker->GetNumberOfObservations(), initialNumberOfObservations + numberOfObservations / 2);
+
+  // Remove all the remaining observations by deleting the observer
+  timer->StartTimer();
+  observer = nullptr;
+  timer->StopTimer();
+  double removeObserverTime = timer->GetElapsedTime();
+  CHECK_INT(broker->GetNumberOfObservations(), initialNumberOfObservations);
+
+  std::cout << "Observations: " << numberOfObservations << std::endl
+            << "  add: " << addTime << " s" << std::endl
+            << "  query: " << queryTime << " s" << std::endl
+            << "  dispatch: " << dispatchTime << " s" << std::endl
+            << "  remove: " << removeTime << " s" << std::endl
+            << "  remove observer: " << removeObserverTime << " s" << std::endl;
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkEventBrokerPerformanceTest(int vtkNotUsed(argc), char * vtkNotUsed(argv) [])
+{
+  CHECK_EXIT_SUCCESS(TestObservationsConsistency());
+  CHECK_EXIT_SUCCESS(TestObservationsPerformance(1000));
+  CHECK_EXIT_SUCCESS(TestObservationsPerformance(100000));
+  return EXIT_SUCCESS;
+}
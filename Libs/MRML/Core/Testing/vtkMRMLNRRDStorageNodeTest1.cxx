@@ -12,10 +12,169 @@
 
 #include "vtkMRMLCoreTestingMacros.h"
 #include "vtkMRMLNRRDStorageNode.h"
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLScene.h"
 
-int vtkMRMLNRRDStorageNodeTest1(int , char * [])
+// vtkTeem includes
+#include <vtkTeemNRRDReader.h>
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkInformation.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+// STD includes
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+// Return the flags of the first gzip member of the data of a .nrrd file,
+// or -1 if the data is not gzip compressed.
+int GetGzipDataFlags(const std::string& fileName)
+{
+  std::ifstream file(fileName.c_str(), std::ios::binary);
+  std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  // the header ends with an empty line
+  size_t dataOffset = content.find("\n\n");
+  if (dataOffset == std::string::npos || content.size() < dataOffset + 2 + 4)
+    {
+    return -1;
+    }
+  dataOffset += 2;
+  if (static_cast<unsigned char>(content[dataOffset]) != 0x1f
+    || static_cast<unsigned char>(content[dataOffset + 1]) != 0x8b)
+    {
+    return -1;
+    }
+  return static_cast<unsigned char>(content[dataOffset + 3]);
+}
+
+//---------------------------------------------------------------------------
+int TestParallelCompression(const std::string& tempDir)
 {
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkImageData> imageData;
+  // 2MB of data: larger than a compressed block
+  imageData->SetDimensions(128, 128, 64);
+  imageData->AllocateScalars(VTK_SHORT, 1);
+  short* voxels = static_cast<short*>(imageData->GetScalarPointer());
+  vtkIdType numberOfVoxels = imageData->GetNumberOfPoints();
+  for (vtkIdType voxelIndex = 0; voxelIndex < numberOfVoxels; ++voxelIndex)
+    {
+    voxels[voxelIndex] = static_cast<short>(voxelIndex % 1000);
+    }
+  vtkMRMLScalarVolumeNode* volumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(
+    scene->AddNewNodeByClass("vtkMRMLScalarVolumeNode"));
+  volumeNode->SetAndObserveImageData(imageData.GetPointer());
+  vtkMRMLNRRDStorageNode* storageNode = vtkMRMLNRRDStorageNode::SafeDownCast(
+    scene->AddNewNodeByClass("vtkMRMLNRRDStorageNode"));
+  volumeNode->SetAndObserveStorageNodeID(storageNode->GetID());
+  storageNode->SetUseCompression(1);
+  CHECK_BOOL(storageNode->GetUseParallelCompression(), false);
+
+  // Teem writes the data in a single gzip member without extra field
+  std::string serialFileName = tempDir + "/vtkMRMLNRRDStorageNodeTest1_serial.nrrd";
+  storageNode->SetFileName(serialFileName.c_str());
+  CHECK_INT(storageNode->WriteData(volumeNode), 1);
+  CHECK_INT(GetGzipDataFlags(serialFileName) & 0x04, 0);
+
+  // Parallel compression writes gzip members with an extra field
+  std::string parallelFileName = tempDir + "/vtkMRMLNRRDStorageNodeTest1_parallel.nrrd";
+  storageNode->UseParallelCompressionOn();
+  storageNode->SetFileName(parallelFileName.c_str());
+  CHECK_INT(storageNode->WriteData(volumeNode), 1);
+  CHECK_INT(GetGzipDataFlags(parallelFileName) & 0x04, 0x04);
+
+  // Both files are read back by the storage node
+  for (const std::string& fileName : { serialFileName, parallelFileName })
+    {
+    vtkNew<vtkMRMLScalarVolumeNode> readVolumeNode;
+    vtkNew<vtkMRMLNRRDStorageNode> readStorageNode;
+    readStorageNode->SetFileName(fileName.c_str());
+    CHECK_INT(readStorageNode->ReadData(readVolumeNode.GetPointer()), 1);
+    vtkImageData* readImageData = readVolumeNode->GetImageData();
+    CHECK_NOT_NULL(readImageData);
+    CHECK_INT(readImageData->GetNumberOfPoints(), numberOfVoxels);
+    CHECK_INT(static_cast<int>(readImageData->GetScalarComponentAsDouble(127, 127, 63, 0)),
+      static_cast<int>(voxels[numberOfVoxels - 1]));
+    }
+
+  // The setting is saved in the scene
+  vtkNew<vtkMRMLNRRDStorageNode> copiedStorageNode;
+  copiedStorageNode->Copy(storageNode);
+  CHECK_BOOL(copiedStorageNode->GetUseParallelCompression(), true);
+
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int TestMemoryMapping(const std::string& tempDir)
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkImageData> imageData;
+  imageData->SetDimensions(64, 64, 16);
+  imageData->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  unsigned char* voxels = static_cast<unsigned char*>(imageData->GetScalarPointer());
+  vtkIdType numberOfVoxels = imageData->GetNumberOfPoints();
+  for (vtkIdType voxelIndex = 0; voxelIndex < numberOfVoxels; ++voxelIndex)
+    {
+    voxels[voxelIndex] = static_cast<unsigned char>(voxelIndex % 251);
+    }
+  vtkMRMLScalarVolumeNode* volumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(
+    scene->AddNewNodeByClass("vtkMRMLScalarVolumeNode"));
+  volumeNode->SetAndObserveImageData(imageData.GetPointer());
+  vtkMRMLNRRDStorageNode* storageNode = vtkMRMLNRRDStorageNode::SafeDownCast(
+    scene->AddNewNodeByClass("vtkMRMLNRRDStorageNode"));
+  volumeNode->SetAndObserveStorageNodeID(storageNode->GetID());
+  std::string fileName = tempDir + "/vtkMRMLNRRDStorageNodeTest1_mapped.nrrd";
+  storageNode->SetFileName(fileName.c_str());
+  storageNode->SetUseCompression(0);
+  CHECK_INT(storageNode->WriteData(volumeNode), 1);
+
+  for (bool memoryMapping : { false, true })
+    {
+    vtkNew<vtkMRMLScalarVolumeNode> readVolumeNode;
+    vtkNew<vtkMRMLNRRDStorageNode> readStorageNode;
+    readStorageNode->SetFileName(fileName.c_str());
+    readStorageNode->SetUseMemoryMapping(memoryMapping);
+    CHECK_INT(readStorageNode->ReadData(readVolumeNode.GetPointer()), 1);
+    vtkDataArray* scalars = readVolumeNode->GetImageData()->GetPointData()->GetScalars();
+    CHECK_NOT_NULL(scalars);
+    // the volume node uses the mapped file contents, not a copy
+    CHECK_INT(scalars->GetInformation()->Get(vtkTeemNRRDReader::MEMORY_MAPPED()), memoryMapping ? 1 : 0);
+    CHECK_INT(static_cast<int>(scalars->GetNumberOfValues()), static_cast<int>(numberOfVoxels));
+    CHECK_INT(memcmp(scalars->GetVoidPointer(0), voxels, numberOfVoxels), 0);
+    }
+
+  vtkNew<vtkMRMLNRRDStorageNode> copiedStorageNode;
+  storageNode->UseMemoryMappingOn();
+  copiedStorageNode->Copy(storageNode);
+  CHECK_BOOL(copiedStorageNode->GetUseMemoryMapping(), true);
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkMRMLNRRDStorageNodeTest1(int argc, char * argv[])
+{
+  if (argc != 2)
+    {
+    std::cerr << "Usage: " << argv[0] << " /path/to/temp" << std::endl;
+    return EXIT_FAILURE;
+    }
+
   vtkNew<vtkMRMLNRRDStorageNode> node1;
   EXERCISE_ALL_BASIC_MRML_METHODS(node1.GetPointer());
+
+  CHECK_EXIT_SUCCESS(TestParallelCompression(argv[1]));
+  CHECK_EXIT_SUCCESS(TestMemoryMapping(argv[1]));
   return EXIT_SUCCESS;
 }
@@ -13,9 +13,59 @@
 #include "vtkMRMLCoreTestingMacros.h"
 #include "vtkMRMLScalarVolumeDisplayNode.h"
 
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkTrivialProducer.h>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+int TestHistogramSampling()
+{
+  // Intensity ramp along the columns
+  vtkNew<vtkImageData> imageData;
+  imageData->SetDimensions(200, 200, 100);
+  imageData->AllocateScalars(VTK_SHORT, 1);
+  short* voxels = static_cast<short*>(imageData->GetScalarPointer());
+  for (vtkIdType voxelIndex = 0; voxelIndex < imageData->GetNumberOfPoints(); ++voxelIndex)
+    {
+    voxels[voxelIndex] = static_cast<short>(voxelIndex % 200);
+    }
+  vtkNew<vtkTrivialProducer> producer;
+  producer->SetOutput(imageData);
+
+  vtkNew<vtkMRMLScalarVolumeDisplayNode> fullDisplayNode;
+  fullDisplayNode->SetMaximumNumberOfHistogramSamples(0);
+  fullDisplayNode->SetInputImageDataConnection(producer->GetOutputPort());
+  CHECK_POINTER(fullDisplayNode->GetHistogramImageData(), imageData.GetPointer());
+  fullDisplayNode->Modified();
+
+  vtkNew<vtkMRMLScalarVolumeDisplayNode> sampledDisplayNode;
+  sampledDisplayNode->SetMaximumNumberOfHistogramSamples(100000);
+  sampledDisplayNode->SetInputImageDataConnection(producer->GetOutputPort());
+  vtkImageData* sampledImageData = sampledDisplayNode->GetHistogramImageData();
+  CHECK_NOT_NULL(sampledImageData);
+  CHECK_BOOL(sampledImageData->GetNumberOfPoints() <= 100000, true);
+  sampledDisplayNode->Modified();
+
+  // The subsampling is reused as long as the image is not modified
+  vtkMTimeType sampledMTime = sampledImageData->GetMTime();
+  CHECK_POINTER(sampledDisplayNode->GetHistogramImageData(), sampledImageData);
+  CHECK_BOOL(sampledImageData->GetMTime() == sampledMTime, true);
+
+  CHECK_DOUBLE_TOLERANCE(sampledDisplayNode->GetWindowLevelMin(), fullDisplayNode->GetWindowLevelMin(), 5.);
+  CHECK_DOUBLE_TOLERANCE(sampledDisplayNode->GetWindowLevelMax(), fullDisplayNode->GetWindowLevelMax(), 5.);
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
 int vtkMRMLScalarVolumeDisplayNodeTest1(int , char * [] )
 {
   vtkNew<vtkMRMLScalarVolumeDisplayNode> node1;
   EXERCISE_ALL_BASIC_MRML_METHODS(node1.GetPointer());
+  CHECK_EXIT_SUCCESS(TestHistogramSampling());
   return EXIT_SUCCESS;
 }
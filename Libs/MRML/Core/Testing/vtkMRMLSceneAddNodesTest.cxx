@@ -0,0 +1,226 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLCoreTestingUtilities.h"
+#include "vtkMRMLModelDisplayNode.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLScriptedModuleNode.h"
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <iostream>
+#include <vector>
+
+using namespace vtkMRMLCoreTestingUtilities;
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+int TestEvents()
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLNodeCallback> callback;
+  scene->AddObserver(vtkCommand::AnyEvent, callback.GetPointer());
+
+  std::vector<vtkSmartPointer<vtkMRMLNode> > nodes;
+  std::vector<vtkMRMLNode*> nodesToAdd;
+  for (int i = 0; i < 10; ++i)
+    {
+    nodes.push_back(vtkSmartPointer<vtkMRMLScriptedModuleNode>::New());
+    nodesToAdd.push_back(nodes.back());
+    }
+  std::vector<vtkMRMLNode*> nodesInScene = scene->AddNodes(nodesToAdd);
+
+  CHECK_EXIT_SUCCESS(callback->CheckStatus());
+  CHECK_INT(callback->GetNumberOfEvents(vtkMRMLScene::NodesAddedEvent), 1);
+  CHECK_INT(callback->GetNumberOfEvents(vtkMRMLScene::NodeAboutToBeAddedEvent), 0);
+  CHECK_INT(callback->GetNumberOfEvents(vtkMRMLScene::NodeAddedEvent), 0);
+  CHECK_INT(callback->GetNumberOfEvents(vtkMRMLScene::StartBatchProcessEvent), 1);
+  CHECK_INT(callback->GetNumberOfEvents(vtkMRMLScene::EndBatchProcessEvent), 1);
+  CHECK_INT(callback->GetNumberOfModified(), 1);
+  CHECK_BOOL(scene->IsBatchProcessing(), false);
+
+  CHECK_INT(static_cast<int>(nodesInScene.size()), 10);
+  for (size_t i = 0; i < nodes.size(); ++i)
+    {
+    CHECK_POINTER(nodesInScene[i], nodes[i]);
+    CHECK_POINTER(scene->GetNodeByID(nodes[i]->GetID()), nodes[i]);
+    CHECK_POINTER(scene->GetFirstNodeByName(nodes[i]->GetName()), nodes[i]);
+    }
+
+  // Singletons are merged into the existing node and not notified as added
+  vtkNew<vtkMRMLScriptedModuleNode> existingSingletonNode;
+  existingSingletonNode->SetSingletonTag("Singleton");
+  scene->AddNode(existingSingletonNode.GetPointer());
+  callback->ResetNumberOfEvents();
+  vtkNew<vtkMRMLScriptedModuleNode> singletonNode;
+  singletonNode->SetSingletonTag("Singleton");
+  nodesToAdd.clear();
+  nodesToAdd.push_back(singletonNode.GetPointer());
+  nodesToAdd.push_back(nullptr);
+  TESTING_OUTPUT_ASSERT_ERRORS_BEGIN();
+  nodesInScene = scene->AddNodes(nodesToAdd);
+  TESTING_OUTPUT_ASSERT_ERRORS_END();
+  CHECK_POINTER(nodesInScene[0], existingSingletonNode.GetPointer());
+  CHECK_NULL(nodesInScene[1]);
+  CHECK_INT(callback->GetNumberOfEvents(vtkMRMLScene::NodesAddedEvent), 0);
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int TestReferences()
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkMRMLNode* existingDisplayNode = scene->AddNewNodeByClass("vtkMRMLModelDisplayNode");
+  CHECK_STD_STRING(existingDisplayNode->GetID(), "vtkMRMLModelDisplayNode1");
+
+  // The model refers to a display node that is added after it and whose ID
+  // conflicts with a node already in the scene.
+  vtkNew<vtkMRMLModelNode> modelNode;
+  vtkNew<vtkMRMLModelDisplayNode> displayNode;
+  displayNode->SetID("vtkMRMLModelDisplayNode1");
+  modelNode->SetAndObserveDisplayNodeID("vtkMRMLModelDisplayNode1");
+
+  std::vector<vtkMRMLNode*> nodesToAdd;
+  nodesToAdd.push_back(modelNode.GetPointer());
+  nodesToAdd.push_back(displayNode.GetPointer());
+  scene->AddNodes(nodesToAdd);
+
+  CHECK_STD_STRING_DIFFERENT(displayNode->GetID(), "vtkMRMLModelDisplayNode1");
+  CHECK_STD_STRING(modelNode->GetDisplayNodeID(), displayNode->GetID());
+  CHECK_POINTER(modelNode->GetDisplayNode(), displayNode.GetPointer());
+  CHECK_POINTER(scene->GetNodeByID("vtkMRMLModelDisplayNode1"), existingDisplayNode);
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+std::vector<vtkSmartPointer<vtkMRMLNode> > CreateModelNodes(int numberOfNodes)
+{
+  std::vector<vtkSmartPointer<vtkMRMLNode> > nodes;
+  for (int i = 0; i < numberOfNodes; ++i)
+    {
+    nodes.push_back(vtkSmartPointer<vtkMRMLModelNode>::New());
+    }
+  return nodes;
+}
+
+//---------------------------------------------------------------------------
+// Displayable-manager-like observer: each notification of added nodes
+// makes it look for the displayable nodes of the scene.
+struct SceneObserverWork
+{
+  int NumberOfUpdates{0};
+  std::vector<vtkMRMLNode*> DisplayableNodes;
+};
+
+//---------------------------------------------------------------------------
+void UpdateFromSceneCallback(vtkObject* caller, unsigned long eid, void* clientData, void* vtkNotUsed(callData))
+{
+  if (eid != vtkMRMLScene::NodeAddedEvent && eid != vtkMRMLScene::NodesAddedEvent)
+    {
+    return;
+    }
+  SceneObserverWork* work = reinterpret_cast<SceneObserverWork*>(clientData);
+  vtkMRMLScene::SafeDownCast(caller)->GetNodesByClass("vtkMRMLDisplayableNode", work->DisplayableNodes);
+  ++work->NumberOfUpdates;
+}
+
+//---------------------------------------------------------------------------
+double AddNodesWithObservers(int numberOfNodes, bool useAddNodes, int& numberOfUpdates)
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLNodeCallback> callback;
+  scene->AddObserver(vtkCommand::AnyEvent, callback.GetPointer());
+  SceneObserverWork work;
+  vtkNew<vtkCallbackCommand> updateCallback;
+  updateCallback->SetCallback(UpdateFromSceneCallback);
+  updateCallback->SetClientData(&work);
+  scene->AddObserver(vtkMRMLScene::NodeAddedEvent, updateCallback.GetPointer());
+  scene->AddObserver(vtkMRMLScene::NodesAddedEvent, updateCallback.GetPointer());
+
+  std::vector<vtkSmartPointer<vtkMRMLNode> > nodes = CreateModelNodes(numberOfNodes);
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  if (useAddNodes)
+    {
+    std::vector<vtkMRMLNode*> nodesToAdd(nodes.begin(), nodes.end());
+    scene->AddNodes(nodesToAdd);
+    }
+  else
+    {
+    scene->StartState(vtkMRMLScene::BatchProcessState);
+    for (int i = 0; i < numberOfNodes; ++i)
+      {
+      scene->AddNode(nodes[i]);
+      }
+    scene->EndState(vtkMRMLScene::BatchProcessState);
+    }
+  timer->StopTimer();
+
+  numberOfUpdates = work.NumberOfUpdates;
+  if (scene->GetNumberOfNodesByClass("vtkMRMLModelNode") != numberOfNodes
+    || static_cast<int>(work.DisplayableNodes.size()) != numberOfNodes
+    || callback->GetNumberOfEvents(vtkMRMLScene::NodeAddedEvent)
+       + callback->GetNumberOfEvents(vtkMRMLScene::NodesAddedEvent) != numberOfUpdates)
+    {
+    std::cerr << "Line " << __LINE__ << ": observers were not notified of all the added nodes" << std::endl;
+    return -1.;
+    }
+  return timer->GetElapsedTime();
+}
+
+//---------------------------------------------------------------------------
+int TestAddNodesPerformance(int numberOfNodes)
+{
+  // Adding nodes one by one: the observers update once per node
+  int addNodeUpdates = 0;
+  double addNodeTime = AddNodesWithObservers(numberOfNodes, false, addNodeUpdates);
+  CHECK_BOOL(addNodeTime >= 0., true);
+  CHECK_INT(addNodeUpdates, numberOfNodes);
+
+  // Adding nodes at once: the observers update once
+  int addNodesUpdates = 0;
+  double addNodesTime = AddNodesWithObservers(numberOfNodes, true, addNodesUpdates);
+  CHECK_BOOL(addNodesTime >= 0., true);
+  CHECK_INT(addNodesUpdates, 1);
+
+  std::cout << "Nodes: " << numberOfNodes << std::endl
+            << "  AddNode in batch process: " << addNodeTime << " s" << std::endl
+            << "  AddNodes: " << addNodesTime << " s" << std::endl;
+  // the observer work is quadratic with AddNode() and linear with AddNodes()
+  CHECK_BOOL(addNodesTime < addNodeTime, true);
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkMRMLSceneAddNodesTest(int vtkNotUsed(argc), char * vtkNotUsed(argv) [])
+{
+  CHECK_EXIT_SUCCESS(TestEvents());
+  CHECK_EXIT_SUCCESS(TestReferences());
+  CHECK_EXIT_SUCCESS(TestAddNodesPerformance(1000));
+  CHECK_EXIT_SUCCESS(TestAddNodesPerformance(5000));
+  return EXIT_SUCCESS;
+}
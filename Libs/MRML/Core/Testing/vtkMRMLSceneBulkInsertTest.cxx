@@ -0,0 +1,129 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLScriptedModuleNode.h"
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <set>
+#include <string>
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+int TestUniqueNames()
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkMRMLNode* node1 = scene->AddNewNodeByClass("vtkMRMLScriptedModuleNode", "Name");
+  CHECK_STD_STRING(scene->GenerateUniqueName("Name"), "Name_1");
+
+  // Renamed nodes are taken into account
+  vtkMRMLNode* node2 = scene->AddNewNodeByClass("vtkMRMLScriptedModuleNode", "Other");
+  node2->SetName("Name_2");
+  CHECK_STD_STRING(scene->GenerateUniqueName("Name"), "Name_3");
+  CHECK_POINTER(scene->GetFirstNodeByName("Name_2"), node2);
+  CHECK_NULL(scene->GetFirstNodeByName("Other"));
+  node1->SetName("Renamed");
+  CHECK_NULL(scene->GetFirstNodeByName("Name"));
+  CHECK_POINTER(scene->GetFirstNodeByName("Renamed"), node1);
+
+  // Removed nodes are not found anymore
+  scene->RemoveNode(node2);
+  CHECK_NULL(scene->GetFirstNodeByName("Name_2"));
+  CHECK_STD_STRING(scene->GenerateUniqueName("Name"), "Name_4");
+
+  // Nodes with the same name
+  vtkMRMLNode* node3 = scene->AddNewNodeByClass("vtkMRMLScriptedModuleNode", "Renamed");
+  node1->SetName("Other");
+  CHECK_POINTER(scene->GetFirstNodeByName("Renamed"), node3);
+
+  // Renaming nodes that are not in the scene doesn't change the scene
+  vtkNew<vtkMRMLScriptedModuleNode> notInSceneNode;
+  notInSceneNode->SetName("NotInScene");
+  CHECK_NULL(scene->GetFirstNodeByName("NotInScene"));
+  CHECK_STD_STRING(scene->GenerateUniqueName("NotInScene"), "NotInScene");
+
+  scene->Clear(1);
+  CHECK_NULL(scene->GetFirstNodeByName("Renamed"));
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+// Returns the average time in seconds to add a node to a scene that contains
+// the given number of nodes.
+int MeasureInsertTime(int numberOfNodes, bool undo, double& insertTime)
+{
+  vtkNew<vtkMRMLScene> scene;
+  if (undo)
+    {
+    scene->SetUndoOn();
+    scene->SaveStateForUndo();
+    }
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  for (int i = 0; i < numberOfNodes; ++i)
+    {
+    vtkSmartPointer<vtkMRMLScriptedModuleNode> node = vtkSmartPointer<vtkMRMLScriptedModuleNode>::New();
+    scene->AddNode(node);
+    }
+  timer->StopTimer();
+  insertTime = timer->GetElapsedTime() / numberOfNodes;
+
+  // All IDs and names are unique
+  std::set<std::string> ids;
+  std::set<std::string> names;
+  for (int i = 0; i < scene->GetNumberOfNodes(); ++i)
+    {
+    vtkMRMLNode* node = scene->GetNthNode(i);
+    ids.insert(node->GetID());
+    names.insert(node->GetName());
+    }
+  CHECK_INT(static_cast<int>(ids.size()), scene->GetNumberOfNodes());
+  CHECK_INT(static_cast<int>(names.size()), scene->GetNumberOfNodes());
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int TestInsertScaling(bool undo)
+{
+  double smallSceneInsertTime = 0.0;
+  CHECK_EXIT_SUCCESS(MeasureInsertTime(1000, undo, smallSceneInsertTime));
+  double largeSceneInsertTime = 0.0;
+  CHECK_EXIT_SUCCESS(MeasureInsertTime(50000, undo, largeSceneInsertTime));
+  std::cout << (undo ? "Undo enabled" : "Undo disabled") << std::endl
+            << "  1000 nodes - insert time: " << smallSceneInsertTime * 1e6 << " us" << std::endl
+            << "  50000 nodes - insert time: " << largeSceneInsertTime * 1e6 << " us" << std::endl;
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkMRMLSceneBulkInsertTest(int vtkNotUsed(argc), char * vtkNotUsed(argv) [])
+{
+  CHECK_EXIT_SUCCESS(TestUniqueNames());
+  CHECK_EXIT_SUCCESS(TestInsertScaling(false));
+  CHECK_EXIT_SUCCESS(TestInsertScaling(true));
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,321 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLModelStorageNode.h"
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLVolumeArchetypeStorageNode.h"
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkImageData.h>
+#include <vtkITKArchetypeImageSeriesReader.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include <vtkSphereSource.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+const int NumberOfModels = 60;
+const int NumberOfVolumes = 4;
+
+//---------------------------------------------------------------------------
+// Model storage node that counts the reads that use the prefetched mesh.
+class vtkMRMLPrefetchCountingModelStorageNode : public vtkMRMLModelStorageNode
+{
+public:
+  static vtkMRMLPrefetchCountingModelStorageNode* New();
+  vtkTypeMacro(vtkMRMLPrefetchCountingModelStorageNode, vtkMRMLModelStorageNode);
+  vtkMRMLNode* CreateNodeInstance() override
+    {
+    return vtkMRMLPrefetchCountingModelStorageNode::New();
+    }
+  int ReadDataInternal(vtkMRMLNode* refNode) override
+    {
+    if (this->PrefetchedMesh)
+      {
+      ++NumberOfPrefetchedReads;
+      }
+    else
+      {
+      ++NumberOfFileReads;
+      }
+    return this->Superclass::ReadDataInternal(refNode);
+    }
+  static int NumberOfPrefetchedReads;
+  static int NumberOfFileReads;
+};
+vtkStandardNewMacro(vtkMRMLPrefetchCountingModelStorageNode);
+int vtkMRMLPrefetchCountingModelStorageNode::NumberOfPrefetchedReads = 0;
+int vtkMRMLPrefetchCountingModelStorageNode::NumberOfFileReads = 0;
+
+//---------------------------------------------------------------------------
+// Volume storage node that counts the reads that use the prefetched reader.
+class vtkMRMLPrefetchCountingVolumeArchetypeStorageNode : public vtkMRMLVolumeArchetypeStorageNode
+{
+public:
+  static vtkMRMLPrefetchCountingVolumeArchetypeStorageNode* New();
+  vtkTypeMacro(vtkMRMLPrefetchCountingVolumeArchetypeStorageNode, vtkMRMLVolumeArchetypeStorageNode);
+  vtkMRMLNode* CreateNodeInstance() override
+    {
+    return vtkMRMLPrefetchCountingVolumeArchetypeStorageNode::New();
+    }
+  int ReadDataInternal(vtkMRMLNode* refNode) override
+    {
+    if (this->PrefetchedReader)
+      {
+      ++NumberOfPrefetchedReads;
+      }
+    else
+      {
+      ++NumberOfFileReads;
+      }
+    return this->Superclass::ReadDataInternal(refNode);
+    }
+  static int NumberOfPrefetchedReads;
+  static int NumberOfFileReads;
+};
+vtkStandardNewMacro(vtkMRMLPrefetchCountingVolumeArchetypeStorageNode);
+int vtkMRMLPrefetchCountingVolumeArchetypeStorageNode::NumberOfPrefetchedReads = 0;
+int vtkMRMLPrefetchCountingVolumeArchetypeStorageNode::NumberOfFileReads = 0;
+
+//---------------------------------------------------------------------------
+void RegisterPrefetchCountingStorageNodes(vtkMRMLScene* scene)
+{
+  vtkMRMLPrefetchCountingModelStorageNode::NumberOfPrefetchedReads = 0;
+  vtkMRMLPrefetchCountingModelStorageNode::NumberOfFileReads = 0;
+  vtkMRMLPrefetchCountingVolumeArchetypeStorageNode::NumberOfPrefetchedReads = 0;
+  vtkMRMLPrefetchCountingVolumeArchetypeStorageNode::NumberOfFileReads = 0;
+  // The nodes replace the default classes registered for their tags
+  TESTING_OUTPUT_RESET();
+  vtkNew<vtkMRMLPrefetchCountingModelStorageNode> modelStorageNode;
+  scene->RegisterNodeClass(modelStorageNode.GetPointer());
+  vtkNew<vtkMRMLPrefetchCountingVolumeArchetypeStorageNode> volumeStorageNode;
+  scene->RegisterNodeClass(volumeStorageNode.GetPointer());
+  TESTING_OUTPUT_ASSERT_WARNINGS(2);
+  TESTING_OUTPUT_RESET();
+}
+
+//---------------------------------------------------------------------------
+void CountImportProgressEvents(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eid),
+  void* clientData, void* vtkNotUsed(callData))
+{
+  ++(*static_cast<int*>(clientData));
+}
+
+//---------------------------------------------------------------------------
+int CreateScene(const std::string& tempDir, const std::string& sceneFileName)
+{
+  vtkNew<vtkMRMLScene> scene;
+  scene->SetRootDirectory(tempDir.c_str());
+
+  for (int modelIndex = 0; modelIndex < NumberOfModels; ++modelIndex)
+    {
+    vtkNew<vtkSphereSource> sphere;
+    sphere->SetThetaResolution(200 + modelIndex);
+    sphere->SetPhiResolution(200);
+    sphere->SetCenter(modelIndex, 0, 0);
+    sphere->Update();
+    vtkMRMLModelNode* modelNode = vtkMRMLModelNode::SafeDownCast(
+      scene->AddNewNodeByClass("vtkMRMLModelNode"));
+    modelNode->SetAndObservePolyData(sphere->GetOutput());
+    modelNode->AddDefaultStorageNode();
+    std::stringstream fileName;
+    fileName << tempDir << "/vtkMRMLSceneImportPrefetchTest_model" << modelIndex << ".vtk";
+    modelNode->GetStorageNode()->SetFileName(fileName.str().c_str());
+    CHECK_INT(modelNode->GetStorageNode()->WriteData(modelNode), 1);
+    }
+
+  for (int volumeIndex = 0; volumeIndex < NumberOfVolumes; ++volumeIndex)
+    {
+    vtkNew<vtkImageData> imageData;
+    imageData->SetDimensions(256, 256, 128);
+    imageData->AllocateScalars(VTK_SHORT, 1);
+    short* voxels = static_cast<short*>(imageData->GetScalarPointer());
+    vtkIdType numberOfVoxels = imageData->GetNumberOfPoints();
+    for (vtkIdType voxelIndex = 0; voxelIndex < numberOfVoxels; ++voxelIndex)
+      {
+      voxels[voxelIndex] = static_cast<short>(voxelIndex % 1000);
+      }
+    vtkMRMLScalarVolumeNode* volumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(
+      scene->AddNewNodeByClass("vtkMRMLScalarVolumeNode"));
+    volumeNode->SetAndObserveImageData(imageData.GetPointer());
+    volumeNode->AddDefaultStorageNode();
+    std::stringstream fileName;
+    fileName << tempDir << "/vtkMRMLSceneImportPrefetchTest_volume" << volumeIndex << ".nrrd";
+    volumeNode->GetStorageNode()->SetFileName(fileName.str().c_str());
+    CHECK_INT(volumeNode->GetStorageNode()->WriteData(volumeNode), 1);
+    }
+
+  scene->SetURL(sceneFileName.c_str());
+  CHECK_INT(scene->Commit(), 1);
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int LoadScene(const std::string& sceneFileName, bool prefetch,
+  int& numberOfPoints, int& numberOfVoxels)
+{
+  vtkNew<vtkMRMLScene> scene;
+  RegisterPrefetchCountingStorageNodes(scene);
+  scene->SetURL(sceneFileName.c_str());
+  scene->SetPrefetchDataOnLoad(prefetch);
+
+  int progressEventCount = 0;
+  vtkNew<vtkCallbackCommand> progressCallback;
+  progressCallback->SetCallback(CountImportProgressEvents);
+  progressCallback->SetClientData(&progressEventCount);
+  scene->AddObserver(vtkMRMLScene::ProgressImportEvent, progressCallback.GetPointer());
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  CHECK_INT(scene->Connect(), 1);
+  timer->StopTimer();
+  std::cout << "Loaded " << NumberOfModels << " models and " << NumberOfVolumes << " volumes "
+            << (prefetch ? "with" : "without") << " prefetching: " << timer->GetElapsedTime() << "s" << std::endl;
+
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLModelNode"), NumberOfModels);
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLScalarVolumeNode"), NumberOfVolumes);
+  CHECK_BOOL(progressEventCount >= NumberOfModels + NumberOfVolumes, true);
+
+  // With prefetching, all the data is read by the worker threads and the
+  // files are not read again when the data is set in the nodes
+  CHECK_INT(vtkMRMLPrefetchCountingModelStorageNode::NumberOfPrefetchedReads, prefetch ? NumberOfModels : 0);
+  CHECK_INT(vtkMRMLPrefetchCountingModelStorageNode::NumberOfFileReads, prefetch ? 0 : NumberOfModels);
+  CHECK_INT(vtkMRMLPrefetchCountingVolumeArchetypeStorageNode::NumberOfPrefetchedReads, prefetch ? NumberOfVolumes : 0);
+  CHECK_INT(vtkMRMLPrefetchCountingVolumeArchetypeStorageNode::NumberOfFileReads, prefetch ? 0 : NumberOfVolumes);
+
+  numberOfPoints = 0;
+  std::vector<vtkMRMLNode*> modelNodes;
+  scene->GetNodesByClass("vtkMRMLModelNode", modelNodes);
+  for (vtkMRMLNode* node : modelNodes)
+    {
+    vtkMRMLModelNode* modelNode = vtkMRMLModelNode::SafeDownCast(node);
+    CHECK_NOT_NULL(modelNode->GetPolyData());
+    numberOfPoints += modelNode->GetPolyData()->GetNumberOfPoints();
+    }
+
+  numberOfVoxels = 0;
+  std::vector<vtkMRMLNode*> volumeNodes;
+  scene->GetNodesByClass("vtkMRMLScalarVolumeNode", volumeNodes);
+  for (vtkMRMLNode* node : volumeNodes)
+    {
+    vtkMRMLScalarVolumeNode* volumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(node);
+    CHECK_NOT_NULL(volumeNode->GetImageData());
+    numberOfVoxels += volumeNode->GetImageData()->GetNumberOfPoints();
+    CHECK_DOUBLE(volumeNode->GetImageData()->GetScalarComponentAsDouble(10, 0, 0, 0), 10.0);
+    }
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+// Load the scene and count the errors logged while loading.
+int LoadSceneWithErrors(const std::string& sceneFileName, bool prefetch, int& numberOfErrors)
+{
+  vtkNew<vtkMRMLScene> scene;
+  RegisterPrefetchCountingStorageNodes(scene);
+  scene->SetURL(sceneFileName.c_str());
+  scene->SetPrefetchDataOnLoad(prefetch);
+  scene->Connect();
+  numberOfErrors = vtkTestingOutputWindow::GetInstance()->GetNumberOfLoggedErrorMessages();
+  TESTING_OUTPUT_RESET();
+  // the file is read only once, by a worker thread if prefetching
+  CHECK_INT(vtkMRMLPrefetchCountingVolumeArchetypeStorageNode::NumberOfPrefetchedReads, prefetch ? 1 : 0);
+  CHECK_INT(vtkMRMLPrefetchCountingVolumeArchetypeStorageNode::NumberOfFileReads, prefetch ? 0 : 1);
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+// Errors of a prefetched read are reported once, as without prefetching.
+int TestReadErrors(const std::string& tempDir)
+{
+  std::string sceneFileName = tempDir + "/vtkMRMLSceneImportPrefetchTest_errors.mrml";
+  std::string fileName = tempDir + "/vtkMRMLSceneImportPrefetchTest_invalid.nrrd";
+  {
+  vtkNew<vtkMRMLScene> scene;
+  scene->SetRootDirectory(tempDir.c_str());
+  vtkNew<vtkImageData> imageData;
+  imageData->SetDimensions(16, 16, 16);
+  imageData->AllocateScalars(VTK_SHORT, 1);
+  vtkMRMLScalarVolumeNode* volumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(
+    scene->AddNewNodeByClass("vtkMRMLScalarVolumeNode"));
+  volumeNode->SetAndObserveImageData(imageData.GetPointer());
+  volumeNode->AddDefaultStorageNode();
+  volumeNode->GetStorageNode()->SetFileName(fileName.c_str());
+  CHECK_INT(volumeNode->GetStorageNode()->WriteData(volumeNode), 1);
+  scene->SetURL(sceneFileName.c_str());
+  CHECK_INT(scene->Commit(), 1);
+  }
+  {
+  std::ofstream file(fileName.c_str());
+  file << "not a NRRD file\n";
+  }
+
+  int numberOfErrors = 0;
+  CHECK_EXIT_SUCCESS(LoadSceneWithErrors(sceneFileName, false, numberOfErrors));
+  int numberOfPrefetchErrors = 0;
+  CHECK_EXIT_SUCCESS(LoadSceneWithErrors(sceneFileName, true, numberOfPrefetchErrors));
+  CHECK_BOOL(numberOfErrors > 0, true);
+  CHECK_INT(numberOfPrefetchErrors, numberOfErrors);
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkMRMLSceneImportPrefetchTest(int argc, char* argv[])
+{
+  if (argc != 2)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Missing parameters !\n"
+              << "Usage: " << argv[0] << " /path/to/temp"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::string tempDir = argv[1];
+  std::string sceneFileName = tempDir + "/vtkMRMLSceneImportPrefetchTest.mrml";
+  CHECK_EXIT_SUCCESS(CreateScene(tempDir, sceneFileName));
+
+  int numberOfPoints = 0;
+  int numberOfVoxels = 0;
+  CHECK_EXIT_SUCCESS(LoadScene(sceneFileName, false, numberOfPoints, numberOfVoxels));
+
+  int numberOfPrefetchedPoints = 0;
+  int numberOfPrefetchedVoxels = 0;
+  CHECK_EXIT_SUCCESS(LoadScene(sceneFileName, true, numberOfPrefetchedPoints, numberOfPrefetchedVoxels));
+
+  CHECK_INT(numberOfPrefetchedPoints, numberOfPoints);
+  CHECK_INT(numberOfPrefetchedVoxels, numberOfVoxels);
+  CHECK_INT(numberOfVoxels, NumberOfVolumes * 256 * 256 * 128);
+
+  CHECK_EXIT_SUCCESS(TestReadErrors(tempDir));
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,293 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Kitware Inc.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLLinearTransformNode.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLScriptedModuleNode.h"
+
+// VTK includes
+#include <vtkCollection.h>
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+// Scripted module node that counts the number of IsA() calls, which is
+// the cost unit of the class queries of the scene.
+class vtkMRMLIsACountingTestNode : public vtkMRMLScriptedModuleNode
+{
+public:
+  static vtkMRMLIsACountingTestNode* New()
+    {
+    vtkMRMLIsACountingTestNode* node = new vtkMRMLIsACountingTestNode;
+    node->InitializeObjectBase();
+    return node;
+    }
+  vtkTypeBool IsA(const char* type) override
+    {
+    ++IsACallCount;
+    return this->vtkMRMLScriptedModuleNode::IsA(type);
+    }
+  static int IsACallCount;
+};
+int vtkMRMLIsACountingTestNode::IsACallCount = 0;
+
+//---------------------------------------------------------------------------
+void AddCountingNodes(vtkMRMLScene* scene, int numberOfNodes)
+{
+  for (int i = 0; i < numberOfNodes; ++i)
+    {
+    vtkSmartPointer<vtkMRMLIsACountingTestNode> node = vtkSmartPointer<vtkMRMLIsACountingTestNode>::New();
+    scene->AddNode(node);
+    }
+}
+
+//---------------------------------------------------------------------------
+int TestQueriesConsistency()
+{
+  vtkNew<vtkMRMLScene> scene;
+
+  vtkMRMLNode* model1 = scene->AddNewNodeByClass("vtkMRMLModelNode", "Model1");
+  vtkMRMLNode* transform1 = scene->AddNewNodeByClass("vtkMRMLLinearTransformNode", "Transform1");
+  vtkMRMLNode* model2 = scene->AddNewNodeByClass("vtkMRMLModelNode", "Model2");
+
+  // Build the index entries
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLModelNode"), 2);
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLTransformableNode"), 3);
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLTransformNode"), 1);
+
+  // The index entries are kept up-to-date when nodes are added
+  vtkMRMLNode* model3 = scene->AddNewNodeByClass("vtkMRMLModelNode", "Model3");
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLModelNode"), 3);
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLTransformableNode"), 4);
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLTransformNode"), 1);
+  CHECK_POINTER(scene->GetFirstNodeByClass("vtkMRMLModelNode"), model1);
+  CHECK_POINTER(scene->GetNthNodeByClass(2, "vtkMRMLModelNode"), model3);
+  CHECK_NULL(scene->GetNthNodeByClass(3, "vtkMRMLModelNode"));
+  CHECK_POINTER(scene->GetNthNodeByClass(1, "vtkMRMLTransformableNode"), transform1);
+
+  // ... and when nodes are removed
+  scene->RemoveNode(model1);
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLModelNode"), 2);
+  CHECK_POINTER(scene->GetFirstNodeByClass("vtkMRMLModelNode"), model2);
+  std::vector<vtkMRMLNode*> nodes;
+  CHECK_INT(scene->GetNodesByClass("vtkMRMLTransformableNode", nodes), 3);
+  CHECK_POINTER(nodes[0], transform1);
+  CHECK_POINTER(nodes[1], model2);
+  CHECK_POINTER(nodes[2], model3);
+
+  // Inserted nodes are listed in the scene order
+  vtkNew<vtkMRMLModelNode> model4;
+  scene->InsertBeforeNode(model3, model4.GetPointer());
+  CHECK_INT(scene->GetNodesByClass("vtkMRMLModelNode", nodes), 3);
+  CHECK_POINTER(nodes[0], model2);
+  CHECK_POINTER(nodes[1], model4.GetPointer());
+  CHECK_POINTER(nodes[2], model3);
+
+  vtkSmartPointer<vtkCollection> collection = vtkSmartPointer<vtkCollection>::Take(
+    scene->GetNodesByClass("vtkMRMLDisplayableNode"));
+  CHECK_INT(collection->GetNumberOfItems(), 3);
+  collection = vtkSmartPointer<vtkCollection>::Take(scene->GetNodesByClassByName("vtkMRMLModelNode", "Model3"));
+  CHECK_INT(collection->GetNumberOfItems(), 1);
+  CHECK_POINTER(collection->GetItemAsObject(0), model3);
+
+  // Nodes can be removed from the middle of the index entries
+  scene->RemoveNode(model4.GetPointer());
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLModelNode"), 2);
+  CHECK_POINTER(scene->GetNthNodeByClass(0, "vtkMRMLModelNode"), model2);
+  CHECK_POINTER(scene->GetNthNodeByClass(1, "vtkMRMLModelNode"), model3);
+  CHECK_NULL(scene->GetNthNodeByClass(2, "vtkMRMLModelNode"));
+  CHECK_POINTER(scene->GetNthNodeByClass(1, "vtkMRMLDisplayableNode"), model3);
+
+  // Results must match the node collection
+  int expectedNumberOfNodes = 0;
+  for (int i = 0; i < scene->GetNumberOfNodes(); ++i)
+    {
+    if (scene->GetNthNode(i)->IsA("vtkMRMLNode"))
+      {
+      ++expectedNumberOfNodes;
+      }
+    }
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLNode"), expectedNumberOfNodes);
+
+  scene->Clear(1);
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLModelNode"), 0);
+  CHECK_NULL(scene->GetFirstNodeByClass("vtkMRMLNode"));
+
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+// Removed nodes are replaced by the last node of the index entries, the
+// queries still list the nodes in the scene order.
+int TestRemovalOrder()
+{
+  vtkNew<vtkMRMLScene> scene;
+  for (int i = 0; i < 100; ++i)
+    {
+    scene->AddNewNodeByClass("vtkMRMLModelNode");
+    }
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLModelNode"), 100);
+
+  std::vector<vtkMRMLNode*> nodes;
+  scene->GetNodesByClass("vtkMRMLModelNode", nodes);
+  for (size_t i = 0; i < nodes.size(); i += 3)
+    {
+    scene->RemoveNode(nodes[i]);
+    }
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLModelNode"), 66);
+
+  std::vector<vtkMRMLNode*> expectedNodes;
+  for (int i = 0; i < scene->GetNumberOfNodes(); ++i)
+    {
+    if (scene->GetNthNode(i)->IsA("vtkMRMLModelNode"))
+      {
+      expectedNodes.push_back(scene->GetNthNode(i));
+      }
+    }
+  CHECK_INT(scene->GetNodesByClass("vtkMRMLModelNode", nodes), 66);
+  CHECK_BOOL(nodes == expectedNodes, true);
+  CHECK_POINTER(scene->GetFirstNodeByClass("vtkMRMLModelNode"), expectedNodes[0]);
+  CHECK_POINTER(scene->GetNthNodeByClass(65, "vtkMRMLModelNode"), expectedNodes[65]);
+
+  // Nodes added after the removals are listed last
+  vtkMRMLNode* addedNode = scene->AddNewNodeByClass("vtkMRMLModelNode");
+  scene->RemoveNode(expectedNodes[10]);
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLModelNode"), 66);
+  CHECK_POINTER(scene->GetNthNodeByClass(10, "vtkMRMLModelNode"), expectedNodes[11]);
+  CHECK_POINTER(scene->GetNthNodeByClass(65, "vtkMRMLModelNode"), addedNode);
+
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+// Count IsA() calls made by class queries and node additions.
+void CountIsACalls(int numberOfNodes, int& queryCalls, int& addCalls)
+{
+  vtkNew<vtkMRMLScene> scene;
+  AddCountingNodes(scene, numberOfNodes);
+
+  // First query builds the index entries
+  scene->GetNumberOfNodesByClass("vtkMRMLScriptedModuleNode");
+  scene->GetNumberOfNodesByClass("vtkMRMLNode");
+
+  vtkMRMLIsACountingTestNode::IsACallCount = 0;
+  for (int i = 0; i < 10; ++i)
+    {
+    scene->GetNumberOfNodesByClass("vtkMRMLScriptedModuleNode");
+    scene->GetFirstNodeByClass("vtkMRMLScriptedModuleNode");
+    scene->GetNthNodeByClass(1, "vtkMRMLNode");
+    std::vector<vtkMRMLNode*> nodes;
+    scene->GetNodesByClass("vtkMRMLScriptedModuleNode", nodes);
+    }
+  queryCalls = vtkMRMLIsACountingTestNode::IsACallCount;
+
+  vtkMRMLIsACountingTestNode::IsACallCount = 0;
+  AddCountingNodes(scene, 1);
+  scene->GetNumberOfNodesByClass("vtkMRMLScriptedModuleNode");
+  addCalls = vtkMRMLIsACountingTestNode::IsACallCount;
+}
+
+//---------------------------------------------------------------------------
+int TestQueriesScaling()
+{
+  int smallSceneQueryCalls = 0;
+  int smallSceneAddCalls = 0;
+  CountIsACalls(1000, smallSceneQueryCalls, smallSceneAddCalls);
+  int largeSceneQueryCalls = 0;
+  int largeSceneAddCalls = 0;
+  CountIsACalls(20000, largeSceneQueryCalls, largeSceneAddCalls);
+
+  // Queries on indexed classes don't visit the nodes
+  CHECK_INT(smallSceneQueryCalls, 0);
+  CHECK_INT(largeSceneQueryCalls, 0);
+  // Adding a node costs the same regardless of the number of nodes
+  CHECK_INT(largeSceneAddCalls, smallSceneAddCalls);
+
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+// Threads reading the scene at the same time rebuild the indices only once.
+int TestConcurrentQueries()
+{
+  vtkNew<vtkMRMLScene> scene;
+  const int numberOfNodes = 1000;
+  for (int i = 0; i < numberOfNodes; ++i)
+    {
+    scene->AddNewNodeByClass(i % 2 ? "vtkMRMLModelNode" : "vtkMRMLLinearTransformNode");
+    }
+  // Inserting a node outdates the indices, the next query rebuilds them
+  vtkNew<vtkMRMLModelNode> insertedModel;
+  scene->InsertBeforeNode(scene->GetNthNode(0), insertedModel.GetPointer());
+
+  std::vector<std::string> nodeIDs;
+  for (int i = 0; i < scene->GetNumberOfNodes(); ++i)
+    {
+    nodeIDs.push_back(scene->GetNthNode(i)->GetID());
+    }
+  std::atomic<int> numberOfErrors(0);
+  std::vector<std::thread> threads;
+  for (int threadIndex = 0; threadIndex < 4; ++threadIndex)
+    {
+    threads.push_back(std::thread([&]
+      {
+      for (const std::string& nodeID : nodeIDs)
+        {
+        vtkMRMLNode* node = scene->GetNodeByID(nodeID);
+        if (!node || nodeID != node->GetID())
+          {
+          ++numberOfErrors;
+          }
+        }
+      if (scene->GetNumberOfNodesByClass("vtkMRMLModelNode") != numberOfNodes / 2 + 1
+        || scene->GetFirstNodeByClass("vtkMRMLModelNode") != insertedModel.GetPointer())
+        {
+        ++numberOfErrors;
+        }
+      }));
+    }
+  for (std::thread& thread : threads)
+    {
+    thread.join();
+    }
+  CHECK_INT(numberOfErrors.load(), 0);
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkMRMLSceneNodeClassIndexTest(int vtkNotUsed(argc), char * vtkNotUsed(argv) [])
+{
+  CHECK_EXIT_SUCCESS(TestQueriesConsistency());
+  CHECK_EXIT_SUCCESS(TestRemovalOrder());
+  CHECK_EXIT_SUCCESS(TestQueriesScaling());
+  CHECK_EXIT_SUCCESS(TestConcurrentQueries());
+  return EXIT_SUCCESS;
+}
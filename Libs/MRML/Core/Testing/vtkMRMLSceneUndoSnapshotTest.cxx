@@ -0,0 +1,238 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLScriptedModuleNode.h"
+#include "vtkMRMLTableNode.h"
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+#include <vtkStringArray.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <vector>
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+std::vector<vtkMRMLScriptedModuleNode*> AddParameterNodes(vtkMRMLScene* scene, int numberOfNodes)
+{
+  std::vector<vtkMRMLScriptedModuleNode*> nodes;
+  for (int i = 0; i < numberOfNodes; ++i)
+    {
+    vtkMRMLScriptedModuleNode* node = vtkMRMLScriptedModuleNode::SafeDownCast(
+      scene->AddNewNodeByClass("vtkMRMLScriptedModuleNode"));
+    node->SetUndoEnabled(true);
+    node->SetParameter("Value", "0");
+    nodes.push_back(node);
+    }
+  return nodes;
+}
+
+//---------------------------------------------------------------------------
+int TestSharedSnapshots()
+{
+  vtkNew<vtkMRMLScene> scene;
+  scene->SetUndoOn();
+  CHECK_BOOL(scene->GetSharedUndoSnapshots(), true);
+  std::vector<vtkMRMLScriptedModuleNode*> nodes = AddParameterNodes(scene, 10);
+
+  scene->SaveStateForUndo();
+  CHECK_INT(scene->GetNumberOfUndoSnapshots(), 10);
+
+  // Only the modified node is copied
+  nodes[0]->SetParameter("Value", "1");
+  scene->SaveStateForUndo();
+  CHECK_INT(scene->GetNumberOfUndoLevels(), 2);
+  CHECK_INT(scene->GetNumberOfUndoSnapshots(), 11);
+
+  // Nothing is copied if the scene has not changed
+  scene->SaveStateForUndo();
+  CHECK_INT(scene->GetNumberOfUndoSnapshots(), 11);
+
+  // Nodes modified while their modified events are disabled are copied
+  int wasModifying = nodes[1]->StartModify();
+  nodes[1]->SetParameter("Value", "1");
+  scene->SaveStateForUndo();
+  nodes[1]->EndModify(wasModifying);
+  CHECK_INT(scene->GetNumberOfUndoSnapshots(), 12);
+
+  nodes[0]->SetParameter("Value", "2");
+  nodes[1]->SetParameter("Value", "2");
+
+  scene->Undo();
+  CHECK_STD_STRING(nodes[0]->GetParameter("Value"), "1");
+  CHECK_STD_STRING(nodes[1]->GetParameter("Value"), "1");
+  scene->Undo();
+  CHECK_STD_STRING(nodes[0]->GetParameter("Value"), "1");
+  CHECK_STD_STRING(nodes[1]->GetParameter("Value"), "0");
+  scene->Undo();
+  scene->Undo();
+  CHECK_STD_STRING(nodes[0]->GetParameter("Value"), "0");
+  CHECK_STD_STRING(nodes[1]->GetParameter("Value"), "0");
+  CHECK_INT(scene->GetNumberOfUndoLevels(), 0);
+  CHECK_INT(scene->GetNumberOfUndoSnapshots(), 0);
+  for (size_t i = 2; i < nodes.size(); ++i)
+    {
+    CHECK_POINTER(scene->GetNodeByID(nodes[i]->GetID()), nodes[i]);
+    CHECK_STD_STRING(nodes[i]->GetParameter("Value"), "0");
+    }
+
+  scene->Redo();
+  scene->Redo();
+  scene->Redo();
+  scene->Redo();
+  CHECK_STD_STRING(nodes[0]->GetParameter("Value"), "2");
+  CHECK_STD_STRING(nodes[1]->GetParameter("Value"), "2");
+
+  // All nodes are copied at each state if sharing is disabled
+  scene->ClearUndoStack();
+  scene->SetSharedUndoSnapshots(false);
+  scene->SaveStateForUndo();
+  scene->SaveStateForUndo();
+  CHECK_INT(scene->GetNumberOfUndoSnapshots(), 20);
+
+  // Snapshots of trimmed states are released
+  scene->SetSharedUndoSnapshots(true);
+  scene->SetMaximumNumberOfSavedUndoStates(1);
+  CHECK_INT(scene->GetNumberOfUndoLevels(), 1);
+  CHECK_INT(scene->GetNumberOfUndoSnapshots(), 10);
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int TestRestoreDeletedNode()
+{
+  vtkNew<vtkMRMLScene> scene;
+  scene->SetUndoOn();
+  vtkMRMLScriptedModuleNode* node = AddParameterNodes(scene, 1)[0];
+  std::string nodeID = node->GetID();
+
+  // The snapshot of the node is shared by the two states
+  scene->SaveStateForUndo();
+  scene->SaveStateForUndo();
+  CHECK_INT(scene->GetNumberOfUndoSnapshots(), 1);
+  scene->RemoveNode(node);
+
+  scene->Undo();
+  vtkMRMLScriptedModuleNode* restoredNode =
+    vtkMRMLScriptedModuleNode::SafeDownCast(scene->GetNodeByID(nodeID));
+  CHECK_NOT_NULL(restoredNode);
+  CHECK_STD_STRING(restoredNode->GetParameter("Value"), "0");
+
+  // Modifying the restored node must not modify the remaining undo state
+  restoredNode->SetParameter("Value", "1");
+  scene->Undo();
+  CHECK_POINTER(scene->GetNodeByID(nodeID), restoredNode);
+  CHECK_STD_STRING(restoredNode->GetParameter("Value"), "0");
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int TestContentChanges()
+{
+  vtkNew<vtkMRMLScene> scene;
+  scene->SetUndoOn();
+  vtkMRMLTableNode* tableNode = vtkMRMLTableNode::SafeDownCast(
+    scene->AddNewNodeByClass("vtkMRMLTableNode"));
+  tableNode->SetUndoEnabled(true);
+  vtkStringArray* column = vtkStringArray::SafeDownCast(tableNode->AddColumn());
+  tableNode->AddEmptyRow();
+  tableNode->SetCellText(0, 0, "a");
+
+  scene->SaveStateForUndo();
+  int numberOfSnapshots = scene->GetNumberOfUndoSnapshots();
+
+  // Modifying the table content makes a new snapshot
+  column->SetValue(0, "b");
+  column->Modified();
+  scene->SaveStateForUndo();
+  CHECK_INT(scene->GetNumberOfUndoSnapshots(), numberOfSnapshots + 1);
+
+  tableNode->SetCellText(0, 0, "c");
+  scene->Undo();
+  CHECK_STD_STRING(tableNode->GetCellText(0, 0), "b");
+  scene->Undo();
+  CHECK_STD_STRING(tableNode->GetCellText(0, 0), "a");
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int TestUndoPerformance(int numberOfNodes, int numberOfStates, bool shared)
+{
+  vtkNew<vtkMRMLScene> scene;
+  scene->SetUndoOn();
+  scene->SetSharedUndoSnapshots(shared);
+  scene->SetMaximumNumberOfSavedUndoStates(numberOfStates);
+  std::vector<vtkMRMLScriptedModuleNode*> nodes = AddParameterNodes(scene, numberOfNodes);
+
+  // Each state modifies a single node
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  for (int i = 0; i < numberOfStates; ++i)
+    {
+    scene->SaveStateForUndo();
+    nodes[i % numberOfNodes]->SetParameter("Value", "1");
+    }
+  timer->StopTimer();
+  double saveTime = timer->GetElapsedTime();
+  int numberOfSnapshots = scene->GetNumberOfUndoSnapshots();
+
+  timer->StartTimer();
+  while (scene->GetNumberOfUndoLevels() > 0)
+    {
+    scene->Undo();
+    }
+  timer->StopTimer();
+  double undoTime = timer->GetElapsedTime();
+  for (int i = 0; i < numberOfNodes; ++i)
+    {
+    CHECK_STD_STRING(nodes[i]->GetParameter("Value"), "0");
+    }
+
+  if (shared)
+    {
+    CHECK_INT(numberOfSnapshots, numberOfNodes + numberOfStates - 1);
+    }
+  else
+    {
+    CHECK_INT(numberOfSnapshots, numberOfNodes * numberOfStates);
+    }
+
+  std::cout << "Nodes: " << numberOfNodes << ", states: " << numberOfStates
+            << (shared ? ", shared snapshots" : ", full copies") << std::endl
+            << "  node copies: " << numberOfSnapshots << std::endl
+            << "  save state: " << saveTime / numberOfStates << " s" << std::endl
+            << "  undo: " << undoTime / numberOfStates << " s" << std::endl;
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkMRMLSceneUndoSnapshotTest(int vtkNotUsed(argc), char * vtkNotUsed(argv) [])
+{
+  CHECK_EXIT_SUCCESS(TestSharedSnapshots());
+  CHECK_EXIT_SUCCESS(TestRestoreDeletedNode());
+  CHECK_EXIT_SUCCESS(TestContentChanges());
+  CHECK_EXIT_SUCCESS(TestUndoPerformance(1000, 20, false));
+  CHECK_EXIT_SUCCESS(TestUndoPerformance(1000, 20, true));
+  return EXIT_SUCCESS;
+}
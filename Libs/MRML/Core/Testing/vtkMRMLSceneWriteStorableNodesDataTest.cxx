@@ -0,0 +1,198 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLModelStorageNode.h"
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLVolumeArchetypeStorageNode.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPolyData.h>
+#include <vtkSphereSource.h>
+#include <vtkTimerLog.h>
+
+// VTKsys includes
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+const int NumberOfModels = 4;
+const int NumberOfVolumes = 8;
+
+//---------------------------------------------------------------------------
+std::string FileName(const std::string& tempDir, const std::string& name, int index, const std::string& extension)
+{
+  std::stringstream fileName;
+  fileName << tempDir << "/vtkMRMLSceneWriteStorableNodesDataTest_" << name << index << extension;
+  return fileName.str();
+}
+
+//---------------------------------------------------------------------------
+int CheckWrittenFiles(const std::vector<vtkMRMLStorageNode*>& storageNodes,
+  const std::vector<unsigned long>& expectedFileLengths)
+{
+  for (size_t index = 0; index < storageNodes.size(); ++index)
+    {
+    const char* fileName = storageNodes[index]->GetFileName();
+    CHECK_BOOL(vtksys::SystemTools::FileExists(fileName, true), true);
+    if (expectedFileLengths.size() > index)
+      {
+      CHECK_BOOL(vtksys::SystemTools::FileLength(fileName) == expectedFileLengths[index], true);
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkMRMLSceneWriteStorableNodesDataTest(int argc, char* argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Missing parameters !\n"
+              << "Usage: " << argv[0] << " /path/to/temp [total volume size in MB]"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::string tempDir = argv[1];
+  // Each slice of 256x256 short voxels is 128kB, 8 volumes of n slices are n MB.
+  // The default size keeps the test fast, pass a larger one (e.g. 256) to
+  // measure the write time of a realistic scene.
+  int totalSizeInMB = (argc > 2 ? atoi(argv[2]) : 8);
+  CHECK_BOOL(totalSizeInMB > 0, true);
+
+  vtkNew<vtkMRMLScene> scene;
+  std::vector<vtkMRMLStorageNode*> storageNodes;
+  std::vector<vtkMRMLStorableNode*> storableNodes;
+
+  for (int volumeIndex = 0; volumeIndex < NumberOfVolumes; ++volumeIndex)
+    {
+    vtkNew<vtkImageData> imageData;
+    imageData->SetDimensions(256, 256, totalSizeInMB);
+    imageData->AllocateScalars(VTK_SHORT, 1);
+    short* voxels = static_cast<short*>(imageData->GetScalarPointer());
+    vtkIdType numberOfVoxels = imageData->GetNumberOfPoints();
+    for (vtkIdType voxelIndex = 0; voxelIndex < numberOfVoxels; ++voxelIndex)
+      {
+      voxels[voxelIndex] = static_cast<short>((voxelIndex + volumeIndex) % 1000);
+      }
+    vtkMRMLScalarVolumeNode* volumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(
+      scene->AddNewNodeByClass("vtkMRMLScalarVolumeNode"));
+    volumeNode->SetAndObserveImageData(imageData.GetPointer());
+    volumeNode->AddDefaultStorageNode();
+    vtkMRMLStorageNode* storageNode = volumeNode->GetStorageNode();
+    storageNode->SetFileName(FileName(tempDir, "volume", volumeIndex, ".nrrd").c_str());
+    storageNode->SetUseCompression(0);
+    CHECK_BOOL(storageNode->CanWriteDataConcurrently(), true);
+    storageNodes.push_back(storageNode);
+    storableNodes.push_back(volumeNode);
+    }
+
+  for (int modelIndex = 0; modelIndex < NumberOfModels; ++modelIndex)
+    {
+    vtkNew<vtkSphereSource> sphere;
+    sphere->SetThetaResolution(100 + modelIndex);
+    sphere->SetPhiResolution(100);
+    sphere->Update();
+    vtkMRMLModelNode* modelNode = vtkMRMLModelNode::SafeDownCast(
+      scene->AddNewNodeByClass("vtkMRMLModelNode"));
+    modelNode->SetAndObservePolyData(sphere->GetOutput());
+    modelNode->AddDefaultStorageNode();
+    vtkMRMLStorageNode* storageNode = modelNode->GetStorageNode();
+    storageNode->SetFileName(FileName(tempDir, "model", modelIndex, ".vtk").c_str());
+    CHECK_BOOL(storageNode->CanWriteDataConcurrently(), true);
+    storageNodes.push_back(storageNode);
+    storableNodes.push_back(modelNode);
+    }
+
+  // Reference: write the files one after the other
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  std::vector<unsigned long> fileLengths;
+  for (size_t index = 0; index < storageNodes.size(); ++index)
+    {
+    CHECK_INT(storageNodes[index]->WriteData(storableNodes[index]), 1);
+    fileLengths.push_back(vtksys::SystemTools::FileLength(storageNodes[index]->GetFileName()));
+    }
+  timer->StopTimer();
+  double serialTime = timer->GetElapsedTime();
+  CHECK_EXIT_SUCCESS(CheckWrittenFiles(storageNodes, fileLengths));
+  for (vtkMRMLStorageNode* storageNode : storageNodes)
+    {
+    vtksys::SystemTools::RemoveFile(storageNode->GetFileName());
+    }
+
+  timer->StartTimer();
+  std::vector<int> results = scene->WriteStorableNodesData(storageNodes, storableNodes);
+  timer->StopTimer();
+  double concurrentTime = timer->GetElapsedTime();
+  CHECK_INT(static_cast<int>(results.size()), static_cast<int>(storageNodes.size()));
+  for (int result : results)
+    {
+    CHECK_INT(result, 1);
+    }
+  CHECK_EXIT_SUCCESS(CheckWrittenFiles(storageNodes, fileLengths));
+
+  std::cout << "Wrote " << NumberOfVolumes << " volumes (" << totalSizeInMB << "MB) and "
+            << NumberOfModels << " models: serially " << serialTime
+            << "s, concurrently " << concurrentTime << "s" << std::endl;
+
+  // Written volumes can be read back
+  vtkNew<vtkMRMLScalarVolumeNode> readVolumeNode;
+  vtkNew<vtkMRMLVolumeArchetypeStorageNode> readStorageNode;
+  readStorageNode->SetFileName(storageNodes[NumberOfVolumes - 1]->GetFileName());
+  CHECK_INT(readStorageNode->ReadData(readVolumeNode.GetPointer()), 1);
+  CHECK_DOUBLE(readVolumeNode->GetImageData()->GetScalarComponentAsDouble(10, 0, 0, 0),
+    static_cast<double>(10 + NumberOfVolumes - 1));
+
+  // Missing nodes are not written
+  storageNodes.push_back(nullptr);
+  storableNodes.push_back(storableNodes[0]);
+  results = scene->WriteStorableNodesData(storageNodes, storableNodes);
+  CHECK_INT(static_cast<int>(results.size()), static_cast<int>(storageNodes.size()));
+  CHECK_INT(results.back(), 0);
+  CHECK_INT(results.front(), 1);
+
+  // Mismatching number of storage and storable nodes
+  storableNodes.pop_back();
+  TESTING_OUTPUT_ASSERT_ERRORS_BEGIN();
+  results = scene->WriteStorableNodesData(storageNodes, storableNodes);
+  TESTING_OUTPUT_ASSERT_ERRORS_END();
+  CHECK_INT(results.front(), 0);
+
+  for (vtkMRMLStorageNode* storageNode : storageNodes)
+    {
+    if (storageNode)
+      {
+      vtksys::SystemTools::RemoveFile(storageNode->GetFileName());
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,168 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLSubjectHierarchyNode.h"
+
+// VTK includes
+#include <vtkNew.h>
+
+// STD includes
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+int TestLookupConsistency()
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkMRMLSubjectHierarchyNode* shNode = scene->GetSubjectHierarchyNode();
+  CHECK_NOT_NULL(shNode);
+  vtkIdType sceneItemID = shNode->GetSceneItemID();
+
+  vtkIdType studyItemID = shNode->CreateStudyItem(sceneItemID, "Study");
+  shNode->SetItemUID(studyItemID, "DICOM", "1.2.3");
+  vtkIdType folderItemID = shNode->CreateFolderItem(sceneItemID, "Folder");
+
+  vtkMRMLNode* model1 = scene->AddNewNodeByClass("vtkMRMLModelNode", "Model1");
+  vtkMRMLNode* model2 = scene->AddNewNodeByClass("vtkMRMLModelNode", "Model2");
+  vtkIdType model1ItemID = shNode->CreateItem(studyItemID, model1);
+  vtkIdType model2ItemID = shNode->CreateItem(sceneItemID, model2);
+  shNode->SetItemUID(model1ItemID, "DICOMInstanceUID", "1.2.3.4 1.2.3.5 1.2.3.6");
+
+  CHECK_INT(shNode->GetItemByDataNode(model1), model1ItemID);
+  CHECK_INT(shNode->GetItemByDataNode(model2), model2ItemID);
+  CHECK_INT(shNode->GetItemByUID("DICOM", "1.2.3"), studyItemID);
+  CHECK_INT(shNode->GetItemByUID("DICOM", "1.2.3.4"), vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+  CHECK_INT(shNode->GetItemByUIDList("DICOMInstanceUID", "1.2.3.5"), model1ItemID);
+  CHECK_INT(shNode->GetItemByUIDList("DICOMInstanceUID", "1.2.3.7"), vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+
+  // Reparenting keeps the lookup consistent
+  shNode->SetItemParent(model1ItemID, folderItemID);
+  CHECK_INT(shNode->GetItemByDataNode(model1), model1ItemID);
+  CHECK_INT(shNode->GetItemByUIDList("DICOMInstanceUID", "1.2.3.6"), model1ItemID);
+
+  // Replaced UID values are no longer found
+  shNode->SetItemUID(studyItemID, "DICOM", "1.2.4");
+  CHECK_INT(shNode->GetItemByUID("DICOM", "1.2.3"), vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+  CHECK_INT(shNode->GetItemByUID("DICOM", "1.2.4"), studyItemID);
+
+  // Children of removed items are moved to the parent and can still be found
+  shNode->RemoveItem(folderItemID, false, false);
+  CHECK_INT(shNode->GetItemParent(model1ItemID), sceneItemID);
+  CHECK_INT(shNode->GetItemByDataNode(model1), model1ItemID);
+
+  // Removed items are no longer found
+  std::string model1ID = model1->GetID();
+  shNode->RemoveItem(model1ItemID);
+  CHECK_INT(shNode->GetItemByUIDList("DICOMInstanceUID", "1.2.3.5"), vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+  CHECK_NULL(scene->GetNodeByID(model1ID));
+  shNode->RemoveItem(model2ItemID, false);
+  CHECK_INT(shNode->GetItemByDataNode(model2), vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID);
+  // Items can be added again for the same data node
+  model2ItemID = shNode->CreateItem(studyItemID, model2);
+  CHECK_BOOL(model2ItemID != vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID, true);
+  CHECK_INT(shNode->GetItemByDataNode(model2), model2ItemID);
+
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+// Items with the same UID are found in the order of the tree, as when the
+// lookup traversed the tree.
+int TestDuplicateUIDs()
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkMRMLSubjectHierarchyNode* shNode = scene->GetSubjectHierarchyNode();
+  CHECK_NOT_NULL(shNode);
+  vtkIdType sceneItemID = shNode->GetSceneItemID();
+
+  vtkIdType study1ItemID = shNode->CreateStudyItem(sceneItemID, "Study1");
+  vtkIdType study2ItemID = shNode->CreateStudyItem(sceneItemID, "Study2");
+  vtkIdType folderItemID = shNode->CreateFolderItem(study2ItemID, "Folder");
+  // UIDs are set in the reverse order of the tree
+  shNode->SetItemUID(folderItemID, "DICOM", "1.2.3");
+  shNode->SetItemUID(study2ItemID, "DICOM", "1.2.3");
+  shNode->SetItemUID(study1ItemID, "DICOM", "1.2.3");
+  shNode->SetItemUID(folderItemID, "DICOMInstanceUID", "1.2.3.4 1.2.3.5");
+  shNode->SetItemUID(study2ItemID, "DICOMInstanceUID", "1.2.3.5 1.2.3.6");
+  CHECK_INT(shNode->GetItemByUID("DICOM", "1.2.3"), study1ItemID);
+  // a parent is found before its children
+  CHECK_INT(shNode->GetItemByUIDList("DICOMInstanceUID", "1.2.3.5"), study2ItemID);
+  CHECK_INT(shNode->GetItemByUIDList("DICOMInstanceUID", "1.2.3.4"), folderItemID);
+
+  // Reparenting changes the order
+  shNode->SetItemParent(study1ItemID, folderItemID);
+  CHECK_INT(shNode->GetItemByUID("DICOM", "1.2.3"), study2ItemID);
+  shNode->RemoveItem(study2ItemID, false, false);
+  CHECK_INT(shNode->GetItemByUID("DICOM", "1.2.3"), folderItemID);
+  CHECK_INT(shNode->GetItemByUIDList("DICOMInstanceUID", "1.2.3.5"), folderItemID);
+
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+// Lookups find all the items of a large hierarchy
+int TestLookupLargeHierarchy()
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkMRMLSubjectHierarchyNode* shNode = scene->GetSubjectHierarchyNode();
+  CHECK_NOT_NULL(shNode);
+
+  const int numberOfItems = 5000;
+  std::vector<vtkMRMLNode*> dataNodes;
+  std::vector<vtkIdType> itemIDs;
+  vtkIdType parentItemID = shNode->GetSceneItemID();
+  for (int i = 0; i < numberOfItems; ++i)
+    {
+    if (i % 100 == 0)
+      {
+      parentItemID = shNode->CreateStudyItem(shNode->GetSceneItemID(), "Study");
+      }
+    vtkMRMLNode* node = scene->AddNewNodeByClass("vtkMRMLModelNode");
+    vtkIdType itemID = shNode->CreateItem(parentItemID, node);
+    std::stringstream uid;
+    uid << "1.2.840." << i;
+    shNode->SetItemUID(itemID, "DICOM", uid.str());
+    dataNodes.push_back(node);
+    itemIDs.push_back(itemID);
+    }
+
+  for (int i = 0; i < numberOfItems; ++i)
+    {
+    CHECK_INT(shNode->GetItemByDataNode(dataNodes[i]), itemIDs[i]);
+    std::stringstream uid;
+    uid << "1.2.840." << i;
+    CHECK_INT(shNode->GetItemByUID("DICOM", uid.str().c_str()), itemIDs[i]);
+    }
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+int vtkMRMLSubjectHierarchyNodeLookupTest(int vtkNotUsed(argc), char * vtkNotUsed(argv) [])
+{
+  CHECK_EXIT_SUCCESS(TestLookupConsistency());
+  CHECK_EXIT_SUCCESS(TestDuplicateUIDs());
+  CHECK_EXIT_SUCCESS(TestLookupLargeHierarchy());
+  return EXIT_SUCCESS;
+}
@@ -25,23 +25,34 @@
 #include "vtkMRMLTableNode.h"
 #include "vtkMRMLTableStorageNode.h"
 #include "vtkDoubleArray.h"
+#include "vtkFloatArray.h"
+#include "vtkIntArray.h"
 #include "vtkStringArray.h"
 #include "vtkTable.h"
+#include "vtkTimerLog.h"
 
+#include <vtksys/FStream.hxx>
 #include <vtksys/SystemTools.hxx>
 
+// STD includes
+#include <cstdlib>
+
 //---------------------------------------------------------------------------
-int TestReadWriteWithoutSchema(vtkMRMLScene* scene);
-int TestReadWriteWithSchema(vtkMRMLScene* scene);
-int TestReadWriteData(vtkMRMLScene* scene, const char *extension, vtkTable* table, bool schemaExpected);
+int TestReadWriteWithoutSchema(vtkMRMLScene* scene, bool useTypedReaderWriter);
+int TestReadWriteWithSchema(vtkMRMLScene* scene, bool useTypedReaderWriter);
+int TestReadWriteData(vtkMRMLScene* scene, const char *extension, vtkTable* table, bool schemaExpected, bool useTypedReaderWriter);
+int TestTypedReader(vtkMRMLScene* scene);
+int TestReadWritePerformance(vtkMRMLScene* scene, vtkIdType numberOfRows);
 
 int vtkMRMLTableStorageNodeTest1(int argc, char * argv[])
 {
-  if (argc != 2)
+  if (argc < 2)
     {
-    std::cerr << "Usage: " << argv[0] << " /path/to/temp" << std::endl;
+    std::cerr << "Usage: " << argv[0] << " /path/to/temp [numberOfRows]" << std::endl;
     return EXIT_FAILURE;
     }
+  // Number of rows of the table used for measuring read/write throughput
+  vtkIdType numberOfRows = (argc > 2 ? atoi(argv[2]) : 100000);
 
   vtkNew<vtkMRMLTableStorageNode> node1;
   EXERCISE_ALL_BASIC_MRML_METHODS(node1.GetPointer());
@@ -50,15 +61,20 @@ int vtkMRMLTableStorageNodeTest1(int argc, char * argv[])
   const char* tempDir = argv[1];
   scene->SetRootDirectory(tempDir);
 
-  CHECK_EXIT_SUCCESS(TestReadWriteWithoutSchema(scene.GetPointer()));
-  CHECK_EXIT_SUCCESS(TestReadWriteWithSchema(scene.GetPointer()));
+  for (int useTypedReaderWriter = 0; useTypedReaderWriter <= 1; ++useTypedReaderWriter)
+    {
+    CHECK_EXIT_SUCCESS(TestReadWriteWithoutSchema(scene.GetPointer(), useTypedReaderWriter));
+    CHECK_EXIT_SUCCESS(TestReadWriteWithSchema(scene.GetPointer(), useTypedReaderWriter));
+    }
+  CHECK_EXIT_SUCCESS(TestTypedReader(scene.GetPointer()));
+  CHECK_EXIT_SUCCESS(TestReadWritePerformance(scene.GetPointer(), numberOfRows));
 
   std::cout << "Test passed." << std::endl;
   return EXIT_SUCCESS;
 }
 
 //---------------------------------------------------------------------------
-int TestReadWriteWithoutSchema(vtkMRMLScene* scene)
+int TestReadWriteWithoutSchema(vtkMRMLScene* scene, bool useTypedReaderWriter)
 {
   // Create a scene with string columns
   vtkNew<vtkStringArray> col1;
@@ -73,15 +89,15 @@ int TestReadWriteWithoutSchema(vtkMRMLScene* scene)
   table->AddColumn(col1.GetPointer());
   table->AddColumn(col2.GetPointer());
 
-  CHECK_EXIT_SUCCESS(TestReadWriteData(scene, ".csv", table.GetPointer(), false));
-  CHECK_EXIT_SUCCESS(TestReadWriteData(scene, ".tsv", table.GetPointer(), false));
-  CHECK_EXIT_SUCCESS(TestReadWriteData(scene, ".txt", table.GetPointer(), false));
+  CHECK_EXIT_SUCCESS(TestReadWriteData(scene, ".csv", table.GetPointer(), false, useTypedReaderWriter));
+  CHECK_EXIT_SUCCESS(TestReadWriteData(scene, ".tsv", table.GetPointer(), false, useTypedReaderWriter));
+  CHECK_EXIT_SUCCESS(TestReadWriteData(scene, ".txt", table.GetPointer(), false, useTypedReaderWriter));
 
   return EXIT_SUCCESS;
 }
 
 //---------------------------------------------------------------------------
-int TestReadWriteWithSchema(vtkMRMLScene* scene)
+int TestReadWriteWithSchema(vtkMRMLScene* scene, bool useTypedReaderWriter)
 {
   // Create a scene with various column types
   // (it will require using a schema to save column types)
@@ -106,15 +122,15 @@ int TestReadWriteWithSchema(vtkMRMLScene* scene)
   table->AddColumn(col2.GetPointer());
   table->AddColumn(col3.GetPointer());
 
-  CHECK_EXIT_SUCCESS(TestReadWriteData(scene, ".csv", table.GetPointer(), true));
-  CHECK_EXIT_SUCCESS(TestReadWriteData(scene, ".tsv", table.GetPointer(), true));
-  CHECK_EXIT_SUCCESS(TestReadWriteData(scene, ".txt", table.GetPointer(), true));
+  CHECK_EXIT_SUCCESS(TestReadWriteData(scene, ".csv", table.GetPointer(), true, useTypedReaderWriter));
+  CHECK_EXIT_SUCCESS(TestReadWriteData(scene, ".tsv", table.GetPointer(), true, useTypedReaderWriter));
+  CHECK_EXIT_SUCCESS(TestReadWriteData(scene, ".txt", table.GetPointer(), true, useTypedReaderWriter));
 
   return EXIT_SUCCESS;
 }
 
 //---------------------------------------------------------------------------
-int TestReadWriteData(vtkMRMLScene* scene, const char *extension, vtkTable* table, bool schemaExpected)
+int TestReadWriteData(vtkMRMLScene* scene, const char *extension, vtkTable* table, bool schemaExpected, bool useTypedReaderWriter)
 {
   std::string fileName = std::string(scene->GetRootDirectory()) +
     std::string("/vtkMRMLTableStorageNodeTest1") +
@@ -138,9 +154,10 @@ int TestReadWriteData(vtkMRMLScene* scene, const char *extension, vtkTable* tabl
 
   // Add storage node
   tableNode->AddDefaultStorageNode();
-  vtkMRMLStorageNode* storageNode = tableNode->GetStorageNode();
+  vtkMRMLTableStorageNode* storageNode = vtkMRMLTableStorageNode::SafeDownCast(tableNode->GetStorageNode());
   CHECK_NOT_NULL(storageNode);
   storageNode->SetFileName(fileName.c_str());
+  storageNode->SetUseTypedReaderWriter(useTypedReaderWriter);
 
   // Test writing
   CHECK_BOOL(storageNode->WriteData(tableNode.GetPointer()), true);
@@ -186,3 +203,231 @@ int TestReadWriteData(vtkMRMLScene* scene, const char *extension, vtkTable* tabl
     }
   return EXIT_SUCCESS;
 }
+
+//---------------------------------------------------------------------------
+int CompareTables(vtkTable* table, vtkTable* table2)
+{
+  CHECK_NOT_NULL(table);
+  CHECK_NOT_NULL(table2);
+  CHECK_INT(table2->GetNumberOfColumns(), table->GetNumberOfColumns());
+  for (vtkIdType columnId = 0; columnId < table->GetNumberOfColumns(); ++columnId)
+    {
+    vtkAbstractArray* column = table->GetColumn(columnId);
+    vtkAbstractArray* column2 = table2->GetColumn(columnId);
+    CHECK_NOT_NULL(column2);
+    CHECK_STRING(column2->GetName(), column->GetName());
+    CHECK_INT(column2->GetDataType(), column->GetDataType());
+    CHECK_INT(column2->GetNumberOfComponents(), column->GetNumberOfComponents());
+    CHECK_INT(column2->GetNumberOfValues(), column->GetNumberOfValues());
+    for (vtkIdType valueId = 0; valueId < column->GetNumberOfValues(); ++valueId)
+      {
+      if (column->GetVariantValue(valueId) != column2->GetVariantValue(valueId))
+        {
+        std::cerr << "Column " << column->GetName() << " value " << valueId << " mismatch: "
+          << column->GetVariantValue(valueId).ToString() << " != " << column2->GetVariantValue(valueId).ToString() << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int ReadTableFile(const std::string& fileName, bool useTypedReaderWriter, vtkMRMLTableNode* tableNode)
+{
+  vtkNew<vtkMRMLTableStorageNode> storageNode;
+  storageNode->SetFileName(fileName.c_str());
+  storageNode->SetUseTypedReaderWriter(useTypedReaderWriter);
+  CHECK_BOOL(storageNode->ReadData(tableNode), true);
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int TestTypedReader(vtkMRMLScene* scene)
+{
+  std::string fileName = std::string(scene->GetRootDirectory()) + "/vtkMRMLTableStorageNodeTest1Typed.csv";
+  std::string schemaFileName = std::string(scene->GetRootDirectory()) + "/vtkMRMLTableStorageNodeTest1Typed.schema.csv";
+
+  // Values with delimiters, line breaks, missing and invalid values
+  {
+  vtksys::ofstream schemaFile(schemaFileName.c_str());
+  schemaFile << "columnName,type,componentNames,nullValue\n"
+    << "name,string,,\n"
+    << "value,double,,-1\n"
+    << "count,int,,\n"
+    << "position,float,x|y,\n"
+    << "flag,bit,,\n";
+  }
+
+  // Same values are read by vtkDelimitedTextReader and the typed reader
+  const char* contents[] = {
+    // quoted values, empty cells, invalid values
+    "name,value,count,position_x,position_y,flag\n"
+    "\"a, b\",1.5,3,0.5,-0.5,1\n"
+    "c,,-7,1e3, 2 ,0\n"
+    "d,2.5e-3,abc,,,\n",
+    // escape character, read by vtkDelimitedTextReader
+    "name,value,count,position_x,position_y,flag\n"
+    "a\\b,1,2,3,4,1\n",
+    // more fields than columns, read by vtkDelimitedTextReader
+    "name,value,count,position_x,position_y,flag\n"
+    "a,1,2,3,4,1,5\n",
+    };
+  for (const char* fileContents : contents)
+    {
+    {
+    vtksys::ofstream file(fileName.c_str(), std::ios::out | std::ios::binary);
+    file << fileContents;
+    }
+    vtkNew<vtkMRMLTableNode> tableNode;
+    vtkNew<vtkMRMLTableNode> tableNode2;
+    TESTING_OUTPUT_IGNORE_WARNINGS_ERRORS_BEGIN();
+    CHECK_EXIT_SUCCESS(ReadTableFile(fileName, false, tableNode.GetPointer()));
+    CHECK_EXIT_SUCCESS(ReadTableFile(fileName, true, tableNode2.GetPointer()));
+    TESTING_OUTPUT_IGNORE_WARNINGS_ERRORS_END();
+    CHECK_EXIT_SUCCESS(CompareTables(tableNode->GetTable(), tableNode2->GetTable()));
+    }
+
+  // Line breaks within quoted values, Windows line breaks, missing fields,
+  // non-integer numbers in integer columns are truncated
+  {
+  vtksys::ofstream file(fileName.c_str(), std::ios::out | std::ios::binary);
+  file << "name,value,count,position_x,position_y,flag\r\n"
+    << "\"multi\nline\",1,2.9,3,4,1\r\n"
+    << "b,5\r\n"
+    << "c,6,1e5,,,\r\n";
+  }
+  vtkNew<vtkMRMLTableNode> tableNode;
+  CHECK_EXIT_SUCCESS(ReadTableFile(fileName, true, tableNode.GetPointer()));
+  vtkTable* table = tableNode->GetTable();
+  CHECK_INT(table->GetNumberOfRows(), 3);
+  CHECK_INT(table->GetValueByName(0, "count").ToInt(), 2);
+  CHECK_INT(table->GetValueByName(2, "count").ToInt(), 100000);
+  CHECK_STD_STRING(table->GetValueByName(0, "name").ToString(), "multi\nline");
+  CHECK_DOUBLE(table->GetValueByName(1, "value").ToDouble(), 5.0);
+  CHECK_INT(table->GetValueByName(0, "flag").ToInt(), 1);
+  CHECK_DOUBLE(table->GetValueByName(1, "count").ToDouble(), 0.0);
+  CHECK_INT(vtkFloatArray::SafeDownCast(table->GetColumnByName("position"))->GetNumberOfComponents(), 2);
+  CHECK_DOUBLE(table->GetColumnByName("position")->GetVariantValue(1).ToDouble(), 4.0);
+
+  // Whitespace-only cells are empty, hexadecimal numbers, "inf" and "nan" are invalid
+  {
+  vtksys::ofstream file(fileName.c_str(), std::ios::out | std::ios::binary);
+  file << "name,value,count,position_x,position_y,flag\n"
+    << "a,0x10, ,1,2,  \n"
+    << "b,inf,1,1,2,1\n"
+    << "c,nan,1,1,2,1\n"
+    << "d, 7 ,1,1,2,1\n";
+  }
+  vtkNew<vtkMRMLTableNode> invalidValuesTableNode;
+  TESTING_OUTPUT_ASSERT_WARNINGS_BEGIN();
+  CHECK_EXIT_SUCCESS(ReadTableFile(fileName, true, invalidValuesTableNode.GetPointer()));
+  // only the invalid values of the value column are reported
+  TESTING_OUTPUT_ASSERT_WARNINGS(1);
+  TESTING_OUTPUT_ASSERT_WARNINGS_END();
+  table = invalidValuesTableNode->GetTable();
+  CHECK_INT(table->GetNumberOfRows(), 4);
+  for (vtkIdType row = 0; row < 3; ++row)
+    {
+    CHECK_DOUBLE(table->GetValueByName(row, "value").ToDouble(), -1.0);
+    }
+  CHECK_DOUBLE(table->GetValueByName(3, "value").ToDouble(), 7.0);
+  CHECK_INT(table->GetValueByName(0, "count").ToInt(), 0);
+  CHECK_INT(table->GetValueByName(0, "flag").ToInt(), 0);
+
+  vtksys::SystemTools::RemoveFile(fileName);
+  vtksys::SystemTools::RemoveFile(schemaFileName);
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int TestReadWritePerformance(vtkMRMLScene* scene, vtkIdType numberOfRows)
+{
+  // Table similar to radiomics features or tracking results
+  vtkNew<vtkTable> table;
+  vtkNew<vtkStringArray> labelColumn;
+  labelColumn->SetName("label");
+  labelColumn->SetNumberOfValues(numberOfRows);
+  table->AddColumn(labelColumn.GetPointer());
+  vtkNew<vtkIntArray> indexColumn;
+  indexColumn->SetName("index");
+  indexColumn->SetNumberOfValues(numberOfRows);
+  table->AddColumn(indexColumn.GetPointer());
+  vtkNew<vtkFloatArray> positionColumn;
+  positionColumn->SetName("position");
+  positionColumn->SetNumberOfComponents(3);
+  positionColumn->SetComponentName(0, "R");
+  positionColumn->SetComponentName(1, "A");
+  positionColumn->SetComponentName(2, "S");
+  positionColumn->SetNumberOfTuples(numberOfRows);
+  table->AddColumn(positionColumn.GetPointer());
+  const int numberOfFeatures = 8;
+  for (int featureIndex = 0; featureIndex < numberOfFeatures; ++featureIndex)
+    {
+    vtkNew<vtkDoubleArray> featureColumn;
+    featureColumn->SetName((std::string("feature") + vtkVariant(featureIndex).ToString()).c_str());
+    featureColumn->SetNumberOfValues(numberOfRows);
+    for (vtkIdType row = 0; row < numberOfRows; ++row)
+      {
+      featureColumn->SetValue(row, (row + 1) / (featureIndex + 3.0));
+      }
+    table->AddColumn(featureColumn.GetPointer());
+    }
+  for (vtkIdType row = 0; row < numberOfRows; ++row)
+    {
+    labelColumn->SetValue(row, std::string("segment_") + vtkVariant(row % 100).ToString());
+    indexColumn->SetValue(row, static_cast<int>(row));
+    positionColumn->SetTuple3(row, row * 0.5, -row * 0.25, row * 0.125);
+    }
+
+  const char* extensions[] = { ".csv", ".tsv" };
+  for (const char* extension : extensions)
+    {
+    std::string fileName = std::string(scene->GetRootDirectory()) + "/vtkMRMLTableStorageNodeTest1Performance" + extension;
+    std::string schemaFileName = std::string(scene->GetRootDirectory()) + "/vtkMRMLTableStorageNodeTest1Performance.schema" + extension;
+
+    vtkNew<vtkMRMLTableNode> tableNode;
+    tableNode->SetAndObserveTable(table.GetPointer());
+    vtkNew<vtkMRMLTableStorageNode> storageNode;
+    storageNode->SetFileName(fileName.c_str());
+
+    double writeTime[2] = { 0.0, 0.0 };
+    double readTime[2] = { 0.0, 0.0 };
+    vtkSmartPointer<vtkTable> readTables[2];
+    vtkNew<vtkTimerLog> timer;
+    for (int useTypedReaderWriter = 0; useTypedReaderWriter <= 1; ++useTypedReaderWriter)
+      {
+      storageNode->SetUseTypedReaderWriter(useTypedReaderWriter);
+
+      timer->StartTimer();
+      CHECK_BOOL(storageNode->WriteData(tableNode.GetPointer()), true);
+      timer->StopTimer();
+      writeTime[useTypedReaderWriter] = timer->GetElapsedTime();
+
+      vtkNew<vtkMRMLTableNode> readTableNode;
+      timer->StartTimer();
+      CHECK_BOOL(storageNode->ReadData(readTableNode.GetPointer()), true);
+      timer->StopTimer();
+      readTime[useTypedReaderWriter] = timer->GetElapsedTime();
+      readTables[useTypedReaderWriter] = readTableNode->GetTable();
+      }
+
+    // Both readers get the same values from the file written by the typed writer.
+    vtkNew<vtkMRMLTableNode> delimitedTextReaderTableNode;
+    CHECK_EXIT_SUCCESS(ReadTableFile(fileName, false, delimitedTextReaderTableNode.GetPointer()));
+    CHECK_EXIT_SUCCESS(CompareTables(delimitedTextReaderTableNode->GetTable(), readTables[1]));
+    // Typed writer writes values that are read back exactly.
+    CHECK_EXIT_SUCCESS(CompareTables(table.GetPointer(), readTables[1]));
+
+    double fileSizeMB = vtksys::SystemTools::FileLength(fileName) / 1e6;
+    std::cout << numberOfRows << " rows (" << fileSizeMB << " MB " << extension << "):" << std::endl
+      << "  write: vtkDelimitedTextWriter " << writeTime[0] << "s (" << fileSizeMB / writeTime[0] << " MB/s), typed writer "
+      << writeTime[1] << "s (" << fileSizeMB / writeTime[1] << " MB/s)" << std::endl
+      << "  read:  vtkDelimitedTextReader " << readTime[0] << "s (" << fileSizeMB / readTime[0] << " MB/s), typed reader "
+      << readTime[1] << "s (" << fileSizeMB / readTime[1] << " MB/s)" << std::endl;
+
+    vtksys::SystemTools::RemoveFile(fileName);
+    vtksys::SystemTools::RemoveFile(schemaFileName);
+    }
+  return EXIT_SUCCESS;
+}
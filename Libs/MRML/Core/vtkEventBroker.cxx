@@ -22,6 +22,15 @@
 #include <vtkObjectFactory.h>
 #include <vtkTimerLog.h>
 
+// STD includes
+#include <algorithm>
+
+namespace
+{
+// List index of observations that are not in the list
+const size_t NOT_IN_LIST = static_cast<size_t>(-1);
+}
+
 vtkCxxSetObjectMacro(vtkEventBroker, TimerLog, vtkTimerLog);
 
 //----------------------------------------------------------------------------
@@ -98,6 +107,7 @@ vtkEventBroker::vtkEventBroker()
   this->LogFileName = nullptr;
   this->ScriptHandler = nullptr;
   this->ScriptHandlerClientData = nullptr;
+  this->NumberOfObservations = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -125,7 +135,7 @@ void vtkEventBroker::DetachObservations()
 {
   // for each subject, remove observations in its list
   ObjectToObservationVectorMap::iterator mapiter;
-  ObservationVector::iterator oiter;
+  ObservationList::iterator oiter;
 
   for (mapiter = this->SubjectMap.begin(); mapiter != this->SubjectMap.end(); mapiter++)
     {
@@ -140,21 +150,20 @@ void vtkEventBroker::DetachObservations()
       }
     }
   this->SubjectMap.clear();
+  this->ObserverMap.clear();
+  this->NumberOfObservations = 0;
 }
 
 //----------------------------------------------------------------------------
 vtkObservation *vtkEventBroker::AddObservation (
   vtkObject *subject, unsigned long event, vtkObject *observer, vtkCallbackCommand *notify, float priority)
 {
-  std::vector<vtkObject *>::iterator siter;
-
   vtkObservation *observation = vtkObservation::New();
   observation->SetEventBroker( this );
-  this->SubjectMap[subject].insert( observation );
-  this->ObserverMap[observer].insert( observation );
   observation->AssignSubject( subject );
   observation->SetEvent( event );
   observation->AssignObserver( observer );
+  this->AddToObservationLists( observation, true );
   observation->SetCallbackCommand( notify );
   observation->SetPriority( priority );
 
@@ -181,8 +190,8 @@ vtkObservation *vtkEventBroker::AddObservation (
 {
   vtkObservation *observation = vtkObservation::New();
   observation->SetEventBroker( this );
-  this->SubjectMap[subject].insert( observation );
   observation->AssignSubject( subject );
+  this->AddToObservationLists( observation, false );
 
   // figure out event either as a predefined string, or
   // as an ascii number
@@ -210,6 +219,53 @@ vtkObservation *vtkEventBroker::AddObservation (
   return (observation);
 }
 
+//----------------------------------------------------------------------------
+void vtkEventBroker::AddToObservationLists ( vtkObservation *observation, bool addToObserverList )
+{
+  ObservationList& subjectObservations = this->SubjectMap[observation->GetSubject()];
+  observation->SubjectListIndex = subjectObservations.size();
+  subjectObservations.push_back( observation );
+  if ( addToObserverList )
+    {
+    ObservationList& observerObservations = this->ObserverMap[observation->GetObserver()];
+    observation->ObserverListIndex = observerObservations.size();
+    observerObservations.push_back( observation );
+    }
+  this->NumberOfObservations++;
+}
+
+//----------------------------------------------------------------------------
+bool vtkEventBroker::RemoveFromObservationList ( ObjectToObservationVectorMap& map,
+  vtkObject *object, vtkObservation *observation, size_t vtkObservation::* listIndex )
+{
+  size_t index = observation->*listIndex;
+  if ( index == NOT_IN_LIST )
+    {
+    return false;
+    }
+  observation->*listIndex = NOT_IN_LIST;
+  ObjectToObservationVectorMap::iterator mapIter = map.find( object );
+  if ( mapIter == map.end() )
+    {
+    return false;
+    }
+  ObservationList& observations = mapIter->second;
+  if ( index >= observations.size() || observations[index] != observation )
+    {
+    return false;
+    }
+  // move the last observation in place of the removed one
+  vtkObservation *lastObservation = observations.back();
+  observations[index] = lastObservation;
+  lastObservation->*listIndex = index;
+  observations.pop_back();
+  if ( observations.empty() )
+    {
+    map.erase( mapIter );
+    }
+  return true;
+}
+
 //----------------------------------------------------------------------------
 void vtkEventBroker::AttachObservation ( vtkObservation *observation )
 {
@@ -271,13 +327,19 @@ void vtkEventBroker::RemoveObservation ( vtkObservation *observation )
     {
     return;
     }
-  ObservationVector removeList;
-  removeList.insert( observation );
-  this->RemoveObservations( removeList );
+  ObservationList removeList( 1, observation );
+  this->RemoveObservationList( removeList );
 }
 
 //----------------------------------------------------------------------------
 void vtkEventBroker::RemoveObservations (ObservationVector observations)
+{
+  ObservationList removeList( observations.begin(), observations.end() );
+  this->RemoveObservationList( removeList );
+}
+
+//----------------------------------------------------------------------------
+void vtkEventBroker::RemoveObservationList (const ObservationList& observations)
 {
   // remove passed observations from:
   // - broker's observation maps
@@ -287,108 +349,174 @@ void vtkEventBroker::RemoveObservations (ObservationVector observations)
   // - detach from subject (and observer)
   // - delete the observation
 
-  ObservationVector::iterator inObsIter;
-
+  ObservationList::const_iterator inObsIter;
   for(inObsIter=observations.begin(); inObsIter != observations.end(); inObsIter++)
     {
     vtkObservation *inObs = (*inObsIter);
-    ObservationVector& subjectObservations = this->SubjectMap[(*inObsIter)->GetSubject()];
-    subjectObservations.erase(subjectObservations.find(inObs));
+    if ( RemoveFromObservationList( this->SubjectMap, inObs->GetSubject(), inObs, &vtkObservation::SubjectListIndex ) )
+      {
+      this->NumberOfObservations--;
+      }
+    RemoveFromObservationList( this->ObserverMap, inObs->GetObserver(), inObs, &vtkObservation::ObserverListIndex );
     }
 
+  // remove from event queue
+  // (removed observations are no longer in the subject lists)
+  {
+  std::lock_guard<std::mutex> lock(this->EventQueueMutex);
+  bool inEventQueue = false;
   for(inObsIter=observations.begin(); inObsIter != observations.end(); inObsIter++)
     {
-    vtkObservation *inObs = (*inObsIter);
-    ObservationVector& observerObservations = this->ObserverMap[inObs->GetObserver()];
-    observerObservations.erase(observerObservations.find(inObs));
+    inEventQueue = inEventQueue || (*inObsIter)->GetInEventQueue();
     }
-
-  // remove from event queue
-  std::deque< vtkObservation *>::iterator queueIter;
-  for(queueIter=this->EventQueue.begin(); queueIter != this->EventQueue.end();)
+  if ( inEventQueue )
     {
-    // foreach of the broker's observations see if it is in the list of items to be removed
-    if (observations.find(*queueIter)!=observations.end())
-      {
-      // these event is related to the observations to be deleted
-      queueIter=this->EventQueue.erase(queueIter);
-      }
-    else
-      {
-      ++queueIter;
-      }
+    this->EventQueue.erase( std::remove_if( this->EventQueue.begin(), this->EventQueue.end(),
+      [](vtkObservation* queuedObs) { return queuedObs->SubjectListIndex == NOT_IN_LIST; } ),
+      this->EventQueue.end() );
+    }
+  for(inObsIter=observations.begin(); inObsIter != observations.end(); inObsIter++)
+    {
+    (*inObsIter)->SetInEventQueue( 0 );
+    (*inObsIter)->GetCallDataList()->clear();
     }
+  }
 
   // detach and delete each of the observations
-  for(ObservationVector::iterator removeIter=observations.begin(); removeIter != observations.end(); removeIter++)
+  for(inObsIter=observations.begin(); inObsIter != observations.end(); inObsIter++)
     {
-    (*removeIter)->SetInEventQueue( 0 );
-    this->DetachObservation( *removeIter );
-    (*removeIter)->Delete();
+    this->DetachObservation( *inObsIter );
+    (*inObsIter)->Delete();
     }
 }
 
 //----------------------------------------------------------------------------
 void vtkEventBroker::RemoveObservations (vtkObject *observer)
 {
-  this->RemoveObservations( this->GetObservations( observer ) );
+  ObjectToObservationVectorMap::iterator mapIter = this->ObserverMap.find( observer );
+  if ( mapIter == this->ObserverMap.end() )
+    {
+    return;
+    }
+  // copy the list, as it is modified during removal
+  ObservationList removeList = mapIter->second;
+  this->RemoveObservationList( removeList );
 }
 
 //----------------------------------------------------------------------------
 void vtkEventBroker::RemoveObservations (vtkObject *subject, vtkObject *observer)
 {
-  this->RemoveObservations( this->GetObservations( subject, 0, observer ) );
+  this->RemoveObservations( subject, 0, observer, nullptr );
 }
 
 //----------------------------------------------------------------------------
 void vtkEventBroker::RemoveObservations (vtkObject *subject, unsigned long event, vtkObject *observer)
 {
-  this->RemoveObservations( this->GetObservations( subject, event, observer ) );
+  this->RemoveObservations( subject, event, observer, nullptr );
 }
 
 //----------------------------------------------------------------------------
 void vtkEventBroker::RemoveObservations (vtkObject *subject, unsigned long event, vtkObject *observer, vtkCallbackCommand *notify)
 {
-  this->RemoveObservations( this->GetObservations( subject, event, observer, notify ) );
+  ObservationList removeList;
+  this->FindObservations( subject, event, observer, notify, 0, removeList );
+  if ( !removeList.empty() )
+    {
+    this->RemoveObservationList( removeList );
+    }
 }
 
 //----------------------------------------------------------------------------
 void vtkEventBroker::RemoveObservationsForSubjectByTag (vtkObject *subject, unsigned long tag)
 {
-  this->RemoveObservations( this->GetObservationsForSubjectByTag ( subject, tag ) );
+  ObjectToObservationVectorMap::iterator mapIter = this->SubjectMap.find( subject );
+  if ( mapIter == this->SubjectMap.end() )
+    {
+    return;
+    }
+  ObservationList removeList;
+  if ( tag == 0 )
+    {
+    removeList = mapIter->second;
+    }
+  else
+    {
+    for (ObservationList::iterator obsIter = mapIter->second.begin();
+         obsIter != mapIter->second.end(); ++obsIter)
+      {
+      if ( (*obsIter)->GetEventTag() == tag )
+        {
+        removeList.push_back( *obsIter );
+        }
+      }
+    }
+  this->RemoveObservationList( removeList );
 }
 
 //----------------------------------------------------------------------------
 vtkEventBroker::ObservationVector vtkEventBroker
-::GetSubjectObservations (vtkObject *observer)
+::GetSubjectObservations (vtkObject *subject)
 {
-  // find matching observations to remove
-  ObservationVector observationList = this->ObserverMap[observer];
-
+  ObservationVector observationList;
+  ObjectToObservationVectorMap::iterator mapIter = this->SubjectMap.find( subject );
+  if ( mapIter != this->SubjectMap.end() )
+    {
+    observationList.insert( mapIter->second.begin(), mapIter->second.end() );
+    }
   return( observationList );
 }
 
+//----------------------------------------------------------------------------
+void vtkEventBroker::FindObservations (
+  vtkObject *subject, unsigned long event, vtkObject *observer, vtkCallbackCommand *notify,
+  unsigned int maxReturnedObservations, ObservationList& observations)
+{
+  ObjectToObservationVectorMap::iterator mapIter = this->SubjectMap.find( subject );
+  if ( mapIter == this->SubjectMap.end() )
+    {
+    return;
+    }
+  ObservationList& subjectList = mapIter->second;
+  for(ObservationList::iterator obsIter = subjectList.begin();
+      obsIter != subjectList.end();
+      ++obsIter)
+    {
+    if ( (observer == nullptr || (*obsIter)->GetObserver() == observer) &&
+         (event == 0 || (*obsIter)->GetEvent() == event) &&
+         (notify == nullptr || (*obsIter)->GetCallbackCommand() == notify))
+      {
+      observations.push_back( *obsIter );
+      if (maxReturnedObservations && observations.size()>=maxReturnedObservations)
+        {
+        // reached enough number of requested observations
+        break;
+        }
+      }
+    }
+}
+
 //----------------------------------------------------------------------------
 vtkEventBroker::ObservationVector vtkEventBroker::GetObservations (
   vtkObject *subject, unsigned long event,
   vtkObject *observer, vtkCallbackCommand *notify, unsigned int maxReturnedObservations/*=0*/)
 {
-  ObservationVector observationList;
   // Special case for fast return
-  if (event == 0 && observer == nullptr && notify == nullptr)
+  if (event == 0 && observer == nullptr && notify == nullptr && maxReturnedObservations == 0)
+    {
+    return this->GetSubjectObservations(subject);
+    }
+  ObservationVector observationList;
+  ObjectToObservationVectorMap::iterator mapIter = this->SubjectMap.find( subject );
+  if ( mapIter == this->SubjectMap.end() )
     {
-    observationList = this->GetSubjectObservations(subject);
     return observationList;
     }
-  // find matching observations to remove
-  ObservationVector& subjectList = this->SubjectMap[subject];
-
-  for(ObservationVector::iterator obsIter = subjectList.begin();
+  ObservationList& subjectList = mapIter->second;
+  for(ObservationList::iterator obsIter = subjectList.begin();
       obsIter != subjectList.end();
       ++obsIter)
     {
     if ( (observer == nullptr || (*obsIter)->GetObserver() == observer) &&
-         //(subject == 0 || (*obsIter)->GetSubject() == subject) &&
          (event == 0 || (*obsIter)->GetEvent() == event) &&
          (notify == nullptr || (*obsIter)->GetCallbackCommand() == notify))
       {
@@ -408,9 +536,24 @@ bool vtkEventBroker::GetObservationExist (
   vtkObject *subject, unsigned long event,
   vtkObject *observer, vtkCallbackCommand *notify)
 {
-  // request up to 1 element to see if any observation exist
-  ObservationVector observationList = GetObservations (subject, event, observer, notify, 1);
-  return (observationList.size()>0);
+  ObjectToObservationVectorMap::iterator mapIter = this->SubjectMap.find( subject );
+  if ( mapIter == this->SubjectMap.end() )
+    {
+    return false;
+    }
+  ObservationList& subjectList = mapIter->second;
+  for(ObservationList::iterator obsIter = subjectList.begin();
+      obsIter != subjectList.end();
+      ++obsIter)
+    {
+    if ( (observer == nullptr || (*obsIter)->GetObserver() == observer) &&
+         (event == 0 || (*obsIter)->GetEvent() == event) &&
+         (notify == nullptr || (*obsIter)->GetCallbackCommand() == notify))
+      {
+      return true;
+      }
+    }
+  return false;
 }
 
 //----------------------------------------------------------------------------
@@ -418,14 +561,18 @@ vtkEventBroker::ObservationVector vtkEventBroker::GetObservationsForSubjectByTag
 {
   // find matching observations to remove
   // - all tags match 0
-  ObservationVector& subjectList = this->SubjectMap[subject];
   ObservationVector observationList;
-  for (ObservationVector::iterator obsIter = subjectList.begin();
+  ObjectToObservationVectorMap::iterator mapIter = this->SubjectMap.find( subject );
+  if ( mapIter == this->SubjectMap.end() )
+    {
+    return observationList;
+    }
+  ObservationList& subjectList = mapIter->second;
+  for (ObservationList::iterator obsIter = subjectList.begin();
        obsIter != subjectList.end(); obsIter++)
     {
     vtkObservation *obs = *obsIter;
-    if ( ( obs->GetSubject() == subject ) &&
-         ( (tag == 0) || (obs->GetEventTag() == tag) ) )
+    if ( (tag == 0) || (obs->GetEventTag() == tag) )
       {
       observationList.insert( obs );
       }
@@ -433,18 +580,35 @@ vtkEventBroker::ObservationVector vtkEventBroker::GetObservationsForSubjectByTag
   return ( observationList );
 }
 
+//----------------------------------------------------------------------------
+void vtkEventBroker::SetObserverSynchronous ( vtkObject *observer, bool synchronous )
+{
+  ObjectToObservationVectorMap::iterator mapIter = this->ObserverMap.find( observer );
+  if ( mapIter == this->ObserverMap.end() )
+    {
+    return;
+    }
+  for (ObservationList::iterator obsIter = mapIter->second.begin();
+       obsIter != mapIter->second.end(); ++obsIter)
+    {
+    (*obsIter)->SetSynchronous( synchronous ? 1 : 0 );
+    }
+}
+
 //----------------------------------------------------------------------------
 vtkCollection *vtkEventBroker::GetObservationsForSubject ( vtkObject *subject )
 {
   vtkCollection *collection = vtkCollection::New();
-  ObservationVector& subjectList = this->SubjectMap[subject];
-  for(ObservationVector::iterator iter=subjectList.begin();
+  ObjectToObservationVectorMap::iterator mapIter = this->SubjectMap.find( subject );
+  if ( mapIter == this->SubjectMap.end() )
+    {
+    return collection;
+    }
+  ObservationList& subjectList = mapIter->second;
+  for(ObservationList::iterator iter=subjectList.begin();
       iter != subjectList.end(); iter++)
     {
-    if ( (*iter)->GetSubject() == subject )
-      {
-      collection->AddItem( *iter );
-      }
+    collection->AddItem( *iter );
     }
   return collection;
 }
@@ -453,14 +617,16 @@ vtkCollection *vtkEventBroker::GetObservationsForSubject ( vtkObject *subject )
 vtkCollection *vtkEventBroker::GetObservationsForObserver ( vtkObject *observer )
 {
   vtkCollection *collection = vtkCollection::New();
-  ObservationVector& observerList = this->ObserverMap[observer];
-  for (ObservationVector::iterator iter = observerList.begin();
+  ObjectToObservationVectorMap::iterator mapIter = this->ObserverMap.find( observer );
+  if ( mapIter == this->ObserverMap.end() )
+    {
+    return collection;
+    }
+  ObservationList& observerList = mapIter->second;
+  for (ObservationList::iterator iter = observerList.begin();
        iter != observerList.end(); iter++)
     {
-    if ( (*iter)->GetObserver() == observer )
-      {
-      collection->AddItem( *iter );
-      }
+    collection->AddItem( *iter );
     }
   return collection;
 }
@@ -472,7 +638,7 @@ vtkCollection *vtkEventBroker::GetObservationsForCallback ( vtkCallbackCommand *
   ObjectToObservationVectorMap::iterator it;
   for (it = this->ObserverMap.begin(); it != this->ObserverMap.end(); ++it)
     {
-    ObservationVector::iterator iter;
+    ObservationList::iterator iter;
     for(iter=it->second.begin(); iter != it->second.end(); iter++)
       {
       if ( *iter && (*iter)->GetCallbackCommand() == callback )
@@ -487,19 +653,13 @@ vtkCollection *vtkEventBroker::GetObservationsForCallback ( vtkCallbackCommand *
 //----------------------------------------------------------------------------
 int vtkEventBroker::GetNumberOfObservations ( )
 {
-  size_t count = 0;
-  ObjectToObservationVectorMap::iterator iter;
-  for(iter=this->SubjectMap.begin(); iter != this->SubjectMap.end(); iter++)
-    {
-    count += iter->second.size();
-    }
-  return static_cast<int>(count);
+  return this->NumberOfObservations;
 }
 
 //----------------------------------------------------------------------------
 vtkObservation *vtkEventBroker::GetNthObservation ( int n )
 {
-  if ( n < 0 )
+  if ( n < 0 || n >= this->NumberOfObservations )
     {
     return nullptr;
     }
@@ -510,9 +670,7 @@ vtkObservation *vtkEventBroker::GetNthObservation ( int n )
     {
     if ( static_cast<size_t>(n) < count + iter->second.size())
       {
-      ObservationVector::iterator it=iter->second.begin();
-      std::advance(it, n-count);
-      return (*it);
+      return iter->second[n-count];
       }
     else
       {
@@ -537,34 +695,37 @@ int vtkEventBroker::GenerateGraphFile ( const char *graphFile )
 
   file << "strict digraph G {\n";
 
-  vtkObservation *observation;
-  int size = this->GetNumberOfObservations();
-  for (int count = 0; count < size; count++)
+  ObjectToObservationVectorMap::iterator mapIter;
+  ObservationList::iterator obsIter;
+  for (mapIter = this->SubjectMap.begin(); mapIter != this->SubjectMap.end(); ++mapIter)
     {
-    observation = this->GetNthObservation( count );
-    file << "# " << observation->GetReferenceCount() << "\n";
-    if ( observation->GetScript() != nullptr )
-      {
-      file << " " \
-          << "\"" << observation->GetScript() << "\""
-          << " -> "
-          << observation->GetSubject()->GetClassName()
-          << " [ label = \""
-          << vtkCommand::GetStringFromEventId( observation->GetEvent() )
-          << "\" ];\n" ;
-      }
-    else
+    for (obsIter = mapIter->second.begin(); obsIter != mapIter->second.end(); ++obsIter)
       {
-      file << " " \
-          << observation->GetObserver()->GetClassName()
-          << " -> "
-          << observation->GetSubject()->GetClassName()
-          << " [ label = \""
-          << vtkCommand::GetStringFromEventId( observation->GetEvent() )
-          << "\" ];\n" ;
+      vtkObservation *observation = *obsIter;
+      file << "# " << observation->GetReferenceCount() << "\n";
+      if ( observation->GetScript() != nullptr )
+        {
+        file << " " \
+            << "\"" << observation->GetScript() << "\""
+            << " -> "
+            << observation->GetSubject()->GetClassName()
+            << " [ label = \""
+            << vtkCommand::GetStringFromEventId( observation->GetEvent() )
+            << "\" ];\n" ;
+        }
+      else
+        {
+        file << " " \
+            << observation->GetObserver()->GetClassName()
+            << " -> "
+            << observation->GetSubject()->GetClassName()
+            << " [ label = \""
+            << vtkCommand::GetStringFromEventId( observation->GetEvent() )
+            << "\" ];\n" ;
+        }
       }
-    file.flush();
     }
+  file.flush();
 
   file << "}\n";
   file.close();
@@ -681,7 +842,9 @@ void vtkEventBroker::ProcessEvent ( vtkObservation *observation, vtkObject *call
   //
   if ( eid == observation->GetEvent() || observation->GetEvent() == vtkCommand::AnyEvent )
     {
-    if ( this->EventMode == vtkEventBroker::Synchronous || eid == vtkCommand::DeleteEvent )
+    // events of the broker itself are not queued, as they notify about the queue
+    if ( this->EventMode == vtkEventBroker::Synchronous || eid == vtkCommand::DeleteEvent
+         || observation->GetSynchronous() || caller == this )
       {
       this->InvokeObservation( observation, eid, callData );
       }
@@ -689,6 +852,19 @@ void vtkEventBroker::ProcessEvent ( vtkObservation *observation, vtkObject *call
       {
       this->QueueObservation( observation, eid, callData );
       }
+    else if ( this->EventMode == vtkEventBroker::Coalescing )
+      {
+      // only modifications are deferred, other events may carry call data
+      // that is not valid anymore when the queue is processed
+      if ( eid == vtkCommand::ModifiedEvent )
+        {
+        this->QueueObservation( observation, eid, callData );
+        }
+      else
+        {
+        this->InvokeObservation( observation, eid, callData );
+        }
+      }
     else
       {
       vtkErrorMacro ( "Bad EventMode " << this->EventMode );
@@ -706,15 +882,24 @@ void vtkEventBroker::ProcessEvent ( vtkObservation *observation, vtkObject *call
   if ( eid == vtkCommand::DeleteEvent )
     {
     // iterate list of observations for the deleted object (caller) as subject
-    ObservationVector::iterator obsIter;
-    ObservationVector& subjectList = this->SubjectMap[caller];
-    for(obsIter=subjectList.begin(); obsIter != subjectList.end(); ++obsIter)
+    // (count them first, as invoked callbacks may modify the list)
+    int numberOfDeleteEventObservations = 0;
+    ObjectToObservationVectorMap::iterator mapIter = this->SubjectMap.find( caller );
+    if ( mapIter != this->SubjectMap.end() )
       {
-      if ( (*obsIter)->GetEvent() == vtkCommand::DeleteEvent )
+      ObservationList::iterator obsIter;
+      for(obsIter=mapIter->second.begin(); obsIter != mapIter->second.end(); ++obsIter)
         {
-        this->InvokeObservation( observation, eid, callData );
+        if ( (*obsIter)->GetEvent() == vtkCommand::DeleteEvent )
+          {
+          numberOfDeleteEventObservations++;
+          }
         }
       }
+    for (int i = 0; i < numberOfDeleteEventObservations; ++i)
+      {
+      this->InvokeObservation( observation, eid, callData );
+      }
     if ( caller == observation->GetSubject() )
       {
       // Remove all observations for this subject (0 matches all tags)
@@ -750,6 +935,12 @@ void vtkEventBroker::QueueObservation ( vtkObservation *observation,
   // can be invoked.
   // If the event is not currently in the queue, add it and keep a flag.
   //
+  // Events may be invoked from other threads than the one processing the
+  // queue, the queue and the call data of the queued observations are
+  // only accessed with EventQueueMutex locked.
+  bool requestProcessing = false;
+  {
+  std::lock_guard<std::mutex> lock(this->EventQueueMutex);
   vtkObservation::CallType call(eid, callData);
   if ( this->GetCompressCallData() &&
        observation->GetEvent() != vtkCommand::AnyEvent)
@@ -774,23 +965,35 @@ void vtkEventBroker::QueueObservation ( vtkObservation *observation,
       }
     }
 
+  // An observation already in the queue keeps its position: it is invoked
+  // where it was first queued (see EventMode).
   if ( !observation->GetInEventQueue() )
     {
+    requestProcessing = this->EventQueue.empty();
     this->EventQueue.push_back( observation );
     observation->SetInEventQueue(1);
     }
+  }
+
+  if ( requestProcessing )
+    {
+    // let the application know that the queue needs to be processed
+    this->InvokeEvent( vtkEventBroker::RequestProcessEventQueueEvent );
+    }
 }
 
 //----------------------------------------------------------------------------
 int vtkEventBroker::GetNumberOfQueuedObservations ()
 {
+  std::lock_guard<std::mutex> lock(this->EventQueueMutex);
   return static_cast<int>( this->EventQueue.size() );
 }
 
 //----------------------------------------------------------------------------
 vtkObservation *vtkEventBroker::GetNthQueuedObservation ( int n )
 {
-  if ( n < 0 || n >= this->GetNumberOfQueuedObservations() )
+  std::lock_guard<std::mutex> lock(this->EventQueueMutex);
+  if ( n < 0 || n >= static_cast<int>( this->EventQueue.size() ) )
     {
     return nullptr;
     }
@@ -800,6 +1003,11 @@ vtkObservation *vtkEventBroker::GetNthQueuedObservation ( int n )
 //----------------------------------------------------------------------------
 vtkObservation *vtkEventBroker::DequeueObservation ()
 {
+  std::lock_guard<std::mutex> lock(this->EventQueueMutex);
+  if ( this->EventQueue.empty() )
+    {
+    return nullptr;
+    }
   vtkObservation *observation = this->EventQueue.front();
   this->EventQueue.pop_front();
   observation->SetInEventQueue(0);
@@ -854,30 +1062,40 @@ void vtkEventBroker::ProcessEventQueue ()
   //
   // for each observation on the event queue,
   // invoke it with each of the stored callData pointers
+  // - the observation is dequeued with its call data before being invoked,
+  //   so that the queue can be modified (or processed) by the callbacks:
+  //   if the event is invoked again during the callback, the observation is
+  //   queued again.
   // - register your pointer to the observation in case it
   //   gets deleted during handling of the event
-  // - if the observation is no longer in the queue, stop processing events
-  // - unregister before after dequeing in case the observation should go away
+  // - if the observation is removed from the broker, stop invoking it
   //
-  while ( this->GetNumberOfQueuedObservations() > 0 )
+  while ( true )
+    {
+    vtkObservation *observation = nullptr;
+    std::deque< vtkObservation::CallType > calls;
     {
-    vtkObservation *observation = this->EventQueue.front();
+    std::lock_guard<std::mutex> lock(this->EventQueueMutex);
+    if ( this->EventQueue.empty() )
+      {
+      break;
+      }
+    observation = this->EventQueue.front();
+    this->EventQueue.pop_front();
+    observation->SetInEventQueue(0);
+    calls.swap( *observation->GetCallDataList() );
     observation->Register( this );
-    int finished = 0;
-    while ( !finished )
+    }
+    for (std::deque< vtkObservation::CallType >::iterator callIter = calls.begin();
+         callIter != calls.end(); ++callIter)
       {
-      vtkObservation::CallType call = observation->GetCallDataList()->front();
-      observation->GetCallDataList()->pop_front();
-      finished = (observation->GetCallDataList()->size() == 0);
-      this->InvokeObservation( observation, call.EventID, call.CallData );
-      if ( !observation->GetInEventQueue() )
+      if ( observation->SubjectListIndex == NOT_IN_LIST )
         {
-        observation->GetCallDataList()->clear();
-        finished = 1;
+        // removed by a previous callback
         break;
         }
+      this->InvokeObservation( observation, callIter->EventID, callIter->CallData );
       }
-    this->DequeueObservation();
     observation->Delete();
     }
 }
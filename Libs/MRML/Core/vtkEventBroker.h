@@ -19,6 +19,7 @@
 #include "vtkMRML.h"
 
 // VTK includes
+#include <vtkCommand.h>
 #include <vtkObject.h>
 class vtkTimerLog;
 
@@ -27,6 +28,8 @@ class vtkTimerLog;
 #include <vector>
 #include <set>
 #include <map>
+#include <mutex>
+#include <unordered_map>
 #include <fstream>
 
 class vtkCollection;
@@ -54,6 +57,14 @@ public:
 
   typedef std::set< vtkObservation * > ObservationVector;
 
+  enum
+    {
+    /// Invoked when an observation is added to the empty event queue.
+    /// The application is expected to call ProcessEventQueue() from its
+    /// event loop (e.g. once per rendered frame).
+    RequestProcessEventQueueEvent = vtkCommand::UserEvent + 1
+    };
+
   ///
   /// Return the singleton instance with no reference counting.
   static vtkEventBroker* GetInstance();
@@ -112,12 +123,20 @@ public:
                                                   vtkCallbackCommand *notify = nullptr,
                                                   unsigned int maxReturnedObservations = 0);
   /// Returns true if such an observation exists (arguments are same as for GetObservations)
+  /// This does not allocate memory, prefer it to GetObservations when only
+  /// the existence of the observation is needed.
   bool GetObservationExist (vtkObject *subject,
                                                   unsigned long event = 0,
                                                   vtkObject *observer = nullptr,
                                                   vtkCallbackCommand *notify = nullptr);
   ObservationVector GetObservationsForSubjectByTag (vtkObject *subject, unsigned long tag);
 
+  /// Set the Synchronous flag of all the current observations of the observer.
+  /// Synchronous observations are invoked immediately in all event modes.
+  /// Observations added later are not affected.
+  /// \sa vtkObservation::SetSynchronous()
+  void SetObserverSynchronous (vtkObject *observer, bool synchronous);
+
   /// Description
   /// Accessors for intropsection
   /// Note: vtkCollection object is allocated internally
@@ -179,9 +198,24 @@ public:
   /// In synchronous mode, observations are invoked immediately when the
   /// event takes place.  In asynchronous mode, observations are added
   /// to the event queue for later invocation.
+  /// In coalescing mode, only ModifiedEvent invocations are added to the
+  /// event queue, other events are invoked immediately. As an observation
+  /// is queued only once, repeated modifications of the same subject
+  /// result in a single invocation when the queue is processed.
+  /// The coalesced invocation keeps the position of the first one in the
+  /// queue: if subject A is modified, then subject B, then subject A again,
+  /// observers of A are invoked before observers of B. Events that are not
+  /// queued (e.g. other events of the same subject) are invoked before the
+  /// queued modifications.
+  /// Events can be queued from any thread, the queue is processed by the
+  /// thread that calls ProcessEventQueue().
+  /// Observations with the Synchronous flag and DeleteEvent invocations
+  /// are never queued.
+  /// \sa RequestProcessEventQueueEvent, SetObserverSynchronous()
   enum EventMode {
     Synchronous,
-    Asynchronous
+    Asynchronous,
+    Coalescing
   };
   vtkGetMacro(EventMode, int);
   void SetEventMode(int eventMode)
@@ -196,9 +230,11 @@ public:
 
   void SetEventModeToSynchronous() {this->SetEventMode(vtkEventBroker::Synchronous);};
   void SetEventModeToAsynchronous() {this->SetEventMode(vtkEventBroker::Asynchronous);};
+  void SetEventModeToCoalescing() {this->SetEventMode(vtkEventBroker::Coalescing);};
   const char * GetEventModeAsString() {
     if (this->EventMode == vtkEventBroker::Synchronous) return ("Synchronous");
     if (this->EventMode == vtkEventBroker::Asynchronous) return ("Asynchronous");
+    if (this->EventMode == vtkEventBroker::Coalescing) return ("Coalescing");
     return "Undefined";
   }
 
@@ -265,15 +301,37 @@ protected:
   typedef vtkEventBroker Self;
 
 
-  ///
-  typedef std::map< vtkObject*, ObservationVector > ObjectToObservationVectorMap;
+  /// Observations are stored in contiguous lists. Each observation knows its
+  /// position in the subject and observer lists so that it can be removed in
+  /// constant time (the last observation of the list takes its place).
+  typedef std::vector< vtkObservation* > ObservationList;
+  typedef std::unordered_map< vtkObject*, ObservationList > ObjectToObservationVectorMap;
+
+  /// Add the observation to the subject list (and observer list if requested).
+  void AddToObservationLists(vtkObservation* observation, bool addToObserverList);
+  /// Remove observations from the subject and observer lists and from the
+  /// event queue, then detach and delete them.
+  void RemoveObservationList(const ObservationList& observations);
+  /// Remove the observation from the list of object. Returns false if the
+  /// observation was not in the list.
+  static bool RemoveFromObservationList(ObjectToObservationVectorMap& map,
+    vtkObject* object, vtkObservation* observation, size_t vtkObservation::* listIndex);
+  /// Append observations of the subject that match the event, observer and
+  /// callback (0 matches all) to the list.
+  void FindObservations(vtkObject* subject, unsigned long event, vtkObject* observer,
+    vtkCallbackCommand* notify, unsigned int maxReturnedObservations, ObservationList& observations);
 
   /// maps to manage quick lookup by object
   ObjectToObservationVectorMap SubjectMap;
   ObjectToObservationVectorMap ObserverMap;
 
+  /// Total number of observations in SubjectMap
+  int NumberOfObservations;
+
   /// The event queue of triggered but not-yet-invoked observations
   std::deque< vtkObservation * > EventQueue;
+  /// Lock of EventQueue and of the call data of the queued observations
+  std::mutex EventQueueMutex;
 
   void (*ScriptHandler) (const char* script, void* clientData);
   void *ScriptHandlerClientData;
@@ -22,6 +22,7 @@
 #include <vtkBYUReader.h>
 #include <vtkCellArray.h>
 #include <vtkDataSetSurfaceFilter.h>
+#include <vtkErrorSink.h>
 #include <vtkFieldData.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
@@ -93,6 +94,8 @@ vtkMRMLModelStorageNode::vtkMRMLModelStorageNode()
 {
   this->DefaultWriteFileExtension = "vtk";
   this->CoordinateSystem = vtkMRMLStorageNode::CoordinateSystemLPS;
+  this->PrefetchedReadResult = 0;
+  this->PrefetchedCoordinateSystemInFileHeader = -1;
 }
 
 //----------------------------------------------------------------------------
@@ -150,46 +153,61 @@ bool vtkMRMLModelStorageNode::CanReadInReferenceNode(vtkMRMLNode *refNode)
 }
 
 //----------------------------------------------------------------------------
-int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
+int vtkMRMLModelStorageNode::PrefetchData(vtkMRMLNode *refNode)
 {
-  if (this->GetWriteState() == SkippedNoData)
-    {
-    vtkDebugMacro("ReadDataInternal (" << (this->ID ? this->ID : "(unknown)") << "): empty model file was not saved, ignore loading");
-    return 1;
-    }
-
-  vtkMRMLModelNode *modelNode = dynamic_cast <vtkMRMLModelNode *> (refNode);
-  if (!modelNode)
+  this->ClearPrefetchedData();
+  vtkMRMLModelNode *modelNode = vtkMRMLModelNode::SafeDownCast(refNode);
+  if (!modelNode || this->GetWriteState() == SkippedNoData)
     {
-    vtkErrorMacro("ReadDataInternal (" << (this->ID ? this->ID : "(unknown)") << "): refNode is not a valid mode node");
     return 0;
     }
-
   std::string fullName = this->GetFullNameFromFileName();
-  if (fullName.empty())
+  if (fullName.empty() || !vtksys::SystemTools::FileExists(fullName.c_str()))
     {
-    vtkErrorMacro("ReadDataInternal (" << (this->ID ? this->ID : "(unknown)") << "): File name not specified");
+    // errors are reported by ReadData()
     return 0;
     }
+  // Errors are not displayed from the worker thread but kept for ReadData(),
+  // which reports them instead of reading the file again.
+  vtkSmartPointer<vtkErrorSink> errorSink = vtkSmartPointer<vtkErrorSink>::New();
+  errorSink->SetObservedObject(this);
+  vtkSmartPointer<vtkPointSet> mesh;
+  int coordinateSystemInFileHeader = -1;
+  int readResult = this->ReadMeshFromFile(fullName, modelNode->GetMeshType(), mesh, coordinateSystemInFileHeader);
+  errorSink->SetObservedObject(nullptr);
+  this->PrefetchedReadResult = readResult;
+  this->PrefetchedMesh = mesh;
+  this->PrefetchedCoordinateSystemInFileHeader = coordinateSystemInFileHeader;
+  this->PrefetchedErrors = errorSink;
+  this->PrefetchedFileName = fullName;
+  return 1;
+}
 
-  // check that the file exists
-  if (vtksys::SystemTools::FileExists(fullName.c_str()) == false)
-    {
-    vtkErrorMacro("ReadDataInternal (" << (this->ID ? this->ID : "(unknown)") << "): model file '" << fullName.c_str() << "' not found.");
-    return 0;
-    }
+//----------------------------------------------------------------------------
+void vtkMRMLModelStorageNode::ClearPrefetchedData()
+{
+  this->PrefetchedReadResult = 0;
+  this->PrefetchedMesh = nullptr;
+  this->PrefetchedCoordinateSystemInFileHeader = -1;
+  this->PrefetchedErrors = nullptr;
+  this->PrefetchedFileName.clear();
+}
 
+//----------------------------------------------------------------------------
+int vtkMRMLModelStorageNode::ReadMeshFromFile(const std::string& fullName, int meshType,
+  vtkSmartPointer<vtkPointSet>& mesh, int& coordinateSystemInFileHeader)
+{
   // compute file prefix
   std::string extension = vtkMRMLStorageNode::GetLowercaseExtensionFromFileName(fullName);
   if( extension.empty() )
     {
-    vtkErrorMacro("ReadData: no file extension specified: " << fullName.c_str());
+    vtkErrorMacro("ReadMeshFromFile: no file extension specified: " << fullName.c_str());
     return 0;
     }
 
-  vtkDebugMacro("ReadDataInternal (" << (this->ID ? this->ID : "(unknown)") << "): extension = " << extension.c_str());
+  vtkDebugMacro("ReadMeshFromFile (" << (this->ID ? this->ID : "(unknown)") << "): extension = " << extension.c_str());
 
-  int coordinateSystemInFileHeader = -1;
+  coordinateSystemInFileHeader = -1;
   vtkSmartPointer<vtkPointSet> meshFromFile;
   try
     {
@@ -233,7 +251,7 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
         }
       else
         {
-        vtkErrorMacro("ReadDataInternal (" << (this->ID ? this->ID : "(unknown)") << "): file " << fullName.c_str()
+        vtkErrorMacro("ReadMeshFromFile (" << (this->ID ? this->ID : "(unknown)") << "): file " << fullName.c_str()
                       << " is not recognized as polydata nor as an unstructured grid.");
         }
       coordinateSystemInFileHeader = vtkMRMLModelStorageNode::GetCoordinateSystemFromFileHeader(reader->GetHeader());
@@ -348,48 +366,106 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
       }
     else
       {
-      vtkDebugMacro("ReadDataInternal (" << (this->ID ? this->ID : "(unknown)")
+      vtkDebugMacro("ReadMeshFromFile (" << (this->ID ? this->ID : "(unknown)")
         << "): Cannot read model file '" << fullName.c_str() << "' (extension = " << extension.c_str() << ")");
       return 0;
       }
     }
   catch (...)
     {
-    vtkErrorMacro("ReadDataInternal (" << (this->ID ? this->ID : "(unknown)") << "): unknown exception while trying to read file: " << fullName.c_str());
+    vtkErrorMacro("ReadMeshFromFile (" << (this->ID ? this->ID : "(unknown)") << "): unknown exception while trying to read file: " << fullName.c_str());
     return 0;
     }
 
-  if (coordinateSystemInFileHeader >= 0)
+  // coordinate system specified in the file is used regardless of the preferred
+  // coordinate system in the node
+  int coordinateSystem = (coordinateSystemInFileHeader >= 0 ? coordinateSystemInFileHeader : this->CoordinateSystem);
+  if (coordinateSystem == vtkMRMLStorageNode::CoordinateSystemRAS)
     {
-    // coordinate system specified in the file, use it (regardless oassumingf what was the preferred coordinate system in the node)
-    this->CoordinateSystem = coordinateSystemInFileHeader;
+    // no flip of first two axes
+    mesh = meshFromFile;
     }
   else
     {
-    // no coordinate system in the file, use the currently set coordinate system
-    vtkInfoMacro("ReadDataInternal (" << (this->ID ? this->ID : "(unknown)") << "): File "
-      << fullName.c_str() << " does not contain coordinate system information. Assuming "
-      << vtkMRMLStorageNode::GetCoordinateSystemTypeAsString(this->CoordinateSystem) << ".");
+    // transform from RAS to LPS
+    if (meshType == vtkMRMLModelNode::PolyDataMeshType)
+      {
+      mesh = vtkSmartPointer<vtkPolyData>::New();
+      }
+    else
+      {
+      mesh = vtkSmartPointer<vtkUnstructuredGrid>::New();
+      }
+    vtkMRMLModelStorageNode::ConvertBetweenRASAndLPS(meshFromFile, mesh);
     }
+  return 1;
+}
 
-  vtkSmartPointer<vtkPointSet> meshToSetInNode;
-  if (this->CoordinateSystem == vtkMRMLStorageNode::CoordinateSystemRAS)
+//----------------------------------------------------------------------------
+int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
+{
+  if (this->GetWriteState() == SkippedNoData)
     {
-    // no flip of first two axes
-    meshToSetInNode = meshFromFile;
+    vtkDebugMacro("ReadDataInternal (" << (this->ID ? this->ID : "(unknown)") << "): empty model file was not saved, ignore loading");
+    return 1;
     }
-  else
+
+  vtkMRMLModelNode *modelNode = dynamic_cast <vtkMRMLModelNode *> (refNode);
+  if (!modelNode)
     {
-    // transform from RAS to LPS
-    if (modelNode->GetMeshType() == vtkMRMLModelNode::PolyDataMeshType)
+    vtkErrorMacro("ReadDataInternal (" << (this->ID ? this->ID : "(unknown)") << "): refNode is not a valid mode node");
+    return 0;
+    }
+
+  std::string fullName = this->GetFullNameFromFileName();
+  if (fullName.empty())
+    {
+    vtkErrorMacro("ReadDataInternal (" << (this->ID ? this->ID : "(unknown)") << "): File name not specified");
+    return 0;
+    }
+
+  // check that the file exists
+  if (vtksys::SystemTools::FileExists(fullName.c_str()) == false)
+    {
+    vtkErrorMacro("ReadDataInternal (" << (this->ID ? this->ID : "(unknown)") << "): model file '" << fullName.c_str() << "' not found.");
+    return 0;
+    }
+
+  int coordinateSystemInFileHeader = -1;
+  vtkSmartPointer<vtkPointSet> meshToSetInNode;
+  if (!this->PrefetchedFileName.empty() && this->PrefetchedFileName == fullName)
+    {
+    // the file has already been read, only report the errors of that read
+    this->PrefetchedErrors->DisplayMessages();
+    int readResult = this->PrefetchedReadResult;
+    meshToSetInNode = this->PrefetchedMesh;
+    coordinateSystemInFileHeader = this->PrefetchedCoordinateSystemInFileHeader;
+    this->ClearPrefetchedData();
+    if (!readResult)
       {
-      meshToSetInNode = vtkSmartPointer<vtkPolyData>::New();
+      return 0;
       }
-    else
+    }
+  else
+    {
+    this->ClearPrefetchedData();
+    if (!this->ReadMeshFromFile(fullName, modelNode->GetMeshType(), meshToSetInNode, coordinateSystemInFileHeader))
       {
-      meshToSetInNode = vtkSmartPointer<vtkUnstructuredGrid>::New();
+      return 0;
       }
-    vtkMRMLModelStorageNode::ConvertBetweenRASAndLPS(meshFromFile, meshToSetInNode);
+    }
+
+  if (coordinateSystemInFileHeader >= 0)
+    {
+    // coordinate system specified in the file, use it (regardless of what was the preferred coordinate system in the node)
+    this->CoordinateSystem = coordinateSystemInFileHeader;
+    }
+  else
+    {
+    // no coordinate system in the file, use the currently set coordinate system
+    vtkInfoMacro("ReadDataInternal (" << (this->ID ? this->ID : "(unknown)") << "): File "
+      << fullName.c_str() << " does not contain coordinate system information. Assuming "
+      << vtkMRMLStorageNode::GetCoordinateSystemTypeAsString(this->CoordinateSystem) << ".");
     }
 
   modelNode->SetAndObserveMesh(meshToSetInNode);
@@ -17,6 +17,10 @@
 
 #include "vtkMRMLStorageNode.h"
 
+// VTK includes
+#include <vtkSmartPointer.h>
+
+class vtkErrorSink;
 class vtkMRMLModelNode;
 class vtkPointSet;
 
@@ -45,6 +49,15 @@ public:
   /// Return true if the reference node can be read in
   bool CanReadInReferenceNode(vtkMRMLNode *refNode) override;
 
+  /// Read the mesh of the model node from file, the next ReadData() call sets it in the node.
+  /// \sa vtkMRMLStorageNode::PrefetchData()
+  int PrefetchData(vtkMRMLNode *refNode) override;
+  void ClearPrefetchedData() override;
+
+  /// Files are written from the data of the node only, several nodes can be written in parallel.
+  /// \sa vtkMRMLStorageNode::CanWriteDataConcurrently()
+  bool CanWriteDataConcurrently() override { return true; }
+
   /// Get/Set flag that controls if points are to be written in various coordinate systems
   vtkSetClampMacro(CoordinateSystem, int, 0, vtkMRMLStorageNode::CoordinateSystemType_Last-1);
   vtkGetMacro(CoordinateSystem, int);
@@ -69,6 +82,13 @@ protected:
   /// Read data and set it in the referenced node
   int ReadDataInternal(vtkMRMLNode *refNode) override;
 
+  /// Read the mesh from file and convert it to RAS coordinate system.
+  /// The coordinate system found in the file header is returned in
+  /// coordinateSystemInFileHeader (-1 if not specified).
+  /// It does not modify the storage node, therefore it can be called from a worker thread.
+  int ReadMeshFromFile(const std::string& fullName, int meshType,
+    vtkSmartPointer<vtkPointSet>& mesh, int& coordinateSystemInFileHeader);
+
   /// Write data from a  referenced node
   int WriteDataInternal(vtkMRMLNode *refNode) override;
 
@@ -79,6 +99,14 @@ protected:
   static int GetCoordinateSystemFromFieldData(vtkPointSet* mesh);
 
   int CoordinateSystem;
+
+  /// Result of the read of PrefetchedFileName by PrefetchData(): return
+  /// value, mesh in RAS coordinate system and errors to report in ReadData()
+  int PrefetchedReadResult;
+  vtkSmartPointer<vtkPointSet> PrefetchedMesh;
+  int PrefetchedCoordinateSystemInFileHeader;
+  vtkSmartPointer<vtkErrorSink> PrefetchedErrors;
+  std::string PrefetchedFileName;
 };
 
 #endif
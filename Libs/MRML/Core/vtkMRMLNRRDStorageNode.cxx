@@ -42,6 +42,8 @@ vtkMRMLNodeNewMacro(vtkMRMLNRRDStorageNode);
 vtkMRMLNRRDStorageNode::vtkMRMLNRRDStorageNode()
 {
   this->CenterImage = 0;
+  this->UseParallelCompression = false;
+  this->UseMemoryMapping = false;
   this->DefaultWriteFileExtension = "nhdr";
 
   this->CompressionPresets.emplace_back(this->GetCompressionParameterFastest(), "Fastest");
@@ -63,6 +65,8 @@ void vtkMRMLNRRDStorageNode::WriteXML(ostream& of, int nIndent)
   std::stringstream ss;
   ss << this->CenterImage;
   of << " centerImage=\"" << ss.str() << "\"";
+  of << " useParallelCompression=\"" << (this->UseParallelCompression ? "true" : "false") << "\"";
+  of << " useMemoryMapping=\"" << (this->UseMemoryMapping ? "true" : "false") << "\"";
 }
 
 //----------------------------------------------------------------------------
@@ -84,6 +88,14 @@ void vtkMRMLNRRDStorageNode::ReadXMLAttributes(const char** atts)
       ss << attValue;
       ss >> this->CenterImage;
       }
+    else if (!strcmp(attName, "useParallelCompression"))
+      {
+      this->UseParallelCompression = !strcmp(attValue, "true");
+      }
+    else if (!strcmp(attName, "useMemoryMapping"))
+      {
+      this->UseMemoryMapping = !strcmp(attValue, "true");
+      }
     }
 
   this->EndModify(disabledModify);
@@ -101,6 +113,8 @@ void vtkMRMLNRRDStorageNode::Copy(vtkMRMLNode *anode)
   vtkMRMLNRRDStorageNode *node = (vtkMRMLNRRDStorageNode *) anode;
 
   this->SetCenterImage(node->CenterImage);
+  this->SetUseParallelCompression(node->UseParallelCompression);
+  this->SetUseMemoryMapping(node->UseMemoryMapping);
 
   this->EndModify(disabledModify);
 
@@ -111,6 +125,8 @@ void vtkMRMLNRRDStorageNode::PrintSelf(ostream& os, vtkIndent indent)
 {
   vtkMRMLStorageNode::PrintSelf(os,indent);
   os << indent << "CenterImage:   " << this->CenterImage << "\n";
+  os << indent << "UseParallelCompression:   " << this->UseParallelCompression << "\n";
+  os << indent << "UseMemoryMapping:   " << this->UseMemoryMapping << "\n";
 }
 
 //----------------------------------------------------------------------------
@@ -166,6 +182,7 @@ int vtkMRMLNRRDStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     {
     reader->SetUseNativeOriginOn();
     }
+  reader->SetUseMemoryMapping(this->UseMemoryMapping);
 
   if (volNode->GetImageData())
     {
@@ -375,6 +392,7 @@ int vtkMRMLNRRDStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
   writer->SetInputConnection(volNode->GetImageDataConnection());
   writer->SetUseCompression(this->GetUseCompression());
   writer->SetCompressionLevel(this->GetGzipCompressionLevelFromCompressionParameter(this->CompressionParameter));
+  writer->SetUseParallelCompression(this->UseParallelCompression);
 
   // set volume attributes
   writer->SetIJKToRASMatrix(ijkToRas.GetPointer());
@@ -53,6 +53,26 @@ class VTK_MRML_EXPORT vtkMRMLNRRDStorageNode : public vtkMRMLStorageNode
   vtkGetMacro(CenterImage, int);
   vtkSetMacro(CenterImage, int);
 
+  ///
+  /// Compress the data of .nrrd files in independent blocks on all threads
+  /// when compression is enabled. Such files are read faster by Slicer, but
+  /// other readers may only decode the first block of the data.
+  /// Default is off.
+  /// \sa vtkTeemNRRDWriter::SetUseParallelCompression()
+  vtkGetMacro(UseParallelCompression, bool);
+  vtkSetMacro(UseParallelCompression, bool);
+  vtkBooleanMacro(UseParallelCompression, bool);
+
+  ///
+  /// Map uncompressed data into memory instead of reading it, so that only
+  /// the accessed parts of large volumes are loaded from disk. Modified voxels
+  /// are not written back to the file. Compressed data is read as usual.
+  /// Default is off.
+  /// \sa vtkTeemNRRDReader::SetUseMemoryMapping()
+  vtkGetMacro(UseMemoryMapping, bool);
+  vtkSetMacro(UseMemoryMapping, bool);
+  vtkBooleanMacro(UseMemoryMapping, bool);
+
   ///
   /// Access the nrrd header fields to create a diffusion gradient table
   int ParseDiffusionInformation(vtkTeemNRRDReader *reader,vtkDoubleArray *grad,vtkDoubleArray *bvalues);
@@ -95,6 +115,8 @@ protected:
   int GetGzipCompressionLevelFromCompressionParameter(std::string parameter);
 
   int CenterImage;
+  bool UseParallelCompression;
+  bool UseMemoryMapping;
 };
 
 #endif
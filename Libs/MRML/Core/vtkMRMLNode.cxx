@@ -111,6 +111,12 @@ void vtkMRMLNode::CopyWithScene(vtkMRMLNode *node)
   this->Copy(node);
 }
 
+//----------------------------------------------------------------------------
+vtkMTimeType vtkMRMLNode::GetContentMTime()
+{
+  return this->GetMTime();
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLNode::Copy(vtkMRMLNode *node)
 {
@@ -928,6 +934,33 @@ void vtkMRMLNode::SetID (const char* _arg)
   this->Modified();
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLNode::SetName(const char* name)
+{
+  // Mostly copied from vtkSetStringMacro() in vtkSetGet.h
+  vtkDebugMacro(<< this->GetClassName() << " (" << this << "): setting Name to " << (name?name:"(null)") );
+  if ( this->Name == nullptr && name == nullptr) { return;}
+  if ( this->Name && name && (!strcmp(this->Name,name))) { return;}
+  char* oldName = this->Name;
+  if (name)
+    {
+    size_t n = strlen(name) + 1;
+    this->Name = new char[n];
+    memcpy(this->Name, name, n);
+    }
+  else
+    {
+    this->Name = nullptr;
+    }
+  // keep the name index of the scene up-to-date
+  if (this->Scene)
+    {
+    this->Scene->UpdateNodeName(this, oldName);
+    }
+  delete [] oldName;
+  this->Modified();
+}
+
 //----------------------------------------------------------------------------
 const char * vtkMRMLNode::URLEncodeString(const char *inString)
 {
@@ -225,6 +225,16 @@ public:
   /// \sa vtkMRMLScene::AddNode(vtkMRMLNode*)
   void CopyWithScene(vtkMRMLNode *node);
 
+  /// \brief Get the last modification time of the node or of the data it
+  /// copies in Copy() (e.g. segments of a segmentation, table contents).
+  ///
+  /// The scene uses it to share undo snapshots of nodes that have not changed
+  /// since their last snapshot.
+  /// Subclasses that deep copy data objects that can be modified without
+  /// modifying the node should reimplement this method.
+  /// \sa vtkMRMLScene::SaveStateForUndo()
+  virtual vtkMTimeType GetContentMTime();
+
   /// \brief Reset node attributes to the initial state as defined in the
   /// constructor or the passed default node.
   ///
@@ -350,7 +360,7 @@ public:
   vtkGetStringMacro(Description);
 
   /// Name of this node, to be set by the user
-  vtkSetStringMacro(Name);
+  virtual void SetName(const char* name);
   vtkGetStringMacro(Name);
 
   /// ID use by other nodes to reference this node in XML.
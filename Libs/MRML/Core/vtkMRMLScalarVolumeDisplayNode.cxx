@@ -30,6 +30,7 @@ Version:   $Revision: 1.2 $
 #include <vtkImageHistogramStatistics.h>
 #include <vtkImageLogic.h>
 #include <vtkImageMapToWindowLevelColors.h>
+#include <vtkImageShrink3D.h>
 #include <vtkImageStencil.h>
 #include <vtkImageThreshold.h>
 #include <vtkObjectFactory.h>
@@ -39,7 +40,9 @@ Version:   $Revision: 1.2 $
 
 
 // STD includes
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 
 //----------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLScalarVolumeDisplayNode);
@@ -106,6 +109,8 @@ vtkMRMLScalarVolumeDisplayNode::vtkMRMLScalarVolumeDisplayNode()
 
   this->HistogramStatistics = nullptr;
   this->IsInCalculateAutoLevels = false;
+  this->HistogramSampler = nullptr;
+  this->MaximumNumberOfHistogramSamples = 1 << 24;
 
   vtkEventBroker::GetInstance()->AddObservation(
     this, vtkCommand::ModifiedEvent, this, this->MRMLCallbackCommand  , 10000.);
@@ -130,6 +135,11 @@ vtkMRMLScalarVolumeDisplayNode::~vtkMRMLScalarVolumeDisplayNode()
     this->HistogramStatistics->Delete();
     this->HistogramStatistics = nullptr;
     }
+  if (this->HistogramSampler)
+    {
+    this->HistogramSampler->Delete();
+    this->HistogramSampler = nullptr;
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -389,6 +399,7 @@ void vtkMRMLScalarVolumeDisplayNode::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "UpperThreshold:    " << this->GetUpperThreshold() << "\n";
   os << indent << "LowerThreshold:    " << this->GetLowerThreshold() << "\n";
   os << indent << "Interpolate:       " << this->Interpolate << "\n";
+  os << indent << "MaximumNumberOfHistogramSamples: " << this->MaximumNumberOfHistogramSamples << "\n";
 }
 
 //---------------------------------------------------------------------------
@@ -699,20 +710,12 @@ void vtkMRMLScalarVolumeDisplayNode::GetDisplayScalarRange(double range[2])
 }
 
 //---------------------------------------------------------------------------
-void vtkMRMLScalarVolumeDisplayNode::CalculateAutoLevels()
+vtkImageData* vtkMRMLScalarVolumeDisplayNode::GetHistogramImageData()
 {
-  if (!this->GetAutoWindowLevel() && !this->GetAutoThreshold())
-    {
-    vtkDebugMacro("CalculateScalarAutoLevels: " << (this->GetID() == nullptr ? "nullid" : this->GetID())
-                  << ": Auto window level not turned on, returning.");
-    return;
-    }
-
   vtkImageData *imageDataScalar = this->GetScalarImageData();
   if (!imageDataScalar)
     {
-    vtkDebugMacro("CalculateScalarAutoLevels: input image data is null");
-    return;
+    return nullptr;
     }
   // Make sure the point data is up to date.
   // Remember, the display node pipeline is not connected to a consumer (volume
@@ -726,6 +729,50 @@ void vtkMRMLScalarVolumeDisplayNode::CalculateAutoLevels()
   if (!(imageDataScalar->GetPointData()) ||
       !(imageDataScalar->GetPointData()->GetScalars()))
     {
+    return nullptr;
+    }
+
+  int* dimensions = imageDataScalar->GetDimensions();
+  double numberOfVoxels = static_cast<double>(dimensions[0]) * dimensions[1] * dimensions[2];
+  if (this->MaximumNumberOfHistogramSamples <= 0
+      || numberOfVoxels <= this->MaximumNumberOfHistogramSamples)
+    {
+    return imageDataScalar;
+    }
+
+  // Take one voxel every shrinkFactor voxels along each axis of the image.
+  // Percentiles of 10+ million samples are accurate enough for
+  // window/level and the histogram display, and much faster to compute.
+  int numberOfAxes = (dimensions[0] > 1) + (dimensions[1] > 1) + (dimensions[2] > 1);
+  int shrinkFactor = static_cast<int>(std::ceil(std::pow(
+    numberOfVoxels / this->MaximumNumberOfHistogramSamples, 1. / std::max(numberOfAxes, 1))));
+  if (this->HistogramSampler == nullptr)
+    {
+    this->HistogramSampler = vtkImageShrink3D::New();
+    this->HistogramSampler->AveragingOff();
+    }
+  this->HistogramSampler->SetShrinkFactors(
+    dimensions[0] > 1 ? shrinkFactor : 1,
+    dimensions[1] > 1 ? shrinkFactor : 1,
+    dimensions[2] > 1 ? shrinkFactor : 1);
+  this->HistogramSampler->SetInputData(imageDataScalar);
+  this->HistogramSampler->Update();
+  return this->HistogramSampler->GetOutput();
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLScalarVolumeDisplayNode::CalculateAutoLevels()
+{
+  if (!this->GetAutoWindowLevel() && !this->GetAutoThreshold())
+    {
+    vtkDebugMacro("CalculateScalarAutoLevels: " << (this->GetID() == nullptr ? "nullid" : this->GetID())
+                  << ": Auto window level not turned on, returning.");
+    return;
+    }
+
+  vtkImageData *histogramImageData = this->GetHistogramImageData();
+  if (!histogramImageData)
+    {
     vtkDebugMacro("CalculateScalarAutoLevels: input image data is null");
     return;
     }
@@ -753,7 +800,10 @@ void vtkMRMLScalarVolumeDisplayNode::CalculateAutoLevels()
     }
 
   this->IsInCalculateAutoLevels = true;
-  this->HistogramStatistics->SetInputData(imageDataScalar);
+  // The histogram is computed again only if the image has been modified
+  // since the last update (e.g. new frame of a sequence, output of a CLI),
+  // not for every modification of the display node.
+  this->HistogramStatistics->SetInputData(histogramImageData);
   this->HistogramStatistics->Update();
   double* intensityRange = this->HistogramStatistics->GetAutoRange();
   vtkDebugMacro("CalculateScalarAutoLevels:"
@@ -23,6 +23,7 @@ class vtkImageAlgorithm;
 class vtkImageAppendComponents;
 class vtkImageHistogramStatistics;
 class vtkImageCast;
+class vtkImageShrink3D;
 class vtkImageLogic;
 class vtkImageMapToColors;
 class vtkImageMapToWindowLevelColors;
@@ -185,6 +186,21 @@ class VTK_MRML_EXPORT vtkMRMLScalarVolumeDisplayNode : public vtkMRMLVolumeDispl
   /// Volume node and returns its image data scalar range.
   virtual void GetDisplayScalarRange(double range[2]);
 
+  /// Image to compute the histogram of the volume from: the scalar image
+  /// or, if it has more than MaximumNumberOfHistogramSamples voxels, a
+  /// regular subsampling of it. The subsampling is only computed again when
+  /// the image is modified. Used for the automatic window/level and
+  /// threshold and by the histogram widgets.
+  /// Returns nullptr if there is no scalar image.
+  vtkImageData* GetHistogramImageData();
+
+  /// Maximum number of voxels used to compute the histogram of the volume.
+  /// Larger images are subsampled. 0 means that all voxels are used.
+  /// The value is not saved in the scene.
+  /// Default is 16777216 (2^24) voxels.
+  vtkSetMacro(MaximumNumberOfHistogramSamples, vtkIdType);
+  vtkGetMacro(MaximumNumberOfHistogramSamples, vtkIdType);
+
 protected:
   vtkMRMLScalarVolumeDisplayNode();
   ~vtkMRMLScalarVolumeDisplayNode() override;
@@ -243,6 +259,11 @@ protected:
   /// Used internally in CalculateScalarAutoLevels and CalculateStatisticsAutoLevels
   vtkImageHistogramStatistics *HistogramStatistics;
   bool IsInCalculateAutoLevels;
+
+  ///
+  /// Subsampling of very large images in GetHistogramImageData
+  vtkImageShrink3D *HistogramSampler;
+  vtkIdType MaximumNumberOfHistogramSamples;
 };
 
 #endif
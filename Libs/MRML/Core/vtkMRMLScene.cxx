@@ -16,6 +16,7 @@ Version:   $Revision: 1.18 $
 #include "vtkMRMLParser.h"
 
 #include "vtkCacheManager.h"
+#include "vtkDataFileFormatHelper.h"
 #include "vtkDataIOManager.h"
 #include "vtkTagTable.h"
 
@@ -87,7 +88,9 @@ Version:   $Revision: 1.18 $
 #include <vtkCollection.h>
 #include <vtkDebugLeaks.h>
 #include <vtkErrorCode.h>
+#include <vtkNew.h>
 #include <vtkObjectFactory.h>
+#include <vtkSMPTools.h>
 #include <vtkSmartPointer.h>
 
 // VTKSYS includes
@@ -96,6 +99,7 @@ Version:   $Revision: 1.18 $
 
 // STD includes
 #include <algorithm>
+#include <iterator>
 #include <numeric>
 
 //#define MRMLSCENE_VERBOSE
@@ -113,6 +117,11 @@ vtkCxxSetObjectMacro(vtkMRMLScene, URIHandlerCollection, vtkCollection)
 vtkMRMLScene::vtkMRMLScene()
 {
   this->NodeIDsMTime = 0;
+  this->NextNodeSequenceNumber = 0;
+  this->NodesByClassMTime = 0;
+  this->NodeNamesMTime = 0;
+  this->UndoStackReferenceIDsMTime = 0;
+  this->UndoStackReferenceIDsStackSize = 0;
 
   this->RegisteredNodeClasses.clear();
   this->UniqueIDs.clear();
@@ -121,6 +130,7 @@ vtkMRMLScene::vtkMRMLScene()
   this->Nodes =  vtkCollection::New();
   this->MaximumNumberOfSavedUndoStates = 20;
   this->UndoFlag = false;
+  this->SharedUndoSnapshots = true;
 
   this->NodeReferences.clear();
   this->ReferencedIDChanges.clear();
@@ -138,6 +148,8 @@ vtkMRMLScene::vtkMRMLScene()
 
   this->ReadDataOnLoad = 1;
 
+  this->PrefetchDataOnLoad = 1;
+
   this->LastLoadedVersion = nullptr;
   this->Version = nullptr;
   this->SetVersion(CURRENT_MRML_VERSION);
@@ -803,19 +815,27 @@ int vtkMRMLScene::Import()
 
     this->InvokeEvent(vtkMRMLScene::NewSceneEvent, nullptr);
 
+    // Read the data files of all the storage nodes in parallel first, the
+    // data is then set in the nodes by UpdateScene, in the order of the nodes.
+    int progress = 0;
+    std::vector<vtkSmartPointer<vtkMRMLStorageNode> > prefetchedStorageNodes;
+    if (this->ReadDataOnLoad && this->PrefetchDataOnLoad)
+      {
+      prefetchedStorageNodes = this->PrefetchStorableNodesData(addedNodes, progress);
+      }
+
     // Notify the imported nodes about that all nodes are created
     // (so the observers can be attached to referenced nodes, etc.)
     // by calling UpdateScene on each node
     for (addedNodes->InitTraversal(it);
          (node = (vtkMRMLNode*)addedNodes->GetNextItemAsObject(it)) ;)
       {
-      //double progress = n / (1. * nnodes);
-      //this->InvokeEvent(vtkCommand::ProgressEvent,(void *)&progress);
       vtkDebugMacro("Adding Node: " << (node->GetName() ? node->GetName() : "(undefined)"));
       if (node->GetAddToScene())
         {
         node->UpdateScene(this);
         }
+      this->ProgressState(vtkMRMLScene::ImportState, ++progress);
       if (this->GetErrorCode() == 1)
         {
         //vtkErrorMacro("Import: error updating node " << node->GetID());
@@ -827,6 +847,13 @@ int vtkMRMLScene::Import()
         }
       }
 
+    // Release the data that was not used, for example if the node was
+    // removed from the scene by another node
+    for (vtkMRMLStorageNode* storageNode : prefetchedStorageNodes)
+      {
+      storageNode->ClearPrefetchedData();
+      }
+
     this->Modified();
     this->RemoveUnusedNodeReferences();
 #ifdef MRMLSCENE_VERBOSE
@@ -876,6 +903,148 @@ int vtkMRMLScene::Import()
   return returnCode;
 }
 
+//------------------------------------------------------------------------------
+std::vector<vtkSmartPointer<vtkMRMLStorageNode> > vtkMRMLScene::PrefetchStorableNodesData(
+  vtkCollection* nodes, int& progress)
+{
+  // Only local files are prefetched, remote files are downloaded by ReadData()
+  std::vector<std::pair<vtkSmartPointer<vtkMRMLStorageNode>, vtkSmartPointer<vtkMRMLStorableNode> > > storageNodes;
+  // a storage node shared by several storable nodes is read only once
+  std::set<vtkMRMLStorageNode*> uniqueStorageNodes;
+  vtkMRMLNode* node = nullptr;
+  vtkCollectionSimpleIterator it;
+  for (nodes->InitTraversal(it); (node = vtkMRMLNode::SafeDownCast(nodes->GetNextItemAsObject(it)));)
+    {
+    vtkMRMLStorableNode* storableNode = vtkMRMLStorableNode::SafeDownCast(node);
+    if (!storableNode || !storableNode->GetAddToScene())
+      {
+      continue;
+      }
+    int numberOfStorageNodes = storableNode->GetNumberOfStorageNodes();
+    for (int storageNodeIndex = 0; storageNodeIndex < numberOfStorageNodes; ++storageNodeIndex)
+      {
+      vtkMRMLStorageNode* storageNode = storableNode->GetNthStorageNode(storageNodeIndex);
+      if (!storageNode || !storageNode->GetAddToScene()
+        || storageNode->GetFileName() == nullptr
+        || (storageNode->GetURI() != nullptr && strlen(storageNode->GetURI()) > 0)
+        || !storageNode->CanReadInReferenceNode(storableNode)
+        || !uniqueStorageNodes.insert(storageNode).second)
+        {
+        continue;
+        }
+      storageNodes.push_back(std::make_pair(storageNode, storableNode));
+      }
+    }
+
+  // Nodes are read in batches to report progress between them
+  std::vector<int> prefetched(storageNodes.size(), 0);
+  vtkIdType batchSize = 4 * std::max(1, vtkSMPTools::GetEstimatedNumberOfThreads());
+  vtkIdType numberOfStorageNodes = static_cast<vtkIdType>(storageNodes.size());
+  for (vtkIdType batchStart = 0; batchStart < numberOfStorageNodes; batchStart += batchSize)
+    {
+    vtkIdType batchEnd = std::min(batchStart + batchSize, numberOfStorageNodes);
+    auto prefetchData = [&](vtkIdType begin, vtkIdType end)
+      {
+      for (vtkIdType index = begin; index < end; ++index)
+        {
+        prefetched[index] = storageNodes[index].first->PrefetchData(storageNodes[index].second);
+        }
+      };
+    vtkSMPTools::For(batchStart, batchEnd, 1, prefetchData);
+    progress += static_cast<int>(batchEnd - batchStart);
+    this->ProgressState(vtkMRMLScene::ImportState, progress);
+    }
+
+  std::vector<vtkSmartPointer<vtkMRMLStorageNode> > prefetchedStorageNodes;
+  for (size_t index = 0; index < storageNodes.size(); ++index)
+    {
+    if (prefetched[index])
+      {
+      prefetchedStorageNodes.push_back(storageNodes[index].first);
+      }
+    }
+  return prefetchedStorageNodes;
+}
+
+//------------------------------------------------------------------------------
+std::vector<int> vtkMRMLScene::WriteStorableNodesData(const std::vector<vtkMRMLStorageNode*>& storageNodes,
+  const std::vector<vtkMRMLStorableNode*>& storableNodes)
+{
+  std::vector<int> results(storageNodes.size(), 0);
+  if (storableNodes.size() != storageNodes.size())
+    {
+    vtkErrorMacro("WriteStorableNodesData: the number of storage nodes and storable nodes differ");
+    return results;
+    }
+
+  // A storage node that is listed several times is written concurrently only once.
+  // Only local files are written concurrently, remote files are uploaded by the
+  // cache manager and remote IO logic that are not thread-safe.
+  std::vector<size_t> concurrentIndices;
+  std::vector<size_t> serialIndices;
+  std::set<vtkMRMLStorageNode*> concurrentStorageNodes;
+  for (size_t index = 0; index < storageNodes.size(); ++index)
+    {
+    vtkMRMLStorageNode* storageNode = storageNodes[index];
+    if (!storageNode || !storableNodes[index])
+      {
+      continue;
+      }
+    if (storageNode->CanWriteDataConcurrently()
+      && (storageNode->GetURI() == nullptr || strlen(storageNode->GetURI()) == 0)
+      && concurrentStorageNodes.insert(storageNode).second)
+      {
+      concurrentIndices.push_back(index);
+      }
+    else
+      {
+      serialIndices.push_back(index);
+      }
+    }
+  if (concurrentIndices.size() < 2)
+    {
+    serialIndices.insert(serialIndices.end(), concurrentIndices.begin(), concurrentIndices.end());
+    std::sort(serialIndices.begin(), serialIndices.end());
+    concurrentIndices.clear();
+    }
+  else if (this->GetDataIOManager())
+    {
+    // the file format helper is lazily initialized, it must exist before the threads start
+    this->GetDataIOManager()->GetFileFormatHelper()->GetITKSupportedWriteFileExtensions();
+    }
+
+  // Events are not invoked from the worker threads
+  std::vector<int> storageNodeWasModifying(concurrentIndices.size());
+  std::vector<int> storableNodeWasModifying(concurrentIndices.size());
+  for (size_t concurrentIndex = 0; concurrentIndex < concurrentIndices.size(); ++concurrentIndex)
+    {
+    size_t index = concurrentIndices[concurrentIndex];
+    storageNodeWasModifying[concurrentIndex] = storageNodes[index]->StartModify();
+    storableNodeWasModifying[concurrentIndex] = storableNodes[index]->StartModify();
+    }
+  auto writeData = [&](vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType concurrentIndex = begin; concurrentIndex < end; ++concurrentIndex)
+      {
+      size_t index = concurrentIndices[concurrentIndex];
+      results[index] = storageNodes[index]->WriteData(storableNodes[index]);
+      }
+    };
+  vtkSMPTools::For(0, static_cast<vtkIdType>(concurrentIndices.size()), 1, writeData);
+  for (size_t concurrentIndex = concurrentIndices.size(); concurrentIndex-- > 0;)
+    {
+    size_t index = concurrentIndices[concurrentIndex];
+    storableNodes[index]->EndModify(storableNodeWasModifying[concurrentIndex]);
+    storageNodes[index]->EndModify(storageNodeWasModifying[concurrentIndex]);
+    }
+
+  for (size_t index : serialIndices)
+    {
+    results[index] = storageNodes[index]->WriteData(storableNodes[index]);
+    }
+  return results;
+}
+
 //------------------------------------------------------------------------------
 int vtkMRMLScene::LoadIntoScene(vtkCollection* nodeCollection)
 {
@@ -1190,10 +1359,16 @@ vtkMRMLNode* vtkMRMLScene::AddNodeNoNotify(vtkMRMLNode *n)
     n->SetName(this->GenerateUniqueName(n).c_str());
     }
   n->SetScene( this );
+  // make sure the class and name indices are in sync before adding the node,
+  // as they are updated incrementally
+  this->UpdateNodesByClass();
+  this->UpdateNodeNames();
   this->Nodes->vtkCollection::AddItem((vtkObject *)n);
 
   // cache the node so the whole scene cache stays up-to date
   this->AddNodeID(n);
+  this->AddNodeToClassIndex(n);
+  this->AddNodeToNameIndex(n);
 
   // Keep the SH up-to-date
   if (vtkMRMLSubjectHierarchyNode::SafeDownCast(n) != nullptr &&
@@ -1275,6 +1450,116 @@ vtkMRMLNode* vtkMRMLScene::AddNode(vtkMRMLNode *n)
   return node;
 }
 
+//------------------------------------------------------------------------------
+std::vector<vtkMRMLNode*> vtkMRMLScene::AddNodes(const std::vector<vtkMRMLNode*>& nodesToAdd)
+{
+  std::vector<vtkMRMLNode*> nodesInScene(nodesToAdd.size(), nullptr);
+  if (nodesToAdd.empty())
+    {
+    return nodesInScene;
+    }
+  this->StartState(vtkMRMLScene::BatchProcessState);
+
+  // When importing or restoring, node ID changes are recorded in
+  // ReferencedIDChanges and resolved by the caller.
+  bool resolveIDChanges = !this->IsImporting() && !this->IsRestoring();
+
+  // IDs of the nodes to add must not be given to other nodes of the batch
+  std::vector<std::string> reservedIDs;
+  if (resolveIDChanges)
+    {
+    for (std::vector<vtkMRMLNode*>::const_iterator nodeIt = nodesToAdd.begin(); nodeIt != nodesToAdd.end(); ++nodeIt)
+      {
+      vtkMRMLNode* node = *nodeIt;
+      if (node && !IsNodeWithoutID(node) && !this->IsReservedID(node->GetID()))
+        {
+        this->AddReservedID(node->GetID());
+        reservedIDs.push_back(node->GetID());
+        }
+      }
+    }
+
+  vtkNew<vtkCollection> addedNodes;
+  std::set<vtkMRMLNode*> batchNodes;
+  std::map<std::string, std::string> changedIDs;
+  for (size_t nodeIndex = 0; nodeIndex < nodesToAdd.size(); ++nodeIndex)
+    {
+    vtkMRMLNode* node = nodesToAdd[nodeIndex];
+    if (!node)
+      {
+      vtkErrorMacro("AddNodes: unable to add a null node to the scene");
+      continue;
+      }
+    if (!node->GetAddToScene())
+      {
+      continue;
+      }
+    // if the node is a singleton, then it won't be added, just replaced
+    bool add = (node->GetSingletonTag() == nullptr || this->GetSingletonNode(node) == nullptr);
+    std::string oldID(node->GetID() ? node->GetID() : "");
+    vtkMRMLNode* nodeInScene = this->AddNodeNoNotify(node);
+    if (!nodeInScene)
+      {
+      continue;
+      }
+    nodesInScene[nodeIndex] = nodeInScene;
+    batchNodes.insert(nodeInScene);
+    if (add)
+      {
+      addedNodes->AddItem(nodeInScene);
+      }
+    if (!oldID.empty() && oldID != nodeInScene->GetID())
+      {
+      changedIDs[oldID] = nodeInScene->GetID();
+      }
+    }
+
+  if (resolveIDChanges)
+    {
+    for (std::vector<std::string>::iterator idIt = reservedIDs.begin(); idIt != reservedIDs.end(); ++idIt)
+      {
+      this->ReservedIDs.erase(*idIt);
+      }
+
+    // Update references of the nodes of the batch to the nodes that got a new ID
+    for (std::map<std::string, std::string>::iterator changedIt = changedIDs.begin();
+      changedIt != changedIDs.end(); ++changedIt)
+      {
+      NodeReferencesType::iterator referencedIdIt = this->NodeReferences.find(changedIt->first);
+      if (referencedIdIt == this->NodeReferences.end())
+        {
+        continue;
+        }
+      // make a copy of the node list, as the list may change as a result of UpdateReferenceID calls
+      std::set<std::string> referencingNodeIDs = referencedIdIt->second;
+      for (std::set<std::string>::iterator referencingIt = referencingNodeIDs.begin();
+        referencingIt != referencingNodeIDs.end(); ++referencingIt)
+        {
+        vtkMRMLNode* referencingNode = this->GetNodeByID(*referencingIt);
+        if (referencingNode && batchNodes.find(referencingNode) != batchNodes.end())
+          {
+          referencingNode->UpdateReferenceID(changedIt->first.c_str(), changedIt->second.c_str());
+          }
+        }
+      }
+
+    // Convert all node reference IDs to pointers and add observers,
+    // now that all the referenced nodes of the batch are in the scene.
+    for (std::set<vtkMRMLNode*>::iterator nodeIt = batchNodes.begin(); nodeIt != batchNodes.end(); ++nodeIt)
+      {
+      (*nodeIt)->UpdateNodeReferences();
+      }
+    }
+
+  if (addedNodes->GetNumberOfItems() > 0)
+    {
+    this->InvokeEvent(vtkMRMLScene::NodesAddedEvent, addedNodes.GetPointer());
+    }
+  this->Modified();
+  this->EndState(vtkMRMLScene::BatchProcessState);
+  return nodesInScene;
+}
+
 //------------------------------------------------------------------------------
 vtkMRMLNode* vtkMRMLScene::AddNewNodeByClass(
     std::string className, std::string nodeBaseName /* = "" */)
@@ -1407,10 +1692,14 @@ void vtkMRMLScene::RemoveNode(vtkMRMLNode *n)
     {
     n->SetScene(nullptr);
     }
+  this->UpdateNodesByClass();
+  this->UpdateNodeNames();
   this->Nodes->vtkCollection::RemoveItem((vtkObject *)n);
 
   std::string nid = (n->GetID() ? n->GetID() : "");
   this->RemoveNodeID(n->GetID());
+  this->RemoveNodeFromClassIndex(n);
+  this->RemoveNodeFromNameIndex(n);
 
   this->InvokeEvent(vtkMRMLScene::NodeRemovedEvent, n);
 
@@ -1588,18 +1877,8 @@ int vtkMRMLScene::GetNumberOfNodesByClass(const char *className)
     vtkErrorMacro("GetNumberOfNodesByClass: class name is null.");
     return 0;
     }
-  int num=0;
-  vtkMRMLNode *node;
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
-    {
-    if (node->IsA(className))
-      {
-      num++;
-      }
-    }
-  return num;
+  std::lock_guard<std::recursive_mutex> lock(this->NodeIndexLock);
+  return static_cast<int>(this->GetNodeClassIndex(className, false).Nodes.size());
 }
 
 //------------------------------------------------------------------------------
@@ -1611,15 +1890,12 @@ int vtkMRMLScene::GetNodesByClass(const char *className, std::vector<vtkMRMLNode
     vtkErrorMacro("GetNodesByClass: class name is null.");
     return 0;
     }
-  vtkMRMLNode *node;
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+  std::lock_guard<std::recursive_mutex> lock(this->NodeIndexLock);
+  NodeClassIndexType& classNodes = this->GetNodeClassIndex(className);
+  nodes.reserve(classNodes.Nodes.size());
+  for (const auto& classNode : classNodes.Nodes)
     {
-    if (node->IsA(className))
-      {
-      nodes.push_back(node);
-      }
+    nodes.push_back(classNode.second);
     }
   return static_cast<int>(nodes.size());
 }
@@ -1633,15 +1909,11 @@ vtkCollection* vtkMRMLScene::GetNodesByClass(const char *className)
     return nullptr;
     }
   vtkCollection* nodes = vtkCollection::New();
-  vtkMRMLNode *node;
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+  std::lock_guard<std::recursive_mutex> lock(this->NodeIndexLock);
+  NodeClassIndexType& classNodes = this->GetNodeClassIndex(className);
+  for (const auto& classNode : classNodes.Nodes)
     {
-    if (node->IsA(className))
-      {
-      nodes->AddItem(node);
-      }
+    nodes->AddItem(classNode.second);
     }
   return nodes;
 }
@@ -1702,13 +1974,12 @@ vtkMRMLNode* vtkMRMLScene::GetSingletonNode(const char* singletonTag, const char
     return nullptr;
     }
 
-  vtkCollectionSimpleIterator it;
-  vtkMRMLNode* node = nullptr;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+  std::lock_guard<std::recursive_mutex> lock(this->NodeIndexLock);
+  NodeClassIndexType& classNodes = this->GetNodeClassIndex(className);
+  for (const auto& classNode : classNodes.Nodes)
     {
-    if (node->IsA(className) &&
-        node->GetSingletonTag() != nullptr &&
+    vtkMRMLNode* node = classNode.second;
+    if (node->GetSingletonTag() != nullptr &&
         strcmp(node->GetSingletonTag(), singletonTag) == 0)
       {
       return node;
@@ -1778,22 +2049,13 @@ vtkMRMLNode* vtkMRMLScene::GetNthNodeByClass(int n, const char *className)
     return nullptr;
     }
 
-  int num=0;
-  vtkMRMLNode *node;
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+  std::lock_guard<std::recursive_mutex> lock(this->NodeIndexLock);
+  NodeClassIndexType& classNodes = this->GetNodeClassIndex(className);
+  if (n >= static_cast<int>(classNodes.Nodes.size()))
     {
-    if (node->IsA(className))
-      {
-      if (num == n)
-        {
-        return node;
-        }
-      num++;
-      }
+    return nullptr;
     }
-  return nullptr;
+  return classNodes.Nodes[n].second;
 }
 
 //------------------------------------------------------------------------------
@@ -1812,6 +2074,10 @@ vtkCollection* vtkMRMLScene::GetNodesByName(const char* name)
     vtkErrorMacro("GetNodesByName: name is null");
     return nodes;
     }
+  if (!this->IsNodeNameInUse(name))
+    {
+    return nodes;
+    }
 
   vtkMRMLNode *node;
   vtkCollectionSimpleIterator it;
@@ -1870,6 +2136,10 @@ vtkMRMLNode* vtkMRMLScene::GetFirstNodeByName(const char* name)
     vtkErrorMacro("GetNodesByName: name is null");
     return node;
     }
+  if (!this->IsNodeNameInUse(name))
+    {
+    return nullptr;
+    }
 
   vtkCollectionSimpleIterator it;
   for (this->Nodes->InitTraversal(it);
@@ -1899,14 +2169,16 @@ vtkMRMLNode* vtkMRMLScene::GetNodeByID(const char* id)
     }
 
   vtkMRMLNode *node = nullptr;
+  std::unique_lock<std::recursive_mutex> lock(this->NodeIndexLock);
   this->UpdateNodeIDs();
   std::map< std::string, vtkSmartPointer<vtkMRMLNode> >::iterator it = this->NodeIDs.find(std::string(id));
   if (it != this->NodeIDs.end())
     {
     node = it->second;
     }
+  lock.unlock();
 #ifndef NDEBUG
-  else
+  if (!node)
     {
     // Ensure the node can't be found, and there is no error with the cache
     // mechanism.
@@ -1940,11 +2212,12 @@ vtkCollection* vtkMRMLScene::GetNodesByClassByName(const char* className, const
     return nodes;
     }
 
-  vtkMRMLNode *node;
-  for (int n=0; n < this->Nodes->GetNumberOfItems(); n++)
+  std::lock_guard<std::recursive_mutex> lock(this->NodeIndexLock);
+  NodeClassIndexType& classNodes = this->GetNodeClassIndex(className);
+  for (const auto& classNode : classNodes.Nodes)
     {
-    node = (vtkMRMLNode*)this->Nodes->GetItemAsObject(n);
-    if (node->GetName() != nullptr && !strcmp(node->GetName(), name) && node->IsA(className))
+    vtkMRMLNode* node = classNode.second;
+    if (node->GetName() != nullptr && !strcmp(node->GetName(), name))
       {
       nodes->AddItem(node);
       }
@@ -2039,6 +2312,9 @@ vtkMRMLNode* vtkMRMLScene::InsertAfterNode(vtkMRMLNode *item, vtkMRMLNode *n)
     }
   // cache the node so the whole scene cache stays up-to-date
   this->AddNodeID(n);
+  // the node is not appended, the class index must be rebuilt to keep the
+  // nodes in the collection order
+  this->ClearNodesByClass();
 
   n->SetDisableModifiedEvent(modifyStatus);
 
@@ -2137,6 +2413,9 @@ vtkMRMLNode* vtkMRMLScene::InsertBeforeNode(vtkMRMLNode *item, vtkMRMLNode *n)
     }
   // cache the node so the whole scene cache stays up-todate
   this->AddNodeID(n);
+  // the node is not appended, the class index must be rebuilt to keep the
+  // nodes in the collection order
+  this->ClearNodesByClass();
 
   n->SetDisableModifiedEvent(modifyStatus);
 
@@ -2157,6 +2436,8 @@ void vtkMRMLScene::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "ErrorCode = " << this->ErrorCode << "\n";
   os << indent << "URL = " << this->GetURL() << "\n";
   os << indent << "Root Directory = " << this->GetRootDirectory() << "\n";
+  os << indent << "ReadDataOnLoad = " << this->ReadDataOnLoad << "\n";
+  os << indent << "PrefetchDataOnLoad = " << this->PrefetchDataOnLoad << "\n";
 
   this->Nodes->vtkCollection::PrintSelf(os,indent);
   std::list<std::string> classes = this->GetNodeClassesList();
@@ -2291,7 +2572,6 @@ int vtkMRMLScene::GetUniqueIDIndex(const std::string& baseID)
   bool isUnique = false;
   int index = lastIDIndex;
   // keep looping until you find an id that isn't yet in the scene
-  // TODO: this could be speeded up if it becomes a bottleneck
   for (; !isUnique; )
     {
     ++index;
@@ -2307,6 +2587,10 @@ int vtkMRMLScene::GetUniqueIDIndex(const std::string& baseID)
 //------------------------------------------------------------------------------
 bool vtkMRMLScene::IsNodeIDReservedByUndo(const std::string id) const
 {
+  if (this->UndoStack.empty())
+    {
+    return false;
+    }
   NodeReferencesType::const_iterator referenceIt = this->NodeReferences.find(id);
   if (referenceIt != this->NodeReferences.end())
     {
@@ -2315,14 +2599,22 @@ bool vtkMRMLScene::IsNodeIDReservedByUndo(const std::string id) const
     return false;
     }
 
-  std::set<std::string> undoReferenceIDs;
-  this->GetNodeReferenceIDsFromUndoStack(undoReferenceIDs);
-  if (undoReferenceIDs.find(id) != undoReferenceIDs.end())
+  // Collecting the references of the undo stack is expensive, only do it
+  // again if an undo state has been added, modified or removed.
+  vtkMTimeType undoStackMTime = 0;
+  std::list<vtkCollection*>::const_iterator undoStackIt;
+  for (undoStackIt = this->UndoStack.begin(); undoStackIt != this->UndoStack.end(); ++undoStackIt)
     {
-    return true;
+    undoStackMTime = std::max(undoStackMTime, (*undoStackIt)->GetMTime());
     }
-
-  return false;
+  if (undoStackMTime != this->UndoStackReferenceIDsMTime
+    || this->UndoStack.size() != this->UndoStackReferenceIDsStackSize)
+    {
+    this->GetNodeReferenceIDsFromUndoStack(this->UndoStackReferenceIDs);
+    this->UndoStackReferenceIDsMTime = undoStackMTime;
+    this->UndoStackReferenceIDsStackSize = this->UndoStack.size();
+    }
+  return this->UndoStackReferenceIDs.find(id) != this->UndoStackReferenceIDs.end();
 }
 
 //------------------------------------------------------------------------------
@@ -2423,12 +2715,11 @@ int vtkMRMLScene::GetUniqueNameIndex(const std::string& baseName)
   bool isUnique = false;
   int index = lastNameIndex;
   // keep looping until you find a name that isn't yet in the scene
-  // TODO: this could be speeded up if it becomes a bottleneck
   for (; !isUnique; )
     {
     ++index;
     std::string candidateName = this->BuildName(baseName, index);
-    isUnique = (this->GetFirstNodeByName(candidateName.c_str()) == nullptr);
+    isUnique = !this->IsNodeNameInUse(candidateName.c_str());
     }
   return index;
 }
@@ -2521,18 +2812,18 @@ void vtkMRMLScene::SaveStateForUndo (std::vector<vtkMRMLNode *> nodes)
     return;
     }
 
-  this->ClearRedoStack();
-  //this->SetUndoOn();
-  this->PushIntoUndoStack();
-  unsigned int n;
-  for (n=0; n<nodes.size(); n++)
+  std::set<vtkMRMLNode*> nodesToCopy;
+  for (std::vector<vtkMRMLNode*>::iterator nodeIt = nodes.begin(); nodeIt != nodes.end(); ++nodeIt)
     {
-    vtkMRMLNode *node = nodes[n];
+    vtkMRMLNode *node = *nodeIt;
     if (node && node->GetUndoEnabled())
       {
-      this->CopyNodeInUndoStack(node);
+      nodesToCopy.insert(node);
       }
     }
+
+  this->ClearRedoStack();
+  this->PushIntoUndoStack(nodesToCopy);
 }
 
 //------------------------------------------------------------------------------
@@ -2558,20 +2849,19 @@ void vtkMRMLScene::SaveStateForUndo (vtkCollection* nodes)
     return;
     }
 
-  this->ClearRedoStack();
-  //this->SetUndoOn();
-  this->PushIntoUndoStack();
-
+  std::set<vtkMRMLNode*> nodesToCopy;
   int nnodes = nodes->GetNumberOfItems();
-
   for (int n=0; n<nnodes; n++)
     {
     vtkMRMLNode *node  = vtkMRMLNode::SafeDownCast(nodes->GetItemAsObject(n));
     if (node && node->GetUndoEnabled())
       {
-      this->CopyNodeInUndoStack(node);
+      nodesToCopy.insert(node);
       }
     }
+
+  this->ClearRedoStack();
+  this->PushIntoUndoStack(nodesToCopy);
 }
 
 //------------------------------------------------------------------------------
@@ -2620,6 +2910,45 @@ void vtkMRMLScene::PushIntoUndoStack()
   this->TrimUndoStack();
 }
 
+//------------------------------------------------------------------------------
+// Make a new collection that has copies of the nodes to copy and pointers to
+// all the other nodes in the current scene
+void vtkMRMLScene::PushIntoUndoStack(const std::set<vtkMRMLNode*>& nodesToCopy)
+{
+  if (this->Nodes == nullptr)
+    {
+    return;
+    }
+
+  vtkCollection* newScene = vtkCollection::New();
+
+  vtkCollection* currentScene = this->Nodes;
+
+  int nnodes = currentScene->GetNumberOfItems();
+
+  for (int n=0; n<nnodes; n++)
+    {
+    vtkMRMLNode *node  = vtkMRMLNode::SafeDownCast(currentScene->GetItemAsObject(n));
+    if (!node || !node->GetUndoEnabled())
+      {
+      continue;
+      }
+    if (nodesToCopy.find(node) == nodesToCopy.end())
+      {
+      newScene->AddItem(node);
+      continue;
+      }
+    vtkSmartPointer<vtkMRMLNode> snapshot = this->GetUndoSnapshot(node);
+    if (snapshot)
+      {
+      newScene->AddItem(snapshot);
+      }
+    }
+
+  this->UndoStack.push_back(newScene);
+  this->TrimUndoStack();
+}
+
 //------------------------------------------------------------------------------
 // Make a new collection that has pointers to the current scene nodes
 void vtkMRMLScene::PushIntoRedoStack()
@@ -2658,10 +2987,10 @@ void vtkMRMLScene::CopyNodeInUndoStack(vtkMRMLNode *copyNode)
     return;
     }
 
-  vtkMRMLNode *snode = copyNode->CreateNodeInstance();
-  if (snode != nullptr)
+  vtkSmartPointer<vtkMRMLNode> snode = this->GetUndoSnapshot(copyNode);
+  if (snode == nullptr)
     {
-    snode->CopyWithScene(copyNode);
+    return;
     }
 
   vtkCollection* undoScene = this->UndoStack.back();
@@ -2675,7 +3004,102 @@ void vtkMRMLScene::CopyNodeInUndoStack(vtkMRMLNode *copyNode)
       break;
       }
     }
-  snode->Delete();
+}
+
+//------------------------------------------------------------------------------
+vtkMRMLNode* vtkMRMLScene::GetUpToDateUndoSnapshot(vtkMRMLNode* node)
+{
+  if (!this->SharedUndoSnapshots || !node)
+    {
+    return nullptr;
+    }
+  std::unordered_map<vtkMRMLNode*, UndoSnapshot>::iterator snapshotIt = this->UndoSnapshots.find(node);
+  if (snapshotIt == this->UndoSnapshots.end()
+    || snapshotIt->second.Node.GetPointer() != node)
+    {
+    return nullptr;
+    }
+  // While modified events are disabled, the node content may have changed
+  // without its modification time being updated yet.
+  if (node->GetDisableModifiedEvent()
+    || node->GetContentMTime() != snapshotIt->second.ContentMTime)
+    {
+    return nullptr;
+    }
+  return snapshotIt->second.Snapshot;
+}
+
+//------------------------------------------------------------------------------
+vtkSmartPointer<vtkMRMLNode> vtkMRMLScene::GetUndoSnapshot(vtkMRMLNode* node)
+{
+  vtkSmartPointer<vtkMRMLNode> snapshot = this->GetUpToDateUndoSnapshot(node);
+  if (snapshot)
+    {
+    return snapshot;
+    }
+
+  snapshot = vtkSmartPointer<vtkMRMLNode>::Take(node->CreateNodeInstance());
+  if (snapshot == nullptr)
+    {
+    vtkErrorMacro("GetUndoSnapshot: failed to create a copy of node " << (node->GetID() ? node->GetID() : "(none)"));
+    return nullptr;
+    }
+  snapshot->CopyWithScene(node);
+
+  if (this->SharedUndoSnapshots)
+    {
+    // Copying may update the modification time of the source node
+    // (e.g. by temporarily disabling its modified events), therefore the
+    // content time is retrieved after the copy.
+    UndoSnapshot& undoSnapshot = this->UndoSnapshots[node];
+    undoSnapshot.Node = node;
+    undoSnapshot.Snapshot = snapshot;
+    undoSnapshot.ContentMTime = node->GetContentMTime();
+    }
+  return snapshot;
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLScene::RemoveUnusedUndoSnapshots()
+{
+  std::unordered_map<vtkMRMLNode*, UndoSnapshot>::iterator snapshotIt = this->UndoSnapshots.begin();
+  while (snapshotIt != this->UndoSnapshots.end())
+    {
+    // The snapshot is only referenced by this map if it is not used by the undo stack anymore
+    if (!snapshotIt->second.Node || snapshotIt->second.Snapshot->GetReferenceCount() <= 1)
+      {
+      snapshotIt = this->UndoSnapshots.erase(snapshotIt);
+      }
+    else
+      {
+      ++snapshotIt;
+      }
+    }
+}
+
+//------------------------------------------------------------------------------
+int vtkMRMLScene::GetNumberOfUndoSnapshots()
+{
+  std::set<vtkObject*> sceneNodes;
+  int nnodes = this->Nodes->GetNumberOfItems();
+  for (int n=0; n<nnodes; n++)
+    {
+    sceneNodes.insert(this->Nodes->GetItemAsObject(n));
+    }
+  std::set<vtkObject*> snapshots;
+  for (std::list<vtkCollection*>::iterator stackIt = this->UndoStack.begin(); stackIt != this->UndoStack.end(); ++stackIt)
+    {
+    nnodes = (*stackIt)->GetNumberOfItems();
+    for (int n=0; n<nnodes; n++)
+      {
+      vtkObject* node = (*stackIt)->GetItemAsObject(n);
+      if (sceneNodes.find(node) == sceneNodes.end())
+        {
+        snapshots.insert(node);
+        }
+      }
+    }
+  return static_cast<int>(snapshots.size());
 }
 
 //------------------------------------------------------------------------------
@@ -2783,7 +3207,7 @@ void vtkMRMLScene::Undo()
       // the node was deleted, add Node back to the current scene
       addNodes.push_back(*iterNode);
       }
-    else if (*iterNode != *curIterNode)
+    else if (*iterNode != *curIterNode && *iterNode != this->GetUpToDateUndoSnapshot(*curIterNode))
       {
       // nodes differ, copy from undo to current scene
       // but before create a copy in redo stack from current
@@ -2804,10 +3228,39 @@ void vtkMRMLScene::Undo()
       }
     }
 
+  // Node copies that are shared with other undo states must not become
+  // scene nodes, a new copy is added instead.
+  std::set<vtkMRMLNode*> sharedSnapshots;
+  if (!addNodes.empty())
+    {
+    for (std::list<vtkCollection*>::iterator stackIt = this->UndoStack.begin(); stackIt != this->UndoStack.end(); ++stackIt)
+      {
+      if (*stackIt == undoScene)
+        {
+        continue;
+        }
+      nnodes = (*stackIt)->GetNumberOfItems();
+      for (n=0; n<nnodes; n++)
+        {
+        sharedSnapshots.insert(vtkMRMLNode::SafeDownCast((*stackIt)->GetItemAsObject(n)));
+        }
+      }
+    std::unordered_map<vtkMRMLNode*, UndoSnapshot>::iterator snapshotIt;
+    for (snapshotIt = this->UndoSnapshots.begin(); snapshotIt != this->UndoSnapshots.end(); ++snapshotIt)
+      {
+      sharedSnapshots.insert(snapshotIt->second.Snapshot);
+      }
+    }
   for (nn=0; nn<addNodes.size(); nn++)
     {
-    this->AddNode(addNodes[nn]);
-    addNodes[nn]->SetSceneReferences();
+    vtkSmartPointer<vtkMRMLNode> nodeToAdd = addNodes[nn];
+    if (sharedSnapshots.find(nodeToAdd) != sharedSnapshots.end())
+      {
+      nodeToAdd = vtkSmartPointer<vtkMRMLNode>::Take(addNodes[nn]->CreateNodeInstance());
+      nodeToAdd->CopyWithScene(addNodes[nn]);
+      }
+    this->AddNode(nodeToAdd);
+    nodeToAdd->SetSceneReferences();
     }
   for (nn=0; nn<removeNodes.size(); nn++)
     {
@@ -2830,6 +3283,7 @@ void vtkMRMLScene::Undo()
    {
    this->UndoStack.pop_back();
    }
+  this->RemoveUnusedUndoSnapshots();
   this->Modified();
 
   this->EndState(vtkMRMLScene::UndoState);
@@ -2971,6 +3425,7 @@ void vtkMRMLScene::ClearUndoStack()
     (*iter)->Delete();
     }
   this->UndoStack.clear();
+  this->UndoSnapshots.clear();
 }
 
 //------------------------------------------------------------------------------
@@ -3249,6 +3704,7 @@ void vtkMRMLScene::UpdateNodeChangedIDs()
 //------------------------------------------------------------------------------
 void vtkMRMLScene::UpdateNodeIDs()
 {
+  std::lock_guard<std::recursive_mutex> lock(this->NodeIndexLock);
   if (this->Nodes->GetNumberOfItems() == 0)
     {
     this->ClearNodeIDs();
@@ -3310,6 +3766,228 @@ void vtkMRMLScene::ClearNodeIDs()
   }
 }
 
+//-----------------------------------------------------------------------------
+vtkMRMLScene::NodeClassIndexType& vtkMRMLScene::GetNodeClassIndex(const char* className, bool sorted)
+{
+  std::lock_guard<std::recursive_mutex> lock(this->NodeIndexLock);
+  this->UpdateNodesByClass();
+  std::map< std::string, NodeClassIndexType >::iterator classIt = this->NodesByClass.find(className);
+  if (classIt != this->NodesByClass.end())
+    {
+    NodeClassIndexType& classNodes = classIt->second;
+    if (sorted && !classNodes.Sorted)
+      {
+      // Restore the scene order after nodes have been removed
+      std::sort(classNodes.Nodes.begin(), classNodes.Nodes.end(),
+        [](const std::pair< unsigned long, vtkMRMLNode* >& node1, const std::pair< unsigned long, vtkMRMLNode* >& node2)
+        { return node1.first < node2.first; });
+      for (size_t position = 0; position < classNodes.Nodes.size(); ++position)
+        {
+        classNodes.Positions[classNodes.Nodes[position].second] = position;
+        }
+      classNodes.Sorted = true;
+      }
+    return classNodes;
+    }
+  // First time this class is queried, look for all the matching nodes once.
+  NodeClassIndexType& classNodes = this->NodesByClass[className];
+  vtkMRMLNode *node;
+  vtkCollectionSimpleIterator it;
+  for (this->Nodes->InitTraversal(it);
+       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+    {
+    if (node->IsA(className))
+      {
+      classNodes.Positions[node] = classNodes.Nodes.size();
+      classNodes.Nodes.push_back(std::make_pair(this->NodeSequenceNumbers[node], node));
+      }
+    }
+  return classNodes;
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::UpdateNodesByClass()
+{
+  std::lock_guard<std::recursive_mutex> lock(this->NodeIndexLock);
+  if (!this->Nodes || this->Nodes->GetMTime() <= this->NodesByClassMTime)
+    {
+    return;
+    }
+#ifdef MRMLSCENE_VERBOSE
+  std::cerr << "Recompute node class index..." << std::endl;
+#endif
+  this->ClearNodesByClass();
+  vtkMRMLNode *node;
+  vtkCollectionSimpleIterator it;
+  for (this->Nodes->InitTraversal(it);
+       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+    {
+    this->NodeSequenceNumbers[node] = this->NextNodeSequenceNumber++;
+    }
+  this->NodesByClassMTime = this->Nodes->GetMTime();
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::AddNodeToClassIndex(vtkMRMLNode* node)
+{
+  if (!this->Nodes || !node)
+    {
+    return;
+    }
+  // The node is the last one of the collection, its sequence number is the
+  // largest so appending it keeps sorted index entries sorted.
+  unsigned long sequenceNumber = this->NextNodeSequenceNumber++;
+  this->NodeSequenceNumbers[node] = sequenceNumber;
+  for (std::map< std::string, NodeClassIndexType >::iterator classIt = this->NodesByClass.begin();
+    classIt != this->NodesByClass.end(); ++classIt)
+    {
+    if (node->IsA(classIt->first.c_str()))
+      {
+      NodeClassIndexType& classNodes = classIt->second;
+      classNodes.Positions[node] = classNodes.Nodes.size();
+      classNodes.Nodes.push_back(std::make_pair(sequenceNumber, node));
+      }
+    }
+  this->NodesByClassMTime = this->Nodes->GetMTime();
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::RemoveNodeFromClassIndex(vtkMRMLNode* node)
+{
+  if (!this->Nodes || !node)
+    {
+    return;
+    }
+  for (std::map< std::string, NodeClassIndexType >::iterator classIt = this->NodesByClass.begin();
+    classIt != this->NodesByClass.end(); ++classIt)
+    {
+    NodeClassIndexType& classNodes = classIt->second;
+    std::unordered_map< vtkMRMLNode*, size_t >::iterator positionIt = classNodes.Positions.find(node);
+    if (positionIt == classNodes.Positions.end())
+      {
+      continue;
+      }
+    // Move the last node to the position of the removed node
+    size_t position = positionIt->second;
+    classNodes.Positions.erase(positionIt);
+    if (position + 1 < classNodes.Nodes.size())
+      {
+      classNodes.Nodes[position] = classNodes.Nodes.back();
+      classNodes.Positions[classNodes.Nodes[position].second] = position;
+      classNodes.Sorted = false;
+      }
+    classNodes.Nodes.pop_back();
+    }
+  this->NodeSequenceNumbers.erase(node);
+  this->NodesByClassMTime = this->Nodes->GetMTime();
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::ClearNodesByClass()
+{
+  this->NodesByClass.clear();
+  this->NodeSequenceNumbers.clear();
+  this->NextNodeSequenceNumber = 0;
+  this->NodesByClassMTime = 0;
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::UpdateNodeNames()
+{
+  std::lock_guard<std::recursive_mutex> lock(this->NodeIndexLock);
+  if (!this->Nodes || this->Nodes->GetMTime() <= this->NodeNamesMTime)
+    {
+    return;
+    }
+#ifdef MRMLSCENE_VERBOSE
+  std::cerr << "Recompute node name index..." << std::endl;
+#endif
+  this->NodeNames.clear();
+  vtkMRMLNode *node;
+  vtkCollectionSimpleIterator it;
+  for (this->Nodes->InitTraversal(it);
+       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+    {
+    if (node->GetName())
+      {
+      ++this->NodeNames[node->GetName()];
+      }
+    }
+  this->NodeNamesMTime = this->Nodes->GetMTime();
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::AddNodeToNameIndex(vtkMRMLNode* node)
+{
+  if (!this->Nodes || !node)
+    {
+    return;
+    }
+  if (node->GetName())
+    {
+    ++this->NodeNames[node->GetName()];
+    }
+  this->NodeNamesMTime = this->Nodes->GetMTime();
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::RemoveNodeFromNameIndex(vtkMRMLNode* node)
+{
+  if (!this->Nodes || !node)
+    {
+    return;
+    }
+  if (node->GetName())
+    {
+    std::unordered_map< std::string, int >::iterator nameIt = this->NodeNames.find(node->GetName());
+    if (nameIt != this->NodeNames.end() && --nameIt->second <= 0)
+      {
+      this->NodeNames.erase(nameIt);
+      }
+    }
+  this->NodeNamesMTime = this->Nodes->GetMTime();
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::UpdateNodeName(vtkMRMLNode* node, const char* oldName)
+{
+  std::lock_guard<std::recursive_mutex> lock(this->NodeIndexLock);
+  if (!this->Nodes || !node || this->Nodes->GetMTime() > this->NodeNamesMTime)
+    {
+    // the index is not in sync, it will be rebuilt at next use
+    return;
+    }
+  // only nodes that are in the scene are indexed
+  if (!node->GetID() || this->GetNodeByID(node->GetID()) != node)
+    {
+    return;
+    }
+  if (oldName)
+    {
+    std::unordered_map< std::string, int >::iterator nameIt = this->NodeNames.find(oldName);
+    if (nameIt != this->NodeNames.end() && --nameIt->second <= 0)
+      {
+      this->NodeNames.erase(nameIt);
+      }
+    }
+  if (node->GetName())
+    {
+    ++this->NodeNames[node->GetName()];
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool vtkMRMLScene::IsNodeNameInUse(const char* name)
+{
+  if (!name)
+    {
+    return false;
+    }
+  std::lock_guard<std::recursive_mutex> lock(this->NodeIndexLock);
+  this->UpdateNodeNames();
+  return this->NodeNames.find(name) != this->NodeNames.end();
+}
+
 //------------------------------------------------------------------------------
 void vtkMRMLScene::AddURIHandler(vtkURIHandler *handler)
 {
@@ -3680,10 +4358,17 @@ void vtkMRMLScene::SetMaximumNumberOfSavedUndoStates(int stackSize)
 //-----------------------------------------------------------------------------
 void vtkMRMLScene::TrimUndoStack()
 {
-  std::list<vtkSmartPointer<vtkCollection> > removedStacks;
+  bool removed = false;
   while(static_cast<int>(this->UndoStack.size()) > this->MaximumNumberOfSavedUndoStates)
     {
-    removedStacks.emplace_back(this->UndoStack.front());
+    vtkCollection* removedScene = this->UndoStack.front();
     this->UndoStack.pop_front();
+    removedScene->RemoveAllItems();
+    removedScene->Delete();
+    removed = true;
+    }
+  if (removed)
+    {
+    this->RemoveUnusedUndoSnapshots();
     }
 }
@@ -30,8 +30,10 @@ Version:   $Revision: 1.18 $
 // STD includes
 #include <list>
 #include <map>
+#include <mutex>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 class vtkCacheManager;
@@ -44,6 +46,8 @@ class vtkGeneralTransform;
 class vtkURIHandler;
 class vtkMRMLNode;
 class vtkMRMLSceneViewNode;
+class vtkMRMLStorableNode;
+class vtkMRMLStorageNode;
 class vtkMRMLSubjectHierarchyNode;
 
 /// \brief A set of MRML Nodes that supports serialization and undo/redo.
@@ -60,6 +64,8 @@ class VTK_MRML_EXPORT vtkMRMLScene : public vtkObject
   /// so that it can call protected methods, for example UpdateNodeIDs()
   /// but that's the only class that is allowed to do so
   friend class vtkMRMLSceneViewNode;
+  /// vtkMRMLNode notifies the scene when it is renamed (see UpdateNodeName())
+  friend class vtkMRMLNode;
 
 public:
   static vtkMRMLScene *New();
@@ -95,6 +101,19 @@ public:
   /// Returns nonzero on success
   int Commit(const char* url=nullptr);
 
+  /// \brief Write the data of storable nodes with their storage nodes.
+  ///
+  /// The nth storage node writes the data of the nth storable node.
+  /// Storage nodes that support it (see vtkMRMLStorageNode::CanWriteDataConcurrently())
+  /// write their local files in parallel, the other ones and the ones with a
+  /// URI write their files one after the other. The scene must not be
+  /// modified meanwhile.
+  /// Modified events of the nodes are invoked after all the files are written.
+  /// Returns the result of vtkMRMLStorageNode::WriteData() for each storage node.
+  /// \sa Commit()
+  std::vector<int> WriteStorableNodesData(const std::vector<vtkMRMLStorageNode*>& storageNodes,
+    const std::vector<vtkMRMLStorableNode*>& storableNodes);
+
   /// Remove nodes and clear undo/redo stacks.
   /// \param removeSingletons If set to true then it removes
   /// all singleton nodes (interaction, color, view nodes etc.)
@@ -184,6 +203,29 @@ public:
   /// into the already existing singleton node. That node is then returned.
   vtkMRMLNode* AddNode(vtkMRMLNode *nodeToAdd);
 
+  /// \brief Add a batch of nodes to the scene and send a single
+  /// vtkMRMLScene::NodesAddedEvent.
+  ///
+  /// Nodes are added the same way as with AddNode() (unique IDs and names
+  /// are generated, singletons are merged into the existing singleton node)
+  /// but no vtkMRMLScene::NodeAboutToBeAddedEvent and
+  /// vtkMRMLScene::NodeAddedEvent are sent for the individual nodes.
+  /// Instead, vtkMRMLScene::NodesAddedEvent is sent once with the collection
+  /// of added nodes as call data. The whole insertion is done in
+  /// \link vtkMRMLScene::BatchProcessState BatchProcessState \endlink, so
+  /// observers that don't handle vtkMRMLScene::NodesAddedEvent can update
+  /// from the scene on vtkMRMLScene::EndBatchProcessEvent.
+  ///
+  /// Node references are resolved after all the nodes are in the scene:
+  /// nodes of the batch can refer to each other regardless of their order,
+  /// and references to the IDs of nodes that had to be changed to avoid
+  /// conflicts with the scene are updated to the new IDs.
+  ///
+  /// Returns the nodes in the scene corresponding to \a nodesToAdd (the
+  /// existing singleton node if merged, nullptr if the node was not added).
+  /// \sa AddNode(), NodesAddedEvent
+  std::vector<vtkMRMLNode*> AddNodes(const std::vector<vtkMRMLNode*>& nodesToAdd);
+
   /// \brief Instantiate and add a node to the scene.
   ///
   /// This is the preferred way to create and add a new node to
@@ -288,11 +330,17 @@ public:
   vtkMRMLNode* GetNthNode(int n);
 
   /// Get n-th node of a specified class in the scene
+  /// \note The class queries (GetNthNodeByClass(), GetNumberOfNodesByClass(),
+  /// GetNodesByClass()...) use an index that is updated lazily. Concurrent
+  /// queries are serialized, but the scene must not be modified while other
+  /// threads query it: call them from the main thread unless the scene is
+  /// known not to change.
   vtkMRMLNode* GetNthNodeByClass(int n, const char* className );
   /// Convenience function for getting 0-th node of a specified class in the scene
   vtkMRMLNode* GetFirstNodeByClass(const char* className);
 
   /// Get number of nodes of a specified class in the scene
+  /// \sa GetNthNodeByClass() about thread safety
   int GetNumberOfNodesByClass(const char* className);
 
   /// Get vector of nodes of a specified class in the scene
@@ -369,6 +417,19 @@ public:
   /// returns number of redo steps in the history buffer
   int GetNumberOfRedoLevels() {return static_cast<int>(this->RedoStack.size());}
 
+  /// \brief Share copies of unchanged nodes between undo states.
+  ///
+  /// If enabled (default), SaveStateForUndo() only copies the nodes whose
+  /// content (see vtkMRMLNode::GetContentMTime()) changed since their last
+  /// saved state and reuses the previous copy of all the other nodes.
+  /// If disabled, all undo-enabled nodes are copied at each saved state.
+  vtkSetMacro(SharedUndoSnapshots, bool);
+  vtkGetMacro(SharedUndoSnapshots, bool);
+  vtkBooleanMacro(SharedUndoSnapshots, bool);
+
+  /// Returns the number of distinct node copies stored in the undo history buffer.
+  int GetNumberOfUndoSnapshots();
+
   /// Save current state in the undo buffer
   void SaveStateForUndo();
 
@@ -494,6 +555,14 @@ public:
   vtkSetMacro(ReadDataOnLoad,int);
   vtkGetMacro(ReadDataOnLoad,int);
 
+  /// If enabled (default), Import() reads the files of the storage nodes
+  /// concurrently (see vtkMRMLStorageNode::PrefetchData()) before setting
+  /// the data in the nodes in their order in the scene.
+  /// \sa SetReadDataOnLoad(), Import()
+  vtkSetMacro(PrefetchDataOnLoad,int);
+  vtkGetMacro(PrefetchDataOnLoad,int);
+  vtkBooleanMacro(PrefetchDataOnLoad,int);
+
   void SetErrorMessage(const std::string &error);
   std::string GetErrorMessage();
 
@@ -655,6 +724,8 @@ public:
     NodeAddedEvent,
     NodeAboutToBeRemovedEvent,
     NodeRemovedEvent,
+    /// Sent once by AddNodes(), call data is a vtkCollection of the added nodes.
+    NodesAddedEvent,
 
     NewSceneEvent = 66030,
     MetadataAddedEvent = 66032, // ### Slicer 4.5: Simplify - Do not explicitly set for backward compat. See issue #3472
@@ -679,7 +750,7 @@ public:
 
     StartImportEvent = StateEvent | StartEvent | ImportState,
     EndImportEvent = StateEvent | EndEvent | ImportState,
-    ProgressImportEvent = StateEvent | EndEvent | ImportState,
+    ProgressImportEvent = StateEvent | ProgressEvent | ImportState,
 
     StartRestoreEvent = StateEvent | StartEvent | RestoreState,
     EndRestoreEvent = StateEvent | EndEvent | RestoreState,
@@ -754,9 +825,25 @@ protected:
   void PushIntoUndoStack();
   void PushIntoRedoStack();
 
+  /// Push a new undo state that contains a copy of each node of \a nodesToCopy
+  /// and pointers to all the other undo-enabled nodes of the scene.
+  void PushIntoUndoStack(const std::set<vtkMRMLNode*>& nodesToCopy);
+
   void CopyNodeInUndoStack(vtkMRMLNode *node);
   void CopyNodeInRedoStack(vtkMRMLNode *node);
 
+  /// Return a copy of the node to store in the undo stack. The last copy of the
+  /// node is returned if the node content has not changed since then.
+  /// \sa SharedUndoSnapshots
+  vtkSmartPointer<vtkMRMLNode> GetUndoSnapshot(vtkMRMLNode* node);
+
+  /// Return the last copy of the node if the node content has not changed
+  /// since then, nullptr otherwise.
+  vtkMRMLNode* GetUpToDateUndoSnapshot(vtkMRMLNode* node);
+
+  /// Forget node copies that are not used by the undo stack anymore.
+  void RemoveUnusedUndoSnapshots();
+
   /// Add a node to the scene without invoking a vtkMRMLScene::NodeAddedEvent event.
   ///
   /// \warning Use with extreme caution as it might unsynchronize observer.
@@ -801,6 +888,67 @@ protected:
   /// Clear NodeIDs map used to speedup GetByID() method.
   void ClearNodeIDs();
 
+  /// Nodes of a class (or of any of its subclasses) with their sequence
+  /// number. A vector is used so that GetNthNodeByClass() does not need to
+  /// traverse the nodes of the class.
+  /// A node is removed in constant time by moving the last node of the
+  /// vector to its position, which breaks the order of the nodes: they are
+  /// sorted again by sequence number (i.e. in the order of the \a Nodes
+  /// collection) by the next query that needs the order.
+  struct NodeClassIndexType
+  {
+    std::vector< std::pair< unsigned long, vtkMRMLNode* > > Nodes;
+    // Position of each node in Nodes
+    std::unordered_map< vtkMRMLNode*, size_t > Positions;
+    bool Sorted;
+    NodeClassIndexType() : Sorted(true) {}
+  };
+
+  /// \brief Return the NodesByClass index entry of \a className.
+  ///
+  /// The entry is built the first time a class is queried, then it is kept
+  /// up-to-date by AddNodeNoNotify() and RemoveNode(), so that
+  /// GetNodesByClass() and related methods don't need to traverse the scene.
+  /// The nodes of the entry are in the scene order if \a sorted is true.
+  /// The caller must hold NodeIndexLock while it uses the entry.
+  /// \sa UpdateNodesByClass()
+  NodeClassIndexType& GetNodeClassIndex(const char* className, bool sorted = true);
+
+  /// \brief Synchronize NodesByClass index with the \a Nodes collection.
+  ///
+  /// The index is rebuilt if the collection has been modified without
+  /// updating the index (e.g. nodes inserted by InsertAfterNode()).
+  void UpdateNodesByClass();
+
+  /// Add node to the NodesByClass index entries it belongs to.
+  void AddNodeToClassIndex(vtkMRMLNode* node);
+
+  /// Remove node from all the NodesByClass index entries.
+  void RemoveNodeFromClassIndex(vtkMRMLNode* node);
+
+  /// Clear the NodesByClass index.
+  void ClearNodesByClass();
+
+  /// \brief Synchronize NodeNames index with the \a Nodes collection.
+  ///
+  /// The index is kept up-to-date by AddNodeNoNotify(), RemoveNode() and
+  /// UpdateNodeName(). It is rebuilt if the collection has been modified
+  /// without updating the index (e.g. nodes inserted by InsertAfterNode()).
+  void UpdateNodeNames();
+
+  /// Add the node name to the NodeNames index.
+  void AddNodeToNameIndex(vtkMRMLNode* node);
+
+  /// Remove the node name from the NodeNames index.
+  void RemoveNodeFromNameIndex(vtkMRMLNode* node);
+
+  /// Update the NodeNames index after a node of the scene is renamed.
+  /// Called by vtkMRMLNode::SetName().
+  void UpdateNodeName(vtkMRMLNode* node, const char* oldName);
+
+  /// Returns true if a node of the scene has the name \a name.
+  bool IsNodeNameInUse(const char* name);
+
   /// Get a NodeReferences iterator for a node reference.
   NodeReferencesType::iterator FindNodeReference(const char* referencedId, vtkMRMLNode* referencingNode);
 
@@ -837,6 +985,16 @@ protected:
   std::list< vtkCollection* >  UndoStack;
   std::list< vtkCollection* >  RedoStack;
 
+  // Last copy of each node saved in the undo stack, see GetUndoSnapshot().
+  struct UndoSnapshot
+  {
+    vtkWeakPointer<vtkMRMLNode> Node;
+    vtkSmartPointer<vtkMRMLNode> Snapshot;
+    vtkMTimeType ContentMTime;
+  };
+  std::unordered_map< vtkMRMLNode*, UndoSnapshot > UndoSnapshots;
+  bool SharedUndoSnapshots;
+
   std::string                 URL;
   std::string                 RootDirectory;
 
@@ -851,6 +1009,32 @@ protected:
   std::map< std::string, std::string > ReferencedIDChanges;
   std::map< std::string, vtkSmartPointer<vtkMRMLNode> > NodeIDs;
 
+  // Index used to speedup GetNodesByClass() and related methods.
+  // Keys are the class names that have been queried so far (a node is
+  // listed under all the queried classes it IsA()), values are the matching
+  // nodes with their sequence number in NodeSequenceNumbers.
+  std::map< std::string, NodeClassIndexType > NodesByClass;
+  std::map< vtkMRMLNode*, unsigned long > NodeSequenceNumbers;
+  unsigned long NextNodeSequenceNumber;
+  vtkMTimeType NodesByClassMTime;
+
+  // Number of nodes in the scene for each node name. Used to speedup
+  // GetUniqueNameIndex() and GetFirstNodeByName().
+  std::unordered_map< std::string, int > NodeNames;
+  vtkMTimeType NodeNamesMTime;
+
+  // Serializes the lazy rebuilds and lookups of NodeIDs, NodesByClass and
+  // NodeNames, so that threads reading the scene at the same time (e.g.
+  // processing tasks calling GetNodeByID()) don't rebuild them concurrently.
+  // It does not make it safe to modify the scene while other threads read it.
+  std::recursive_mutex NodeIndexLock;
+
+  // Node IDs referenced in the undo stack. The cache is invalidated when an
+  // undo state is added, modified or removed (see IsNodeIDReservedByUndo()).
+  mutable std::set<std::string> UndoStackReferenceIDs;
+  mutable vtkMTimeType UndoStackReferenceIDsMTime;
+  mutable size_t UndoStackReferenceIDsStackSize;
+
   // Stores default nodes. If a class is created or reset (using CreateNodeByClass or Clear) and
   // a default node is defined for it then the content of the default node will be used to initialize
   // the class. It is useful for overriding default values that are set in a node's constructor.
@@ -866,6 +1050,8 @@ protected:
 
   int ReadDataOnLoad;
 
+  int PrefetchDataOnLoad;
+
   vtkMTimeType  NodeIDsMTime;
 
   void RemoveAllNodes(bool removeSingletons);
@@ -883,6 +1069,12 @@ private:
   /// Returns nonzero on success
   int LoadIntoScene(vtkCollection* scene);
 
+  /// Read concurrently the files of the storage nodes of the nodes in the
+  /// collection. Progress is reported with ProgressState(ImportState).
+  /// Returns the storage nodes that keep the result of the read for ReadData().
+  std::vector<vtkSmartPointer<vtkMRMLStorageNode> > PrefetchStorableNodesData(
+    vtkCollection* nodes, int& progress);
+
   unsigned long ErrorCode;
 
   /// Time when the scene was last read or written.
@@ -164,6 +164,33 @@ void vtkMRMLSegmentationNode::Copy(vtkMRMLNode *anode)
   this->EndModify(wasModified);
 }
 
+//----------------------------------------------------------------------------
+vtkMTimeType vtkMRMLSegmentationNode::GetContentMTime()
+{
+  vtkMTimeType contentMTime = this->Superclass::GetContentMTime();
+  if (!this->Segmentation)
+    {
+    return contentMTime;
+    }
+  contentMTime = std::max(contentMTime, this->Segmentation->GetMTime());
+  for (int segmentIndex = 0; segmentIndex < this->Segmentation->GetNumberOfSegments(); ++segmentIndex)
+    {
+    vtkSegment* segment = this->Segmentation->GetNthSegment(segmentIndex);
+    contentMTime = std::max(contentMTime, segment->GetMTime());
+    std::vector<std::string> representationNames;
+    segment->GetContainedRepresentationNames(representationNames);
+    for (std::vector<std::string>::iterator nameIt = representationNames.begin(); nameIt != representationNames.end(); ++nameIt)
+      {
+      vtkDataObject* representation = segment->GetRepresentation(*nameIt);
+      if (representation)
+        {
+        contentMTime = std::max(contentMTime, representation->GetMTime());
+        }
+      }
+    }
+  return contentMTime;
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLSegmentationNode::DeepCopy(vtkMRMLNode* aNode)
 {
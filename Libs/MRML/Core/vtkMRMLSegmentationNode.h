@@ -74,6 +74,10 @@ public:
   /// Copy the entire contents of the node into this node
   virtual void DeepCopy(vtkMRMLNode* node);
 
+  /// Reimplemented to take into account the modified time of the segments
+  /// and their representations, which are deep copied by Copy().
+  vtkMTimeType GetContentMTime() override;
+
   /// Get unique node XML tag name (like Volume, Model)
   const char* GetNodeTagName() override {return "Segmentation";};
 
@@ -22,6 +22,7 @@ Version:   $Revision: 1.3 $
 #include <vtkCallbackCommand.h>
 
 // STD includes
+#include <algorithm>
 #include <sstream>
 
 const char* vtkMRMLStorableNode::StorageNodeReferenceRole = "storage";
@@ -390,6 +391,12 @@ void vtkMRMLStorableNode::StorableModified()
   this->StorableModifiedTime.Modified();
 }
 
+//---------------------------------------------------------------------------
+vtkMTimeType vtkMRMLStorableNode::GetContentMTime()
+{
+  return std::max(this->Superclass::GetContentMTime(), this->StorableModifiedTime.GetMTime());
+}
+
 //---------------------------------------------------------------------------
 vtkTimeStamp vtkMRMLStorableNode::GetStoredTime()
 {
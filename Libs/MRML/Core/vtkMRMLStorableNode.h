@@ -138,6 +138,10 @@ public:
   /// \sa GetStoredTime() StorableModifiedTime Modified() GetModifiedSinceRead()
   virtual void StorableModified();
 
+  /// Reimplemented to take into account the storable modified time.
+  /// \sa vtkMRMLNode::GetContentMTime()
+  vtkMTimeType GetContentMTime() override;
+
  protected:
   vtkMRMLStorableNode();
   ~vtkMRMLStorableNode() override;
@@ -57,12 +57,44 @@ public:
   /// \sa SetFileName(), ReadDataInternal(), GetStoredTime()
   virtual int ReadData(vtkMRMLNode *refNode, bool temporaryFile = false);
 
+  ///
+  /// Read the file of the referenced node and keep the result in the storage
+  /// node until the next ReadData() call, which then only has to set it in the
+  /// referenced node.
+  /// Neither the scene nor the referenced node are modified and no event is
+  /// invoked, therefore the files of several storage nodes can be prefetched
+  /// concurrently (see vtkMRMLScene::Import()). The caller is responsible for
+  /// checking that the file is local and that the node can be read.
+  /// Errors reported by the storage node during the read are displayed by
+  /// ReadData(), which does not read the file again, so that each error is
+  /// reported once.
+  /// Return 1 if ReadData() uses the result of the read, 0 if prefetching is
+  /// not supported, in which case ReadData() reads the file as usual.
+  /// Not supported by default. Implemented by the model and the volume
+  /// archetype storage nodes. Segmentation storage nodes are not prefetched:
+  /// they read the file directly into the segmentation of the referenced node.
+  /// \sa ReadData(), ClearPrefetchedData()
+  virtual int PrefetchData(vtkMRMLNode *refNode);
+
+  ///
+  /// Release the data read by PrefetchData() that has not been used by ReadData().
+  virtual void ClearPrefetchedData();
+
   ///
   /// Write data from a  referenced node
   /// Return 1 on success, 0 on failure.
   /// NOTE: Subclasses should implement this method
   virtual int WriteData(vtkMRMLNode *refNode);
 
+  ///
+  /// Return true if WriteData() only reads the referenced node and writes
+  /// its own files, so that several storage nodes can write concurrently
+  /// while the scene is not modified (see vtkMRMLScene::WriteStorableNodesData()).
+  /// Modified events of the storage node are then delayed until all the
+  /// files are written.
+  /// Returns false by default.
+  virtual bool CanWriteDataConcurrently();
+
   ///
   /// Write this node's information to a MRML file in XML format.
   void WriteXML(ostream& of, int indent) override;
@@ -42,6 +42,7 @@
 #include <set>
 #include <map>
 #include <algorithm>
+#include <unordered_map>
 
 //----------------------------------------------------------------------------
 const vtkIdType vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID = 0;
@@ -52,6 +53,53 @@ const std::string vtkMRMLSubjectHierarchyNode::SUBJECTHIERARCHY_VERSION_ATTRIBUT
 //----------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLSubjectHierarchyNode);
 
+class vtkSubjectHierarchyItem;
+
+//----------------------------------------------------------------------------
+/// Reverse lookup tables of the items in a subject hierarchy tree, to find items
+/// by data node or UID without traversing the tree.
+/// Items that are part of the tree point to the index of their tree, and keep it
+/// up-to-date when they are added to or removed from the tree and when their data
+/// node or UIDs are set.
+class vtkSubjectHierarchyItemIndex
+{
+public:
+  typedef std::vector<vtkSubjectHierarchyItem*> ItemVector;
+  typedef std::unordered_map<std::string, ItemVector> UIDValueMap;
+
+  /// Add data node and UIDs of an item
+  void AddItem(vtkSubjectHierarchyItem* item);
+  /// Remove data node and UIDs of an item
+  void RemoveItem(vtkSubjectHierarchyItem* item);
+  /// Add UID of an item. UID values are also indexed as lists, by their elements
+  void AddUID(vtkSubjectHierarchyItem* item, const std::string& uidName, const std::string& uidValue);
+  /// Remove UID of an item
+  void RemoveUID(vtkSubjectHierarchyItem* item, const std::string& uidName, const std::string& uidValue);
+
+  /// Find item by associated data node
+  vtkSubjectHierarchyItem* FindItemByDataNode(vtkMRMLNode* dataNode);
+  /// Find item by UID (exact match)
+  vtkSubjectHierarchyItem* FindItemByUID(const std::string& uidName, const std::string& uidValue);
+  /// Find item by UID list containing the given element
+  vtkSubjectHierarchyItem* FindItemByUIDList(const std::string& uidName, const std::string& uidValue);
+
+protected:
+  /// Split UID list on the separator used in vtkMRMLSubjectHierarchyNode::DeserializeUIDList
+  static void GetUIDListElements(const std::string& uidValue, std::vector<std::string>& elements);
+  /// Return the item found first by a depth-first traversal of the tree (as the
+  /// recursive FindChildBy... methods of the items), when several items match
+  static vtkSubjectHierarchyItem* GetFirstItemInTree(const ItemVector& items);
+  /// Get the index of the item and of each of its ancestors among their siblings, from the top
+  static void GetPositionInTree(vtkSubjectHierarchyItem* item, std::vector<size_t>& position);
+  static void AddToVector(ItemVector& items, vtkSubjectHierarchyItem* item);
+  static void RemoveFromVector(ItemVector& items, vtkSubjectHierarchyItem* item);
+
+  std::unordered_map<vtkMRMLNode*, vtkSubjectHierarchyItem*> DataNodeToItem;
+  std::unordered_map<vtkSubjectHierarchyItem*, vtkMRMLNode*> ItemToDataNode;
+  std::unordered_map<std::string, UIDValueMap> UIDToItems;
+  std::unordered_map<std::string, UIDValueMap> UIDListElementToItems;
+};
+
 //----------------------------------------------------------------------------
 class vtkSubjectHierarchyItem : public vtkObject
 {
@@ -107,6 +155,10 @@ public:
   /// It can be static as the item IDs are unique in one application session.
   static std::map<vtkIdType, vtkSubjectHierarchyItem*> ItemCache;
 
+  /// Reverse lookup index of the tree the item belongs to. nullptr if the item
+  /// is not in a tree (e.g. unresolved items)
+  vtkSubjectHierarchyItemIndex* Index;
+
 // Get/set functions
 public:
   /// Add data item to tree under parent, specifying basic properties
@@ -263,6 +315,7 @@ vtkSubjectHierarchyItem::vtkSubjectHierarchyItem()
   , TemporaryID(vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID)
   , TemporaryDataNodeID("")
   , TemporaryParentItemID(vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID)
+  , Index(nullptr)
 {
   this->Children.clear();
   this->Attributes.clear();
@@ -303,6 +356,13 @@ vtkIdType vtkSubjectHierarchyItem::AddToTree(vtkSubjectHierarchyItem* parent, vt
 
     // Add to cache
     vtkSubjectHierarchyItem::ItemCache[this->ID] = this;
+
+    // Add to reverse lookup index of the tree
+    this->Index = parent->Index;
+    if (this->Index)
+      {
+      this->Index->AddItem(this);
+      }
     }
   else
     {
@@ -340,6 +400,13 @@ vtkIdType vtkSubjectHierarchyItem::AddToTree(vtkSubjectHierarchyItem* parent, st
 
     // Add to cache
     vtkSubjectHierarchyItem::ItemCache[this->ID] = this;
+
+    // Add to reverse lookup index of the tree
+    this->Index = parent->Index;
+    if (this->Index)
+      {
+      this->Index->AddItem(this);
+      }
     }
   else if (! ( (!name.compare("Scene") && !level.compare("Scene"))
             || (!name.compare("UnresolvedItems") && !level.compare("UnresolvedItems")) ) )
@@ -1117,6 +1184,11 @@ bool vtkSubjectHierarchyItem::RemoveChild(vtkSubjectHierarchyItem* item)
 
   // Remove from cache
   vtkSubjectHierarchyItem::ItemCache.erase(removedItem->ID);
+  if (removedItem->Index)
+    {
+    removedItem->Index->RemoveItem(removedItem);
+    removedItem->Index = nullptr;
+    }
 
   // Invoke events
   this->InvokeEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemRemovedEvent, item);
@@ -1161,6 +1233,11 @@ bool vtkSubjectHierarchyItem::RemoveChild(vtkIdType itemID)
 
   // Remove from cache
   vtkSubjectHierarchyItem::ItemCache.erase(removedItem->ID);
+  if (removedItem->Index)
+    {
+    removedItem->Index->RemoveItem(removedItem);
+    removedItem->Index = nullptr;
+    }
 
   // Invoke events
   this->InvokeEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemRemovedEvent, removedItem.GetPointer());
@@ -1263,8 +1340,16 @@ void vtkSubjectHierarchyItem::SetUID(std::string uidName, std::string uidValue)
       {
       return; // Do nothing if the UID values match
       }
+    if (this->Index)
+      {
+      this->Index->RemoveUID(this, uidName, this->UIDs[uidName]);
+      }
     }
   this->UIDs[uidName] = uidValue;
+  if (this->Index)
+    {
+    this->Index->AddUID(this, uidName, uidValue);
+    }
   this->InvokeEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemUIDAddedEvent, this);
   this->Modified();
 }
@@ -1408,6 +1493,221 @@ vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::GetAncestorAtLevel(std::string
   return nullptr;
 }
 
+//---------------------------------------------------------------------------
+// vtkSubjectHierarchyItemIndex methods
+
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItemIndex::AddItem(vtkSubjectHierarchyItem* item)
+{
+  if (!item)
+    {
+    return;
+    }
+  if (item->DataNode.GetPointer())
+    {
+    this->DataNodeToItem[item->DataNode.GetPointer()] = item;
+    this->ItemToDataNode[item] = item->DataNode.GetPointer();
+    }
+  for (std::map<std::string, std::string>::iterator uidIt = item->UIDs.begin(); uidIt != item->UIDs.end(); ++uidIt)
+    {
+    this->AddUID(item, uidIt->first, uidIt->second);
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItemIndex::RemoveItem(vtkSubjectHierarchyItem* item)
+{
+  if (!item)
+    {
+    return;
+    }
+  // The data node may have been deleted already, so use the data node pointer stored when indexing
+  std::unordered_map<vtkSubjectHierarchyItem*, vtkMRMLNode*>::iterator itemIt = this->ItemToDataNode.find(item);
+  if (itemIt != this->ItemToDataNode.end())
+    {
+    std::unordered_map<vtkMRMLNode*, vtkSubjectHierarchyItem*>::iterator dataNodeIt = this->DataNodeToItem.find(itemIt->second);
+    if (dataNodeIt != this->DataNodeToItem.end() && dataNodeIt->second == item)
+      {
+      this->DataNodeToItem.erase(dataNodeIt);
+      }
+    this->ItemToDataNode.erase(itemIt);
+    }
+  for (std::map<std::string, std::string>::iterator uidIt = item->UIDs.begin(); uidIt != item->UIDs.end(); ++uidIt)
+    {
+    this->RemoveUID(item, uidIt->first, uidIt->second);
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItemIndex::AddUID(vtkSubjectHierarchyItem* item, const std::string& uidName, const std::string& uidValue)
+{
+  if (!item || uidName.empty() || uidValue.empty())
+    {
+    return;
+    }
+  AddToVector(this->UIDToItems[uidName][uidValue], item);
+
+  std::vector<std::string> elements;
+  GetUIDListElements(uidValue, elements);
+  UIDValueMap& listElementMap = this->UIDListElementToItems[uidName];
+  for (std::vector<std::string>::iterator elementIt = elements.begin(); elementIt != elements.end(); ++elementIt)
+    {
+    AddToVector(listElementMap[*elementIt], item);
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItemIndex::RemoveUID(vtkSubjectHierarchyItem* item, const std::string& uidName, const std::string& uidValue)
+{
+  if (!item || uidName.empty() || uidValue.empty())
+    {
+    return;
+    }
+  std::unordered_map<std::string, UIDValueMap>::iterator nameIt = this->UIDToItems.find(uidName);
+  if (nameIt != this->UIDToItems.end())
+    {
+    UIDValueMap::iterator valueIt = nameIt->second.find(uidValue);
+    if (valueIt != nameIt->second.end())
+      {
+      RemoveFromVector(valueIt->second, item);
+      if (valueIt->second.empty())
+        {
+        nameIt->second.erase(valueIt);
+        }
+      }
+    }
+
+  nameIt = this->UIDListElementToItems.find(uidName);
+  if (nameIt != this->UIDListElementToItems.end())
+    {
+    std::vector<std::string> elements;
+    GetUIDListElements(uidValue, elements);
+    for (std::vector<std::string>::iterator elementIt = elements.begin(); elementIt != elements.end(); ++elementIt)
+      {
+      UIDValueMap::iterator valueIt = nameIt->second.find(*elementIt);
+      if (valueIt != nameIt->second.end())
+        {
+        RemoveFromVector(valueIt->second, item);
+        if (valueIt->second.empty())
+          {
+          nameIt->second.erase(valueIt);
+          }
+        }
+      }
+    }
+}
+
+//---------------------------------------------------------------------------
+vtkSubjectHierarchyItem* vtkSubjectHierarchyItemIndex::FindItemByDataNode(vtkMRMLNode* dataNode)
+{
+  std::unordered_map<vtkMRMLNode*, vtkSubjectHierarchyItem*>::iterator dataNodeIt = this->DataNodeToItem.find(dataNode);
+  if (dataNodeIt == this->DataNodeToItem.end())
+    {
+    return nullptr;
+    }
+  if (dataNodeIt->second->DataNode.GetPointer() != dataNode)
+    {
+    // The indexed data node has been deleted and a new node was allocated at the same address
+    this->ItemToDataNode.erase(dataNodeIt->second);
+    this->DataNodeToItem.erase(dataNodeIt);
+    return nullptr;
+    }
+  return dataNodeIt->second;
+}
+
+//---------------------------------------------------------------------------
+vtkSubjectHierarchyItem* vtkSubjectHierarchyItemIndex::FindItemByUID(const std::string& uidName, const std::string& uidValue)
+{
+  std::unordered_map<std::string, UIDValueMap>::iterator nameIt = this->UIDToItems.find(uidName);
+  if (nameIt == this->UIDToItems.end())
+    {
+    return nullptr;
+    }
+  UIDValueMap::iterator valueIt = nameIt->second.find(uidValue);
+  if (valueIt == nameIt->second.end() || valueIt->second.empty())
+    {
+    return nullptr;
+    }
+  return GetFirstItemInTree(valueIt->second);
+}
+
+//---------------------------------------------------------------------------
+vtkSubjectHierarchyItem* vtkSubjectHierarchyItemIndex::FindItemByUIDList(const std::string& uidName, const std::string& uidValue)
+{
+  std::unordered_map<std::string, UIDValueMap>::iterator nameIt = this->UIDListElementToItems.find(uidName);
+  if (nameIt == this->UIDListElementToItems.end())
+    {
+    return nullptr;
+    }
+  UIDValueMap::iterator valueIt = nameIt->second.find(uidValue);
+  if (valueIt == nameIt->second.end() || valueIt->second.empty())
+    {
+    return nullptr;
+    }
+  return GetFirstItemInTree(valueIt->second);
+}
+
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItemIndex::GetUIDListElements(const std::string& uidValue, std::vector<std::string>& elements)
+{
+  vtkMRMLSubjectHierarchyNode::DeserializeUIDList(uidValue, elements);
+}
+
+//---------------------------------------------------------------------------
+vtkSubjectHierarchyItem* vtkSubjectHierarchyItemIndex::GetFirstItemInTree(const ItemVector& items)
+{
+  if (items.size() == 1)
+    {
+    return items.front();
+    }
+  // Items with the same UID are rare, compare their positions only then
+  vtkSubjectHierarchyItem* firstItem = nullptr;
+  std::vector<size_t> firstPosition;
+  for (ItemVector::const_iterator itemIt = items.begin(); itemIt != items.end(); ++itemIt)
+    {
+    std::vector<size_t> position;
+    GetPositionInTree(*itemIt, position);
+    // an ancestor is a prefix of its descendants, hence found first
+    if (!firstItem || position < firstPosition)
+      {
+      firstItem = *itemIt;
+      firstPosition.swap(position);
+      }
+    }
+  return firstItem;
+}
+
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItemIndex::GetPositionInTree(vtkSubjectHierarchyItem* item, std::vector<size_t>& position)
+{
+  position.clear();
+  for (; item && item->Parent; item = item->Parent)
+    {
+    vtkSubjectHierarchyItem::ChildVector& siblings = item->Parent->Children;
+    size_t index = 0;
+    while (index < siblings.size() && siblings[index].GetPointer() != item)
+      {
+      ++index;
+      }
+    position.push_back(index);
+    }
+  std::reverse(position.begin(), position.end());
+}
+
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItemIndex::AddToVector(ItemVector& items, vtkSubjectHierarchyItem* item)
+{
+  if (std::find(items.begin(), items.end(), item) == items.end())
+    {
+    items.push_back(item);
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItemIndex::RemoveFromVector(ItemVector& items, vtkSubjectHierarchyItem* item)
+{
+  items.erase(std::remove(items.begin(), items.end(), item), items.end());
+}
 
 //---------------------------------------------------------------------------
 //---------------------------------------------------------------------------
@@ -1451,6 +1751,9 @@ public:
   /// Flag indicating whether resolving unresolved items is underway (after scene import or restore)
   bool IsResolving;
 
+  /// Reverse lookup index (data node and UIDs to item) of the items under the scene item
+  vtkSubjectHierarchyItemIndex ItemIndex;
+
 private:
   vtkMRMLSubjectHierarchyNode* External;
 };
@@ -1467,6 +1770,7 @@ vtkMRMLSubjectHierarchyNode::vtkInternal::vtkInternal(vtkMRMLSubjectHierarchyNod
   // Create scene item
   this->SceneItem = vtkSubjectHierarchyItem::New();
   this->SceneItemID = this->SceneItem->AddToTree(nullptr, "Scene", "Scene");
+  this->SceneItem->Index = &this->ItemIndex;
 
   // Create mock item containing unresolved items
   this->UnresolvedItems = vtkSubjectHierarchyItem::New();
@@ -2043,6 +2347,10 @@ void vtkMRMLSubjectHierarchyNode::SetItemDataNode(vtkIdType itemID, vtkMRMLNode*
     }
 
   item->DataNode = dataNode;
+  if (item->Index)
+    {
+    item->Index->AddItem(item);
+    }
 
   // Add observers for data node
   this->Internal->AddItemObservers(item);
@@ -2711,7 +3019,7 @@ bool vtkMRMLSubjectHierarchyNode::ReparentItemByDataNode(vtkIdType itemID, vtkMR
     }
 
   // Get new parent item by the given data node
-  vtkSubjectHierarchyItem* newParentItem = this->Internal->SceneItem->FindChildByDataNode(newParentNode);
+  vtkSubjectHierarchyItem* newParentItem = this->Internal->ItemIndex.FindItemByDataNode(newParentNode);
   if (!newParentItem)
     {
     vtkErrorMacro("ReparentItem: Failed to find subject hierarchy item by data MRML node " << newParentNode->GetName());
@@ -2747,7 +3055,7 @@ vtkIdType vtkMRMLSubjectHierarchyNode::GetItemByUID(const char* uidName, const c
     vtkErrorMacro("GetSubjectHierarchyNodeByUID: Invalid UID name or value");
     return INVALID_ITEM_ID;
     }
-  vtkSubjectHierarchyItem* item = this->Internal->SceneItem->FindChildByUID(uidName, uidValue);
+  vtkSubjectHierarchyItem* item = this->Internal->ItemIndex.FindItemByUID(uidName, uidValue);
   return (item ? item->ID : INVALID_ITEM_ID);
 }
 
@@ -2759,7 +3067,7 @@ vtkIdType vtkMRMLSubjectHierarchyNode::GetItemByUIDList(const char* uidName, con
     vtkErrorMacro("GetSubjectHierarchyItemByUIDList: Invalid UID name or value");
     return INVALID_ITEM_ID;
     }
-  vtkSubjectHierarchyItem* item = this->Internal->SceneItem->FindChildByUIDList(uidName, uidValue);
+  vtkSubjectHierarchyItem* item = this->Internal->ItemIndex.FindItemByUIDList(uidName, uidValue);
   return (item ? item->ID : INVALID_ITEM_ID);
 }
 
@@ -2772,7 +3080,7 @@ vtkIdType vtkMRMLSubjectHierarchyNode::GetItemByDataNode(vtkMRMLNode* dataNode)
     return INVALID_ITEM_ID;
     }
 
-  vtkSubjectHierarchyItem* item = this->Internal->SceneItem->FindChildByDataNode(dataNode);
+  vtkSubjectHierarchyItem* item = this->Internal->ItemIndex.FindItemByDataNode(dataNode);
   return (item ? item->ID : INVALID_ITEM_ID);
 }
 
@@ -3128,7 +3436,7 @@ std::vector<vtkIdType> vtkMRMLSubjectHierarchyNode::GetItemsReferencedFromItemBy
     // Find first referenced item in the subject hierarchy tree
     if (referencedItems.empty())
       {
-      vtkSubjectHierarchyItem* referencedItem = this->Internal->SceneItem->FindChildByUIDList(
+      vtkSubjectHierarchyItem* referencedItem = this->Internal->ItemIndex.FindItemByUIDList(
         vtkMRMLSubjectHierarchyConstants::GetDICOMInstanceUIDName(), (*uidIt) );
       if (referencedItem)
         {
@@ -3153,7 +3461,7 @@ std::vector<vtkIdType> vtkMRMLSubjectHierarchyNode::GetItemsReferencedFromItemBy
       // If the referenced SOP instance UID is not contained in the already found referenced items, then we look in the tree
       if (!foundUidInFoundReferencedItems)
         {
-        vtkSubjectHierarchyItem* referencedItem = this->Internal->SceneItem->FindChildByUIDList(
+        vtkSubjectHierarchyItem* referencedItem = this->Internal->ItemIndex.FindItemByUIDList(
           vtkMRMLSubjectHierarchyConstants::GetDICOMInstanceUIDName(), (*uidIt) );
         if (referencedItem)
           {
@@ -256,13 +256,15 @@ public:
   /// Find subject hierarchy item according to a UID (by exact match)
   /// \param uidName UID string to lookup
   /// \param uidValue UID string that needs to _exactly match_ the UID string of the subject hierarchy item
+  /// \return First match in the order of the tree (depth-first)
   /// \sa GetUID()
   vtkIdType GetItemByUID(const char* uidName, const char* uidValue);
 
   /// Find subject hierarchy item according to a UID (by containing). For example find UID in instance UID list
   /// \param uidName UID string to lookup
-  /// \param uidValue UID string that needs to be _contained_ in the UID string of the subject hierarchy item
-  /// \return First match
+  /// \param uidValue UID string that needs to be _contained_ in the UID string of the subject hierarchy item,
+  ///   i.e. one of the elements of the space-separated UID list (\sa DeserializeUIDList)
+  /// \return First match in the order of the tree (depth-first)
   /// \sa GetUID()
   vtkIdType GetItemByUIDList(const char* uidName, const char* uidValue);
 
@@ -40,6 +40,7 @@
 #include <vtksys/SystemTools.hxx>
 
 // STD includes
+#include <algorithm>
 #include <deque>
 #include <sstream>
 #include <string>
@@ -131,6 +132,30 @@ void vtkMRMLTableNode::ReadXMLAttributes(const char** atts)
 }
 
 
+//----------------------------------------------------------------------------
+vtkMTimeType vtkMRMLTableNode::GetContentMTime()
+{
+  vtkMTimeType contentMTime = this->Superclass::GetContentMTime();
+  if (this->Table)
+    {
+    contentMTime = std::max(contentMTime, this->Table->GetMTime());
+    // Column arrays can be modified without modifying the table
+    for (vtkIdType columnIndex = 0; columnIndex < this->Table->GetNumberOfColumns(); ++columnIndex)
+      {
+      vtkAbstractArray* column = this->Table->GetColumn(columnIndex);
+      if (column)
+        {
+        contentMTime = std::max(contentMTime, column->GetMTime());
+        }
+      }
+    }
+  if (this->Schema)
+    {
+    contentMTime = std::max(contentMTime, this->Schema->GetMTime());
+    }
+  return contentMTime;
+}
+
 //----------------------------------------------------------------------------
 // Copy the node's attributes to this object.
 //
@@ -70,6 +70,11 @@ public:
   /// Copy the node's attributes to this object
   void Copy(vtkMRMLNode *node) override;
 
+  ///
+  /// Reimplemented to take into account the modified time of the table
+  /// and schema, which are deep copied by Copy().
+  vtkMTimeType GetContentMTime() override;
+
   ///
   /// Get node XML tag name (like Volume, Model)
   const char* GetNodeTagName() override { return "Table"; }
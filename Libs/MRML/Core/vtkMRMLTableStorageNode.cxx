@@ -34,18 +34,442 @@
 #include <vtkStringArray.h>
 #include <vtkBitArray.h>
 #include <vtkNew.h>
+#include <vtkSMPTools.h>
+#include <vtksys/FStream.hxx>
 #include <vtksys/SystemTools.hxx>
 
+// STD includes
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <map>
+
 //------------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLTableStorageNode);
 
 const char* COMPONENT_SEPERATOR = "_";
 
+namespace
+{
+
+const char STRING_DELIMITER = '"';
+
+//----------------------------------------------------------------------------
+bool ReadFileContents(const std::string& filename, std::string& contents)
+{
+  vtksys::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!file)
+    {
+    return false;
+    }
+  file.seekg(0, std::ios::end);
+  std::streamoff fileSize = file.tellg();
+  if (fileSize < 0)
+    {
+    return false;
+    }
+  file.seekg(0, std::ios::beg);
+  contents.resize(static_cast<size_t>(fileSize));
+  if (fileSize > 0)
+    {
+    file.read(&contents[0], fileSize);
+    }
+  return !file.fail();
+}
+
+//----------------------------------------------------------------------------
+/// Find the start position of each record (line). Line breaks within quoted values
+/// do not start a new record. Returns false if a quotation mark is not at the start
+/// of a value or a quoted value is not terminated.
+bool FindRecordStarts(const std::string& contents, char fieldDelimiter, std::vector<size_t>& recordStarts)
+{
+  recordStarts.clear();
+  recordStarts.push_back(0);
+  const char* begin = contents.data();
+  const char* end = begin + contents.size();
+  if (contents.find(STRING_DELIMITER) == std::string::npos)
+    {
+    // Fast path: each line break starts a new record
+    for (const char* position = begin; position < end; ++position)
+      {
+      position = static_cast<const char*>(memchr(position, '\n', end - position));
+      if (!position)
+        {
+        break;
+        }
+      recordStarts.push_back(position + 1 - begin);
+      }
+    }
+  else
+    {
+    bool withinString = false;
+    bool valueStart = true;
+    for (const char* position = begin; position < end; ++position)
+      {
+      const char character = *position;
+      if (withinString)
+        {
+        withinString = (character != STRING_DELIMITER);
+        continue;
+        }
+      if (character == STRING_DELIMITER)
+        {
+        if (!valueStart)
+          {
+          return false;
+          }
+        withinString = true;
+        valueStart = false;
+        continue;
+        }
+      if (character == '\n')
+        {
+        recordStarts.push_back(position + 1 - begin);
+        }
+      valueStart = (character == '\n' || character == fieldDelimiter);
+      }
+    if (withinString)
+      {
+      return false;
+      }
+    }
+  // Final line break does not start a new record
+  if (recordStarts.back() == contents.size())
+    {
+    recordStarts.pop_back();
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Get the end of a record, excluding the line break.
+const char* GetRecordEnd(const std::string& contents, const std::vector<size_t>& recordStarts, size_t recordIndex)
+{
+  const char* begin = contents.data();
+  const char* recordEnd = begin + (recordIndex + 1 < recordStarts.size() ? recordStarts[recordIndex + 1] : contents.size());
+  const char* recordBegin = begin + recordStarts[recordIndex];
+  if (recordEnd > recordBegin && *(recordEnd - 1) == '\n')
+    {
+    --recordEnd;
+    }
+  if (recordEnd > recordBegin && *(recordEnd - 1) == '\r')
+    {
+    --recordEnd;
+    }
+  return recordEnd;
+}
+
+//----------------------------------------------------------------------------
+/// Find the value of the field that starts at position.
+/// Returns the position of the field delimiter after the field (or recordEnd),
+/// nullptr if there are characters between the closing quotation mark and the delimiter.
+const char* FindNextField(const char* position, const char* recordEnd, char fieldDelimiter,
+  const char*& valueBegin, const char*& valueEnd)
+{
+  if (position < recordEnd && *position == STRING_DELIMITER)
+    {
+    valueBegin = position + 1;
+    valueEnd = static_cast<const char*>(memchr(valueBegin, STRING_DELIMITER, recordEnd - valueBegin));
+    if (!valueEnd)
+      {
+      return nullptr;
+      }
+    position = valueEnd + 1;
+    if (position < recordEnd && *position != fieldDelimiter)
+      {
+      return nullptr;
+      }
+    return position;
+    }
+  valueBegin = position;
+  valueEnd = static_cast<const char*>(memchr(position, fieldDelimiter, recordEnd - position));
+  if (!valueEnd)
+    {
+    valueEnd = recordEnd;
+    }
+  return valueEnd;
+}
+
+//----------------------------------------------------------------------------
+bool TrimValue(const char*& begin, const char*& end)
+{
+  while (begin < end && isspace(static_cast<unsigned char>(*begin)))
+    {
+    ++begin;
+    }
+  while (end > begin && isspace(static_cast<unsigned char>(*(end - 1))))
+    {
+    --end;
+    }
+  return begin < end;
+}
+
+//----------------------------------------------------------------------------
+// Unlike vtkVariant::ToDouble, strtod also accepts hexadecimal numbers, "inf" and
+// "nan": only decimal numbers (digits, sign, decimal point and exponent) are accepted.
+bool IsDecimalNumber(const char* begin, const char* end)
+{
+  bool hasDigit = false;
+  for (const char* character = begin; character < end; ++character)
+    {
+    if (isdigit(static_cast<unsigned char>(*character)))
+      {
+      hasDigit = true;
+      }
+    else if (!strchr("+-.eE", *character))
+      {
+      return false;
+      }
+    }
+  return hasDigit;
+}
+
+//----------------------------------------------------------------------------
+// The conversion functions parse the value in place: the character after the value
+// is a delimiter, a line break, a quotation mark, or whitespace, which ends the
+// number for strtod and strtol.
+bool ConvertValue(const char* begin, const char* end, double& value)
+{
+  if (!TrimValue(begin, end) || !IsDecimalNumber(begin, end))
+    {
+    return false;
+    }
+  char* parsedEnd = nullptr;
+  value = strtod(begin, &parsedEnd);
+  return parsedEnd == end;
+}
+
+//----------------------------------------------------------------------------
+bool ConvertValue(const char* begin, const char* end, float& value)
+{
+  if (!TrimValue(begin, end) || !IsDecimalNumber(begin, end))
+    {
+    return false;
+    }
+  char* parsedEnd = nullptr;
+  value = strtof(begin, &parsedEnd);
+  return parsedEnd == end;
+}
+
+//----------------------------------------------------------------------------
+template <typename T>
+bool ConvertValue(const char* begin, const char* end, T& value)
+{
+  if (!TrimValue(begin, end))
+    {
+    return false;
+    }
+  // Integers are parsed exactly (all digits of 64-bit values are kept)
+  char* parsedEnd = nullptr;
+  errno = 0;
+  if (std::numeric_limits<T>::is_signed)
+    {
+    long long parsedValue = strtoll(begin, &parsedEnd, 10);
+    if (parsedEnd == end)
+      {
+      if (errno == ERANGE
+        || parsedValue < static_cast<long long>(std::numeric_limits<T>::min())
+        || parsedValue > static_cast<long long>(std::numeric_limits<T>::max()))
+        {
+        return false;
+        }
+      value = static_cast<T>(parsedValue);
+      return true;
+      }
+    }
+  else if (*begin != '-')
+    {
+    unsigned long long parsedValue = strtoull(begin, &parsedEnd, 10);
+    if (parsedEnd == end)
+      {
+      if (errno == ERANGE
+        || parsedValue > static_cast<unsigned long long>(std::numeric_limits<T>::max()))
+        {
+        return false;
+        }
+      value = static_cast<T>(parsedValue);
+      return true;
+      }
+    }
+  // Other numbers (e.g. "1.5" or "1e5") are truncated, as vtkVariant does
+  double parsedValue = 0.0;
+  if (!ConvertValue(begin, end, parsedValue)
+    || !(parsedValue > static_cast<double>(std::numeric_limits<T>::min()) - 1.0)
+    || !(parsedValue < static_cast<double>(std::numeric_limits<T>::max()) + 1.0))
+    {
+    return false;
+    }
+  value = static_cast<T>(parsedValue);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Column (or component of a column) that receives the values of a field of the file
+struct FieldTarget
+{
+  int DataType = VTK_VOID;
+  /// Values of data arrays
+  void* Data = nullptr;
+  /// Values of string arrays
+  vtkStdString* Strings = nullptr;
+  /// Values of bit arrays, stored as one byte per value until the parsing is completed
+  std::vector<char>* Bits = nullptr;
+  int NumberOfComponents = 1;
+  int Component = 0;
+  double NullValue = 0.0;
+  std::atomic<vtkIdType>* NumberOfInvalidValues = nullptr;
+};
+
+//----------------------------------------------------------------------------
+template <typename T>
+void SetTypedValue(const FieldTarget& target, vtkIdType valueIndex, const char* begin, const char* end)
+{
+  T& value = static_cast<T*>(target.Data)[valueIndex];
+  if (!TrimValue(begin, end))
+    {
+    // empty or whitespace-only cell
+    value = static_cast<T>(target.NullValue);
+    return;
+    }
+  if (!ConvertValue(begin, end, value))
+    {
+    value = static_cast<T>(target.NullValue);
+    ++(*target.NumberOfInvalidValues);
+    }
+}
+
+//----------------------------------------------------------------------------
+void SetTargetValue(const FieldTarget& target, vtkIdType row, const char* begin, const char* end)
+{
+  if (target.DataType == VTK_STRING)
+    {
+    if (begin == end)
+      {
+      target.Strings[row].clear();
+      }
+    else
+      {
+      target.Strings[row].assign(begin, end - begin);
+      }
+    return;
+    }
+  if (target.DataType == VTK_BIT)
+    {
+    int value = 0;
+    if (!TrimValue(begin, end))
+      {
+      value = static_cast<int>(target.NullValue);
+      }
+    else if (!ConvertValue(begin, end, value))
+      {
+      value = static_cast<int>(target.NullValue);
+      ++(*target.NumberOfInvalidValues);
+      }
+    (*target.Bits)[row * target.NumberOfComponents + target.Component] = (value != 0);
+    return;
+    }
+  vtkIdType valueIndex = row * target.NumberOfComponents + target.Component;
+  switch (target.DataType)
+    {
+    vtkTemplateMacro(SetTypedValue<VTK_TT>(target, valueIndex, begin, end));
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Number of values that could not be converted to the column type
+struct InvalidValueCounter
+{
+  InvalidValueCounter(const std::string& columnName, int dataType)
+    : ColumnName(columnName), DataType(dataType), NumberOfInvalidValues(0) {}
+  std::string ColumnName;
+  int DataType;
+  std::atomic<vtkIdType> NumberOfInvalidValues;
+};
+
+//----------------------------------------------------------------------------
+// Numbers are written with as many digits as needed to read back the same value
+void AppendNumber(std::string& text, double value)
+{
+  char buffer[32];
+  int length = snprintf(buffer, sizeof(buffer), "%.15g", value);
+  if (strtod(buffer, nullptr) != value)
+    {
+    length = snprintf(buffer, sizeof(buffer), "%.17g", value);
+    }
+  text.append(buffer, length);
+}
+
+//----------------------------------------------------------------------------
+void AppendNumber(std::string& text, float value)
+{
+  char buffer[32];
+  int length = snprintf(buffer, sizeof(buffer), "%.7g", value);
+  if (strtof(buffer, nullptr) != value)
+    {
+    length = snprintf(buffer, sizeof(buffer), "%.9g", value);
+    }
+  text.append(buffer, length);
+}
+
+//----------------------------------------------------------------------------
+template <typename T>
+void AppendNumber(std::string& text, T value)
+{
+  char buffer[32];
+  int length = 0;
+  if (std::numeric_limits<T>::is_signed)
+    {
+    length = snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(value));
+    }
+  else
+    {
+    length = snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(value));
+    }
+  text.append(buffer, length);
+}
+
+//----------------------------------------------------------------------------
+template <typename T>
+void AppendTypedValue(std::string& text, void* data, vtkIdType valueIndex)
+{
+  AppendNumber(text, static_cast<T*>(data)[valueIndex]);
+}
+
+//----------------------------------------------------------------------------
+/// Returns true if all columns of the table can be written by WriteTableTyped.
+bool CanWriteTableTyped(vtkTable* table)
+{
+  for (vtkIdType col = 0; col < table->GetNumberOfColumns(); ++col)
+    {
+    vtkAbstractArray* column = table->GetColumn(col);
+    if (!column || column->GetNumberOfComponents() != 1
+      || !(vtkDataArray::SafeDownCast(column) || vtkStringArray::SafeDownCast(column)))
+      {
+      return false;
+      }
+    if (column->GetDataType() != VTK_STRING && column->GetDataType() != VTK_BIT
+      && !vtkDataArray::SafeDownCast(column)->HasStandardMemoryLayout())
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 vtkMRMLTableStorageNode::vtkMRMLTableStorageNode()
 {
   this->DefaultWriteFileExtension = "tsv";
   this->AutoFindSchema = true;
+  this->UseTypedReaderWriter = true;
 }
 
 //----------------------------------------------------------------------------
@@ -56,6 +480,8 @@ vtkMRMLTableStorageNode::~vtkMRMLTableStorageNode()
 void vtkMRMLTableStorageNode::PrintSelf(ostream& os, vtkIndent indent)
 {
   vtkMRMLStorageNode::PrintSelf(os,indent);
+  os << indent << "AutoFindSchema: " << (this->AutoFindSchema ? "true" : "false") << "\n";
+  os << indent << "UseTypedReaderWriter: " << (this->UseTypedReaderWriter ? "true" : "false") << "\n";
 }
 
 //----------------------------------------------------------------------------
@@ -565,10 +991,26 @@ bool vtkMRMLTableStorageNode::ReadSchema(std::string filename, vtkMRMLTableNode*
 //----------------------------------------------------------------------------
 bool vtkMRMLTableStorageNode::ReadTable(std::string filename, vtkMRMLTableNode* tableNode)
 {
+  std::string fieldDelimiter = this->GetFieldDelimiterCharacters(filename);
+  if (this->UseTypedReaderWriter && fieldDelimiter.size() == 1)
+    {
+    std::string fileContents;
+    if (!ReadFileContents(filename, fileContents))
+      {
+      vtkErrorMacro("vtkMRMLTableStorageNode::ReadTable: failed to read table file: " << filename);
+      return false;
+      }
+    if (this->ReadTableTyped(fileContents, fieldDelimiter[0], tableNode))
+      {
+      return true;
+      }
+    vtkDebugMacro("vtkMRMLTableStorageNode::ReadTable: file " << filename << " is read using vtkDelimitedTextReader");
+    }
+
   vtkNew<vtkDelimitedTextReader> reader;
   reader->SetFileName(filename.c_str());
   reader->SetHaveHeaders(true);
-  reader->SetFieldDelimiterCharacters(this->GetFieldDelimiterCharacters(filename).c_str());
+  reader->SetFieldDelimiterCharacters(fieldDelimiter.c_str());
   // Make sure string delimiter characters are removed (somebody may have written a tsv with string delimiters)
   reader->SetUseStringDelimiter(true);
   // File contents is preserved better if we don't try to detect numeric columns
@@ -601,6 +1043,225 @@ bool vtkMRMLTableStorageNode::ReadTable(std::string filename, vtkMRMLTableNode*
   return true;
 }
 
+//----------------------------------------------------------------------------
+bool vtkMRMLTableStorageNode::ReadTableTyped(const std::string& fileContents, char fieldDelimiter, vtkMRMLTableNode* tableNode)
+{
+  if (fileContents.find('\\') != std::string::npos)
+    {
+    // escape sequences are only interpreted by vtkDelimitedTextReader
+    return false;
+    }
+  std::vector<size_t> recordStarts;
+  if (!FindRecordStarts(fileContents, fieldDelimiter, recordStarts) || recordStarts.empty())
+    {
+    return false;
+    }
+
+  // Header
+  vtkNew<vtkTable> headerTable;
+  const char* headerEnd = GetRecordEnd(fileContents, recordStarts, 0);
+  const char* headerPosition = fileContents.data();
+  while (true)
+    {
+    const char* nameBegin = nullptr;
+    const char* nameEnd = nullptr;
+    headerPosition = FindNextField(headerPosition, headerEnd, fieldDelimiter, nameBegin, nameEnd);
+    if (!headerPosition || nameBegin == nameEnd)
+      {
+      return false;
+      }
+    vtkNew<vtkStringArray> column;
+    column->SetName(std::string(nameBegin, nameEnd).c_str());
+    headerTable->AddColumn(column.GetPointer());
+    if (headerPosition >= headerEnd)
+      {
+      break;
+      }
+    ++headerPosition;
+    }
+  const int numberOfFields = headerTable->GetNumberOfColumns();
+  std::map<vtkAbstractArray*, int> fieldIndices;
+  for (int fieldIndex = 0; fieldIndex < numberOfFields; ++fieldIndex)
+    {
+    fieldIndices[headerTable->GetColumn(fieldIndex)] = fieldIndex;
+    }
+
+  // Empty lines are interpreted by vtkDelimitedTextReader
+  const vtkIdType numberOfRows = static_cast<vtkIdType>(recordStarts.size()) - 1;
+  for (size_t recordIndex = 1; recordIndex < recordStarts.size(); ++recordIndex)
+    {
+    if (GetRecordEnd(fileContents, recordStarts, recordIndex) == fileContents.data() + recordStarts[recordIndex])
+      {
+      return false;
+      }
+    }
+
+  /// Get the info for the columns defined in the schema, the raw component arrays are the empty header columns.
+  std::vector<vtkMRMLTableStorageNode::ColumnInfo> columnDetails = this->GetColumnInfo(tableNode, headerTable.GetPointer());
+
+  // Create the output columns and set where the values of each field are stored
+  vtkSmartPointer<vtkTable> table = vtkSmartPointer<vtkTable>::New();
+  std::vector<std::vector<FieldTarget> > fieldTargets(numberOfFields);
+  std::deque<std::vector<char> > bitValues;
+  std::deque<InvalidValueCounter> invalidValueCounters;
+  std::vector<std::pair<vtkBitArray*, std::vector<char>*> > bitColumns;
+  for (vtkMRMLTableStorageNode::ColumnInfo& columnInfo : columnDetails)
+    {
+    int valueTypeId = columnInfo.ScalarType;
+    if (valueTypeId == VTK_VOID)
+      {
+      // schema is not defined or no valid column type is defined for column
+      valueTypeId = VTK_STRING;
+      }
+    if (valueTypeId == VTK_STRING)
+      {
+      vtkStringArray* rawColumn = (columnInfo.RawComponentArrays.empty() ? nullptr :
+        vtkStringArray::SafeDownCast(columnInfo.RawComponentArrays[0]));
+      if (rawColumn)
+        {
+        rawColumn->SetNumberOfValues(numberOfRows);
+        FieldTarget target;
+        target.DataType = VTK_STRING;
+        target.Strings = rawColumn->GetPointer(0);
+        fieldTargets[fieldIndices[rawColumn]].push_back(target);
+        }
+      this->AddColumnToTable(table, columnInfo);
+      continue;
+      }
+
+    const int numberOfComponents = static_cast<int>(columnInfo.RawComponentArrays.size());
+    vtkSmartPointer<vtkDataArray> typedColumn = vtkSmartPointer<vtkDataArray>::Take(vtkDataArray::CreateDataArray(valueTypeId));
+    typedColumn->SetName(columnInfo.ColumnName.c_str());
+    if (numberOfComponents == 1 && columnInfo.RawComponentArrays[0] != nullptr)
+      {
+      typedColumn->SetName(columnInfo.RawComponentArrays[0]->GetName());
+      }
+    typedColumn->SetNumberOfComponents(std::max(1, numberOfComponents));
+    typedColumn->SetNumberOfTuples(numberOfRows);
+
+    double nullValue = 0.0;
+    if (!columnInfo.NullValueString.empty())
+      {
+      nullValue = vtkVariant(columnInfo.NullValueString).ToDouble();
+      }
+    invalidValueCounters.emplace_back(columnInfo.ColumnName, valueTypeId);
+    std::vector<char>* columnBitValues = nullptr;
+    if (valueTypeId == VTK_BIT)
+      {
+      bitValues.push_back(std::vector<char>(numberOfRows * numberOfComponents, 0));
+      columnBitValues = &bitValues.back();
+      bitColumns.push_back(std::make_pair(vtkBitArray::SafeDownCast(typedColumn), columnBitValues));
+      }
+
+    for (int componentIndex = 0; componentIndex < numberOfComponents; ++componentIndex)
+      {
+      vtkAbstractArray* rawComponentArray = columnInfo.RawComponentArrays[componentIndex];
+      if (rawComponentArray == nullptr)
+        {
+        vtkWarningMacro("vtkMRMLTableStorageNode::ReadTable: Failed to read component for column " << columnInfo.ColumnName);
+        // Components that are not found are filled with the null value
+        if (columnBitValues)
+          {
+          for (vtkIdType row = 0; row < numberOfRows; ++row)
+            {
+            (*columnBitValues)[row * numberOfComponents + componentIndex] = (nullValue != 0.0);
+            }
+          }
+        else
+          {
+          typedColumn->FillComponent(componentIndex, nullValue);
+          }
+        }
+      else
+        {
+        FieldTarget target;
+        target.DataType = valueTypeId;
+        target.Data = (columnBitValues ? nullptr : typedColumn->GetVoidPointer(0));
+        target.Bits = columnBitValues;
+        target.NumberOfComponents = numberOfComponents;
+        target.Component = componentIndex;
+        target.NullValue = nullValue;
+        target.NumberOfInvalidValues = &invalidValueCounters.back().NumberOfInvalidValues;
+        fieldTargets[fieldIndices[rawComponentArray]].push_back(target);
+        }
+      if (componentIndex < static_cast<int>(columnInfo.ComponentNames.size()))
+        {
+        typedColumn->SetComponentName(componentIndex, columnInfo.ComponentNames[componentIndex].c_str());
+        }
+      }
+    table->AddColumn(typedColumn);
+    }
+
+  // Parse the records in parallel, each record sets one row of the columns
+  std::atomic<bool> unsupportedContents(false);
+  auto parseRecords = [&](vtkIdType firstRow, vtkIdType lastRow)
+    {
+    for (vtkIdType row = firstRow; row < lastRow; ++row)
+      {
+      const size_t recordIndex = static_cast<size_t>(row) + 1;
+      const char* recordEnd = GetRecordEnd(fileContents, recordStarts, recordIndex);
+      const char* position = fileContents.data() + recordStarts[recordIndex];
+      int fieldIndex = 0;
+      while (true)
+        {
+        const char* valueBegin = nullptr;
+        const char* valueEnd = nullptr;
+        position = FindNextField(position, recordEnd, fieldDelimiter, valueBegin, valueEnd);
+        if (!position || fieldIndex >= numberOfFields)
+          {
+          // vtkDelimitedTextReader adds columns for extra fields
+          unsupportedContents = true;
+          return;
+          }
+        for (const FieldTarget& target : fieldTargets[fieldIndex])
+          {
+          SetTargetValue(target, row, valueBegin, valueEnd);
+          }
+        ++fieldIndex;
+        if (position >= recordEnd)
+          {
+          break;
+          }
+        ++position;
+        }
+      // Missing fields at the end of the record are empty
+      for (; fieldIndex < numberOfFields; ++fieldIndex)
+        {
+        for (const FieldTarget& target : fieldTargets[fieldIndex])
+          {
+          SetTargetValue(target, row, nullptr, nullptr);
+          }
+        }
+      }
+    };
+  vtkSMPTools::For(0, numberOfRows, parseRecords);
+  if (unsupportedContents)
+    {
+    return false;
+    }
+
+  for (const std::pair<vtkBitArray*, std::vector<char>*>& bitColumn : bitColumns)
+    {
+    const std::vector<char>& values = *bitColumn.second;
+    for (size_t valueIndex = 0; valueIndex < values.size(); ++valueIndex)
+      {
+      bitColumn.first->SetValue(static_cast<vtkIdType>(valueIndex), values[valueIndex]);
+      }
+    }
+  for (const InvalidValueCounter& counter : invalidValueCounters)
+    {
+    if (counter.NumberOfInvalidValues > 0)
+      {
+      vtkWarningMacro("vtkMRMLTableStorageNode::ReadTable: " << counter.NumberOfInvalidValues << " values of column "
+        << counter.ColumnName << " could not be converted to " << vtkMRMLTableNode::GetValueTypeAsString(counter.DataType)
+        << ", they are replaced by the null value");
+      }
+    }
+
+  tableNode->SetAndObserveTable(table);
+  return true;
+}
+
 //----------------------------------------------------------------------------
 bool vtkMRMLTableStorageNode::WriteTable(std::string filename, vtkMRMLTableNode* tableNode)
 {
@@ -648,11 +1309,15 @@ bool vtkMRMLTableStorageNode::WriteTable(std::string filename, vtkMRMLTableNode*
       }
     }
 
+  std::string delimiter = this->GetFieldDelimiterCharacters(filename);
+  if (this->UseTypedReaderWriter && delimiter.size() == 1 && CanWriteTableTyped(newTable))
+    {
+    return this->WriteTableTyped(filename, newTable, delimiter[0]);
+    }
+
   vtkNew<vtkDelimitedTextWriter> writer;
   writer->SetFileName(filename.c_str());
   writer->SetInputData(newTable);
-
-  std::string delimiter = this->GetFieldDelimiterCharacters(filename);
   writer->SetFieldDelimiter(delimiter.c_str());
 
   // SetUseStringDelimiter(true) causes writing each value in double-quotes, which is not very nice,
@@ -681,6 +1346,118 @@ bool vtkMRMLTableStorageNode::WriteTable(std::string filename, vtkMRMLTableNode*
   return true;
 }
 
+//----------------------------------------------------------------------------
+bool vtkMRMLTableStorageNode::WriteTableTyped(std::string filename, vtkTable* table, char fieldDelimiter)
+{
+  // Same format as vtkDelimitedTextWriter: if the delimiter character is the comma then
+  // column names and string values are written in double-quotes.
+  const bool useStringDelimiter = (fieldDelimiter == ',');
+
+  vtksys::ofstream file(filename.c_str(), std::ios::out | std::ios::binary);
+  if (!file)
+    {
+    vtkErrorMacro("vtkMRMLTableStorageNode::WriteTable: failed to open file for writing: " << filename);
+    return false;
+    }
+
+  const int numberOfColumns = table->GetNumberOfColumns();
+  std::string header;
+  for (int col = 0; col < numberOfColumns; ++col)
+    {
+    if (col > 0)
+      {
+      header += fieldDelimiter;
+      }
+    const char* columnName = table->GetColumn(col)->GetName();
+    if (useStringDelimiter)
+      {
+      header += STRING_DELIMITER;
+      }
+    header += (columnName ? columnName : "");
+    if (useStringDelimiter)
+      {
+      header += STRING_DELIMITER;
+      }
+    }
+  header += '\n';
+  file.write(header.data(), header.size());
+
+  // Rows are formatted in parallel in blocks, blocks are written in order
+  const vtkIdType numberOfRows = table->GetNumberOfRows();
+  const vtkIdType rowsPerBlock = 1024;
+  const vtkIdType numberOfBlocks = (numberOfRows + rowsPerBlock - 1) / rowsPerBlock;
+  const vtkIdType blocksPerBatch = 4 * std::max(1, vtkSMPTools::GetEstimatedNumberOfThreads());
+  std::vector<std::string> blockTexts(blocksPerBatch);
+  for (vtkIdType batchStart = 0; batchStart < numberOfBlocks && file; batchStart += blocksPerBatch)
+    {
+    const vtkIdType batchEnd = std::min(batchStart + blocksPerBatch, numberOfBlocks);
+    auto formatBlocks = [&](vtkIdType firstBlock, vtkIdType lastBlock)
+      {
+      for (vtkIdType block = firstBlock; block < lastBlock; ++block)
+        {
+        std::string& text = blockTexts[block - batchStart];
+        text.clear();
+        const vtkIdType lastRow = std::min((block + 1) * rowsPerBlock, numberOfRows);
+        for (vtkIdType row = block * rowsPerBlock; row < lastRow; ++row)
+          {
+          for (int col = 0; col < numberOfColumns; ++col)
+            {
+            if (col > 0)
+              {
+              text += fieldDelimiter;
+              }
+            vtkAbstractArray* column = table->GetColumn(col);
+            if (row >= column->GetNumberOfTuples())
+              {
+              continue;
+              }
+            const int dataType = column->GetDataType();
+            if (dataType == VTK_STRING)
+              {
+              if (useStringDelimiter)
+                {
+                text += STRING_DELIMITER;
+                }
+              text += static_cast<vtkStringArray*>(column)->GetValue(row);
+              if (useStringDelimiter)
+                {
+                text += STRING_DELIMITER;
+                }
+              }
+            else if (dataType == VTK_BIT)
+              {
+              text += (static_cast<vtkBitArray*>(column)->GetValue(row) ? '1' : '0');
+              }
+            else
+              {
+              void* data = column->GetVoidPointer(0);
+              switch (dataType)
+                {
+                vtkTemplateMacro(AppendTypedValue<VTK_TT>(text, data, row));
+                }
+              }
+            }
+          text += '\n';
+          }
+        }
+      };
+    vtkSMPTools::For(batchStart, batchEnd, 1, formatBlocks);
+    for (vtkIdType block = batchStart; block < batchEnd; ++block)
+      {
+      const std::string& text = blockTexts[block - batchStart];
+      file.write(text.data(), text.size());
+      }
+    }
+
+  file.close();
+  if (file.fail())
+    {
+    vtkErrorMacro("vtkMRMLTableStorageNode::WriteTable: failed to write file: " << filename);
+    return false;
+    }
+  return true;
+}
+
 //----------------------------------------------------------------------------
 bool vtkMRMLTableStorageNode::WriteSchema(std::string filename, vtkMRMLTableNode* tableNode)
 {
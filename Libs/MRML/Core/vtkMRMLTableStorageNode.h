@@ -69,6 +69,15 @@ public:
   vtkGetMacro(AutoFindSchema, bool);
   vtkBooleanMacro(AutoFindSchema, bool);
 
+  /// If enabled (default), values are parsed directly into arrays of the column
+  /// types defined in the schema and rows are parsed and formatted in parallel.
+  /// Files that use quoting or escaping that this parser does not handle are
+  /// read with vtkDelimitedTextReader.
+  /// If disabled, vtkDelimitedTextReader and vtkDelimitedTextWriter are always used.
+  vtkSetMacro(UseTypedReaderWriter, bool);
+  vtkGetMacro(UseTypedReaderWriter, bool);
+  vtkBooleanMacro(UseTypedReaderWriter, bool);
+
 protected:
   vtkMRMLTableStorageNode();
   ~vtkMRMLTableStorageNode() override;
@@ -119,7 +128,19 @@ protected:
   bool WriteTable(std::string filename, vtkMRMLTableNode* tableNode);
   bool WriteSchema(std::string filename, vtkMRMLTableNode* tableNode);
 
+  /// Parses the file contents directly into typed columns.
+  /// Returns false if the contents cannot be parsed this way (e.g., escape characters
+  /// or quotation marks within values), in this case vtkDelimitedTextReader must be used.
+  /// Empty and whitespace-only cells get the null value of the column. As with
+  /// vtkVariant, numbers must be decimal: hexadecimal numbers, "inf" and "nan" are
+  /// invalid values, replaced by the null value with a warning.
+  bool ReadTableTyped(const std::string& fileContents, char fieldDelimiter, vtkMRMLTableNode* tableNode);
+
+  /// Writes single-component data and string columns of the table.
+  bool WriteTableTyped(std::string filename, vtkTable* table, char fieldDelimiter);
+
   bool AutoFindSchema;
+  bool UseTypedReaderWriter;
 };
 
 #endif
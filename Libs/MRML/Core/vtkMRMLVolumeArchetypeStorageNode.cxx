@@ -36,6 +36,7 @@ Version:   $Revision: 1.6 $
 #include <vtkCallbackCommand.h>
 #include <vtkDataArray.h>
 #include <vtkErrorCode.h>
+#include <vtkErrorSink.h>
 #include <vtkImageChangeInformation.h>
 #include <vtkNew.h>
 #include <vtkPointData.h>
@@ -255,6 +256,115 @@ void ApplyImageSeriesReaderWorkaround(vtkMRMLVolumeArchetypeStorageNode * storag
 }
 } // end of anonymous namespace
 
+//----------------------------------------------------------------------------
+vtkITKArchetypeImageSeriesReader* vtkMRMLVolumeArchetypeStorageNode::InstantiateReader(
+  vtkMRMLNode *refNode, const std::string& fullName)
+{
+  vtkSmartPointer<vtkITKArchetypeImageSeriesReader> reader;
+
+  if (refNode->IsA("vtkMRMLVectorVolumeNode"))
+    {
+    reader.TakeReference(this->InstantiateVectorVolumeReader(fullName));
+    }
+  else if (refNode->IsA("vtkMRMLDiffusionTensorVolumeNode"))
+    {
+    reader = vtkSmartPointer<vtkITKArchetypeDiffusionTensorImageReaderFile>::New();
+    reader->SetSingleFile( this->GetSingleFile() );
+    reader->SetUseOrientationFromFile( this->GetUseOrientationFromFile() );
+    }
+  else
+    {
+    reader = vtkSmartPointer<vtkITKArchetypeImageSeriesScalarReader>::New();
+    reader->SetSingleFile( this->GetSingleFile() );
+    reader->SetUseOrientationFromFile( this->GetUseOrientationFromFile() );
+    }
+
+  if (reader.GetPointer() == nullptr)
+    {
+    return nullptr;
+    }
+
+  // Set the list of file names on the reader
+  reader->ResetFileNames();
+  reader->SetArchetype(fullName.c_str());
+
+  // Workaround
+  ApplyImageSeriesReaderWorkaround(this, reader, fullName);
+
+  // Center image
+  reader->SetOutputScalarTypeToNative();
+  reader->SetDesiredCoordinateOrientationToNative();
+  if (this->CenterImage)
+    {
+    reader->SetUseNativeOriginOff();
+    }
+  else
+    {
+    reader->SetUseNativeOriginOn();
+    }
+
+  reader->Register(nullptr);
+  return reader;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLVolumeArchetypeStorageNode::PrefetchData(vtkMRMLNode *refNode)
+{
+  this->ClearPrefetchedData();
+  if (!vtkMRMLScalarVolumeNode::SafeDownCast(refNode) || this->GetWriteState() == SkippedNoData)
+    {
+    return 0;
+    }
+  std::string fullName = this->GetFullNameFromFileName();
+  if (fullName.empty())
+    {
+    return 0;
+    }
+  vtkSmartPointer<vtkITKArchetypeImageSeriesReader> reader;
+  reader.TakeReference(this->InstantiateReader(refNode, fullName));
+  if (reader.GetPointer() == nullptr)
+    {
+    return 0;
+    }
+  // Errors are not displayed from the worker thread but kept for ReadData(),
+  // which reports them instead of reading the file again.
+  vtkSmartPointer<vtkErrorSink> errorSink = vtkSmartPointer<vtkErrorSink>::New();
+  errorSink->SetObservedObject(reader);
+  std::string errorMessage;
+  try
+    {
+    reader->Update();
+    if (reader->GetErrorCode() != vtkErrorCode::NoError)
+      {
+      errorMessage = std::string(vtkErrorCode::GetStringFromErrorCode(reader->GetErrorCode()));
+      }
+    }
+  catch (itk::ExceptionObject& e)
+    {
+    errorMessage = std::string("ITK exception info: error in ") + e.GetLocation() + "\n"
+                                                + e.GetDescription() + "\n";
+    }
+  catch (...)
+    {
+    errorMessage = "Unknown exception";
+    }
+  errorSink->SetObservedObject(nullptr);
+  this->PrefetchedReader = reader;
+  this->PrefetchedErrorMessage = errorMessage;
+  this->PrefetchedErrors = errorSink;
+  this->PrefetchedFileName = fullName;
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeArchetypeStorageNode::ClearPrefetchedData()
+{
+  this->PrefetchedReader = nullptr;
+  this->PrefetchedErrorMessage.clear();
+  this->PrefetchedErrors = nullptr;
+  this->PrefetchedFileName.clear();
+}
+
 //----------------------------------------------------------------------------
 int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
 {
@@ -298,23 +408,23 @@ int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     }
 
   vtkSmartPointer<vtkITKArchetypeImageSeriesReader> reader;
-
-  if (refNode->IsA("vtkMRMLVectorVolumeNode"))
-    {
-    reader.TakeReference(this->InstantiateVectorVolumeReader(fullName));
-    }
-  else if (refNode->IsA("vtkMRMLDiffusionTensorVolumeNode"))
+  bool prefetched = false;
+  bool readingWorked = true;
+  std::string errorMessage = "";
+  if (this->PrefetchedReader && this->PrefetchedFileName == fullName)
     {
-    reader = vtkSmartPointer<vtkITKArchetypeDiffusionTensorImageReaderFile>::New();
-    reader->SetSingleFile( this->GetSingleFile() );
-    reader->SetUseOrientationFromFile( this->GetUseOrientationFromFile() );
+    // the image has already been read, only report the errors of that read
+    reader = this->PrefetchedReader;
+    prefetched = true;
+    this->PrefetchedErrors->DisplayMessages();
+    errorMessage = this->PrefetchedErrorMessage;
+    readingWorked = errorMessage.empty();
     }
   else
     {
-    reader = vtkSmartPointer<vtkITKArchetypeImageSeriesScalarReader>::New();
-    reader->SetSingleFile( this->GetSingleFile() );
-    reader->SetUseOrientationFromFile( this->GetUseOrientationFromFile() );
+    reader.TakeReference(this->InstantiateReader(refNode, fullName));
     }
+  this->ClearPrefetchedData();
 
   if (reader.GetPointer() == nullptr)
     {
@@ -329,32 +439,14 @@ int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     volNode->SetAndObserveImageData(nullptr);
     }
 
-  // Set the list of file names on the reader
-  reader->ResetFileNames();
-  reader->SetArchetype(fullName.c_str());
-
-  // Workaround
-  ApplyImageSeriesReaderWorkaround(this, reader, fullName);
-
-  // Center image
-  reader->SetOutputScalarTypeToNative();
-  reader->SetDesiredCoordinateOrientationToNative();
-  if (this->CenterImage)
-    {
-    reader->SetUseNativeOriginOff();
-    }
-  else
-    {
-    reader->SetUseNativeOriginOn();
-    }
-
-  bool readingWorked = true;
-  std::string errorMessage = "";
   try
     {
     vtkDebugMacro("ReadDataInternal: right before reader update, reader num files = " << reader->GetNumberOfFileNames());
-    reader->Update();
-    if (reader->GetErrorCode() != vtkErrorCode::NoError)
+    if (!prefetched)
+      {
+      reader->Update();
+      }
+    if (readingWorked && reader->GetErrorCode() != vtkErrorCode::NoError)
       {
       readingWorked = false;
       errorMessage = std::string(vtkErrorCode::GetStringFromErrorCode(reader->GetErrorCode()));
@@ -682,9 +774,11 @@ std::string vtkMRMLVolumeArchetypeStorageNode::UpdateFileList(vtkMRMLNode *refNo
   std::string originalDir = vtksys::SystemTools::GetParentDirectory(oldName.c_str());
   std::vector<std::string> pathComponents;
   vtksys::SystemTools::SplitPath(originalDir.c_str(), pathComponents);
-  // add a temp dir to it
+  // add a temp dir to it, named after the complete file name so that files
+  // of the same directory that are written concurrently use different ones
+  // (e.g. case.T1.nrrd and case.T2.nrrd)
   pathComponents.push_back(std::string("TempWrite") +
-    vtksys::SystemTools::GetFilenameWithoutExtension(oldName));
+    vtksys::SystemTools::GetFilenameName(oldName));
   std::string tempDir = vtksys::SystemTools::JoinPath(pathComponents);
   vtkDebugMacro("UpdateFileList: deleting and then re-creating temp dir "<< tempDir.c_str());
   if (vtksys::SystemTools::FileExists(tempDir.c_str()))
@@ -17,6 +17,10 @@
 
 #include "vtkMRMLStorageNode.h"
 
+// VTK includes
+#include <vtkSmartPointer.h>
+
+class vtkErrorSink;
 class vtkImageData;
 class vtkITKArchetypeImageSeriesReader;
 class vtkMRMLVolumeNode;
@@ -90,6 +94,15 @@ public:
   /// using only wrapped types.
   static void SetMetaDataDictionaryFromReader(vtkMRMLVolumeNode*, vtkITKArchetypeImageSeriesReader*);
 
+  /// Read the image of the volume node from file, the next ReadData() call sets it in the node.
+  /// \sa vtkMRMLStorageNode::PrefetchData()
+  int PrefetchData(vtkMRMLNode *refNode) override;
+  void ClearPrefetchedData() override;
+
+  /// Files are written from the data of the node only, several nodes can be written in parallel.
+  /// \sa vtkMRMLStorageNode::CanWriteDataConcurrently()
+  bool CanWriteDataConcurrently() override { return true; }
+
 protected:
   vtkMRMLVolumeArchetypeStorageNode();
   ~vtkMRMLVolumeArchetypeStorageNode() override;
@@ -101,6 +114,10 @@ protected:
 
   vtkITKArchetypeImageSeriesReader* InstantiateVectorVolumeReader(const std::string &fullName);
 
+  /// Instantiate the reader for the volume node type and set its file names and options.
+  /// It does not modify the storage node, therefore it can be called from a worker thread.
+  vtkITKArchetypeImageSeriesReader* InstantiateReader(vtkMRMLNode *refNode, const std::string &fullName);
+
   /// Read data and set it in the referenced node
   int ReadDataInternal(vtkMRMLNode *refNode) override;
 
@@ -111,6 +128,12 @@ protected:
   int SingleFile;
   int UseOrientationFromFile;
 
+  /// Reader updated by PrefetchData(), description of the read failure (empty
+  /// if the read succeeded) and reader errors to report in ReadData()
+  vtkSmartPointer<vtkITKArchetypeImageSeriesReader> PrefetchedReader;
+  std::string PrefetchedErrorMessage;
+  vtkSmartPointer<vtkErrorSink> PrefetchedErrors;
+  std::string PrefetchedFileName;
 };
 
 #endif
@@ -29,6 +29,7 @@ vtkObservation::vtkObservation()
 {
   this->EventBroker = nullptr;
   this->InEventQueue = 0;
+  this->Synchronous = 0;
   this->Subject = nullptr;
   this->Event = 0;
   this->Observer = nullptr;
@@ -39,6 +40,8 @@ vtkObservation::vtkObservation()
   this->EventTag = 0;
   this->SubjectDeleteEventTag = 0;
   this->ObserverDeleteEventTag = 0;
+  this->SubjectListIndex = static_cast<size_t>(-1);
+  this->ObserverListIndex = static_cast<size_t>(-1);
 
   this->ObservationCallbackCommand = vtkCallbackCommand::New();
   this->ObservationCallbackCommand->SetCallback( vtkEventBroker::Callback );
@@ -82,6 +85,7 @@ void vtkObservation::PrintSelf(ostream& os, vtkIndent indent)
   else os << indent << "Subject: " << "(none) \n";
 
   os << indent << "Event: " << this->Event << "\n";
+  os << indent << "Synchronous: " << this->Synchronous << "\n";
 
   if ( this->Observer ) os << indent << "Observer: " << this->Observer << "\n";
   else os << indent << "Observer: " << "(none) \n";
@@ -59,6 +59,11 @@ class VTK_MRML_EXPORT vtkObservation : public vtkObject
   vtkGetObjectMacro (EventBroker, vtkEventBroker);
   vtkGetMacro (InEventQueue, int);
   vtkSetMacro (InEventQueue, int);
+  /// If enabled, the observation is invoked immediately even if the event
+  /// broker is in asynchronous or coalescing mode. Off by default.
+  vtkGetMacro (Synchronous, int);
+  vtkSetMacro (Synchronous, int);
+  vtkBooleanMacro (Synchronous, int);
   vtkGetObjectMacro (ObservationCallbackCommand, vtkCallbackCommand);
   vtkGetObjectMacro (Subject, vtkObject);
   void AssignSubject(vtkObject* subject) {this->Subject = subject;};
@@ -119,6 +124,11 @@ protected:
   /// to be re-added
   int InEventQueue;
 
+  ///
+  /// Flag that tells the broker to always invoke the observation
+  /// immediately
+  int Synchronous;
+
   ///
   /// Holder for Subject
   vtkObject *Subject;
@@ -160,6 +170,13 @@ protected:
   double LastElapsedTime;
   double TotalElapsedTime;
 
+private:
+  ///
+  /// Position of the observation in the subject and observer observation
+  /// lists of the event broker (-1 if not in the list)
+  friend class vtkEventBroker;
+  size_t SubjectListIndex;
+  size_t ObserverListIndex;
 };
 
 //----------------------------------------------------------------------------
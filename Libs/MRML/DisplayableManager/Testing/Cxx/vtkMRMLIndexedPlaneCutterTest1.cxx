@@ -0,0 +1,184 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRMLDisplayableManager includes
+#include <vtkMRMLIndexedPlaneCutter.h>
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkCutter.h>
+#include <vtkDoubleArray.h>
+#include <vtkIdList.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkPlane.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSphereSource.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <cmath>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+double GetTotalLineLength(vtkPolyData* polyData)
+{
+  double length = 0.0;
+  vtkCellArray* lines = polyData->GetLines();
+  vtkNew<vtkIdList> pointIds;
+  lines->InitTraversal();
+  while (lines->GetNextCell(pointIds.GetPointer()))
+    {
+    for (vtkIdType i = 1; i < pointIds->GetNumberOfIds(); ++i)
+      {
+      double p0[3];
+      double p1[3];
+      polyData->GetPoint(pointIds->GetId(i - 1), p0);
+      polyData->GetPoint(pointIds->GetId(i), p1);
+      length += std::sqrt(vtkMath::Distance2BetweenPoints(p0, p1));
+      }
+    }
+  return length;
+}
+
+//----------------------------------------------------------------------------
+int CompareCutters(vtkCutter* referenceCutter, vtkMRMLIndexedPlaneCutter* indexedCutter)
+{
+  referenceCutter->Update();
+  indexedCutter->Update();
+  vtkPolyData* expected = referenceCutter->GetOutput();
+  vtkPolyData* actual = indexedCutter->GetOutput();
+  CHECK_INT(actual->GetNumberOfPoints(), expected->GetNumberOfPoints());
+  CHECK_INT(actual->GetNumberOfLines(), expected->GetNumberOfLines());
+  CHECK_DOUBLE_TOLERANCE(GetTotalLineLength(actual), GetTotalLineLength(expected), 1e-3);
+  if (expected->GetNumberOfPoints() > 0)
+    {
+    double expectedBounds[6];
+    double actualBounds[6];
+    expected->GetBounds(expectedBounds);
+    actual->GetBounds(actualBounds);
+    for (int i = 0; i < 6; ++i)
+      {
+      CHECK_DOUBLE_TOLERANCE(actualBounds[i], expectedBounds[i], 1e-3);
+      }
+    // point data is interpolated
+    vtkDataArray* expectedScalars = expected->GetPointData()->GetArray("Elevation");
+    vtkDataArray* actualScalars = actual->GetPointData()->GetArray("Elevation");
+    CHECK_NOT_NULL(actualScalars);
+    CHECK_DOUBLE_TOLERANCE(actualScalars->GetRange()[0], expectedScalars->GetRange()[0], 1e-3);
+    CHECK_DOUBLE_TOLERANCE(actualScalars->GetRange()[1], expectedScalars->GetRange()[1], 1e-3);
+    }
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMRMLIndexedPlaneCutterTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  // Dense surface: about 2 million triangles
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetRadius(100.0);
+  sphere->SetThetaResolution(1000);
+  sphere->SetPhiResolution(1000);
+  sphere->Update();
+  vtkNew<vtkPolyData> mesh;
+  mesh->DeepCopy(sphere->GetOutput());
+  vtkNew<vtkDoubleArray> elevation;
+  elevation->SetName("Elevation");
+  elevation->SetNumberOfTuples(mesh->GetNumberOfPoints());
+  for (vtkIdType pointId = 0; pointId < mesh->GetNumberOfPoints(); ++pointId)
+    {
+    elevation->SetValue(pointId, mesh->GetPoint(pointId)[0]);
+    }
+  mesh->GetPointData()->AddArray(elevation.GetPointer());
+  std::cout << "Number of cells: " << mesh->GetNumberOfCells() << std::endl;
+
+  vtkNew<vtkPlane> plane;
+  plane->SetNormal(0.0, 0.0, 1.0);
+
+  vtkNew<vtkCutter> referenceCutter;
+  referenceCutter->SetCutFunction(plane.GetPointer());
+  referenceCutter->SetGenerateCutScalars(0);
+  referenceCutter->SetInputData(mesh.GetPointer());
+
+  vtkNew<vtkMRMLIndexedPlaneCutter> indexedCutter;
+  indexedCutter->SetPlane(plane.GetPointer());
+  indexedCutter->SetInputData(mesh.GetPointer());
+
+  // Scroll through the mesh, along an axis and along an oblique direction
+  double normals[2][3] = { { 0.0, 0.0, 1.0 }, { 0.3, -0.5, 0.8 } };
+  const int numberOfOffsets = 50;
+  for (int normalIndex = 0; normalIndex < 2; ++normalIndex)
+    {
+    double* normal = normals[normalIndex];
+    vtkMath::Normalize(normal);
+    plane->SetNormal(normal);
+    const int numberOfIndexBuilds = indexedCutter->GetNumberOfIndexBuilds();
+
+    vtkNew<vtkTimerLog> timer;
+    double referenceTime = 0.0;
+    double indexedTime = 0.0;
+    for (int offsetIndex = 0; offsetIndex <= numberOfOffsets; ++offsetIndex)
+      {
+      // scroll beyond the mesh on both sides
+      double offset = -110.0 + 220.0 * offsetIndex / numberOfOffsets;
+      plane->SetOrigin(offset * normal[0], offset * normal[1], offset * normal[2]);
+
+      timer->StartTimer();
+      referenceCutter->Update();
+      timer->StopTimer();
+      referenceTime += timer->GetElapsedTime();
+
+      timer->StartTimer();
+      indexedCutter->Update();
+      timer->StopTimer();
+      indexedTime += timer->GetElapsedTime();
+
+      CHECK_EXIT_SUCCESS(CompareCutters(referenceCutter.GetPointer(), indexedCutter.GetPointer()));
+      CHECK_BOOL(indexedCutter->GetNumberOfTestedCells() < mesh->GetNumberOfCells() / 10, true);
+      }
+
+    // the index is built once for all the slice offsets
+    CHECK_INT(indexedCutter->GetNumberOfIndexBuilds(), numberOfIndexBuilds + 1);
+
+    std::cout << "Scrolling through " << numberOfOffsets + 1 << " offsets: vtkCutter "
+              << (numberOfOffsets + 1) / referenceTime << " fps, indexed cutter "
+              << (numberOfOffsets + 1) / indexedTime << " fps" << std::endl;
+    }
+
+  // Mesh change rebuilds the index
+  const int numberOfIndexBuilds = indexedCutter->GetNumberOfIndexBuilds();
+  plane->SetOrigin(0.0, 0.0, 0.0);
+  mesh->GetPoints()->Modified();
+  CHECK_EXIT_SUCCESS(CompareCutters(referenceCutter.GetPointer(), indexedCutter.GetPointer()));
+  CHECK_INT(indexedCutter->GetNumberOfIndexBuilds(), numberOfIndexBuilds + 1);
+
+  // Empty input
+  vtkNew<vtkPolyData> emptyMesh;
+  emptyMesh->SetPoints(vtkNew<vtkPoints>().GetPointer());
+  indexedCutter->SetInputData(emptyMesh.GetPointer());
+  indexedCutter->Update();
+  CHECK_INT(indexedCutter->GetOutput()->GetNumberOfPoints(), 0);
+
+  return EXIT_SUCCESS;
+}
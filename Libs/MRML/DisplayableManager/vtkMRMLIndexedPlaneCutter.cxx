@@ -0,0 +1,345 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRMLDisplayableManager includes
+#include "vtkMRMLIndexedPlaneCutter.h"
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkDoubleArray.h>
+#include <vtkGenericCell.h>
+#include <vtkIdList.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkMath.h>
+#include <vtkMergePoints.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPlane.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkMRMLIndexedPlaneCutter);
+vtkCxxSetObjectMacro(vtkMRMLIndexedPlaneCutter, Plane, vtkPlane);
+
+namespace
+{
+//----------------------------------------------------------------------------
+vtkIdType BucketIndex(double value, double bucketOrigin, double bucketWidth, vtkIdType numberOfBuckets)
+{
+  double index = std::floor((value - bucketOrigin) / bucketWidth);
+  if (index < 0.0)
+    {
+    return 0;
+    }
+  if (index >= static_cast<double>(numberOfBuckets))
+    {
+    return numberOfBuckets - 1;
+    }
+  return static_cast<vtkIdType>(index);
+}
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkMRMLIndexedPlaneCutter::vtkMRMLIndexedPlaneCutter()
+{
+  this->Plane = nullptr;
+  this->NumberOfTestedCells = 0;
+  this->NumberOfIndexBuilds = 0;
+  this->IndexNormal[0] = 0.0;
+  this->IndexNormal[1] = 0.0;
+  this->IndexNormal[2] = 0.0;
+  this->BucketOrigin = 0.0;
+  this->BucketWidth = 1.0;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLIndexedPlaneCutter::~vtkMRMLIndexedPlaneCutter()
+{
+  this->SetPlane(nullptr);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIndexedPlaneCutter::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Plane: " << this->Plane << "\n";
+  os << indent << "NumberOfTestedCells: " << this->NumberOfTestedCells << "\n";
+  os << indent << "NumberOfIndexBuilds: " << this->NumberOfIndexBuilds << "\n";
+  os << indent << "NumberOfBuckets: "
+     << (this->BucketOffsets.empty() ? 0 : this->BucketOffsets.size() - 1) << "\n";
+}
+
+//----------------------------------------------------------------------------
+vtkMTimeType vtkMRMLIndexedPlaneCutter::GetMTime()
+{
+  vtkMTimeType mTime = this->Superclass::GetMTime();
+  if (this->Plane)
+    {
+    mTime = std::max(mTime, this->Plane->GetMTime());
+    }
+  return mTime;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLIndexedPlaneCutter::FillInputPortInformation(int vtkNotUsed(port), vtkInformation* info)
+{
+  info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkPointSet");
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIndexedPlaneCutter::BuildIndex(vtkPointSet* input, const double normal[3])
+{
+  const vtkIdType numberOfPoints = input->GetNumberOfPoints();
+  const vtkIdType numberOfCells = input->GetNumberOfCells();
+
+  std::vector<double> pointProjections(numberOfPoints);
+  for (vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+    {
+    double point[3];
+    input->GetPoint(pointId, point);
+    pointProjections[pointId] = vtkMath::Dot(normal, point);
+    }
+
+  // Extent of the cells along the normal. Cells without points get an empty
+  // range (minimum > maximum) and are never contoured.
+  this->CellRanges.assign(2 * numberOfCells, 0.0);
+  double minimum = VTK_DOUBLE_MAX;
+  double maximum = -VTK_DOUBLE_MAX;
+  double sumOfCellExtents = 0.0;
+  vtkIdType numberOfIndexedCells = 0;
+  vtkNew<vtkIdList> cellPointIds;
+  for (vtkIdType cellId = 0; cellId < numberOfCells; ++cellId)
+    {
+    input->GetCellPoints(cellId, cellPointIds.GetPointer());
+    const vtkIdType numberOfCellPoints = cellPointIds->GetNumberOfIds();
+    double cellMinimum = 1.0;
+    double cellMaximum = 0.0;
+    if (numberOfCellPoints > 0)
+      {
+      cellMinimum = cellMaximum = pointProjections[cellPointIds->GetId(0)];
+      for (vtkIdType i = 1; i < numberOfCellPoints; ++i)
+        {
+        double projection = pointProjections[cellPointIds->GetId(i)];
+        cellMinimum = std::min(cellMinimum, projection);
+        cellMaximum = std::max(cellMaximum, projection);
+        }
+      minimum = std::min(minimum, cellMinimum);
+      maximum = std::max(maximum, cellMaximum);
+      sumOfCellExtents += cellMaximum - cellMinimum;
+      ++numberOfIndexedCells;
+      }
+    this->CellRanges[2 * cellId] = cellMinimum;
+    this->CellRanges[2 * cellId + 1] = cellMaximum;
+    }
+
+  // Buckets are about as wide as the cells (so that most cells are in one or
+  // two buckets), with no more buckets than cells.
+  vtkIdType numberOfBuckets = 1;
+  this->BucketOrigin = 0.0;
+  this->BucketWidth = 1.0;
+  if (numberOfIndexedCells > 0)
+    {
+    const double range = maximum - minimum;
+    const double averageCellExtent = sumOfCellExtents / numberOfIndexedCells;
+    this->BucketOrigin = minimum;
+    this->BucketWidth = std::max(averageCellExtent, range / numberOfIndexedCells);
+    if (this->BucketWidth <= 0.0)
+      {
+      // all the cells are in a plane orthogonal to the normal
+      this->BucketWidth = 1.0;
+      }
+    numberOfBuckets = std::min(numberOfIndexedCells,
+      static_cast<vtkIdType>(range / this->BucketWidth) + 1);
+    }
+
+  // Counting sort of the cells into the buckets, cell ids remain sorted in each bucket
+  this->BucketOffsets.assign(numberOfBuckets + 1, 0);
+  for (vtkIdType cellId = 0; cellId < numberOfCells; ++cellId)
+    {
+    const double* cellRange = &this->CellRanges[2 * cellId];
+    if (cellRange[0] > cellRange[1])
+      {
+      continue;
+      }
+    vtkIdType lastBucket = BucketIndex(cellRange[1], this->BucketOrigin, this->BucketWidth, numberOfBuckets);
+    for (vtkIdType bucket = BucketIndex(cellRange[0], this->BucketOrigin, this->BucketWidth, numberOfBuckets);
+      bucket <= lastBucket; ++bucket)
+      {
+      ++this->BucketOffsets[bucket + 1];
+      }
+    }
+  for (vtkIdType bucket = 0; bucket < numberOfBuckets; ++bucket)
+    {
+    this->BucketOffsets[bucket + 1] += this->BucketOffsets[bucket];
+    }
+  this->BucketCellIds.resize(this->BucketOffsets.back());
+  std::vector<vtkIdType> insertPositions(this->BucketOffsets.begin(), this->BucketOffsets.end() - 1);
+  for (vtkIdType cellId = 0; cellId < numberOfCells; ++cellId)
+    {
+    const double* cellRange = &this->CellRanges[2 * cellId];
+    if (cellRange[0] > cellRange[1])
+      {
+      continue;
+      }
+    vtkIdType lastBucket = BucketIndex(cellRange[1], this->BucketOrigin, this->BucketWidth, numberOfBuckets);
+    for (vtkIdType bucket = BucketIndex(cellRange[0], this->BucketOrigin, this->BucketWidth, numberOfBuckets);
+      bucket <= lastBucket; ++bucket)
+      {
+      this->BucketCellIds[insertPositions[bucket]++] = cellId;
+      }
+    }
+
+  this->IndexNormal[0] = normal[0];
+  this->IndexNormal[1] = normal[1];
+  this->IndexNormal[2] = normal[2];
+  this->IndexedInput = input;
+  this->IndexBuildTime.Modified();
+  ++this->NumberOfIndexBuilds;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLIndexedPlaneCutter::RequestData(vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** inputVector, vtkInformationVector* outputVector)
+{
+  vtkPointSet* input = vtkPointSet::GetData(inputVector[0]);
+  vtkPolyData* output = vtkPolyData::GetData(outputVector);
+  this->NumberOfTestedCells = 0;
+  if (!this->Plane)
+    {
+    vtkErrorMacro("RequestData: no plane is specified");
+    return 0;
+    }
+  if (!input || !input->GetPoints() || input->GetNumberOfPoints() < 1 || input->GetNumberOfCells() < 1)
+    {
+    return 1;
+    }
+
+  double normal[3];
+  double origin[3];
+  this->Plane->GetNormal(normal);
+  this->Plane->GetOrigin(origin);
+  if (this->IndexedInput != input
+    || this->IndexBuildTime < input->GetMTime()
+    || normal[0] != this->IndexNormal[0]
+    || normal[1] != this->IndexNormal[1]
+    || normal[2] != this->IndexNormal[2])
+    {
+    this->BuildIndex(input, normal);
+    }
+
+  // Cells are selected with a tolerance, as the cell ranges are not computed
+  // the same way as the plane function. Extra cells do not generate output.
+  const double planeValue = vtkMath::Dot(normal, origin);
+  const vtkIdType numberOfBuckets = static_cast<vtkIdType>(this->BucketOffsets.size()) - 1;
+  const double tolerance = 1e-9 * (std::fabs(planeValue) + std::fabs(this->BucketOrigin)
+    + this->BucketWidth * numberOfBuckets);
+  if (planeValue + tolerance < this->BucketOrigin
+    || planeValue - tolerance > this->BucketOrigin + this->BucketWidth * numberOfBuckets)
+    {
+    return 1;
+    }
+  const vtkIdType firstBucket = BucketIndex(planeValue - tolerance, this->BucketOrigin, this->BucketWidth, numberOfBuckets);
+  const vtkIdType lastBucket = BucketIndex(planeValue + tolerance, this->BucketOrigin, this->BucketWidth, numberOfBuckets);
+  std::vector<vtkIdType> cellIds;
+  for (vtkIdType bucket = firstBucket; bucket <= lastBucket; ++bucket)
+    {
+    for (vtkIdType i = this->BucketOffsets[bucket]; i < this->BucketOffsets[bucket + 1]; ++i)
+      {
+      vtkIdType cellId = this->BucketCellIds[i];
+      if (this->CellRanges[2 * cellId] <= planeValue + tolerance
+        && this->CellRanges[2 * cellId + 1] >= planeValue - tolerance)
+        {
+        cellIds.push_back(cellId);
+        }
+      }
+    }
+  if (firstBucket != lastBucket)
+    {
+    // cells spanning several buckets are listed more than once
+    std::sort(cellIds.begin(), cellIds.end());
+    cellIds.erase(std::unique(cellIds.begin(), cellIds.end()), cellIds.end());
+    }
+  this->NumberOfTestedCells = static_cast<vtkIdType>(cellIds.size());
+  if (cellIds.empty())
+    {
+    return 1;
+    }
+
+  // Contour the selected cells the same way as vtkCutter
+  vtkPointData* inPD = input->GetPointData();
+  vtkCellData* inCD = input->GetCellData();
+  vtkPointData* outPD = output->GetPointData();
+  vtkCellData* outCD = output->GetCellData();
+  vtkIdType estimatedSize = std::max<vtkIdType>(1024, static_cast<vtkIdType>(cellIds.size()));
+
+  vtkNew<vtkPoints> newPoints;
+  newPoints->SetDataType(input->GetPoints()->GetDataType());
+  newPoints->Allocate(estimatedSize, estimatedSize / 2);
+  vtkNew<vtkCellArray> newVerts;
+  newVerts->Allocate(estimatedSize, estimatedSize / 2);
+  vtkNew<vtkCellArray> newLines;
+  newLines->Allocate(estimatedSize, estimatedSize / 2);
+  vtkNew<vtkCellArray> newPolys;
+  newPolys->Allocate(estimatedSize, estimatedSize / 2);
+
+  vtkNew<vtkMergePoints> locator;
+  locator->InitPointInsertion(newPoints.GetPointer(), input->GetBounds(), estimatedSize);
+  outPD->InterpolateAllocate(inPD, estimatedSize, estimatedSize);
+  outCD->CopyAllocate(inCD, estimatedSize, estimatedSize);
+
+  vtkNew<vtkGenericCell> cell;
+  vtkNew<vtkDoubleArray> cellScalars;
+  for (vtkIdType cellId : cellIds)
+    {
+    input->GetCell(cellId, cell.GetPointer());
+    vtkPoints* cellPoints = cell->GetPoints();
+    const vtkIdType numberOfCellPoints = cell->GetNumberOfPoints();
+    cellScalars->SetNumberOfTuples(numberOfCellPoints);
+    for (vtkIdType i = 0; i < numberOfCellPoints; ++i)
+      {
+      cellScalars->SetValue(i, this->Plane->EvaluateFunction(cellPoints->GetPoint(i)));
+      }
+    cell->Contour(0.0, cellScalars.GetPointer(), locator.GetPointer(),
+      newVerts.GetPointer(), newLines.GetPointer(), newPolys.GetPointer(),
+      inPD, outPD, inCD, cellId, outCD);
+    }
+
+  output->SetPoints(newPoints.GetPointer());
+  if (newVerts->GetNumberOfCells() > 0)
+    {
+    output->SetVerts(newVerts.GetPointer());
+    }
+  if (newLines->GetNumberOfCells() > 0)
+    {
+    output->SetLines(newLines.GetPointer());
+    }
+  if (newPolys->GetNumberOfCells() > 0)
+    {
+    output->SetPolys(newPolys.GetPointer());
+    }
+  locator->Initialize();
+  output->Squeeze();
+
+  return 1;
+}
@@ -0,0 +1,98 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkMRMLIndexedPlaneCutter_h
+#define __vtkMRMLIndexedPlaneCutter_h
+
+// MRMLDisplayableManager includes
+#include "vtkMRMLDisplayableManagerExport.h"
+
+// VTK includes
+#include <vtkPointSet.h>
+#include <vtkPolyDataAlgorithm.h>
+#include <vtkWeakPointer.h>
+
+// STD includes
+#include <vector>
+
+class vtkPlane;
+
+/// \brief Cut a mesh with a plane, testing only the cells that may intersect it.
+///
+/// The cells of the input vtkPointSet are bucketed by their extent along the
+/// normal of the plane. The index is built when the input mesh or the plane
+/// normal changes and is reused when only the plane origin changes (e.g. when
+/// the slice offset is changed), then only the cells whose extent contains
+/// the plane are contoured.
+///
+/// The output is the same as vtkCutter (without cut scalars): cells are
+/// contoured in increasing cell id order, points are merged and point and cell
+/// data are interpolated.
+class VTK_MRML_DISPLAYABLEMANAGER_EXPORT vtkMRMLIndexedPlaneCutter
+  : public vtkPolyDataAlgorithm
+{
+public:
+  static vtkMRMLIndexedPlaneCutter* New();
+  vtkTypeMacro(vtkMRMLIndexedPlaneCutter, vtkPolyDataAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// Plane used to cut the input.
+  virtual void SetPlane(vtkPlane* plane);
+  vtkGetObjectMacro(Plane, vtkPlane);
+
+  /// Take the plane modified time into account.
+  vtkMTimeType GetMTime() override;
+
+  /// Number of cells that were contoured during the last execution.
+  vtkGetMacro(NumberOfTestedCells, vtkIdType);
+
+  /// Number of times the cell index has been built.
+  vtkGetMacro(NumberOfIndexBuilds, int);
+
+protected:
+  vtkMRMLIndexedPlaneCutter();
+  ~vtkMRMLIndexedPlaneCutter() override;
+
+  int FillInputPortInformation(int port, vtkInformation* info) override;
+  int RequestData(vtkInformation* request, vtkInformationVector** inputVector,
+                  vtkInformationVector* outputVector) override;
+
+  /// Bucket the cells of \a input by their extent along \a normal.
+  void BuildIndex(vtkPointSet* input, const double normal[3]);
+
+  vtkPlane* Plane;
+
+  vtkIdType NumberOfTestedCells;
+  int NumberOfIndexBuilds;
+
+  /// Cell index
+  vtkTimeStamp IndexBuildTime;
+  vtkWeakPointer<vtkPointSet> IndexedInput;
+  double IndexNormal[3];
+  /// Extent of each cell along the normal (minimum, maximum)
+  std::vector<double> CellRanges;
+  /// Bucket i covers [BucketOrigin + i*BucketWidth, BucketOrigin + (i+1)*BucketWidth[
+  double BucketOrigin;
+  double BucketWidth;
+  /// Cells of bucket i are BucketCellIds[BucketOffsets[i]..BucketOffsets[i+1][
+  std::vector<vtkIdType> BucketOffsets;
+  std::vector<vtkIdType> BucketCellIds;
+
+private:
+  vtkMRMLIndexedPlaneCutter(const vtkMRMLIndexedPlaneCutter&) = delete;
+  void operator=(const vtkMRMLIndexedPlaneCutter&) = delete;
+};
+
+#endif
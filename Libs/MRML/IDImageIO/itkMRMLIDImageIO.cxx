@@ -340,6 +340,25 @@ MRMLIDImageIO
       this->SetDWDictionaryValues(thisDic, dw);
       }
 
+    // Publish the scalars of the node so that the buffer can be shared
+    // instead of being copied by Read()
+    MetaDataDictionary &thisDic = this->GetMetaDataDictionary();
+    if (vtkMRMLDiffusionImageVolumeNode::SafeDownCast(node) == nullptr
+        && node->GetImageData() && node->GetImageData()->GetScalarPointer())
+      {
+      // the scalars stay valid while the image IO exists, even if the node
+      // gets new image data
+      this->m_SharedScalars = node->GetImageData()->GetPointData()->GetScalars();
+      char bufferPointer[64];
+      sprintf(bufferPointer, "%p", this->m_SharedScalars->GetVoidPointer(0));
+      EncapsulateMetaData<std::string>(thisDic, "MRMLIDImageIO_BufferPointer", bufferPointer);
+      }
+    else
+      {
+      this->m_SharedScalars = nullptr;
+      thisDic.Erase("MRMLIDImageIO_BufferPointer");
+      }
+
     // Cleanup
     rasToIjk->Delete();
     ijkToRas->Delete();
@@ -631,10 +650,33 @@ MRMLIDImageIO
     int numberOfScalarComponents = 1;
     this->WriteImageInformation(node, img, &scalarType, &numberOfScalarComponents);
 
+    // Adopt the buffer if the writer handed over its ownership, which
+    // requires the whole image to be written at once
+    MetaDataDictionary &thisDic = this->GetMetaDataDictionary();
+    std::string adoptBuffer;
+    char bufferPointer[64];
+    sprintf(bufferPointer, "%p", buffer);
+    bool adopt = vtkMRMLDiffusionTensorVolumeNode::SafeDownCast(node) == nullptr
+      && ExposeMetaData<std::string>(thisDic, "MRMLIDImageIO_AdoptBuffer", adoptBuffer)
+      && adoptBuffer == bufferPointer
+      && this->GetIORegion().GetNumberOfPixels() == this->GetImageSizeInPixels();
+    thisDic.Erase("MRMLIDImageIO_BufferAdopted");
+
     // Allocate the data, copy the data
     //
     //
-    if (vtkMRMLDiffusionTensorVolumeNode::SafeDownCast(node) == nullptr)
+    if (adopt)
+      {
+      vtkDataArray* scalars = vtkDataArray::CreateDataArray(scalarType);
+      scalars->SetNumberOfComponents(numberOfScalarComponents);
+      scalars->SetVoidArray(const_cast<void*>(buffer),
+        static_cast<vtkIdType>(this->GetImageSizeInComponents()), 0,
+        vtkAbstractArray::VTK_DATA_ARRAY_DELETE);
+      img->GetPointData()->SetScalars(scalars);
+      scalars->Delete();
+      EncapsulateMetaData<std::string>(thisDic, "MRMLIDImageIO_BufferAdopted", bufferPointer);
+      }
+    else if (vtkMRMLDiffusionTensorVolumeNode::SafeDownCast(node) == nullptr)
       {
       // Everything but tensor images are passed in the scalars
       img->AllocateScalars(scalarType, numberOfScalarComponents);
@@ -14,6 +14,8 @@
 #pragma warning ( disable : 4786 )
 #endif
 
+#include <vtkDataArray.h>
+#include <vtkSmartPointer.h>
 #include <vtkVersion.h>
 
 #include "itkMRMLIDIOExport.h"
@@ -47,6 +49,18 @@ namespace itk
  *     <code>slicer:\<scene id\>#\<node id\></code>                    - local slicer
  *     <code>slicer://\<hostname\>/\<scene id\>#\<node id\></code>     - remote slicer
  *
+ * To avoid copying large volumes, the pixel buffers can be shared with
+ * the plugin through the meta-data dictionary (see itkPluginUtilities.h):
+ *   - ReadImageInformation() publishes the address of the scalars of the
+ *     node under "MRMLIDImageIO_BufferPointer" so that the image can
+ *     be imported without calling Read(). The image IO keeps a reference
+ *     to the scalars, the image must keep the image IO as long as it
+ *     uses the buffer.
+ *   - Write() adopts the buffer instead of copying it when
+ *     "MRMLIDImageIO_AdoptBuffer" holds the address of the buffer, and
+ *     reports it with "MRMLIDImageIO_BufferAdopted". The writer of the
+ *     buffer must then release its ownership of the memory.
+ *
  * This code was written on the Massachusettes Turnpike with extreme
  * glare on the LCD.
  */
@@ -133,6 +147,8 @@ private:
   std::string m_SceneID;
   std::string m_NodeID;
 
+  /** Scalars published under "MRMLIDImageIO_BufferPointer" */
+  vtkSmartPointer<vtkDataArray> m_SharedScalars;
 };
 
 
@@ -0,0 +1,168 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRMLLogic includes
+#include "vtkImageLabelMapToRGBA.h"
+#include "vtkImageLabelOutline.h"
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkImageMapToRGBA.h>
+#include <vtkLookupTable.h>
+#include <vtkNew.h>
+
+// STD includes
+#include <cmath>
+
+namespace
+{
+
+const int NumberOfLabels = 3;
+const double FillColors[NumberOfLabels + 1][4] = {
+  { 0.0, 0.0, 0.0, 0.0 }, { 1.0, 0.0, 0.0, 0.5 }, { 0.2, 0.8, 0.4, 0.0 }, { 0.3, 0.3, 0.9, 1.0 } };
+const double OutlineColors[NumberOfLabels + 1][4] = {
+  { 0.0, 0.0, 0.0, 0.0 }, { 1.0, 0.0, 0.0, 1.0 }, { 0.2, 0.8, 0.4, 0.7 }, { 0.3, 0.3, 0.9, 0.0 } };
+
+//----------------------------------------------------------------------------
+void CreateLabelmap(vtkImageData* labelmap)
+{
+  labelmap->SetExtent(0, 29, 0, 19, 0, 0);
+  labelmap->AllocateScalars(VTK_SHORT, 1);
+  for (int j = 0; j < 20; ++j)
+    {
+    for (int i = 0; i < 30; ++i)
+      {
+      short label = 0;
+      if (i >= 3 && i < 15 && j >= 2 && j < 12)
+        {
+        label = 1;
+        }
+      if (i >= 10 && i < 22 && j >= 8 && j < 20)
+        {
+        label = 2;
+        }
+      if (i >= 25 && j >= 4 && j < 9)
+        {
+        label = 3;
+        }
+      if (i == 28 && j == 15)
+        {
+        // label without color
+        label = 7;
+        }
+      labelmap->SetScalarComponentFromDouble(i, j, 0, 0, label);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void SetupLookupTable(vtkLookupTable* lookupTable, const double colors[][4])
+{
+  lookupTable->SetNumberOfTableValues(NumberOfLabels + 1);
+  lookupTable->SetRange(0, NumberOfLabels);
+  lookupTable->Build();
+  for (int label = 0; label <= NumberOfLabels; ++label)
+    {
+    lookupTable->SetTableValue(label, colors[label][0], colors[label][1], colors[label][2], colors[label][3]);
+    }
+}
+
+//----------------------------------------------------------------------------
+int TestCompareToLayers(int outline)
+{
+  vtkNew<vtkImageData> labelmap;
+  CreateLabelmap(labelmap.GetPointer());
+
+  // Reference: outline and fill layers, fill drawn over the outline
+  vtkNew<vtkImageLabelOutline> labelOutline;
+  labelOutline->SetInputData(labelmap.GetPointer());
+  labelOutline->SetOutline(outline);
+  vtkNew<vtkLookupTable> outlineLookupTable;
+  SetupLookupTable(outlineLookupTable.GetPointer(), OutlineColors);
+  vtkNew<vtkImageMapToRGBA> outlineColorMapper;
+  outlineColorMapper->SetInputConnection(labelOutline->GetOutputPort());
+  outlineColorMapper->SetLookupTable(outlineLookupTable.GetPointer());
+  outlineColorMapper->Update();
+  vtkNew<vtkLookupTable> fillLookupTable;
+  SetupLookupTable(fillLookupTable.GetPointer(), FillColors);
+  vtkNew<vtkImageMapToRGBA> fillColorMapper;
+  fillColorMapper->SetInputData(labelmap.GetPointer());
+  fillColorMapper->SetLookupTable(fillLookupTable.GetPointer());
+  fillColorMapper->Update();
+
+  vtkNew<vtkImageLabelMapToRGBA> labelMapToRGBA;
+  labelMapToRGBA->SetInputData(labelmap.GetPointer());
+  labelMapToRGBA->SetOutline(outline);
+  for (int label = 1; label <= NumberOfLabels; ++label)
+    {
+    labelMapToRGBA->SetLabelColor(label, FillColors[label], OutlineColors[label]);
+    }
+  CHECK_INT(labelMapToRGBA->GetNumberOfLabelColors(), NumberOfLabels);
+  labelMapToRGBA->Update();
+  vtkImageData* output = labelMapToRGBA->GetOutput();
+  CHECK_INT(output->GetScalarType(), VTK_UNSIGNED_CHAR);
+  CHECK_INT(output->GetNumberOfScalarComponents(), 4);
+
+  for (int j = 0; j < 20; ++j)
+    {
+    for (int i = 0; i < 30; ++i)
+      {
+      unsigned char* fill = static_cast<unsigned char*>(fillColorMapper->GetOutput()->GetScalarPointer(i, j, 0));
+      unsigned char* outlineColor = static_cast<unsigned char*>(outlineColorMapper->GetOutput()->GetScalarPointer(i, j, 0));
+      unsigned char* color = static_cast<unsigned char*>(output->GetScalarPointer(i, j, 0));
+      if (labelmap->GetScalarComponentAsDouble(i, j, 0, 0) == 7)
+        {
+        CHECK_INT(color[3], 0);
+        continue;
+        }
+
+      double fillAlpha = fill[3] / 255.0;
+      double outlineAlpha = outlineColor[3] / 255.0;
+      double expectedAlpha = fillAlpha + (1.0 - fillAlpha) * outlineAlpha;
+      CHECK_BOOL(std::fabs(color[3] - expectedAlpha * 255.0) <= 1.0, true);
+      if (expectedAlpha == 0.0)
+        {
+        continue;
+        }
+      for (int c = 0; c < 3; ++c)
+        {
+        double expectedComponent = (fillAlpha * fill[c] + (1.0 - fillAlpha) * outlineAlpha * outlineColor[c]) / expectedAlpha;
+        if (std::fabs(color[c] - expectedComponent) > 1.0)
+          {
+          std::cerr << "Color mismatch at (" << i << ", " << j << ") component " << c << ": "
+                    << static_cast<int>(color[c]) << " != " << expectedComponent << std::endl;
+          return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkImageLabelMapToRGBATest1(int vtkNotUsed(argc), char * vtkNotUsed(argv) [])
+{
+  vtkNew<vtkImageLabelMapToRGBA> labelMapToRGBA;
+  EXERCISE_BASIC_OBJECT_METHODS(labelMapToRGBA.GetPointer());
+
+  CHECK_EXIT_SUCCESS(TestCompareToLayers(1));
+  CHECK_EXIT_SUCCESS(TestCompareToLayers(2));
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,189 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRMLLogic includes
+#include "vtkSampledDisplacementFieldTransform.h"
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkGeneralTransform.h>
+#include <vtkImageData.h>
+#include <vtkImageReslice.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkThinPlateSplineTransform.h>
+#include <vtkTimerLog.h>
+#include <vtkTransform.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+const int VolumeSize = 128;
+const int SliceSize = 512;
+
+//----------------------------------------------------------------------------
+double ReslicePlane(vtkImageData* volume, vtkAbstractTransform* transform, vtkImageData* output)
+{
+  vtkNew<vtkImageReslice> reslice;
+  reslice->SetInputData(volume);
+  reslice->SetResliceTransform(transform);
+  reslice->SetInterpolationModeToLinear();
+  reslice->SetOutputOrigin(0, 0, 0);
+  reslice->SetOutputSpacing(1, 1, 1);
+  reslice->SetOutputExtent(0, SliceSize - 1, 0, SliceSize - 1, 0, 0);
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  reslice->Update();
+  timer->StopTimer();
+  output->DeepCopy(reslice->GetOutput());
+  return timer->GetElapsedTime();
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkSampledDisplacementFieldTransformTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  // Smooth deformation of the volume
+  vtkNew<vtkPoints> sourceLandmarks;
+  vtkNew<vtkPoints> targetLandmarks;
+  for (int k = 0; k <= 2; ++k)
+    {
+    for (int j = 0; j <= 2; ++j)
+      {
+      for (int i = 0; i <= 2; ++i)
+        {
+        double point[3] = { i * VolumeSize / 2., j * VolumeSize / 2., k * VolumeSize / 2. };
+        sourceLandmarks->InsertNextPoint(point);
+        targetLandmarks->InsertNextPoint(point[0] + 3.0 * std::sin(j + k), point[1] + 2.0 * std::cos(i), point[2] + (i == 1 && j == 1 ? 4.0 : 0.0));
+        }
+      }
+    }
+  vtkNew<vtkThinPlateSplineTransform> warp;
+  warp->SetSourceLandmarks(sourceLandmarks.GetPointer());
+  warp->SetTargetLandmarks(targetLandmarks.GetPointer());
+  warp->SetBasisToR();
+
+  // Slice XY to volume IJK through the inverse of the deformation
+  vtkNew<vtkTransform> xyToRAS;
+  xyToRAS->Translate(0.0, 0.0, VolumeSize / 2.);
+  xyToRAS->Scale(double(VolumeSize) / SliceSize, double(VolumeSize) / SliceSize, 1.0);
+  vtkNew<vtkGeneralTransform> xyToIJK;
+  xyToIJK->PostMultiply();
+  xyToIJK->Concatenate(xyToRAS.GetPointer());
+  xyToIJK->Concatenate(warp->GetInverse());
+
+  vtkNew<vtkSampledDisplacementFieldTransform> sampledXYToIJK;
+  sampledXYToIJK->SetSourceTransform(xyToIJK.GetPointer());
+  sampledXYToIJK->SetExtent(0, SliceSize - 1, 0, SliceSize - 1, 0, 0);
+  const double tolerance = 0.1;
+  sampledXYToIJK->SetTolerance(tolerance);
+
+  // The grid is only built when the transform is used
+  CHECK_INT(sampledXYToIJK->GetNumberOfGridBuilds(), 0);
+  sampledXYToIJK->Update();
+  CHECK_INT(sampledXYToIJK->GetNumberOfGridBuilds(), 1);
+  CHECK_BOOL(sampledXYToIJK->GetSampleSpacing() > 1, true);
+  std::cout << "Sample spacing: " << sampledXYToIJK->GetSampleSpacing() << std::endl;
+
+  double maximumError = 0.0;
+  for (int j = 0; j < SliceSize; ++j)
+    {
+    for (int i = 0; i < SliceSize; ++i)
+      {
+      double xy[3] = { double(i), double(j), 0.0 };
+      double exact[3];
+      double approximated[3];
+      xyToIJK->TransformPoint(xy, exact);
+      sampledXYToIJK->TransformPoint(xy, approximated);
+      maximumError = std::max(maximumError, std::sqrt(vtkMath::Distance2BetweenPoints(exact, approximated)));
+      }
+    }
+  std::cout << "Maximum error: " << maximumError << " voxel" << std::endl;
+  CHECK_BOOL(maximumError < 2 * tolerance, true);
+  CHECK_INT(sampledXYToIJK->GetNumberOfGridBuilds(), 1);
+
+  // Points outside of the extent are computed exactly
+  double outside[3] = { -10.0, SliceSize + 10.0, 0.0 };
+  double exactOutside[3];
+  double approximatedOutside[3];
+  xyToIJK->TransformPoint(outside, exactOutside);
+  sampledXYToIJK->TransformPoint(outside, approximatedOutside);
+  CHECK_DOUBLE(approximatedOutside[0], exactOutside[0]);
+  CHECK_DOUBLE(approximatedOutside[1], exactOutside[1]);
+
+  // Benchmark: reslice through the exact and the approximated transforms
+  vtkNew<vtkImageData> volume;
+  volume->SetDimensions(VolumeSize, VolumeSize, VolumeSize);
+  volume->AllocateScalars(VTK_FLOAT, 1);
+  float* voxels = static_cast<float*>(volume->GetScalarPointer());
+  for (int k = 0; k < VolumeSize; ++k)
+    {
+    for (int j = 0; j < VolumeSize; ++j)
+      {
+      for (int i = 0; i < VolumeSize; ++i)
+        {
+        *(voxels++) = static_cast<float>(i + j + k);
+        }
+      }
+    }
+  vtkNew<vtkImageData> exactSlice;
+  vtkNew<vtkImageData> approximatedSlice;
+  double exactTime = ReslicePlane(volume.GetPointer(), xyToIJK.GetPointer(), exactSlice.GetPointer());
+  // force rebuilding the grid to include it in the time
+  xyToIJK->Modified();
+  double approximatedTime = ReslicePlane(volume.GetPointer(), sampledXYToIJK.GetPointer(), approximatedSlice.GetPointer());
+  CHECK_INT(sampledXYToIJK->GetNumberOfGridBuilds(), 2);
+  std::cout << "Reslicing " << SliceSize << "x" << SliceSize << " pixels: exact transform "
+            << exactTime << "s, sampled displacement field " << approximatedTime << "s" << std::endl;
+
+  // Values change by 1 per voxel along each axis
+  float* exactPixels = static_cast<float*>(exactSlice->GetScalarPointer());
+  float* approximatedPixels = static_cast<float*>(approximatedSlice->GetScalarPointer());
+  double maximumDifference = 0.0;
+  for (int pixelIndex = 0; pixelIndex < SliceSize * SliceSize; ++pixelIndex)
+    {
+    maximumDifference = std::max(maximumDifference, std::fabs(double(exactPixels[pixelIndex]) - approximatedPixels[pixelIndex]));
+    }
+  std::cout << "Maximum pixel difference: " << maximumDifference << std::endl;
+  CHECK_BOOL(maximumDifference < 2 * tolerance * std::sqrt(3.0), true);
+
+  // Source transform modification invalidates the grid
+  warp->SetBasisToR2LogR();
+  sampledXYToIJK->Update();
+  CHECK_INT(sampledXYToIJK->GetNumberOfGridBuilds(), 3);
+
+  // No approximation
+  sampledXYToIJK->SetTolerance(0.0);
+  sampledXYToIJK->Update();
+  CHECK_INT(sampledXYToIJK->GetSampleSpacing(), 0);
+  double xy[3] = { 100.5, 200.25, 0.0 };
+  double exact[3];
+  double approximated[3];
+  xyToIJK->TransformPoint(xy, exact);
+  sampledXYToIJK->TransformPoint(xy, approximated);
+  CHECK_DOUBLE(approximated[0], exact[0]);
+  CHECK_DOUBLE(approximated[1], exact[1]);
+  CHECK_DOUBLE(approximated[2], exact[2]);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,329 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#include "vtkImageLabelMapToRGBA.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkMath.h>
+#include <vtkObjectFactory.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
+
+// STD includes
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Colors of consecutive label values, starting from MinimumLabel.
+/// Labels without a color are stored as fully transparent.
+struct LabelColorTable
+{
+  vtkIdType MinimumLabel = 0;
+  vtkIdType NumberOfLabels = 0;
+  /// RGBA color of non-outline pixels
+  std::vector<unsigned char> Fill;
+  /// RGBA color of outline pixels (fill color drawn over the outline color)
+  std::vector<unsigned char> Outline;
+  /// Non-zero if outline pixels of the label have to be searched for
+  std::vector<unsigned char> OutlineVisible;
+};
+
+//----------------------------------------------------------------------------
+unsigned char ColorComponentToUnsignedChar(double value)
+{
+  // Same quantization as vtkLookupTable
+  return static_cast<unsigned char>(vtkMath::ClampValue(value, 0.0, 1.0) * 255.0 + 0.5);
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+class vtkImageLabelMapToRGBA::vtkInternal
+{
+public:
+  struct LabelColor
+    {
+    double Fill[4];
+    double Outline[4];
+    };
+
+  void UpdateColorTable();
+
+  std::map<int, LabelColor> LabelColors;
+  LabelColorTable ColorTable;
+};
+
+//----------------------------------------------------------------------------
+void vtkImageLabelMapToRGBA::vtkInternal::UpdateColorTable()
+{
+  LabelColorTable& table = this->ColorTable;
+  table.Fill.clear();
+  table.Outline.clear();
+  table.OutlineVisible.clear();
+  if (this->LabelColors.empty())
+    {
+    table.MinimumLabel = 0;
+    table.NumberOfLabels = 0;
+    return;
+    }
+
+  table.MinimumLabel = this->LabelColors.begin()->first;
+  table.NumberOfLabels = static_cast<vtkIdType>(this->LabelColors.rbegin()->first) - table.MinimumLabel + 1;
+  table.Fill.resize(table.NumberOfLabels * 4, 0);
+  table.Outline.resize(table.NumberOfLabels * 4, 0);
+  table.OutlineVisible.resize(table.NumberOfLabels, 0);
+
+  for (std::map<int, LabelColor>::iterator labelColorIt = this->LabelColors.begin();
+    labelColorIt != this->LabelColors.end(); ++labelColorIt)
+    {
+    vtkIdType index = labelColorIt->first - table.MinimumLabel;
+    unsigned char fill[4] = { 0, 0, 0, 0 };
+    unsigned char outline[4] = { 0, 0, 0, 0 };
+    for (int i = 0; i < 4; ++i)
+      {
+      fill[i] = ColorComponentToUnsignedChar(labelColorIt->second.Fill[i]);
+      outline[i] = ColorComponentToUnsignedChar(labelColorIt->second.Outline[i]);
+      }
+    std::copy(fill, fill + 4, table.Fill.begin() + index * 4);
+
+    if (outline[3] == 0)
+      {
+      // Outline is not visible, outline pixels are drawn with the fill color
+      std::copy(fill, fill + 4, table.Outline.begin() + index * 4);
+      continue;
+      }
+    table.OutlineVisible[index] = 1;
+
+    // Fill drawn over the outline
+    double fillAlpha = fill[3] / 255.0;
+    double outlineAlpha = outline[3] / 255.0;
+    double alpha = fillAlpha + (1.0 - fillAlpha) * outlineAlpha;
+    for (int i = 0; i < 3; ++i)
+      {
+      double component = (fillAlpha * fill[i] / 255.0 + (1.0 - fillAlpha) * outlineAlpha * outline[i] / 255.0) / alpha;
+      table.Outline[index * 4 + i] = ColorComponentToUnsignedChar(component);
+      }
+    table.Outline[index * 4 + 3] = ColorComponentToUnsignedChar(alpha);
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkImageLabelMapToRGBA);
+
+//----------------------------------------------------------------------------
+vtkImageLabelMapToRGBA::vtkImageLabelMapToRGBA()
+{
+  this->Internal = new vtkInternal;
+  this->Background = 0.0;
+  this->Outline = 1;
+}
+
+//----------------------------------------------------------------------------
+vtkImageLabelMapToRGBA::~vtkImageLabelMapToRGBA()
+{
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageLabelMapToRGBA::PrintSelf(ostream& os, vtkIndent indent)
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Background: " << this->Background << "\n";
+  os << indent << "Outline: " << this->Outline << "\n";
+  os << indent << "NumberOfLabelColors: " << this->Internal->LabelColors.size() << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkImageLabelMapToRGBA::SetLabelColor(int labelValue, const double fillColor[4], const double outlineColor[4])
+{
+  bool modified = (this->Internal->LabelColors.find(labelValue) == this->Internal->LabelColors.end());
+  vtkInternal::LabelColor& labelColor = this->Internal->LabelColors[labelValue];
+  for (int i = 0; i < 4; ++i)
+    {
+    if (!modified && (labelColor.Fill[i] != fillColor[i] || labelColor.Outline[i] != outlineColor[i]))
+      {
+      modified = true;
+      }
+    labelColor.Fill[i] = fillColor[i];
+    labelColor.Outline[i] = outlineColor[i];
+    }
+  if (modified)
+    {
+    this->Modified();
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageLabelMapToRGBA::RemoveAllLabelColors()
+{
+  if (this->Internal->LabelColors.empty())
+    {
+    return;
+    }
+  this->Internal->LabelColors.clear();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkImageLabelMapToRGBA::GetNumberOfLabelColors()
+{
+  return static_cast<int>(this->Internal->LabelColors.size());
+}
+
+//----------------------------------------------------------------------------
+int vtkImageLabelMapToRGBA::RequestInformation(vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** vtkNotUsed(inputVector), vtkInformationVector* outputVector)
+{
+  vtkInformation* outInfo = outputVector->GetInformationObject(0);
+  vtkDataObject::SetPointDataActiveScalarInfo(outInfo, VTK_UNSIGNED_CHAR, 4);
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageLabelMapToRGBA::RequestUpdateExtent(vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** inputVector, vtkInformationVector* outputVector)
+{
+  vtkInformation* outInfo = outputVector->GetInformationObject(0);
+  vtkInformation* inInfo = inputVector[0]->GetInformationObject(0);
+
+  // Outline pixels depend on the neighborhood in the slice plane
+  int wholeExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  int updateExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExtent);
+  outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), updateExtent);
+  for (int axis = 0; axis < 2; ++axis)
+    {
+    updateExtent[axis * 2] = std::max(updateExtent[axis * 2] - this->Outline, wholeExtent[axis * 2]);
+    updateExtent[axis * 2 + 1] = std::min(updateExtent[axis * 2 + 1] + this->Outline, wholeExtent[axis * 2 + 1]);
+    }
+  inInfo->Set(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), updateExtent, 6);
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageLabelMapToRGBA::RequestData(vtkInformation* request,
+  vtkInformationVector** inputVector, vtkInformationVector* outputVector)
+{
+  // Colors are converted once, before the threads start
+  this->Internal->UpdateColorTable();
+  return this->Superclass::RequestData(request, inputVector, outputVector);
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+static void vtkImageLabelMapToRGBAExecute(vtkImageLabelMapToRGBA* self,
+  vtkImageData* inData, T* vtkNotUsed(inPtr), vtkImageData* outData,
+  int outExt[6], const int wholeExt[6], const LabelColorTable& table)
+{
+  const unsigned char transparent[4] = { 0, 0, 0, 0 };
+  T backgroundLabelValue = static_cast<T>(self->GetBackground());
+  int outline = self->GetOutline();
+
+  vtkIdType inInc0 = 0;
+  vtkIdType inInc1 = 0;
+  vtkIdType inInc2 = 0;
+  inData->GetIncrements(inInc0, inInc1, inInc2);
+  unsigned char* outPtr = static_cast<unsigned char*>(outData->GetScalarPointerForExtent(outExt));
+  vtkIdType outIncX = 0;
+  vtkIdType outIncY = 0;
+  vtkIdType outIncZ = 0;
+  outData->GetContinuousIncrements(outExt, outIncX, outIncY, outIncZ);
+
+  for (int outIdx2 = outExt[4]; outIdx2 <= outExt[5]; ++outIdx2)
+    {
+    for (int outIdx1 = outExt[2]; !self->AbortExecute && outIdx1 <= outExt[3]; ++outIdx1)
+      {
+      // The neighborhood of pixels in this row reaches outside of the image
+      bool rowOnBoundary = (outIdx1 - outline < wholeExt[2] || outIdx1 + outline > wholeExt[3]);
+      T* inPtr0 = static_cast<T*>(inData->GetScalarPointer(outExt[0], outIdx1, outIdx2));
+      for (int outIdx0 = outExt[0]; outIdx0 <= outExt[1]; ++outIdx0, inPtr0 += inInc0, outPtr += 4)
+        {
+        T inLabelValue = *inPtr0;
+        const unsigned char* color = transparent;
+        vtkIdType index = static_cast<vtkIdType>(inLabelValue) - table.MinimumLabel;
+        if (inLabelValue != backgroundLabelValue && index >= 0 && index < table.NumberOfLabels)
+          {
+          color = &table.Fill[index * 4];
+          if (outline > 0 && table.OutlineVisible[index])
+            {
+            // Pixel is on the outline if its neighborhood reaches outside of the image
+            // or contains a different label value.
+            bool outlinePixel = rowOnBoundary
+              || outIdx0 - outline < wholeExt[0] || outIdx0 + outline > wholeExt[1];
+            for (int hoodIdx1 = -outline; !outlinePixel && hoodIdx1 <= outline; ++hoodIdx1)
+              {
+              T* hoodPtr0 = inPtr0 + hoodIdx1 * inInc1 - outline * inInc0;
+              for (int hoodIdx0 = -outline; hoodIdx0 <= outline; ++hoodIdx0, hoodPtr0 += inInc0)
+                {
+                if (*hoodPtr0 != inLabelValue)
+                  {
+                  outlinePixel = true;
+                  break;
+                  }
+                }
+              }
+            if (outlinePixel)
+              {
+              color = &table.Outline[index * 4];
+              }
+            }
+          }
+        memcpy(outPtr, color, 4);
+        }
+      outPtr += outIncY;
+      }
+    outPtr += outIncZ;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageLabelMapToRGBA::ThreadedRequestData(vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** inputVector, vtkInformationVector* vtkNotUsed(outputVector),
+  vtkImageData*** inData, vtkImageData** outData, int outExt[6], int vtkNotUsed(threadId))
+{
+  vtkImageData* input = inData[0][0];
+  vtkImageData* output = outData[0];
+  if (!input || !output)
+    {
+    return;
+    }
+  if (input->GetNumberOfScalarComponents() != 1)
+    {
+    vtkErrorMacro(<< "ThreadedRequestData: Input has " << input->GetNumberOfScalarComponents()
+      << " instead of 1 scalar component.");
+    return;
+    }
+
+  int wholeExt[6] = { 0, -1, 0, -1, 0, -1 };
+  inputVector[0]->GetInformationObject(0)->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExt);
+
+  void* inPtr = input->GetScalarPointerForExtent(outExt);
+  switch (input->GetScalarType())
+    {
+    vtkTemplateMacro(vtkImageLabelMapToRGBAExecute(this, input, static_cast<VTK_TT*>(inPtr),
+      output, outExt, wholeExt, this->Internal->ColorTable));
+    default:
+      vtkErrorMacro(<< "ThreadedRequestData: Unknown input ScalarType");
+      return;
+    }
+}
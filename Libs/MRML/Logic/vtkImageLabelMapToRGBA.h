@@ -0,0 +1,83 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkImageLabelMapToRGBA_h
+#define __vtkImageLabelMapToRGBA_h
+
+#include "vtkMRMLLogicExport.h"
+
+// VTK includes
+#include <vtkThreadedImageAlgorithm.h>
+
+/// \brief Map a labelmap to RGBA colors, drawing filled labels and their outlines in one pass.
+///
+/// Each label value is assigned a fill color and an outline color (RGBA, components
+/// in the 0..1 range). A pixel is an outline pixel if it is not background and a pixel
+/// within Outline pixels of it (in the slice plane) has a different label or is outside
+/// of the image, as in vtkImageLabelOutline.
+///
+/// The output is the fill color drawn over the outline color, which gives the same
+/// result as rendering the output of vtkImageLabelOutline and of the label map,
+/// each mapped to colors by a lookup table, as two layers on top of each other.
+/// Background pixels and labels without color are fully transparent.
+class VTK_MRML_LOGIC_EXPORT vtkImageLabelMapToRGBA : public vtkThreadedImageAlgorithm
+{
+public:
+  static vtkImageLabelMapToRGBA *New();
+  vtkTypeMacro(vtkImageLabelMapToRGBA, vtkThreadedImageAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// Set fill and outline color of a label value.
+  void SetLabelColor(int labelValue, const double fillColor[4], const double outlineColor[4]);
+  /// Remove colors of all label values.
+  void RemoveAllLabelColors();
+  /// Get number of label values that have a color.
+  int GetNumberOfLabelColors();
+
+  /// Background pixel value in the image (usually 0)
+  vtkSetMacro(Background, double);
+  vtkGetMacro(Background, double);
+
+  /// Thickness of the outline in pixels.
+  /// If 0 then outline is not drawn.
+  vtkSetClampMacro(Outline, int, 0, VTK_INT_MAX);
+  vtkGetMacro(Outline, int);
+
+protected:
+  vtkImageLabelMapToRGBA();
+  ~vtkImageLabelMapToRGBA() override;
+
+  int RequestInformation(vtkInformation* request, vtkInformationVector** inputVector,
+    vtkInformationVector* outputVector) override;
+  int RequestUpdateExtent(vtkInformation* request, vtkInformationVector** inputVector,
+    vtkInformationVector* outputVector) override;
+  int RequestData(vtkInformation* request, vtkInformationVector** inputVector,
+    vtkInformationVector* outputVector) override;
+  void ThreadedRequestData(vtkInformation* request, vtkInformationVector** inputVector,
+    vtkInformationVector* outputVector, vtkImageData*** inData, vtkImageData** outData,
+    int outExt[6], int threadId) override;
+
+  double Background;
+  int Outline;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
+private:
+  vtkImageLabelMapToRGBA(const vtkImageLabelMapToRGBA&) = delete;
+  void operator=(const vtkImageLabelMapToRGBA&) = delete;
+};
+
+#endif
@@ -22,6 +22,9 @@
 
 // VTK includes
 #include <vtkCallbackCommand.h>
+#include <vtkCollection.h>
+#include <vtkFloatArray.h>
+#include <vtkIntArray.h>
 #include <vtkObjectFactory.h>
 #include <vtkSmartPointer.h>
 
@@ -353,8 +356,26 @@ void vtkMRMLAbstractLogic::SetAndObserveMRMLSceneEventsInternal(vtkMRMLScene *ne
                                                                 vtkFloatArray *priorities
 )
 {
+  // Nodes added by vtkMRMLScene::AddNodes() are notified in a single event
+  vtkSmartPointer<vtkIntArray> sceneEvents = events;
+  vtkSmartPointer<vtkFloatArray> scenePriorities = priorities;
+  if (events
+    && events->LookupValue(vtkMRMLScene::NodeAddedEvent) >= 0
+    && events->LookupValue(vtkMRMLScene::NodesAddedEvent) < 0)
+    {
+    sceneEvents = vtkSmartPointer<vtkIntArray>::New();
+    sceneEvents->DeepCopy(events);
+    sceneEvents->InsertNextValue(vtkMRMLScene::NodesAddedEvent);
+    if (priorities)
+      {
+      scenePriorities = vtkSmartPointer<vtkFloatArray>::New();
+      scenePriorities->DeepCopy(priorities);
+      scenePriorities->InsertNextValue(
+        priorities->GetValue(events->LookupValue(vtkMRMLScene::NodeAddedEvent)));
+      }
+    }
   this->GetMRMLSceneObserverManager()->SetAndObserveObjectEvents(
-    vtkObjectPointer(&this->Internal->MRMLScene), newScene, events, priorities);
+    vtkObjectPointer(&this->Internal->MRMLScene), newScene, sceneEvents, scenePriorities);
 }
 
 //----------------------------------------------------------------------------
@@ -474,6 +495,9 @@ void vtkMRMLAbstractLogic
       assert(node);
       this->OnMRMLSceneNodeAdded(node);
       break;
+    case vtkMRMLScene::NodesAddedEvent:
+      this->OnMRMLSceneNodesAdded(reinterpret_cast<vtkCollection*>(callData));
+      break;
     case vtkMRMLScene::NodeRemovedEvent:
       node = reinterpret_cast<vtkMRMLNode*>(callData);
       assert(node);
@@ -500,6 +524,21 @@ void vtkMRMLAbstractLogic::UpdateFromMRMLScene()
 {
 }
 
+//---------------------------------------------------------------------------
+void vtkMRMLAbstractLogic::OnMRMLSceneNodesAdded(vtkCollection* nodes)
+{
+  if (!nodes)
+    {
+    return;
+    }
+  vtkMRMLNode* node = nullptr;
+  vtkCollectionSimpleIterator it;
+  for (nodes->InitTraversal(it); (node = vtkMRMLNode::SafeDownCast(nodes->GetNextItemAsObject(it)));)
+    {
+    this->OnMRMLSceneNodeAdded(node);
+    }
+}
+
 //---------------------------------------------------------------------------
 void vtkMRMLAbstractLogic::OnMRMLSceneEndBatchProcess()
 {
@@ -21,6 +21,7 @@ class vtkMRMLScene;
 // VTK includes
 #include <vtkCommand.h>
 #include <vtkObject.h>
+class vtkCollection;
 class vtkIntArray;
 class vtkFloatArray;
 
@@ -302,6 +303,13 @@ protected:
   /// \sa ProcessMRMLSceneEvents, SetMRMLSceneInternal
   /// \sa OnMRMLSceneNodeRemoved, vtkMRMLScene::NodeAboutToBeAdded
   virtual void OnMRMLSceneNodeAdded(vtkMRMLNode* /*node*/){}
+  /// Called when vtkMRMLScene::NodesAddedEvent is fired by
+  /// vtkMRMLScene::AddNodes(). The event is observed automatically if
+  /// vtkMRMLScene::NodeAddedEvent is observed.
+  /// Default implementation calls OnMRMLSceneNodeAdded() for each node of
+  /// \a nodes. Can be reimplemented to process the nodes at once.
+  /// \sa ProcessMRMLSceneEvents, SetMRMLSceneInternal, OnMRMLSceneNodeAdded
+  virtual void OnMRMLSceneNodesAdded(vtkCollection* nodes);
   /// If vtkMRMLScene::NodeRemovedEvent has been set to be observed in
   ///  SetMRMLSceneInternal, it is called when the scene fires the event
   /// \sa ProcessMRMLSceneEvents, SetMRMLSceneInternal
@@ -337,6 +345,9 @@ protected:
   ///   this->SetAndObserveMRMLSceneEventsInternal(newScene, events);
   /// }
   /// \endcode
+  /// vtkMRMLScene::NodesAddedEvent is added to \a events if
+  /// vtkMRMLScene::NodeAddedEvent is in the list, so that nodes added in
+  /// batch are not missed.
   /// \sa SetMRMLSceneInternal()
   void SetAndObserveMRMLSceneEventsInternal(vtkMRMLScene *newScene,
                                             vtkIntArray *events,
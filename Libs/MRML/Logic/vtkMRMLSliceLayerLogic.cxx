@@ -46,6 +46,7 @@
 
 //
 #include "vtkImageLabelOutline.h"
+#include "vtkSampledDisplacementFieldTransform.h"
 
 // STD includes
 #include <algorithm>
@@ -111,6 +112,10 @@ vtkMRMLSliceLayerLogic::vtkMRMLSliceLayerLogic()
   this->XYToIJKTransform = vtkGeneralTransform ::New();
   this->UVWToIJKTransform = vtkGeneralTransform ::New();
 
+  this->NonLinearTransformTolerance = 0.1;
+  this->XYToIJKSampledTransform = vtkSampledDisplacementFieldTransform::New();
+  this->UVWToIJKSampledTransform = vtkSampledDisplacementFieldTransform::New();
+
   this->IsLabelLayer = 0;
 
   this->AssignAttributeTensorsToScalars= vtkAssignAttribute::New();
@@ -166,6 +171,8 @@ vtkMRMLSliceLayerLogic::~vtkMRMLSliceLayerLogic()
 
   this->SetSliceNode(nullptr);
   this->SetVolumeNode(nullptr);
+  this->XYToIJKSampledTransform->Delete();
+  this->UVWToIJKSampledTransform->Delete();
   this->XYToIJKTransform->Delete();
   this->UVWToIJKTransform->Delete();
 
@@ -540,6 +547,15 @@ void vtkMRMLSliceLayerLogic::UpdateTransforms()
       SnapToPermuteMatrix(linearXYToIJKTransform);
       this->Reslice->SetResliceTransform(linearXYToIJKTransform);
       }
+    else if (this->NonLinearTransformTolerance > 0.0)
+      {
+      // Evaluating non-linear transforms (especially inverse ones) at each pixel is slow,
+      // so they are sampled over the slice and interpolated.
+      this->XYToIJKSampledTransform->SetSourceTransform(this->XYToIJKTransform);
+      this->XYToIJKSampledTransform->SetTolerance(this->NonLinearTransformTolerance);
+      this->XYToIJKSampledTransform->SetExtent(0, dimensions[0]-1, 0, dimensions[1]-1, 0, dimensions[2]-1);
+      this->Reslice->SetResliceTransform(this->XYToIJKSampledTransform);
+      }
     else
       {
       this->Reslice->SetResliceTransform(this->XYToIJKTransform);
@@ -550,6 +566,13 @@ void vtkMRMLSliceLayerLogic::UpdateTransforms()
       SnapToPermuteMatrix(linearUVWToIJKTransform);
       this->ResliceUVW->SetResliceTransform( linearUVWToIJKTransform );
       }
+    else if (this->NonLinearTransformTolerance > 0.0)
+      {
+      this->UVWToIJKSampledTransform->SetSourceTransform(this->UVWToIJKTransform);
+      this->UVWToIJKSampledTransform->SetTolerance(this->NonLinearTransformTolerance);
+      this->UVWToIJKSampledTransform->SetExtent(0, dimensionsUVW[0]-1, 0, dimensionsUVW[1]-1, 0, dimensionsUVW[2]-1);
+      this->ResliceUVW->SetResliceTransform( this->UVWToIJKSampledTransform );
+      }
     else
       {
       this->ResliceUVW->SetResliceTransform( this->UVWToIJKTransform );
@@ -591,6 +614,17 @@ void vtkMRMLSliceLayerLogic::UpdateTransforms()
     }
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLSliceLayerLogic::SetNonLinearTransformTolerance(double tolerance)
+{
+  if (this->NonLinearTransformTolerance == tolerance)
+    {
+    return;
+    }
+  this->NonLinearTransformTolerance = tolerance;
+  this->UpdateTransforms();
+}
+
 //----------------------------------------------------------------------------
 vtkImageData* vtkMRMLSliceLayerLogic::GetImageData()
 {
@@ -918,6 +952,7 @@ void vtkMRMLSliceLayerLogic::PrintSelf(ostream& os, vtkIndent indent)
   nextIndent = indent.GetNextIndent();
 
   os << indent << "SlicerSliceLayerLogic:             " << this->GetClassName() << "\n";
+  os << indent << "NonLinearTransformTolerance: " << this->NonLinearTransformTolerance << "\n";
 
   if (this->VolumeNode)
     {
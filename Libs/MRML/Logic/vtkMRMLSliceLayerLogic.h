@@ -55,6 +55,7 @@ class vtkGeneralTransform;
 //#include <cstdlib>
 
 class vtkImageLabelOutline;
+class vtkSampledDisplacementFieldTransform;
 class vtkTransform;
 
 class VTK_MRML_LOGIC_EXPORT vtkMRMLSliceLayerLogic
@@ -129,6 +130,15 @@ public:
   /// The current reslice transform XYToIJK
   vtkGetObjectMacro (XYToIJKTransform, vtkGeneralTransform);
 
+  ///
+  /// Maximum error, in volume voxels, of the approximation of non-linear
+  /// reslice transforms by a displacement field sampled over the slice
+  /// (see vtkSampledDisplacementFieldTransform).
+  /// If 0, non-linear transforms are evaluated for each pixel.
+  /// Default is 0.1.
+  void SetNonLinearTransformTolerance(double tolerance);
+  vtkGetMacro (NonLinearTransformTolerance, double);
+
 
 protected:
   vtkMRMLSliceLayerLogic();
@@ -179,6 +189,12 @@ protected:
   vtkGeneralTransform *XYToIJKTransform;
   vtkGeneralTransform *UVWToIJKTransform;
 
+  /// Approximations of XYToIJKTransform and UVWToIJKTransform used by the
+  /// reslice filters when the transforms are not linear
+  vtkSampledDisplacementFieldTransform *XYToIJKSampledTransform;
+  vtkSampledDisplacementFieldTransform *UVWToIJKSampledTransform;
+  double NonLinearTransformTolerance;
+
   int IsLabelLayer;
 
   int UpdatingTransforms;
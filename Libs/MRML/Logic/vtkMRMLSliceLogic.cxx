@@ -448,6 +448,28 @@ void vtkMRMLSliceLogic::OnMRMLSceneNodeAdded(vtkMRMLNode* node)
   this->UpdateSliceNodes();
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLSliceLogic::OnMRMLSceneNodesAdded(vtkCollection* nodes)
+{
+  if (!nodes)
+    {
+    return;
+    }
+  // Update the slice nodes only once for the whole batch
+  vtkObject* object = nullptr;
+  vtkCollectionSimpleIterator it;
+  for (nodes->InitTraversal(it); (object = nodes->GetNextItemAsObject(it));)
+    {
+    if (object->IsA("vtkMRMLSliceCompositeNode")
+        || object->IsA("vtkMRMLSliceNode")
+        || object->IsA("vtkMRMLVolumeNode"))
+      {
+      this->UpdateSliceNodes();
+      return;
+      }
+    }
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLSliceLogic::OnMRMLSceneNodeRemoved(vtkMRMLNode* node)
 {
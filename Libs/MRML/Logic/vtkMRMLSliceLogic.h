@@ -380,6 +380,7 @@ protected:
   void ProcessMRMLLogicsEvents();
 
   void OnMRMLSceneNodeAdded(vtkMRMLNode* node) override;
+  void OnMRMLSceneNodesAdded(vtkCollection* nodes) override;
   void OnMRMLSceneNodeRemoved(vtkMRMLNode* node) override;
   void UpdateFromMRMLScene() override;
   void OnMRMLSceneStartClose() override;
@@ -0,0 +1,312 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#include "vtkSampledDisplacementFieldTransform.h"
+
+// VTK includes
+#include <vtkMath.h>
+#include <vtkObjectFactory.h>
+#include <vtkSMPTools.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSampledDisplacementFieldTransform);
+vtkCxxSetObjectMacro(vtkSampledDisplacementFieldTransform, SourceTransform, vtkAbstractTransform);
+
+//----------------------------------------------------------------------------
+vtkSampledDisplacementFieldTransform::vtkSampledDisplacementFieldTransform()
+{
+  this->SourceTransform = nullptr;
+  this->Extent[0] = this->Extent[2] = this->Extent[4] = 0;
+  this->Extent[1] = this->Extent[3] = this->Extent[5] = -1;
+  this->Tolerance = 0.1;
+  this->MaximumSampleSpacing = 16;
+  this->SampleSpacing = 0;
+  this->NumberOfGridBuilds = 0;
+  this->GridDimensions[0] = this->GridDimensions[1] = this->GridDimensions[2] = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkSampledDisplacementFieldTransform::~vtkSampledDisplacementFieldTransform()
+{
+  this->SetSourceTransform(nullptr);
+}
+
+//----------------------------------------------------------------------------
+void vtkSampledDisplacementFieldTransform::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "SourceTransform: " << this->SourceTransform << "\n";
+  os << indent << "Extent: " << this->Extent[0] << " " << this->Extent[1] << " "
+     << this->Extent[2] << " " << this->Extent[3] << " "
+     << this->Extent[4] << " " << this->Extent[5] << "\n";
+  os << indent << "Tolerance: " << this->Tolerance << "\n";
+  os << indent << "MaximumSampleSpacing: " << this->MaximumSampleSpacing << "\n";
+  os << indent << "SampleSpacing: " << this->SampleSpacing << "\n";
+  os << indent << "NumberOfGridBuilds: " << this->NumberOfGridBuilds << "\n";
+}
+
+//----------------------------------------------------------------------------
+vtkAbstractTransform* vtkSampledDisplacementFieldTransform::MakeTransform()
+{
+  return vtkSampledDisplacementFieldTransform::New();
+}
+
+//----------------------------------------------------------------------------
+vtkMTimeType vtkSampledDisplacementFieldTransform::GetMTime()
+{
+  vtkMTimeType mTime = this->Superclass::GetMTime();
+  if (this->SourceTransform)
+    {
+    mTime = std::max(mTime, this->SourceTransform->GetMTime());
+    }
+  return mTime;
+}
+
+//----------------------------------------------------------------------------
+void vtkSampledDisplacementFieldTransform::InternalDeepCopy(vtkAbstractTransform* transform)
+{
+  vtkSampledDisplacementFieldTransform* sampledTransform =
+    static_cast<vtkSampledDisplacementFieldTransform*>(transform);
+  this->SetInverseTolerance(sampledTransform->GetInverseTolerance());
+  this->SetInverseIterations(sampledTransform->GetInverseIterations());
+  this->InverseFlag = sampledTransform->InverseFlag;
+  this->SetSourceTransform(sampledTransform->SourceTransform);
+  this->SetExtent(sampledTransform->Extent);
+  this->SetTolerance(sampledTransform->Tolerance);
+  this->SetMaximumSampleSpacing(sampledTransform->MaximumSampleSpacing);
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkSampledDisplacementFieldTransform::InternalUpdate()
+{
+  this->Displacements.clear();
+  this->SampleSpacing = 0;
+  if (!this->SourceTransform)
+    {
+    return;
+    }
+  this->SourceTransform->Update();
+  if (this->Tolerance <= 0.0
+    || this->Extent[1] < this->Extent[0]
+    || this->Extent[3] < this->Extent[2]
+    || this->Extent[5] < this->Extent[4])
+    {
+    return;
+    }
+
+  int spacing = this->MaximumSampleSpacing;
+  this->SampleGrid(spacing);
+  while (spacing > 1 && this->ComputeMaximumError() > this->Tolerance)
+    {
+    spacing = std::max(1, spacing / 2);
+    this->SampleGrid(spacing);
+    }
+  ++this->NumberOfGridBuilds;
+}
+
+//----------------------------------------------------------------------------
+void vtkSampledDisplacementFieldTransform::SampleGrid(int spacing)
+{
+  this->SampleSpacing = spacing;
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    int length = this->Extent[2 * axis + 1] - this->Extent[2 * axis];
+    this->GridDimensions[axis] = (length + spacing - 1) / spacing + 1;
+    }
+  const int* dimensions = this->GridDimensions;
+  this->Displacements.resize(3 * static_cast<size_t>(dimensions[0]) * dimensions[1] * dimensions[2]);
+
+  vtkAbstractTransform* sourceTransform = this->SourceTransform;
+  const int* extent = this->Extent;
+  double* displacements = this->Displacements.data();
+  auto sampleRows = [=](vtkIdType firstRow, vtkIdType lastRow)
+    {
+    for (vtkIdType row = firstRow; row < lastRow; ++row)
+      {
+      double in[3] = { 0.0,
+        static_cast<double>(extent[2] + (row % dimensions[1]) * spacing),
+        static_cast<double>(extent[4] + (row / dimensions[1]) * spacing) };
+      double* displacement = displacements + 3 * row * dimensions[0];
+      for (int i = 0; i < dimensions[0]; ++i, displacement += 3)
+        {
+        in[0] = extent[0] + i * spacing;
+        double out[3];
+        sourceTransform->InternalTransformPoint(in, out);
+        displacement[0] = out[0] - in[0];
+        displacement[1] = out[1] - in[1];
+        displacement[2] = out[2] - in[2];
+        }
+      }
+    };
+  vtkSMPTools::For(0, static_cast<vtkIdType>(dimensions[1]) * dimensions[2], sampleRows);
+}
+
+//----------------------------------------------------------------------------
+double vtkSampledDisplacementFieldTransform::ComputeMaximumError()
+{
+  // Cell centers are the farthest points from the samples
+  int cellDimensions[3] = { 0, 0, 0 };
+  double cellOrigin[3] = { 0.0, 0.0, 0.0 };
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    cellDimensions[axis] = std::max(1, this->GridDimensions[axis] - 1);
+    cellOrigin[axis] = this->Extent[2 * axis] + (this->GridDimensions[axis] > 1 ? 0.5 * this->SampleSpacing : 0.0);
+    }
+  std::vector<double> rowErrors(static_cast<size_t>(cellDimensions[1]) * cellDimensions[2], 0.0);
+
+  const int spacing = this->SampleSpacing;
+  double* errors = rowErrors.data();
+  auto computeRowErrors = [&](vtkIdType firstRow, vtkIdType lastRow)
+    {
+    for (vtkIdType row = firstRow; row < lastRow; ++row)
+      {
+      double in[3] = { 0.0,
+        cellOrigin[1] + (row % cellDimensions[1]) * spacing,
+        cellOrigin[2] + (row / cellDimensions[1]) * spacing };
+      double maximumError2 = 0.0;
+      for (int i = 0; i < cellDimensions[0]; ++i)
+        {
+        in[0] = cellOrigin[0] + i * spacing;
+        double exact[3];
+        double interpolated[3];
+        this->SourceTransform->InternalTransformPoint(in, exact);
+        if (!this->InterpolatePoint(in, interpolated))
+          {
+          continue;
+          }
+        maximumError2 = std::max(maximumError2, vtkMath::Distance2BetweenPoints(exact, interpolated));
+        }
+      errors[row] = maximumError2;
+      }
+    };
+  vtkSMPTools::For(0, static_cast<vtkIdType>(rowErrors.size()), computeRowErrors);
+  return std::sqrt(*std::max_element(rowErrors.begin(), rowErrors.end()));
+}
+
+//----------------------------------------------------------------------------
+bool vtkSampledDisplacementFieldTransform::InterpolatePoint(const double in[3], double out[3])
+{
+  const double tolerance = 1e-6;
+  int baseIndex[3];
+  int nextIndex[3];
+  double weights[3];
+  for (int axis = 0; axis < 3; ++axis)
+    {
+    const int dimension = this->GridDimensions[axis];
+    double position = (in[axis] - this->Extent[2 * axis]) / this->SampleSpacing;
+    if (position < -tolerance || position > dimension - 1 + tolerance)
+      {
+      return false;
+      }
+    int index = static_cast<int>(std::floor(position));
+    index = std::max(0, std::min(index, dimension - 2));
+    baseIndex[axis] = index;
+    nextIndex[axis] = std::min(index + 1, dimension - 1);
+    weights[axis] = (dimension > 1 ? position - index : 0.0);
+    }
+
+  const vtkIdType rowIncrement = this->GridDimensions[0];
+  const vtkIdType sliceIncrement = rowIncrement * this->GridDimensions[1];
+  out[0] = in[0];
+  out[1] = in[1];
+  out[2] = in[2];
+  for (int corner = 0; corner < 8; ++corner)
+    {
+    double weight = 1.0;
+    vtkIdType sampleIndex = 0;
+    int cornerIndex[3];
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      bool next = ((corner >> axis) & 1) != 0;
+      weight *= (next ? weights[axis] : 1.0 - weights[axis]);
+      cornerIndex[axis] = (next ? nextIndex[axis] : baseIndex[axis]);
+      }
+    if (weight == 0.0)
+      {
+      continue;
+      }
+    sampleIndex = cornerIndex[0] + cornerIndex[1] * rowIncrement + cornerIndex[2] * sliceIncrement;
+    const double* displacement = &this->Displacements[3 * sampleIndex];
+    out[0] += weight * displacement[0];
+    out[1] += weight * displacement[1];
+    out[2] += weight * displacement[2];
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkSampledDisplacementFieldTransform::ForwardTransformPoint(const double in[3], double out[3])
+{
+  if (!this->SourceTransform)
+    {
+    out[0] = in[0];
+    out[1] = in[1];
+    out[2] = in[2];
+    return;
+    }
+  if (this->Displacements.empty() || !this->InterpolatePoint(in, out))
+    {
+    this->SourceTransform->InternalTransformPoint(in, out);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkSampledDisplacementFieldTransform::ForwardTransformPoint(const float in[3], float out[3])
+{
+  double inDouble[3] = { in[0], in[1], in[2] };
+  double outDouble[3];
+  this->ForwardTransformPoint(inDouble, outDouble);
+  out[0] = static_cast<float>(outDouble[0]);
+  out[1] = static_cast<float>(outDouble[1]);
+  out[2] = static_cast<float>(outDouble[2]);
+}
+
+//----------------------------------------------------------------------------
+void vtkSampledDisplacementFieldTransform::ForwardTransformDerivative(const double in[3], double out[3],
+  double derivative[3][3])
+{
+  if (!this->SourceTransform)
+    {
+    out[0] = in[0];
+    out[1] = in[1];
+    out[2] = in[2];
+    vtkMath::Identity3x3(derivative);
+    return;
+    }
+  this->SourceTransform->InternalTransformDerivative(in, out, derivative);
+}
+
+//----------------------------------------------------------------------------
+void vtkSampledDisplacementFieldTransform::ForwardTransformDerivative(const float in[3], float out[3],
+  float derivative[3][3])
+{
+  double inDouble[3] = { in[0], in[1], in[2] };
+  double outDouble[3];
+  double derivativeDouble[3][3];
+  this->ForwardTransformDerivative(inDouble, outDouble, derivativeDouble);
+  for (int i = 0; i < 3; ++i)
+    {
+    out[i] = static_cast<float>(outDouble[i]);
+    for (int j = 0; j < 3; ++j)
+      {
+      derivative[i][j] = static_cast<float>(derivativeDouble[i][j]);
+      }
+    }
+}
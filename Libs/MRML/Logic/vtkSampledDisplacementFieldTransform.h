@@ -0,0 +1,119 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkSampledDisplacementFieldTransform_h
+#define __vtkSampledDisplacementFieldTransform_h
+
+#include "vtkMRMLLogicExport.h"
+
+// VTK includes
+#include <vtkWarpTransform.h>
+
+// STD includes
+#include <vector>
+
+/// \brief Approximate a transform by a displacement field sampled over a region.
+///
+/// Evaluating a transform that contains an inverse non-linear transform (e.g.
+/// the inverse of a grid or b-spline transform) requires an iterative search
+/// for each point, which makes reslicing through it slow.
+/// This transform samples the source transform on a regular grid that covers
+/// the Extent (in input coordinates) and interpolates the displacements
+/// trilinearly in between.
+///
+/// The grid is built lazily (when the transform is updated, e.g. by
+/// vtkImageReslice) and rebuilt when the source transform or the parameters
+/// are modified. The grid spacing starts at MaximumSampleSpacing and is halved
+/// until the interpolated points at the center of the grid cells are within
+/// Tolerance of the exact points. Points outside the grid and derivatives are
+/// computed with the source transform.
+class VTK_MRML_LOGIC_EXPORT vtkSampledDisplacementFieldTransform : public vtkWarpTransform
+{
+public:
+  static vtkSampledDisplacementFieldTransform* New();
+  vtkTypeMacro(vtkSampledDisplacementFieldTransform, vtkWarpTransform);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// Transform that is approximated.
+  virtual void SetSourceTransform(vtkAbstractTransform* transform);
+  vtkGetObjectMacro(SourceTransform, vtkAbstractTransform);
+
+  /// Region of the input space where the transform is sampled, the
+  /// spacing between input voxels is 1.
+  vtkSetVector6Macro(Extent, int);
+  vtkGetVector6Macro(Extent, int);
+
+  /// Maximum distance between the approximated and the exact transformed
+  /// points, in output coordinates. If 0, the source transform is used
+  /// without approximation. Default is 0.1.
+  vtkSetClampMacro(Tolerance, double, 0.0, VTK_DOUBLE_MAX);
+  vtkGetMacro(Tolerance, double);
+
+  /// Largest spacing between samples, in input voxels. Default is 16.
+  vtkSetClampMacro(MaximumSampleSpacing, int, 1, VTK_INT_MAX);
+  vtkGetMacro(MaximumSampleSpacing, int);
+
+  /// Spacing between the samples of the current grid, 0 if there is no grid.
+  vtkGetMacro(SampleSpacing, int);
+
+  /// Number of times the grid has been built.
+  vtkGetMacro(NumberOfGridBuilds, int);
+
+  vtkAbstractTransform* MakeTransform() override;
+
+  /// Take the source transform modified time into account.
+  vtkMTimeType GetMTime() override;
+
+protected:
+  vtkSampledDisplacementFieldTransform();
+  ~vtkSampledDisplacementFieldTransform() override;
+
+  void InternalUpdate() override;
+  void InternalDeepCopy(vtkAbstractTransform* transform) override;
+
+  void ForwardTransformPoint(const float in[3], float out[3]) override;
+  void ForwardTransformPoint(const double in[3], double out[3]) override;
+
+  void ForwardTransformDerivative(const float in[3], float out[3],
+                                  float derivative[3][3]) override;
+  void ForwardTransformDerivative(const double in[3], double out[3],
+                                  double derivative[3][3]) override;
+
+  /// Sample the source transform with the given spacing.
+  void SampleGrid(int spacing);
+
+  /// Interpolate the displacement at \a in. Returns false if \a in is outside the grid.
+  bool InterpolatePoint(const double in[3], double out[3]);
+
+  /// Largest distance between the interpolated and exact points at the center of the grid cells.
+  double ComputeMaximumError();
+
+  vtkAbstractTransform* SourceTransform;
+  int Extent[6];
+  double Tolerance;
+  int MaximumSampleSpacing;
+  int SampleSpacing;
+  int NumberOfGridBuilds;
+
+  /// Displacements (3 components) of the samples, x varies fastest
+  std::vector<double> Displacements;
+  int GridDimensions[3];
+
+private:
+  vtkSampledDisplacementFieldTransform(const vtkSampledDisplacementFieldTransform&) = delete;
+  void operator=(const vtkSampledDisplacementFieldTransform&) = delete;
+};
+
+#endif
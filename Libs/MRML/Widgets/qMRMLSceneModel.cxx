@@ -348,6 +348,7 @@ void qMRMLSceneModel::setMRMLScene(vtkMRMLScene* scene)
     {
     scene->AddObserver(vtkMRMLScene::NodeAboutToBeAddedEvent, d->CallBack, -10.);
     scene->AddObserver(vtkMRMLScene::NodeAddedEvent, d->CallBack, 10.);
+    scene->AddObserver(vtkMRMLScene::NodesAddedEvent, d->CallBack, 10.);
     scene->AddObserver(vtkMRMLScene::NodeAboutToBeRemovedEvent, d->CallBack, -10.);
     scene->AddObserver(vtkMRMLScene::NodeRemovedEvent, d->CallBack, 10.);
     scene->AddObserver(vtkCommand::DeleteEvent, d->CallBack);
@@ -1137,6 +1138,17 @@ void qMRMLSceneModel::onMRMLSceneEvent(vtkObject* vtk_obj, unsigned long event,
       Q_ASSERT(node);
       sceneModel->onMRMLSceneNodeAdded(scene, node);
       break;
+    case vtkMRMLScene::NodesAddedEvent:
+      {
+      vtkCollection* nodes = reinterpret_cast<vtkCollection*>(call_data);
+      Q_ASSERT(nodes);
+      vtkCollectionSimpleIterator it;
+      for (nodes->InitTraversal(it); (node = vtkMRMLNode::SafeDownCast(nodes->GetNextItemAsObject(it)));)
+        {
+        sceneModel->onMRMLSceneNodeAdded(scene, node);
+        }
+      }
+      break;
     case vtkMRMLScene::NodeAboutToBeRemovedEvent:
       Q_ASSERT(node);
       sceneModel->onMRMLSceneNodeAboutToBeRemoved(scene, node);
@@ -0,0 +1,307 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// vtkITK includes
+#include <vtkITKArchetypeImageSeriesScalarReader.h>
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+// ITK includes
+#include <itkFactoryRegistration.h>
+#include <itkGDCMImageIO.h>
+#include <itkImageRegionIterator.h>
+#include <itkImageSeriesWriter.h>
+#include <itkMetaDataObject.h>
+#include <itksys/SystemTools.hxx>
+
+// STD includes
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+const int NumberOfSlices = 8;
+
+//----------------------------------------------------------------------------
+bool WriteDICOMSeries(const std::string& directory, std::vector<std::string>& fileNames)
+{
+  typedef itk::Image<short, 3> ImageType;
+  typedef itk::Image<short, 2> SliceType;
+
+  ImageType::RegionType region;
+  ImageType::SizeType size;
+  size[0] = 16;
+  size[1] = 12;
+  size[2] = NumberOfSlices;
+  region.SetSize(size);
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+  itk::ImageRegionIterator<ImageType> it(image, region);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    ImageType::IndexType index = it.GetIndex();
+    it.Set(static_cast<short>(index[0] + 20 * index[1] + 300 * index[2]));
+    }
+
+  std::vector<itk::MetaDataDictionary> dictionaries(NumberOfSlices);
+  itk::ImageSeriesWriter<ImageType, SliceType>::DictionaryArrayType dictionaryArray;
+  for (int i = 0; i < NumberOfSlices; ++i)
+    {
+    itk::MetaDataDictionary& dictionary = dictionaries[i];
+    std::ostringstream value;
+    itk::EncapsulateMetaData<std::string>(dictionary, "0008|0016", "1.2.840.10008.5.1.4.1.1.2"); // CT image storage
+    itk::EncapsulateMetaData<std::string>(dictionary, "0008|0060", "CT");
+    itk::EncapsulateMetaData<std::string>(dictionary, "0020|000d", "1.2.826.0.1.3680043.2.1125.1");
+    itk::EncapsulateMetaData<std::string>(dictionary, "0020|000e", "1.2.826.0.1.3680043.2.1125.1.1");
+    itk::EncapsulateMetaData<std::string>(dictionary, "0020|0052", "1.2.826.0.1.3680043.2.1125.1.2");
+    value << "1.2.826.0.1.3680043.2.1125.1.1." << i + 1;
+    itk::EncapsulateMetaData<std::string>(dictionary, "0008|0018", value.str());
+    value.str("");
+    value << i + 1;
+    itk::EncapsulateMetaData<std::string>(dictionary, "0020|0013", value.str());
+    value.str("");
+    value << "0\\0\\" << i;
+    itk::EncapsulateMetaData<std::string>(dictionary, "0020|0032", value.str());
+    itk::EncapsulateMetaData<std::string>(dictionary, "0020|0037", "1\\0\\0\\0\\1\\0");
+    itk::EncapsulateMetaData<std::string>(dictionary, "0018|0050", "1");
+    dictionaryArray.push_back(&dictionary);
+
+    value.str("");
+    value << directory << "/slice" << (i < 9 ? "0" : "") << i + 1 << ".dcm";
+    fileNames.push_back(value.str());
+    }
+
+  itk::GDCMImageIO::Pointer gdcmIO = itk::GDCMImageIO::New();
+  gdcmIO->SetKeepOriginalUID(true);
+  itk::ImageSeriesWriter<ImageType, SliceType>::Pointer writer =
+    itk::ImageSeriesWriter<ImageType, SliceType>::New();
+  writer->SetInput(image);
+  writer->SetImageIO(gdcmIO);
+  writer->SetFileNames(fileNames);
+  writer->SetMetaDataDictionaryArray(&dictionaryArray);
+  try
+    {
+    writer->Update();
+    }
+  catch (itk::ExceptionObject& e)
+    {
+    std::cerr << "Line " << __LINE__ << ": failed to write DICOM series: " << e << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool ReadDICOMSeries(const std::string& archetype, const std::string& cacheFileName,
+  int expectedNumberOfSlices, vtkImageData* expectedImage, vtkImageData* image)
+{
+  vtkNew<vtkITKArchetypeImageSeriesScalarReader> reader;
+  reader->SetArchetype(archetype.c_str());
+  reader->SetSingleFile(0);
+  reader->SetDICOMHeaderCacheFileName(cacheFileName.c_str());
+  reader->SetOutputScalarTypeToNative();
+  reader->SetDesiredCoordinateOrientationToNative();
+  reader->SetUseNativeOriginOn();
+  reader->Update();
+  if (reader->GetErrorCode() != 0)
+    {
+    std::cerr << "Line " << __LINE__ << ": failed to read " << archetype << std::endl;
+    return false;
+    }
+  if (static_cast<int>(reader->GetNumberOfFileNames()) != expectedNumberOfSlices
+    || reader->GetOutput()->GetDimensions()[2] != expectedNumberOfSlices)
+    {
+    std::cerr << "Line " << __LINE__ << ": expected " << expectedNumberOfSlices << " slices, got "
+              << reader->GetNumberOfFileNames() << " files and "
+              << reader->GetOutput()->GetDimensions()[2] << " slices" << std::endl;
+    return false;
+    }
+  if (image)
+    {
+    image->DeepCopy(reader->GetOutput());
+    }
+  if (expectedImage)
+    {
+    vtkDataArray* expectedScalars = expectedImage->GetPointData()->GetScalars();
+    vtkDataArray* scalars = reader->GetOutput()->GetPointData()->GetScalars();
+    size_t dataSize = expectedScalars->GetNumberOfValues() * expectedScalars->GetDataTypeSize();
+    if (scalars->GetNumberOfValues() != expectedScalars->GetNumberOfValues()
+      || memcmp(scalars->GetVoidPointer(0), expectedScalars->GetVoidPointer(0), dataSize) != 0)
+      {
+      std::cerr << "Line " << __LINE__ << ": voxels read using the cache do not match" << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool ReadCacheLines(const std::string& cacheFileName, std::vector<std::string>& lines,
+  int expectedNumberOfFiles = NumberOfSlices)
+{
+  lines.clear();
+  std::ifstream cacheFile(cacheFileName.c_str());
+  std::string line;
+  while (std::getline(cacheFile, line))
+    {
+    lines.push_back(line);
+    }
+  // signature followed by one line per file
+  if (static_cast<int>(lines.size()) != 1 + expectedNumberOfFiles)
+    {
+    std::cerr << "Line " << __LINE__ << ": expected " << 1 + expectedNumberOfFiles
+              << " lines in " << cacheFileName << ", got " << lines.size() << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  itk::itkFactoryRegistration();
+
+  if (argc < 2)
+    {
+    std::cerr << "Usage: vtkITKArchetypeImageSeriesReaderDICOMHeaderCacheTest temporaryDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::string testDirectory = std::string(argv[1]) + "/vtkITKArchetypeImageSeriesReaderDICOMHeaderCacheTest";
+  std::string dicomDirectory = testDirectory + "/DICOM";
+  std::string cacheFileName = testDirectory + "/DICOMHeaderCache.txt";
+  itksys::SystemTools::RemoveADirectory(testDirectory);
+  itksys::SystemTools::MakeDirectory(dicomDirectory);
+
+  std::vector<std::string> fileNames;
+  if (!WriteDICOMSeries(dicomDirectory, fileNames))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // No cache yet: all the headers are read in parallel then cached.
+  vtkNew<vtkImageData> image;
+  if (!ReadDICOMSeries(fileNames[0], cacheFileName, NumberOfSlices, nullptr, image))
+    {
+    return EXIT_FAILURE;
+    }
+  std::vector<std::string> lines;
+  if (!ReadCacheLines(cacheFileName, lines))
+    {
+    return EXIT_FAILURE;
+    }
+  std::string signature = lines[0];
+
+  // Reading again using the cache gives the same volume.
+  if (!ReadDICOMSeries(fileNames[0], cacheFileName, NumberOfSlices, image, nullptr))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Cached tags are used instead of the headers: give the last slices
+  // another series instance UID (first tag after path, size and time).
+  {
+  std::ofstream cacheFile(cacheFileName.c_str());
+  cacheFile << lines[0] << "\n";
+  for (int i = 1; i <= NumberOfSlices; ++i)
+    {
+    std::string line = lines[i];
+    if (i > NumberOfSlices / 2)
+      {
+      size_t tagStart = line.find('\t');
+      tagStart = line.find('\t', tagStart + 1);
+      tagStart = line.find('\t', tagStart + 1) + 1;
+      size_t tagEnd = line.find('\t', tagStart);
+      line.replace(tagStart, tagEnd - tagStart, "1.2.826.0.1.3680043.2.1125.1.99");
+      }
+    cacheFile << line << "\n";
+    }
+  }
+  if (!ReadDICOMSeries(fileNames[0], cacheFileName, NumberOfSlices / 2, nullptr, nullptr))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // A file that is not a cache is ignored and replaced.
+  {
+  std::ofstream cacheFile(cacheFileName.c_str());
+  cacheFile << "not a DICOM header cache\n";
+  }
+  if (!ReadDICOMSeries(fileNames[0], cacheFileName, NumberOfSlices, image, nullptr)
+    || !ReadCacheLines(cacheFileName, lines))
+    {
+    return EXIT_FAILURE;
+    }
+  if (lines[0] != signature)
+    {
+    std::cerr << "Line " << __LINE__ << ": invalid cache file was not replaced" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Entries of deleted files in the directory of the series are removed
+  // when the cache is updated, other entries are kept.
+  std::string cachedDirectory = itksys::SystemTools::GetFilenamePath(lines[1].substr(0, lines[1].find('\t')));
+  std::string deletedFileName = cachedDirectory + "/deleted.dcm";
+  std::string otherFileName = testDirectory + "/Other/other.dcm";
+  {
+  std::ofstream cacheFile(cacheFileName.c_str());
+  cacheFile << lines[0] << "\n";
+  for (int i = 1; i <= NumberOfSlices; ++i)
+    {
+    std::string line = lines[i];
+    if (i == 1)
+      {
+      // wrong file size: the header is read again and the cache is updated
+      size_t sizeStart = line.find('\t') + 1;
+      size_t sizeEnd = line.find('\t', sizeStart);
+      line.replace(sizeStart, sizeEnd - sizeStart, "1");
+      }
+    cacheFile << line << "\n";
+    }
+  for (const std::string& fileName : { deletedFileName, otherFileName })
+    {
+    std::string line = lines[1];
+    line.replace(0, line.find('\t'), fileName);
+    cacheFile << line << "\n";
+    }
+  }
+  if (!ReadDICOMSeries(fileNames[0], cacheFileName, NumberOfSlices, image, nullptr)
+    || !ReadCacheLines(cacheFileName, lines, NumberOfSlices + 1))
+    {
+    return EXIT_FAILURE;
+    }
+  for (const std::string& line : lines)
+    {
+    if (line.compare(0, deletedFileName.size() + 1, deletedFileName + "\t") == 0)
+      {
+      std::cerr << "Line " << __LINE__ << ": entry of a deleted file was not removed" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  itksys::SystemTools::RemoveADirectory(testDirectory);
+  return EXIT_SUCCESS;
+}
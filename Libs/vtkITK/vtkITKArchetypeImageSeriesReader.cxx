@@ -26,6 +26,7 @@
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
+#include <vtkSMPTools.h>
 #include <vtkStreamingDemandDrivenPipeline.h>
 
 // ITK includes
@@ -36,9 +37,18 @@
 #include <itkMetaDataObject.h>
 #include <itkMetaImageIO.h>
 #include <itkTimeProbe.h>
+#include <itksys/SystemTools.hxx>
 
 // STD includes
 #include <algorithm>
+#include <array>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
 #include <vector>
 
 #include "itkArchetypeSeriesFileNames.h"
@@ -52,6 +62,279 @@
 
 vtkStandardNewMacro(vtkITKArchetypeImageSeriesReader);
 
+namespace
+{
+//----------------------------------------------------------------------------
+/// Get MetaData from dictionary, removing all whitespaces from the string.
+std::string GetTagValueWithoutSpaces(const itk::MetaDataDictionary &dict, const std::string& tag)
+{
+  std::string tagValue;
+  itk::ExposeMetaData<std::string>(dict, tag, tagValue);
+  tagValue.erase(std::remove_if(tagValue.begin(), tagValue.end(), isspace), tagValue.end());
+  return tagValue;
+}
+} // end of anonymous namespace
+
+#ifdef VTKITK_BUILD_DICOM_SUPPORT
+namespace
+{
+
+/// DICOM tags used to group files, see vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
+const int NumberOfAnalyzedDicomTags = 8;
+const char* AnalyzedDicomTags[NumberOfAnalyzedDicomTags] = {
+  "0020|000e", // series instance UID
+  "0008|0033", // content time
+  "0018|1060", // trigger time
+  "0018|0086", // echo numbers
+  "0010|9089", // diffusion gradient orientation
+  "0020|1041", // slice location
+  "0020|0037", // image orientation patient
+  "0020|0032"  // image position patient
+  };
+typedef std::array<std::string, NumberOfAnalyzedDicomTags> DicomHeaderTags;
+
+//----------------------------------------------------------------------------
+/// Analyzed DICOM tags of a file, along with the size and modification time
+/// of the file when the tags were read.
+struct DicomHeaderCacheEntry
+{
+  unsigned long FileSize{0};
+  long int FileModifiedTime{0};
+  DicomHeaderTags Tags;
+};
+
+//----------------------------------------------------------------------------
+/// On-disk cache of analyzed DICOM tags.
+/// Each line of the file contains the path, size and modification time of a
+/// file followed by its tag values, separated by tabs. The tag values do not
+/// contain any whitespace (see GetTagValueWithoutSpaces()).
+/// Stale entries are removed before saving (see Prune()).
+class DicomHeaderCache
+{
+public:
+  void Load(const std::string& cacheFileName)
+    {
+    std::ifstream cacheFile(cacheFileName.c_str());
+    std::string line;
+    if (!std::getline(cacheFile, line) || line != Signature)
+      {
+      return;
+      }
+    while (std::getline(cacheFile, line))
+      {
+      std::vector<std::string> fields;
+      std::stringstream lineStream(line);
+      std::string field;
+      while (std::getline(lineStream, field, '\t'))
+        {
+        fields.push_back(field);
+        }
+      if (!line.empty() && line.back() == '\t')
+        {
+        // the last tag value is empty
+        fields.emplace_back();
+        }
+      if (fields.size() != 3 + NumberOfAnalyzedDicomTags)
+        {
+        continue;
+        }
+      DicomHeaderCacheEntry entry;
+      try
+        {
+        entry.FileSize = std::stoul(fields[1]);
+        entry.FileModifiedTime = std::stol(fields[2]);
+        }
+      catch (std::exception&)
+        {
+        continue;
+        }
+      std::copy(fields.begin() + 3, fields.end(), entry.Tags.begin());
+      this->Entries[fields[0]] = entry;
+      }
+    }
+
+  void Save(const std::string& cacheFileName) const
+    {
+    // Write a temporary file first so that concurrent readers never see
+    // a partially written cache.
+    std::string temporaryFileName = cacheFileName + ".tmp";
+    {
+    std::ofstream cacheFile(temporaryFileName.c_str());
+    if (!cacheFile)
+      {
+      return;
+      }
+    cacheFile << Signature << "\n";
+    for (const auto& fileEntry : this->Entries)
+      {
+      cacheFile << fileEntry.first << "\t" << fileEntry.second.FileSize
+                << "\t" << fileEntry.second.FileModifiedTime;
+      for (const std::string& tagValue : fileEntry.second.Tags)
+        {
+        cacheFile << "\t" << tagValue;
+        }
+      cacheFile << "\n";
+      }
+    }
+    itksys::SystemTools::RemoveFile(cacheFileName);
+    itksys::SystemTools::RenameFile(temporaryFileName.c_str(), cacheFileName.c_str());
+    }
+
+  /// Return the cached tags of a file if its size and modification time did not change.
+  const DicomHeaderTags* Find(const std::string& fileName,
+    unsigned long fileSize, long int fileModifiedTime) const
+    {
+    auto entryIt = this->Entries.find(fileName);
+    if (entryIt == this->Entries.end()
+      || entryIt->second.FileSize != fileSize
+      || entryIt->second.FileModifiedTime != fileModifiedTime)
+      {
+      return nullptr;
+      }
+    return &entryIt->second.Tags;
+    }
+
+  void Insert(const std::string& fileName, const DicomHeaderCacheEntry& entry)
+    {
+    if (fileName.find_first_of("\t\n") != std::string::npos)
+      {
+      // cannot be stored in the cache file
+      return;
+      }
+    this->Entries[fileName] = entry;
+    }
+
+  /// Remove the entries of files that no longer exist in the directories of
+  /// the files that have just been read.
+  /// If the cache has more than MaximumNumberOfEntries entries, only the
+  /// entries of the files that have just been read are kept.
+  void Prune(const std::vector<std::string>& readFileNames)
+    {
+    std::set<std::string> readFiles(readFileNames.begin(), readFileNames.end());
+    if (this->Entries.size() > MaximumNumberOfEntries)
+      {
+      for (auto entryIt = this->Entries.begin(); entryIt != this->Entries.end();)
+        {
+        entryIt = readFiles.count(entryIt->first) ? std::next(entryIt) : this->Entries.erase(entryIt);
+        }
+      return;
+      }
+    std::set<std::string> readDirectories;
+    for (const std::string& fileName : readFileNames)
+      {
+      readDirectories.insert(itksys::SystemTools::GetFilenamePath(fileName));
+      }
+    for (auto entryIt = this->Entries.begin(); entryIt != this->Entries.end();)
+      {
+      if (!readFiles.count(entryIt->first)
+        && readDirectories.count(itksys::SystemTools::GetFilenamePath(entryIt->first))
+        && !itksys::SystemTools::FileExists(entryIt->first))
+        {
+        entryIt = this->Entries.erase(entryIt);
+        }
+      else
+        {
+        ++entryIt;
+        }
+      }
+    }
+
+private:
+  static const char* Signature;
+  static const size_t MaximumNumberOfEntries = 100000;
+  std::map<std::string, DicomHeaderCacheEntry> Entries;
+};
+
+const char* DicomHeaderCache::Signature = "vtkITKArchetypeImageSeriesReader DICOM header cache 1";
+
+//----------------------------------------------------------------------------
+/// Read the analyzed DICOM tags of a range of files, in parallel.
+/// Tags found in the cache are not read again.
+class ReadDicomHeaderTagsFunctor
+{
+public:
+  ReadDicomHeaderTagsFunctor(const std::vector<std::string>& fileNames, const DicomHeaderCache& cache,
+    std::vector<DicomHeaderCacheEntry>& entries, std::vector<char>& parsed)
+    : FileNames(fileNames), Cache(cache), Entries(entries), Parsed(parsed)
+    {
+    }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+    {
+    itk::GDCMImageIO::Pointer gdcmIO;
+    for (vtkIdType f = begin; f < end; ++f)
+      {
+      const std::string& fileName = this->FileNames[f];
+      DicomHeaderCacheEntry& entry = this->Entries[f];
+      entry.FileSize = itksys::SystemTools::FileLength(fileName);
+      entry.FileModifiedTime = itksys::SystemTools::ModifiedTime(fileName);
+      const DicomHeaderTags* cachedTags = this->Cache.Find(fileName, entry.FileSize, entry.FileModifiedTime);
+      if (cachedTags)
+        {
+        entry.Tags = *cachedTags;
+        continue;
+        }
+      try
+        {
+        if (gdcmIO.IsNull())
+          {
+          gdcmIO = itk::GDCMImageIO::New();
+          }
+        gdcmIO->SetFileName(fileName);
+        gdcmIO->ReadImageInformation();
+        itk::MetaDataDictionary &dict = gdcmIO->GetMetaDataDictionary();
+        for (int k = 0; k < NumberOfAnalyzedDicomTags; ++k)
+          {
+          entry.Tags[k] = GetTagValueWithoutSpaces(dict, AnalyzedDicomTags[k]);
+          }
+        this->Parsed[f] = true;
+        }
+      catch (itk::ExceptionObject& e)
+        {
+        // exceptions cannot leave the worker threads, the first one is
+        // thrown again once all headers are read
+        std::lock_guard<std::mutex> lock(this->ExceptionLock);
+        if (!this->Exception)
+          {
+          this->Exception.reset(new itk::ExceptionObject(e));
+          }
+        return;
+        }
+      catch (...)
+        {
+        // the file is not marked as parsed, so it is not cached
+        std::lock_guard<std::mutex> lock(this->ExceptionLock);
+        if (!this->Exception)
+          {
+          std::string description = "Unknown exception while reading the DICOM header of " + fileName;
+          this->Exception.reset(new itk::ExceptionObject(__FILE__, __LINE__, description.c_str(), ITK_LOCATION));
+          }
+        return;
+        }
+      }
+    }
+
+  /// Throw the first exception raised while reading the headers, if any
+  void RethrowException()
+    {
+    if (this->Exception)
+      {
+      throw *this->Exception;
+      }
+    }
+
+private:
+  const std::vector<std::string>& FileNames;
+  const DicomHeaderCache& Cache;
+  std::vector<DicomHeaderCacheEntry>& Entries;
+  std::vector<char>& Parsed;
+  std::mutex ExceptionLock;
+  std::unique_ptr<itk::ExceptionObject> Exception;
+};
+
+} // end of anonymous namespace
+#endif
+
 //----------------------------------------------------------------------------
 vtkITKArchetypeImageSeriesReader::vtkITKArchetypeImageSeriesReader()
 {
@@ -91,6 +374,7 @@ vtkITKArchetypeImageSeriesReader::vtkITKArchetypeImageSeriesReader()
   this->ImageOrientationPatient.resize( 0 );
 
   this->AnalyzeHeader = true;
+  this->DICOMHeaderCacheFileName = nullptr;
 
   this->GroupingByTags = false;
   this->IsOnlyFile = false;
@@ -126,7 +410,7 @@ vtkITKArchetypeImageSeriesReader::~vtkITKArchetypeImageSeriesReader()
    MeasurementFrameMatrix->Delete();
    MeasurementFrameMatrix = nullptr;
    }
-
+  this->SetDICOMHeaderCacheFileName(nullptr);
 }
 
 //----------------------------------------------------------------------------
@@ -176,6 +460,8 @@ void vtkITKArchetypeImageSeriesReader::PrintSelf(ostream& os, vtkIndent indent)
     os << ", " << this->DefaultDataOrigin[idx];
     }
   os << ")\n";
+  os << indent << "DICOMHeaderCacheFileName: " <<
+    (this->DICOMHeaderCacheFileName ? this->DICOMHeaderCacheFileName : "(none)") << "\n";
 #ifdef VTKITK_BUILD_DICOM_SUPPORT
   os << indent << "DICOMImageIOApproach: " << this->GetDICOMImageIOApproach();
 #else
@@ -1202,10 +1488,7 @@ void vtkITKArchetypeImageSeriesReader::GroupFiles ( int idxSeriesInstanceUID,
 
 std::string vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces(const itk::MetaDataDictionary &dict, const std::string& tag)
 {
-  std::string tagValue;
-  itk::ExposeMetaData<std::string>(dict, tag, tagValue);
-  tagValue.erase(std::remove_if(tagValue.begin(), tagValue.end(), isspace), tagValue.end());
-  return tagValue;
+  return GetTagValueWithoutSpaces(dict, tag);
 }
 
 //----------------------------------------------------------------------------
@@ -1315,20 +1598,44 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
     }
 
   // if Archetype is a Dicom File
-  gdcmIO->SetFileName( this->Archetype );
+
+  // Read the headers in parallel, or get their tags from the cache
+  DicomHeaderCache cache;
+  if (this->DICOMHeaderCacheFileName && *this->DICOMHeaderCacheFileName)
+    {
+    cache.Load(this->DICOMHeaderCacheFileName);
+    }
+  std::vector<DicomHeaderCacheEntry> headers(nFiles);
+  std::vector<char> parsed(nFiles, false);
+  ReadDicomHeaderTagsFunctor readHeaders(this->AllFileNames, cache, headers, parsed);
+  vtkSMPTools::For(0, nFiles, readHeaders);
+  readHeaders.RethrowException();
+
+  if (this->DICOMHeaderCacheFileName && *this->DICOMHeaderCacheFileName
+    && std::find(parsed.begin(), parsed.end(), true) != parsed.end())
+    {
+    for (int f = 0; f < nFiles; f++)
+      {
+      if (parsed[f])
+        {
+        cache.Insert(this->AllFileNames[f], headers[f]);
+        }
+      }
+    cache.Prune(this->AllFileNames);
+    cache.Save(this->DICOMHeaderCacheFileName);
+    }
+
+  // Index the tag values, in the order of the files
   for (int f = 0; f < nFiles; f++)
     {
-    gdcmIO->SetFileName( this->AllFileNames[f] );
-    gdcmIO->ReadImageInformation();
-    itk::MetaDataDictionary &dict = gdcmIO->GetMetaDataDictionary();
+    // Tag values are read with GetTagValueWithoutSpaces
+    // to remove extra spaces from the DICOM tag, because extra spaces were found in some
+    // DICOM file before/after the multi-value separator backslashes.
+    const DicomHeaderTags& tags = headers[f].Tags;
     std::string tagValue;
 
-    // Use vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces to remove extra spaces
-    // from the DICOM tag, because extra spaces were found in some DICOM file before/after the
-    // multi-value separator backslashes.
-
     // series instance UID
-    tagValue = vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces(dict, "0020|000e");
+    tagValue = tags[0];
     if (!tagValue.empty())
       {
       int idx = InsertSeriesInstanceUIDs( tagValue.c_str() );
@@ -1340,7 +1647,7 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
       }
 
     // content time
-    tagValue = vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces(dict, "0008|0033");
+    tagValue = tags[1];
     if (!tagValue.empty())
       {
       int idx = InsertContentTime( tagValue.c_str() );
@@ -1352,7 +1659,7 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
       }
 
     // trigger time
-    tagValue = vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces(dict, "0018|1060");
+    tagValue = tags[2];
     if (!tagValue.empty())
       {
       int idx = InsertTriggerTime( tagValue.c_str() );
@@ -1364,7 +1671,7 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
       }
 
     // echo numbers
-    tagValue = vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces(dict, "0018|0086");
+    tagValue = tags[3];
     if (!tagValue.empty())
       {
       int idx = InsertEchoNumbers( tagValue.c_str() );
@@ -1376,7 +1683,7 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
       }
 
     // diffision gradient orientation
-    tagValue = vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces(dict, "0010|9089");
+    tagValue = tags[4];
     if (!tagValue.empty())
       {
       float a[3] = { -1 };
@@ -1390,7 +1697,7 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
       }
 
     // slice location
-    tagValue = vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces(dict, "0020|1041");
+    tagValue = tags[5];
     if (!tagValue.empty())
       {
       float a = -1;
@@ -1404,7 +1711,7 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
       }
 
     // image orientation patient
-    tagValue = vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces(dict, "0020|0037");
+    tagValue = tags[6];
     if (!tagValue.empty())
       {
       float a[6] = { -1 };
@@ -1417,7 +1724,7 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
       this->IndexImageOrientationPatient[f] = -1;
       }
     // image position patient
-    tagValue = vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces(dict, "0020|0032");
+    tagValue = tags[7];
     if (!tagValue.empty())
       {
       float a[3] = { -1 };
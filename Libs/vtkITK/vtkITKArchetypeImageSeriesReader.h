@@ -246,6 +246,16 @@ public:
   vtkSetMacro(AnalyzeHeader, bool);
   vtkGetMacro(AnalyzeHeader, bool);
 
+  ///
+  /// File where the DICOM tags parsed when analyzing the headers are cached,
+  /// so that analyzing the same files again does not parse their headers.
+  /// Entries are identified by file path, size and modification time.
+  /// Entries of deleted files are removed when the cache is updated, and
+  /// the number of entries is bounded.
+  /// No cache is used if empty (default).
+  vtkSetStringMacro(DICOMHeaderCacheFileName);
+  vtkGetStringMacro(DICOMHeaderCacheFileName);
+
   ///
   /// Whether to use orientation from file
   vtkSetMacro(UseOrientationFromFile, int);
@@ -875,6 +885,7 @@ protected:
 
   std::vector<std::string> AllFileNames;
   bool AnalyzeHeader;
+  char* DICOMHeaderCacheFileName;
   bool IsOnlyFile;
   bool ArchetypeIsDICOM;
 
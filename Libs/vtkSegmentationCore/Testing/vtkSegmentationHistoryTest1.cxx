@@ -28,6 +28,10 @@
 #include <vtkSphereSource.h>
 #include <vtkVersion.h>
 
+// STD includes
+#include <cstring>
+#include <vector>
+
 // SegmentationCore includes
 #include "vtkBinaryLabelmapToClosedSurfaceConversionRule.h"
 #include "vtkClosedSurfaceToBinaryLabelmapConversionRule.h"
@@ -68,6 +72,125 @@ int GetVoxelCount(vtkImageData* labelmap, int labelValue)
   return accumulate->GetVoxelCount();
 }
 
+//----------------------------------------------------------------------------
+void FillRegion(vtkImageData* labelmap, int region[6], unsigned char value)
+{
+  for (int k = region[4]; k <= region[5]; ++k)
+    {
+    for (int j = region[2]; j <= region[3]; ++j)
+      {
+      for (int i = region[0]; i <= region[1]; ++i)
+        {
+        *static_cast<unsigned char*>(labelmap->GetScalarPointer(i, j, k)) = value;
+        }
+      }
+    }
+  labelmap->Modified();
+}
+
+//----------------------------------------------------------------------------
+bool IsSameLabelmap(vtkImageData* labelmap1, vtkImageData* labelmap2)
+{
+  int* extent1 = labelmap1->GetExtent();
+  int* extent2 = labelmap2->GetExtent();
+  for (int i = 0; i < 6; ++i)
+    {
+    if (extent1[i] != extent2[i])
+      {
+      return false;
+      }
+    }
+  vtkIdType size = labelmap1->GetNumberOfPoints() * labelmap1->GetScalarSize();
+  return memcmp(labelmap1->GetScalarPointer(), labelmap2->GetScalarPointer(), size) == 0;
+}
+
+//----------------------------------------------------------------------------
+/// Store typical editing steps (paint, threshold, remove islands) and compare memory usage
+/// to storing full copies of the labelmap, and check that all states can be restored.
+bool TestStateMemorySize()
+{
+  vtkNew<vtkSegment> segment;
+  segment->SetLabelValue(1);
+  vtkNew<vtkOrientedImageData> labelmap;
+  labelmap->SetExtent(0, 255, 0, 255, 0, 199);
+  labelmap->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  labelmap->GetPointData()->GetScalars()->Fill(0);
+  segment->AddRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName(), labelmap);
+  vtkNew<vtkSegmentation> segmentation;
+  segmentation->AddSegment(segment);
+
+  vtkNew<vtkSegmentationHistory> history;
+  history->SetSegmentation(segmentation);
+  // Allow storing the current state on undo in addition to the 5 editing steps
+  history->SetMaximumNumberOfStates(6);
+
+  std::vector<vtkSmartPointer<vtkOrientedImageData> > expectedLabelmaps;
+  int regions[5][6] =
+    {
+    { 100, 110, 100, 110, 100, 110 }, // paint
+    { 120, 128, 90, 100, 100, 104 }, // paint
+    { 0, 255, 0, 255, 50, 120 }, // threshold
+    { 30, 40, 200, 210, 60, 61 }, // remove islands
+    { 105, 115, 100, 105, 108, 112 }, // paint
+    };
+  unsigned char values[5] = { 1, 1, 1, 0, 0 };
+  for (int step = 0; step < 5; ++step)
+    {
+    history->SaveState();
+    vtkSmartPointer<vtkOrientedImageData> expectedLabelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+    expectedLabelmap->DeepCopy(segment->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+    expectedLabelmaps.push_back(expectedLabelmap);
+    FillRegion(labelmap, regions[step], values[step]);
+    }
+
+  unsigned long fullCopiesMemorySize = history->GetNumberOfStates() * labelmap->GetActualMemorySize();
+  unsigned long statesMemorySize = history->GetActualMemorySize();
+  std::cout << "Memory size of " << history->GetNumberOfStates() << " states: " << statesMemorySize
+    << " KiB (full copies: " << fullCopiesMemorySize << " KiB)" << std::endl;
+  // Only the uncompressed copy of the most recent state is expected to take significant memory
+  if (statesMemorySize > 2 * labelmap->GetActualMemorySize())
+    {
+    std::cerr << "Memory size of stored states is too large" << std::endl;
+    return false;
+    }
+
+  // Undo all steps
+  for (int step = 4; step >= 0; --step)
+    {
+    if (!history->RestorePreviousState())
+      {
+      std::cerr << "Failed to restore state " << step << std::endl;
+      return false;
+      }
+    vtkImageData* restoredLabelmap = vtkImageData::SafeDownCast(
+      segment->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+    if (!IsSameLabelmap(restoredLabelmap, expectedLabelmaps[step]))
+      {
+      std::cerr << "Restored labelmap of state " << step << " does not match the stored labelmap" << std::endl;
+      return false;
+      }
+    }
+
+  // Redo all steps
+  for (int step = 1; step < 5; ++step)
+    {
+    if (!history->RestoreNextState())
+      {
+      std::cerr << "Failed to restore state " << step << std::endl;
+      return false;
+      }
+    vtkImageData* restoredLabelmap = vtkImageData::SafeDownCast(
+      segment->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+    if (!IsSameLabelmap(restoredLabelmap, expectedLabelmaps[step]))
+      {
+      std::cerr << "Restored labelmap of state " << step << " does not match the stored labelmap" << std::endl;
+      return false;
+      }
+    }
+
+  return true;
+}
+
 //----------------------------------------------------------------------------
 int vtkSegmentationHistoryTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
 {
@@ -178,6 +301,11 @@ int vtkSegmentationHistoryTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
     return EXIT_FAILURE;
     }
 
+  if (!TestStateMemorySize())
+    {
+    return EXIT_FAILURE;
+    }
+
   std::cout << "Segmentation history test 1 passed." << std::endl;
   return EXIT_SUCCESS;
 }
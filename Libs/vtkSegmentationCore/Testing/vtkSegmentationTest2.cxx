@@ -19,10 +19,15 @@
 ==============================================================================*/
 
 // VTK includes
+#include <vtkExtractSelection.h>
+#include <vtkGeometryFilter.h>
+#include <vtkIdList.h>
 #include <vtkNew.h>
 #include <vtkVersion.h>
 #include <vtkPointData.h>
 #include <vtkPolyData.h>
+#include <vtkSelectionNode.h>
+#include <vtkSelectionSource.h>
 #include <vtkSphereSource.h>
 #include <vtkMatrix4x4.h>
 #include <vtkImageAccumulate.h>
@@ -314,6 +319,193 @@ bool TestSharedLabelmapCasting()
   return true;
 }
 
+//----------------------------------------------------------------------------
+void CreateSphereLabelmapSegmentation(vtkSegmentation* segmentation)
+{
+  // Overlapping spheres are stored in separate layers, non-overlapping ones share a layer
+  double sphereCenters[4][3] = { { 0,0,0 }, { -1,-1,-1 }, { 5,5,5 }, { -4,4,-4 } };
+  double sphereRadii[4] = { 1, 2, 2, 1.5 };
+  segmentation->SetMasterRepresentationName(vtkSegmentationConverter::GetClosedSurfaceRepresentationName());
+  for (int i = 0; i < 4; ++i)
+    {
+    vtkNew<vtkPolyData> spherePolyData;
+    CreateSpherePolyData(spherePolyData.GetPointer(), sphereCenters[i], sphereRadii[i]);
+    vtkNew<vtkSegment> sphereSegment;
+    sphereSegment->AddRepresentation(
+      vtkSegmentationConverter::GetSegmentationClosedSurfaceRepresentationName(), spherePolyData.GetPointer());
+    segmentation->AddSegment(sphereSegment);
+    }
+  SetReferenceGeometry(segmentation);
+  segmentation->CreateRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName());
+  segmentation->SetMasterRepresentationName(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName());
+}
+
+//----------------------------------------------------------------------------
+bool TestConcurrentConversion(bool jointSmoothing)
+{
+  vtkNew<vtkSegmentation> sequentialSegmentation;
+  CreateSphereLabelmapSegmentation(sequentialSegmentation);
+  vtkNew<vtkSegmentation> concurrentSegmentation;
+  CreateSphereLabelmapSegmentation(concurrentSegmentation);
+  concurrentSegmentation->ConcurrentConversionOn();
+
+  std::string jointSmoothingValue = jointSmoothing ? "1" : "0";
+  sequentialSegmentation->SetConversionParameter(
+    vtkBinaryLabelmapToClosedSurfaceConversionRule::GetJointSmoothingParameterName(), jointSmoothingValue);
+  concurrentSegmentation->SetConversionParameter(
+    vtkBinaryLabelmapToClosedSurfaceConversionRule::GetJointSmoothingParameterName(), jointSmoothingValue);
+
+  if (concurrentSegmentation->GetNumberOfLayers(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()) < 2)
+    {
+    std::cerr << __LINE__ << ": Segments are expected to be stored in multiple layers" << std::endl;
+    return false;
+    }
+
+  // Convert twice, so that both creating and overwriting the target representation is tested
+  for (int conversion = 0; conversion < 2; ++conversion)
+    {
+    bool alwaysConvert = (conversion > 0);
+    if (!sequentialSegmentation->CreateRepresentation(vtkSegmentationConverter::GetClosedSurfaceRepresentationName(), alwaysConvert)
+      || !concurrentSegmentation->CreateRepresentation(vtkSegmentationConverter::GetClosedSurfaceRepresentationName(), alwaysConvert))
+      {
+      std::cerr << __LINE__ << ": Failed to create closed surface representation" << std::endl;
+      return false;
+      }
+
+    std::vector<std::string> segmentIDs;
+    sequentialSegmentation->GetSegmentIDs(segmentIDs);
+    for (std::vector<std::string>::iterator segmentIdIt = segmentIDs.begin(); segmentIdIt != segmentIDs.end(); ++segmentIdIt)
+      {
+      vtkPolyData* sequentialSurface = vtkPolyData::SafeDownCast(sequentialSegmentation->GetSegment(*segmentIdIt)->GetRepresentation(
+        vtkSegmentationConverter::GetClosedSurfaceRepresentationName()));
+      vtkPolyData* concurrentSurface = vtkPolyData::SafeDownCast(concurrentSegmentation->GetSegment(*segmentIdIt)->GetRepresentation(
+        vtkSegmentationConverter::GetClosedSurfaceRepresentationName()));
+      if (!sequentialSurface || !concurrentSurface)
+        {
+        std::cerr << __LINE__ << ": Missing closed surface representation in segment " << *segmentIdIt << std::endl;
+        return false;
+        }
+      if (sequentialSurface->GetNumberOfPoints() == 0
+        || sequentialSurface->GetNumberOfPoints() != concurrentSurface->GetNumberOfPoints()
+        || sequentialSurface->GetNumberOfPolys() != concurrentSurface->GetNumberOfPolys())
+        {
+        std::cerr << __LINE__ << ": Concurrent conversion result of segment " << *segmentIdIt << " (" << concurrentSurface->GetNumberOfPoints()
+          << " points) differs from sequential conversion result (" << sequentialSurface->GetNumberOfPoints() << " points)" << std::endl;
+        return false;
+        }
+      for (vtkIdType pointIndex = 0; pointIndex < sequentialSurface->GetNumberOfPoints(); ++pointIndex)
+        {
+        double sequentialPoint[3] = { 0.0, 0.0, 0.0 };
+        sequentialSurface->GetPoint(pointIndex, sequentialPoint);
+        double concurrentPoint[3] = { 0.0, 0.0, 0.0 };
+        concurrentSurface->GetPoint(pointIndex, concurrentPoint);
+        if (sequentialPoint[0] != concurrentPoint[0] || sequentialPoint[1] != concurrentPoint[1] || sequentialPoint[2] != concurrentPoint[2])
+          {
+          std::cerr << __LINE__ << ": Concurrent conversion result of segment " << *segmentIdIt
+            << " differs from sequential conversion result at point " << pointIndex << std::endl;
+          return false;
+          }
+        }
+      }
+    }
+
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool TestJointSurfaceSplit()
+{
+  // Labelmap with adjacent boxes of different labels
+  vtkNew<vtkOrientedImageData> labelmap;
+  labelmap->SetExtent(0, 29, 0, 19, 0, 19);
+  labelmap->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  labelmap->GetPointData()->GetScalars()->Fill(0);
+  for (int k = 4; k < 16; ++k)
+    {
+    for (int j = 4; j < 16; ++j)
+      {
+      for (int i = 4; i < 26; ++i)
+        {
+        unsigned char labelValue = static_cast<unsigned char>(i < 12 ? 1 : (i < 20 ? 2 : 5));
+        *static_cast<unsigned char*>(labelmap->GetScalarPointer(i, j, k)) = labelValue;
+        }
+      }
+    }
+
+  vtkNew<vtkBinaryLabelmapToClosedSurfaceConversionRule> rule;
+  std::vector<int> labelValues = { 1, 2, 5 };
+  vtkNew<vtkPolyData> jointSurface;
+  rule->CreateClosedSurface(labelmap, jointSurface, labelValues);
+
+  std::map<int, vtkSmartPointer<vtkPolyData> > labelSurfaces;
+  vtkBinaryLabelmapToClosedSurfaceConversionRule::SplitSurfaceByLabel(jointSurface, labelSurfaces);
+  if (labelSurfaces.size() != labelValues.size())
+    {
+    std::cerr << __LINE__ << ": Invalid number of label surfaces " << labelSurfaces.size()
+      << " should be " << labelValues.size() << std::endl;
+    return false;
+    }
+
+  for (std::vector<int>::iterator labelIt = labelValues.begin(); labelIt != labelValues.end(); ++labelIt)
+    {
+    // Extract the label using threshold selection, as it was done before surfaces were split
+    vtkNew<vtkSelectionSource> selection;
+    selection->SetContentType(vtkSelectionNode::THRESHOLDS);
+    selection->SetFieldType(vtkSelectionNode::POINT);
+    selection->ContainingCellsOn();
+    selection->AddThreshold(*labelIt, *labelIt);
+    vtkNew<vtkExtractSelection> threshold;
+    threshold->SetInputData(jointSurface);
+    threshold->SetSelectionConnection(selection->GetOutputPort());
+    vtkNew<vtkGeometryFilter> geometry;
+    geometry->SetInputConnection(threshold->GetOutputPort());
+    geometry->Update();
+    vtkPolyData* expectedSurface = geometry->GetOutput();
+
+    vtkPolyData* labelSurface = labelSurfaces[*labelIt];
+    if (!labelSurface
+      || expectedSurface->GetNumberOfPolys() == 0
+      || labelSurface->GetNumberOfPoints() != expectedSurface->GetNumberOfPoints()
+      || labelSurface->GetNumberOfCells() != expectedSurface->GetNumberOfCells())
+      {
+      std::cerr << __LINE__ << ": Surface of label " << *labelIt << " differs from the extracted surface ("
+        << expectedSurface->GetNumberOfPoints() << " points, " << expectedSurface->GetNumberOfCells() << " cells)" << std::endl;
+      return false;
+      }
+    for (vtkIdType pointIndex = 0; pointIndex < expectedSurface->GetNumberOfPoints(); ++pointIndex)
+      {
+      double expectedPoint[3] = { 0.0, 0.0, 0.0 };
+      expectedSurface->GetPoint(pointIndex, expectedPoint);
+      double point[3] = { 0.0, 0.0, 0.0 };
+      labelSurface->GetPoint(pointIndex, point);
+      if (expectedPoint[0] != point[0] || expectedPoint[1] != point[1] || expectedPoint[2] != point[2])
+        {
+        std::cerr << __LINE__ << ": Surface of label " << *labelIt << " differs from the extracted surface at point " << pointIndex << std::endl;
+        return false;
+        }
+      }
+    vtkNew<vtkIdList> expectedCellPointIds;
+    vtkNew<vtkIdList> cellPointIds;
+    for (vtkIdType cellIndex = 0; cellIndex < expectedSurface->GetNumberOfCells(); ++cellIndex)
+      {
+      expectedSurface->GetCellPoints(cellIndex, expectedCellPointIds);
+      labelSurface->GetCellPoints(cellIndex, cellPointIds);
+      bool sameCell = (expectedCellPointIds->GetNumberOfIds() == cellPointIds->GetNumberOfIds());
+      for (vtkIdType i = 0; sameCell && i < cellPointIds->GetNumberOfIds(); ++i)
+        {
+        sameCell = (expectedCellPointIds->GetId(i) == cellPointIds->GetId(i));
+        }
+      if (!sameCell)
+        {
+        std::cerr << __LINE__ << ": Surface of label " << *labelIt << " differs from the extracted surface at cell " << cellIndex << std::endl;
+        return false;
+        }
+      }
+    }
+
+  return true;
+}
+
 //----------------------------------------------------------------------------
 int vtkSegmentationTest2(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
 {
@@ -338,6 +530,16 @@ int vtkSegmentationTest2(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
     return EXIT_FAILURE;
     }
 
+  if (!TestConcurrentConversion(false) || !TestConcurrentConversion(true))
+    {
+    return EXIT_FAILURE;
+    }
+
+  if (!TestJointSurfaceSplit())
+    {
+    return EXIT_FAILURE;
+    }
+
   std::cout << "Segmentation test 2 passed." << std::endl;
   return EXIT_SUCCESS;
 }
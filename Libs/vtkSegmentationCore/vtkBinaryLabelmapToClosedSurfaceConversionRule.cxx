@@ -65,8 +65,106 @@
 #include <vtkFloatArray.h>
 #include <vtkExtractSelectedIds.h>
 #include <vtkInformation.h>
-#include <vtkExtractSelection.h>
-#include <vtkSelectionSource.h>
+#include <vtkCellData.h>
+#include <vtkIdList.h>
+#include <vtkIdTypeArray.h>
+#include <vtkSMPTools.h>
+
+// STD includes
+#include <algorithm>
+
+//----------------------------------------------------------------------------
+/// Builds the surface of each label from the list of cells of that label.
+/// Different labels may be processed in parallel.
+class SplitSurfaceByLabelFunctor
+{
+public:
+  SplitSurfaceByLabelFunctor(vtkPolyData* jointSurface, std::vector<std::vector<vtkIdType> >& labelCellIds,
+    std::vector<vtkSmartPointer<vtkPolyData> >& labelSurfaces)
+    : JointSurface(jointSurface)
+    , LabelCellIds(labelCellIds)
+    , LabelSurfaces(labelSurfaces)
+    {
+    }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+    {
+    vtkNew<vtkIdList> cellPointIds;
+    for (vtkIdType labelIndex = begin; labelIndex < end; ++labelIndex)
+      {
+      this->LabelSurfaces[labelIndex] = this->ExtractCells(this->LabelCellIds[labelIndex], cellPointIds);
+      }
+    }
+
+  vtkSmartPointer<vtkPolyData> ExtractCells(const std::vector<vtkIdType>& cellIds, vtkIdList* cellPointIds)
+    {
+    // Points used by the cells, in increasing order of their original ID
+    std::vector<vtkIdType> pointIds;
+    for (std::vector<vtkIdType>::const_iterator cellIt = cellIds.begin(); cellIt != cellIds.end(); ++cellIt)
+      {
+      this->JointSurface->GetCellPoints(*cellIt, cellPointIds);
+      for (vtkIdType i = 0; i < cellPointIds->GetNumberOfIds(); ++i)
+        {
+        pointIds.push_back(cellPointIds->GetId(i));
+        }
+      }
+    std::sort(pointIds.begin(), pointIds.end());
+    pointIds.erase(std::unique(pointIds.begin(), pointIds.end()), pointIds.end());
+    vtkIdType numberOfPoints = static_cast<vtkIdType>(pointIds.size());
+    vtkIdType numberOfCells = static_cast<vtkIdType>(cellIds.size());
+
+    vtkSmartPointer<vtkPolyData> labelSurface = vtkSmartPointer<vtkPolyData>::New();
+    vtkPointData* inputPointData = this->JointSurface->GetPointData();
+    vtkPointData* outputPointData = labelSurface->GetPointData();
+    vtkCellData* inputCellData = this->JointSurface->GetCellData();
+    vtkCellData* outputCellData = labelSurface->GetCellData();
+
+    vtkNew<vtkPoints> points;
+    points->SetDataType(this->JointSurface->GetPoints()->GetDataType());
+    points->SetNumberOfPoints(numberOfPoints);
+    outputPointData->CopyAllocate(inputPointData, numberOfPoints);
+    vtkNew<vtkIdTypeArray> originalPointIds;
+    originalPointIds->SetName("vtkOriginalPointIds");
+    originalPointIds->SetNumberOfValues(numberOfPoints);
+    for (vtkIdType pointIndex = 0; pointIndex < numberOfPoints; ++pointIndex)
+      {
+      double point[3] = { 0.0, 0.0, 0.0 };
+      this->JointSurface->GetPoints()->GetPoint(pointIds[pointIndex], point);
+      points->SetPoint(pointIndex, point);
+      outputPointData->CopyData(inputPointData, pointIds[pointIndex], pointIndex);
+      originalPointIds->SetValue(pointIndex, pointIds[pointIndex]);
+      }
+    labelSurface->SetPoints(points);
+    outputPointData->AddArray(originalPointIds);
+
+    labelSurface->Allocate(numberOfCells);
+    outputCellData->CopyAllocate(inputCellData, numberOfCells);
+    vtkNew<vtkIdTypeArray> originalCellIds;
+    originalCellIds->SetName("vtkOriginalCellIds");
+    originalCellIds->SetNumberOfValues(numberOfCells);
+    for (vtkIdType cellIndex = 0; cellIndex < numberOfCells; ++cellIndex)
+      {
+      vtkIdType cellId = cellIds[cellIndex];
+      this->JointSurface->GetCellPoints(cellId, cellPointIds);
+      for (vtkIdType i = 0; i < cellPointIds->GetNumberOfIds(); ++i)
+        {
+        cellPointIds->SetId(i, static_cast<vtkIdType>(
+          std::lower_bound(pointIds.begin(), pointIds.end(), cellPointIds->GetId(i)) - pointIds.begin()));
+        }
+      vtkIdType newCellId = labelSurface->InsertNextCell(this->JointSurface->GetCellType(cellId), cellPointIds);
+      outputCellData->CopyData(inputCellData, cellId, newCellId);
+      originalCellIds->SetValue(cellIndex, cellId);
+      }
+    outputCellData->AddArray(originalCellIds);
+    labelSurface->Squeeze();
+    return labelSurface;
+    }
+
+private:
+  vtkPolyData* JointSurface;
+  std::vector<std::vector<vtkIdType> >& LabelCellIds;
+  std::vector<vtkSmartPointer<vtkPolyData> >& LabelSurfaces;
+};
 
 //----------------------------------------------------------------------------
 vtkSegmentationConverterRuleNewMacro(vtkBinaryLabelmapToClosedSurfaceConversionRule);
@@ -161,7 +259,21 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::Convert(vtkSegment* segment
 
   if (jointSmoothing > 0 && smoothingFactor > 0)
     {
-    if (this->JointSmoothCache.find(orientedBinaryLabelmap) == this->JointSmoothCache.end())
+    // Segments sharing the same labelmap are always converted on the same thread,
+    // so only the access to the cache needs to be protected, not the surface creation.
+    std::map<int, vtkSmartPointer<vtkPolyData> > labelSurfaces;
+    bool jointSurfaceCached = false;
+      {
+      std::lock_guard<std::mutex> lock(this->JointSmoothCacheLock);
+      std::map<vtkOrientedImageData*, std::map<int, vtkSmartPointer<vtkPolyData> > >::iterator cacheIt =
+        this->JointSmoothCache.find(orientedBinaryLabelmap);
+      if (cacheIt != this->JointSmoothCache.end())
+        {
+        labelSurfaces = cacheIt->second;
+        jointSurfaceCached = true;
+        }
+      }
+    if (!jointSurfaceCached)
       {
       double* scalarRange = orientedBinaryLabelmap->GetScalarRange();
       int lowLabel = (int)(floor(scalarRange[0]));
@@ -188,32 +300,22 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::Convert(vtkSegment* segment
 
       vtkSmartPointer<vtkPolyData> jointSmoothedSurface = vtkSmartPointer<vtkPolyData>::New();
       this->CreateClosedSurface(orientedBinaryLabelmap, jointSmoothedSurface, labelValues);
-      this->JointSmoothCache[orientedBinaryLabelmap] = jointSmoothedSurface;
+      // Split the joint surface into the surfaces of all the segments at once,
+      // instead of extracting each segment from the joint surface separately.
+      vtkBinaryLabelmapToClosedSurfaceConversionRule::SplitSurfaceByLabel(jointSmoothedSurface, labelSurfaces);
+      std::lock_guard<std::mutex> lock(this->JointSmoothCacheLock);
+      this->JointSmoothCache[orientedBinaryLabelmap] = labelSurfaces;
       }
 
-    vtkDataObject* sharedSurface = this->JointSmoothCache[orientedBinaryLabelmap];
-    if (!sharedSurface)
+    std::map<int, vtkSmartPointer<vtkPolyData> >::iterator labelSurfaceIt = labelSurfaces.find(segment->GetLabelValue());
+    if (labelSurfaceIt != labelSurfaces.end())
       {
-      vtkErrorMacro("Convert: Could not find cached surface");
-      return false;
+      closedSurfacePolyData->ShallowCopy(labelSurfaceIt->second);
+      }
+    else
+      {
+      closedSurfacePolyData->Initialize();
       }
-
-    vtkNew<vtkSelectionSource> selection;
-    selection->SetContentType(vtkSelectionNode::THRESHOLDS);
-    selection->SetFieldType(vtkSelectionNode::POINT);
-    selection->GetContainingCells();
-    selection->AddThreshold(segment->GetLabelValue(), segment->GetLabelValue());
-
-    vtkNew<vtkExtractSelection> threshold;
-    threshold->SetInputData(sharedSurface);
-    threshold->SetSelectionConnection(selection->GetOutputPort());
-
-    vtkNew<vtkGeometryFilter> geometry;
-    geometry->SetInputConnection(threshold->GetOutputPort());
-    geometry->Update();
-
-    vtkPolyData* thresholdedSurface = geometry->GetOutput();
-    closedSurfacePolyData->ShallowCopy(thresholdedSurface);
     }
   else
     {
@@ -386,9 +488,69 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::CreateClosedSurface(vtkOrie
   return true;
 }
 
+//----------------------------------------------------------------------------
+void vtkBinaryLabelmapToClosedSurfaceConversionRule::SplitSurfaceByLabel(vtkPolyData* jointSurface,
+  std::map<int, vtkSmartPointer<vtkPolyData> >& labelSurfaces)
+{
+  labelSurfaces.clear();
+  if (!jointSurface || !jointSurface->GetPoints())
+    {
+    return;
+    }
+  vtkDataArray* labelArray = jointSurface->GetPointData()->GetScalars();
+  if (!labelArray)
+    {
+    return;
+    }
+
+  // Collect the cells of each label in a single pass.
+  // This also builds the cells of the joint surface, which is required before accessing them from multiple threads.
+  std::vector<int> labelValues;
+  std::map<int, size_t> labelIndices;
+  std::vector<std::vector<vtkIdType> > labelCellIds;
+  std::vector<int> cellLabelValues;
+  vtkNew<vtkIdList> cellPointIds;
+  vtkIdType numberOfCells = jointSurface->GetNumberOfCells();
+  for (vtkIdType cellId = 0; cellId < numberOfCells; ++cellId)
+    {
+    jointSurface->GetCellPoints(cellId, cellPointIds);
+    cellLabelValues.clear();
+    for (vtkIdType i = 0; i < cellPointIds->GetNumberOfIds(); ++i)
+      {
+      double value = labelArray->GetTuple1(cellPointIds->GetId(i));
+      int labelValue = static_cast<int>(value);
+      if (labelValue != value
+        || std::find(cellLabelValues.begin(), cellLabelValues.end(), labelValue) != cellLabelValues.end())
+        {
+        continue;
+        }
+      cellLabelValues.push_back(labelValue);
+
+      std::map<int, size_t>::iterator labelIndexIt = labelIndices.find(labelValue);
+      if (labelIndexIt == labelIndices.end())
+        {
+        labelIndexIt = labelIndices.insert(std::make_pair(labelValue, labelValues.size())).first;
+        labelValues.push_back(labelValue);
+        labelCellIds.push_back(std::vector<vtkIdType>());
+        }
+      labelCellIds[labelIndexIt->second].push_back(cellId);
+      }
+    }
+
+  std::vector<vtkSmartPointer<vtkPolyData> > surfaces(labelValues.size());
+  SplitSurfaceByLabelFunctor functor(jointSurface, labelCellIds, surfaces);
+  vtkSMPTools::For(0, static_cast<vtkIdType>(labelValues.size()), functor);
+
+  for (size_t labelIndex = 0; labelIndex < labelValues.size(); ++labelIndex)
+    {
+    labelSurfaces[labelValues[labelIndex]] = surfaces[labelIndex];
+    }
+}
+
 //----------------------------------------------------------------------------
 bool vtkBinaryLabelmapToClosedSurfaceConversionRule::PostConvert(vtkSegmentation* vtkNotUsed(segmentation))
 {
+  std::lock_guard<std::mutex> lock(this->JointSmoothCacheLock);
   this->JointSmoothCache.clear();
   return true;
 }
@@ -30,6 +30,9 @@
 // VTK includes
 #include <vtkPolyData.h>
 
+// STD includes
+#include <mutex>
+
 /// \ingroup SegmentationCore
 /// \brief Convert binary labelmap representation (vtkOrientedImageData type) to
 ///   closed surface representation (vtkPolyData type). The conversion algorithm
@@ -68,6 +71,12 @@ public:
   /// Perform the actual binary labelmap to closed surface conversion
   bool CreateClosedSurface(vtkOrientedImageData* inputImage, vtkPolyData* outputPolydata, std::vector<int> values);
 
+  /// Split a surface containing multiple labels (stored in the point scalars) into one surface per label value.
+  /// A cell is added to the surface of each label value of its points, points are kept in their original order.
+  /// The result is the same as extracting each label using a point threshold selection, but the input
+  /// is traversed only once and the label surfaces are built in parallel.
+  static void SplitSurfaceByLabel(vtkPolyData* jointSurface, std::map<int, vtkSmartPointer<vtkPolyData> >& labelSurfaces);
+
   /// Update the target representation based on the source representation
   bool Convert(vtkSegment* segment) override;
 
@@ -75,6 +84,10 @@ public:
   /// Clears the joint smoothing cache
   bool PostConvert(vtkSegmentation* segmentation) override;
 
+  /// Segments in different labelmaps can be converted concurrently.
+  /// The joint smoothing cache is protected by a mutex.
+  bool IsConcurrentConversionSupported() override { return true; };
+
   /// Get the cost of the conversion.
   unsigned int GetConversionCost(vtkDataObject* sourceRepresentation=nullptr, vtkDataObject* targetRepresentation=nullptr) override;
 
@@ -98,9 +111,13 @@ protected:
   void operator=(const vtkBinaryLabelmapToClosedSurfaceConversionRule&);
 
 protected:
-  /// Cache for storing merged closed surfaces that have been joint smoothed
-  /// The key used is the binary labelmap representation, which maps to the combined vtkPolyData containing surfaces for all segments in the segmentation
-  std::map<vtkOrientedImageData*, vtkSmartPointer<vtkPolyData> > JointSmoothCache;
+  /// Cache for storing closed surfaces that have been joint smoothed
+  /// The key used is the binary labelmap representation, which maps to the surfaces of all segments in the labelmap split from
+  /// the combined joint smoothed vtkPolyData (indexed by label value)
+  std::map<vtkOrientedImageData*, std::map<int, vtkSmartPointer<vtkPolyData> > > JointSmoothCache;
+
+  /// Lock protecting \sa JointSmoothCache during concurrent conversion
+  std::mutex JointSmoothCacheLock;
 
 };
 
@@ -40,6 +40,7 @@
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
 #include <vtkPolyData.h>
+#include <vtkSMPTools.h>
 #include <vtkStringArray.h>
 #include <vtkTransform.h>
 #include <vtkTransformPolyDataFilter.h>
@@ -66,6 +67,48 @@ public:
     }
 };
 
+//----------------------------------------------------------------------------
+/// Converts groups of segments using a conversion rule. Each group is converted
+/// sequentially, different groups may be converted in parallel.
+/// The result of the conversion of each segment is stored in ConversionResults.
+class ConvertSegmentGroupsFunctor
+{
+public:
+  typedef std::vector<std::vector<vtkSegment*> > SegmentGroupListType;
+  // char instead of bool so that groups can be written from different threads
+  typedef std::vector<std::vector<char> > ConversionResultListType;
+
+  ConvertSegmentGroupsFunctor(vtkSegmentationConverterRule* rule, SegmentGroupListType& segmentGroups,
+    ConversionResultListType& conversionResults)
+    : Rule(rule)
+    , SegmentGroups(segmentGroups)
+    , ConversionResults(conversionResults)
+    {
+    this->ConversionResults.resize(this->SegmentGroups.size());
+    for (size_t groupIndex = 0; groupIndex < this->SegmentGroups.size(); ++groupIndex)
+      {
+      this->ConversionResults[groupIndex].assign(this->SegmentGroups[groupIndex].size(), 0);
+      }
+    }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType groupIndex = begin; groupIndex < end; ++groupIndex)
+      {
+      std::vector<vtkSegment*>& segments = this->SegmentGroups[groupIndex];
+      for (size_t segmentIndex = 0; segmentIndex < segments.size(); ++segmentIndex)
+        {
+        this->ConversionResults[groupIndex][segmentIndex] = this->Rule->Convert(segments[segmentIndex]);
+        }
+      }
+    }
+
+private:
+  vtkSegmentationConverterRule* Rule;
+  SegmentGroupListType& SegmentGroups;
+  ConversionResultListType& ConversionResults;
+};
+
 //----------------------------------------------------------------------------
 vtkSegmentation::vtkSegmentation()
 {
@@ -84,6 +127,8 @@ vtkSegmentation::vtkSegmentation()
 
   this->SegmentIdAutogeneratorIndex = 0;
 
+  this->ConcurrentConversion = false;
+
   this->SetMasterRepresentationName(vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName());
 }
 
@@ -147,6 +192,7 @@ void vtkSegmentation::DeepCopy(vtkSegmentation* aSegmentation)
 
   // Copy properties
   this->SetMasterRepresentationName(aSegmentation->GetMasterRepresentationName());
+  this->SetConcurrentConversion(aSegmentation->GetConcurrentConversion());
 
   // Copy conversion parameters
   this->Converter->DeepCopy(aSegmentation->Converter);
@@ -177,6 +223,7 @@ void vtkSegmentation::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Modified Time: " << this->GetMTime() << "\n";
 
   os << indent << "MasterRepresentationName:  " << this->MasterRepresentationName << "\n";
+  os << indent << "ConcurrentConversion:  " << (this->ConcurrentConversion ? "true" : "false") << "\n";
   os << indent << "Number of segments:  " << this->Segments.size() << "\n";
 
   for (std::deque< std::string >::iterator segmentIdIt = this->SegmentIds.begin();
@@ -1027,6 +1074,15 @@ bool vtkSegmentation::ConvertSegmentsUsingPath(std::vector<std::string> segmentI
 
     // Perform conversion step
     currentConversionRule->PreConvert(this);
+    if (this->ConcurrentConversion && currentConversionRule->IsConcurrentConversionSupported())
+      {
+      if (!this->ConvertSegmentsUsingRuleConcurrently(segmentIDs, currentConversionRule, overwriteExisting))
+        {
+        return false;
+        }
+      currentConversionRule->PostConvert(this);
+      continue;
+      }
     for (auto segmentID : segmentIDs)
       {
       vtkSegment* segment = this->GetSegment(segmentID);
@@ -1058,6 +1114,95 @@ bool vtkSegmentation::ConvertSegmentsUsingPath(std::vector<std::string> segmentI
   return true;
 }
 
+//-----------------------------------------------------------------------------
+bool vtkSegmentation::ConvertSegmentsUsingRuleConcurrently(const std::vector<std::string>& segmentIDs,
+  vtkSegmentationConverterRule* rule, bool overwriteExisting)
+{
+  const char* sourceRepresentationName = rule->GetSourceRepresentationName();
+  const char* targetRepresentationName = rule->GetTargetRepresentationName();
+
+  // Segments are converted as copies that share the source representation but are not observed,
+  // so that no events are invoked from the worker threads. Segments sharing the same source
+  // representation (shared labelmap layer) are grouped, as they cannot be converted in parallel.
+  std::vector<std::pair<vtkSegment*, vtkSmartPointer<vtkSegment> > > convertedSegments;
+  std::map<vtkDataObject*, size_t> groupIndices;
+  ConvertSegmentGroupsFunctor::SegmentGroupListType segmentGroups;
+  for (std::vector<std::string>::const_iterator segmentIdIt = segmentIDs.begin(); segmentIdIt != segmentIDs.end(); ++segmentIdIt)
+    {
+    vtkSegment* segment = this->GetSegment(*segmentIdIt);
+
+    // Get source representation from segment. It is expected to exist
+    vtkDataObject* sourceRepresentation = segment->GetRepresentation(sourceRepresentationName);
+    if (!sourceRepresentation)
+      {
+      vtkErrorMacro("ConvertSegmentsUsingRuleConcurrently: Source representation does not exist!");
+      return false;
+      }
+    // If target representation exists and we do not overwrite existing representations,
+    // then no conversion is necessary with this conversion rule
+    if (segment->GetRepresentation(targetRepresentationName) && !overwriteExisting)
+      {
+      continue;
+      }
+
+    vtkSmartPointer<vtkSegment> segmentCopy = vtkSmartPointer<vtkSegment>::New();
+    segmentCopy->DeepCopyMetadata(segment);
+    segmentCopy->AddRepresentation(sourceRepresentationName, sourceRepresentation);
+    convertedSegments.push_back(std::make_pair(segment, segmentCopy));
+
+    std::map<vtkDataObject*, size_t>::iterator groupIt = groupIndices.find(sourceRepresentation);
+    if (groupIt == groupIndices.end())
+      {
+      groupIt = groupIndices.insert(std::make_pair(sourceRepresentation, segmentGroups.size())).first;
+      segmentGroups.push_back(std::vector<vtkSegment*>());
+      }
+    segmentGroups[groupIt->second].push_back(segmentCopy);
+    }
+
+  ConvertSegmentGroupsFunctor::ConversionResultListType conversionResults;
+  ConvertSegmentGroupsFunctor functor(rule, segmentGroups, conversionResults);
+  vtkSMPTools::For(0, static_cast<vtkIdType>(segmentGroups.size()), functor);
+
+  // Report failed conversions from the calling thread. As in the sequential conversion,
+  // the other segments are still converted and set.
+  for (size_t groupIndex = 0; groupIndex < segmentGroups.size(); ++groupIndex)
+    {
+    for (size_t segmentIndex = 0; segmentIndex < segmentGroups[groupIndex].size(); ++segmentIndex)
+      {
+      if (!conversionResults[groupIndex][segmentIndex])
+        {
+        vtkSegment* segment = segmentGroups[groupIndex][segmentIndex];
+        vtkErrorMacro("ConvertSegmentsUsingRuleConcurrently: Failed to convert segment '"
+          << (segment->GetName() ? segment->GetName() : "") << "' from " << sourceRepresentationName
+          << " to " << targetRepresentationName);
+        }
+      }
+    }
+
+  // Set converted representations in the original segments in the same way as the sequential conversion would
+  for (std::vector<std::pair<vtkSegment*, vtkSmartPointer<vtkSegment> > >::iterator segmentIt = convertedSegments.begin();
+    segmentIt != convertedSegments.end(); ++segmentIt)
+    {
+    vtkSegment* segment = segmentIt->first;
+    vtkDataObject* convertedRepresentation = segmentIt->second->GetRepresentation(targetRepresentationName);
+    if (!convertedRepresentation)
+      {
+      continue;
+      }
+    vtkDataObject* targetRepresentation = segment->GetRepresentation(targetRepresentationName);
+    if (targetRepresentation && !rule->GetReplaceTargetRepresentation())
+      {
+      targetRepresentation->ShallowCopy(convertedRepresentation);
+      }
+    else
+      {
+      segment->AddRepresentation(targetRepresentationName, convertedRepresentation);
+      }
+    }
+
+  return true;
+}
+
 //-----------------------------------------------------------------------------
 bool vtkSegmentation::ConvertSegmentUsingPath(vtkSegment* segment, vtkSegmentationConverter::ConversionPathType path, bool overwriteExisting/*=false*/)
 {
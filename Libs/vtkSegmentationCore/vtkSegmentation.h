@@ -461,6 +461,14 @@ public:
   /// the segmentation! Use \sa CreateRepresentation for that.
   virtual void SetMasterRepresentationName(const std::string& representationName);
 
+  /// Enable/disable concurrent conversion of segments.
+  /// If enabled, then conversion rules that support it (\sa vtkSegmentationConverterRule::IsConcurrentConversionSupported)
+  /// convert segments with different source representation objects (such as segments in different shared
+  /// labelmap layers) in parallel. The result is the same as with sequential conversion. Disabled by default.
+  vtkGetMacro(ConcurrentConversion, bool);
+  vtkSetMacro(ConcurrentConversion, bool);
+  vtkBooleanMacro(ConcurrentConversion, bool);
+
   /// Deep copies source segment to destination segment. If the same representation is found in baseline
   /// with up-to-date timestamp then the representation is reused from baseline.
   static void CopySegment(vtkSegment* destination, vtkSegment* source, vtkSegment* baseline,
@@ -477,6 +485,15 @@ protected:
   /// \return Success flag
   bool ConvertSegmentUsingPath(vtkSegment* segment, vtkSegmentationConverter::ConversionPathType path, bool overwriteExisting = false);
 
+  /// Convert segments using a single conversion rule on multiple threads.
+  /// Segments sharing the same source representation object are converted on the same thread.
+  /// Converted representations are set to the segments on the calling thread.
+  /// Segments that fail to convert are reported as errors on the calling thread, the other
+  /// segments are converted as in the sequential conversion.
+  /// \sa ConcurrentConversion
+  bool ConvertSegmentsUsingRuleConcurrently(const std::vector<std::string>& segmentIDs,
+    vtkSegmentationConverterRule* rule, bool overwriteExisting);
+
   /// Converts a single segment to a representation.
   bool ConvertSingleSegment(std::string segmentId, std::string targetRepresentationName);
 
@@ -550,6 +567,9 @@ protected:
 
   std::set<vtkSmartPointer<vtkDataObject> > MasterRepresentationCache;
 
+  /// Segments are converted on multiple threads if the conversion rule supports it
+  bool ConcurrentConversion;
+
   friend class vtkMRMLSegmentationNode;
   friend class vtkSlicerSegmentationsModuleLogic;
   friend class vtkSegmentationModifier;
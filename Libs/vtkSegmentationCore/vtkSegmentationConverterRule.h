@@ -96,6 +96,11 @@ public:
   /// This step should be unneccessary if only converting a single segment
   virtual bool PostConvert(vtkSegmentation* vtkNotUsed(segmentation)) { return true; };
 
+  /// Return true if \sa Convert can be called concurrently from multiple threads for segments that
+  /// do not share their source representation object. \sa PreConvert and \sa PostConvert are always
+  /// called from the thread that performs the conversion. False by default.
+  virtual bool IsConcurrentConversionSupported() { return false; };
+
   /// Get the cost of the conversion.
   /// \return Expected duration of the conversion in milliseconds. If the arguments are omitted, then a rough average can be
   ///   given just to indicate the relative computational cost of the algorithm. If the objects are given, then a more educated
@@ -132,6 +137,9 @@ public:
   /// Determine if the rule has a parameter with a certain name
   bool HasConversionParameter(const std::string& name);
 
+  /// If true, the target representation of the segment is replaced with a new object on conversion
+  vtkGetMacro(ReplaceTargetRepresentation, bool);
+
 protected:
   /// Update the target representation based on the source representation
   virtual bool CreateTargetRepresentation(vtkSegment* segment);
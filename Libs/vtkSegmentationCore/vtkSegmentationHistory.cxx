@@ -22,14 +22,409 @@
 #include "vtkSegmentationHistory.h"
 #include "vtkSegmentationConverterFactory.h"
 #include "vtkSegmentation.h"
+#include "vtkOrientedImageData.h"
 
 // VTK includes
 #include <vtkNew.h>
+#include <vtkMatrix4x4.h>
 #include <vtkObjectFactory.h>
 #include <vtkCallbackCommand.h>
+#include <vtkPointData.h>
+#include <vtkUnsignedCharArray.h>
+#include <vtkWeakPointer.h>
+#include <vtkZLibDataCompressor.h>
 
 // std includes
 #include <algorithm>
+#include <cstring>
+#include <set>
+
+namespace
+{
+//----------------------------------------------------------------------------
+vtkIdType GetNumberOfVoxels(const int extent[6])
+{
+  if (extent[0] > extent[1] || extent[2] > extent[3] || extent[4] > extent[5])
+    {
+    return 0;
+    }
+  return static_cast<vtkIdType>(extent[1] - extent[0] + 1)
+    * static_cast<vtkIdType>(extent[3] - extent[2] + 1)
+    * static_cast<vtkIdType>(extent[5] - extent[4] + 1);
+}
+
+//----------------------------------------------------------------------------
+/// Copy voxels of a region between an image buffer and a contiguous region buffer.
+/// \param imageToRegion If true then voxels are copied from the image to the region, otherwise from the region to the image
+void CopyImageRegion(unsigned char* imageScalars, const int imageExtent[6],
+  unsigned char* regionScalars, const int regionExtent[6], vtkIdType voxelSize, bool imageToRegion)
+{
+  vtkIdType regionRowSize = static_cast<vtkIdType>(regionExtent[1] - regionExtent[0] + 1) * voxelSize;
+  vtkIdType imageRowSize = static_cast<vtkIdType>(imageExtent[1] - imageExtent[0] + 1) * voxelSize;
+  vtkIdType imageSliceSize = imageRowSize * (imageExtent[3] - imageExtent[2] + 1);
+  for (int k = regionExtent[4]; k <= regionExtent[5]; ++k)
+    {
+    for (int j = regionExtent[2]; j <= regionExtent[3]; ++j)
+      {
+      unsigned char* imageRow = imageScalars + (k - imageExtent[4]) * imageSliceSize
+        + (j - imageExtent[2]) * imageRowSize + (regionExtent[0] - imageExtent[0]) * voxelSize;
+      if (imageToRegion)
+        {
+        memcpy(regionScalars, imageRow, regionRowSize);
+        }
+      else
+        {
+        memcpy(imageRow, regionScalars, regionRowSize);
+        }
+      regionScalars += regionRowSize;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Copy voxels of a region between images that have the same extent, scalar type and number of components
+void CopyRegionBetweenImages(vtkImageData* sourceImage, vtkImageData* targetImage, const int region[6])
+{
+  int* extent = sourceImage->GetExtent();
+  vtkIdType voxelSize = sourceImage->GetScalarSize() * sourceImage->GetNumberOfScalarComponents();
+  vtkIdType regionRowSize = static_cast<vtkIdType>(region[1] - region[0] + 1) * voxelSize;
+  vtkIdType rowSize = static_cast<vtkIdType>(extent[1] - extent[0] + 1) * voxelSize;
+  vtkIdType sliceSize = rowSize * (extent[3] - extent[2] + 1);
+  unsigned char* sourceScalars = static_cast<unsigned char*>(sourceImage->GetScalarPointer());
+  unsigned char* targetScalars = static_cast<unsigned char*>(targetImage->GetScalarPointer());
+  for (int k = region[4]; k <= region[5]; ++k)
+    {
+    for (int j = region[2]; j <= region[3]; ++j)
+      {
+      vtkIdType offset = (k - extent[4]) * sliceSize + (j - extent[2]) * rowSize + (region[0] - extent[0]) * voxelSize;
+      memcpy(targetScalars + offset, sourceScalars + offset, regionRowSize);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Get the smallest extent that contains all voxels that are different in the two images.
+/// The images must have the same extent, scalar type and number of components.
+/// \return True if the images are different
+bool GetChangedExtent(vtkImageData* image1, vtkImageData* image2, int changedExtent[6])
+{
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  image1->GetExtent(extent);
+  vtkIdType voxelSize = image1->GetScalarSize() * image1->GetNumberOfScalarComponents();
+  vtkIdType rowSize = static_cast<vtkIdType>(extent[1] - extent[0] + 1) * voxelSize;
+  const unsigned char* row1 = static_cast<unsigned char*>(image1->GetScalarPointer());
+  const unsigned char* row2 = static_cast<unsigned char*>(image2->GetScalarPointer());
+  bool changed = false;
+  for (int k = extent[4]; k <= extent[5]; ++k)
+    {
+    for (int j = extent[2]; j <= extent[3]; ++j, row1 += rowSize, row2 += rowSize)
+      {
+      if (memcmp(row1, row2, rowSize) == 0)
+        {
+        continue;
+        }
+      vtkIdType firstDifference = 0;
+      while (row1[firstDifference] == row2[firstDifference])
+        {
+        ++firstDifference;
+        }
+      vtkIdType lastDifference = rowSize - 1;
+      while (row1[lastDifference] == row2[lastDifference])
+        {
+        --lastDifference;
+        }
+      int firstI = extent[0] + static_cast<int>(firstDifference / voxelSize);
+      int lastI = extent[0] + static_cast<int>(lastDifference / voxelSize);
+      if (!changed)
+        {
+        changedExtent[0] = firstI;
+        changedExtent[1] = lastI;
+        changedExtent[2] = changedExtent[3] = j;
+        changedExtent[4] = changedExtent[5] = k;
+        changed = true;
+        }
+      else
+        {
+        changedExtent[0] = std::min(changedExtent[0], firstI);
+        changedExtent[1] = std::max(changedExtent[1], lastI);
+        changedExtent[2] = std::min(changedExtent[2], j);
+        changedExtent[3] = std::max(changedExtent[3], j);
+        changedExtent[5] = k;
+        }
+      }
+    }
+  return changed;
+}
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+/// Labelmap representation stored in a segmentation state.
+/// Voxels are stored compressed. If the labelmap of the previous state (base) has the same extent,
+/// scalar type and number of components then only the region that is different from the base is stored.
+class vtkSegmentationHistoryLabelmap : public vtkObject
+{
+public:
+  static vtkSegmentationHistoryLabelmap* New();
+  vtkTypeMacro(vtkSegmentationHistoryLabelmap, vtkObject);
+
+  /// Store the labelmap.
+  /// \param baseline Labelmap stored in the previous state. Only the changed region is stored
+  ///   if the labelmap can be stored relative to it. Its uncompressed copy is taken over if it has one.
+  void Store(vtkOrientedImageData* labelmap, vtkSegmentationHistoryLabelmap* baseline);
+
+  /// Create a new labelmap from the stored data.
+  vtkSmartPointer<vtkOrientedImageData> Restore();
+
+  /// Store the labelmap in itself, so that it does not depend on the base labelmap anymore.
+  void RemoveBase();
+
+  /// Set the labelmap object that currently contains the stored content
+  void SetCurrentLabelmap(vtkOrientedImageData* labelmap)
+    {
+    this->CurrentLabelmap = labelmap;
+    this->CurrentLabelmapMTime = labelmap ? labelmap->GetMTime() : 0;
+    }
+
+  /// Returns true if the labelmap object was stored in or restored from this object and it has not been modified since.
+  bool IsCurrentLabelmap(vtkOrientedImageData* labelmap)
+    {
+    return labelmap != nullptr && labelmap == this->CurrentLabelmap.GetPointer()
+      && labelmap->GetMTime() == this->CurrentLabelmapMTime;
+    }
+
+  /// Remove uncompressed copy of the labelmap
+  void RemoveUncompressedLabelmap()
+    {
+    this->UncompressedLabelmap = nullptr;
+    }
+
+  /// Get memory used by this object (not including the base) in kibibytes
+  unsigned long GetActualMemorySize();
+
+protected:
+  vtkSegmentationHistoryLabelmap();
+  ~vtkSegmentationHistoryLabelmap() override = default;
+
+  /// Returns true if the labelmap can be stored relative to this one
+  bool IsCompatible(vtkOrientedImageData* labelmap);
+
+  /// Write stored voxels into scalars buffer that has the size of the stored extent
+  void RestoreScalars(unsigned char* scalars);
+
+  /// Compress the voxels of the region from the scalars buffer that has the size of the stored extent
+  void CompressRegion(unsigned char* scalars, const int region[6]);
+
+protected:
+  int Extent[6];
+  vtkNew<vtkMatrix4x4> ImageToWorldMatrix;
+  int ScalarType;
+  int NumberOfScalarComponents;
+  bool HasScalars;
+
+  /// Labelmap that the stored region is relative to. nullptr if the whole labelmap is stored.
+  vtkSmartPointer<vtkSegmentationHistoryLabelmap> Base;
+  /// Region that is stored in CompressedScalars
+  int StoredExtent[6];
+  vtkSmartPointer<vtkUnsignedCharArray> CompressedScalars;
+
+  /// Uncompressed copy of the labelmap. Only kept for the most recent state,
+  /// to allow quick detection of changed region when the next state is stored.
+  vtkSmartPointer<vtkOrientedImageData> UncompressedLabelmap;
+
+  /// Labelmap object that currently contains the stored content, to avoid storing or restoring it unnecessarily
+  vtkWeakPointer<vtkOrientedImageData> CurrentLabelmap;
+  vtkMTimeType CurrentLabelmapMTime;
+};
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSegmentationHistoryLabelmap);
+
+//----------------------------------------------------------------------------
+vtkSegmentationHistoryLabelmap::vtkSegmentationHistoryLabelmap()
+{
+  for (int i = 0; i < 6; i += 2)
+    {
+    this->Extent[i] = 0;
+    this->Extent[i + 1] = -1;
+    this->StoredExtent[i] = 0;
+    this->StoredExtent[i + 1] = -1;
+    }
+  this->ScalarType = VTK_UNSIGNED_CHAR;
+  this->NumberOfScalarComponents = 1;
+  this->HasScalars = false;
+  this->CurrentLabelmapMTime = 0;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSegmentationHistoryLabelmap::IsCompatible(vtkOrientedImageData* labelmap)
+{
+  if (!this->HasScalars)
+    {
+    return false;
+    }
+  int* extent = labelmap->GetExtent();
+  for (int i = 0; i < 6; ++i)
+    {
+    if (extent[i] != this->Extent[i])
+      {
+      return false;
+      }
+    }
+  return labelmap->GetScalarType() == this->ScalarType
+    && labelmap->GetNumberOfScalarComponents() == this->NumberOfScalarComponents;
+}
+
+//----------------------------------------------------------------------------
+void vtkSegmentationHistoryLabelmap::Store(vtkOrientedImageData* labelmap, vtkSegmentationHistoryLabelmap* baseline)
+{
+  labelmap->GetExtent(this->Extent);
+  labelmap->GetImageToWorldMatrix(this->ImageToWorldMatrix);
+  this->HasScalars = (labelmap->GetPointData()->GetScalars() != nullptr && GetNumberOfVoxels(this->Extent) > 0);
+  this->SetCurrentLabelmap(labelmap);
+  if (!this->HasScalars)
+    {
+    return;
+    }
+  this->ScalarType = labelmap->GetScalarType();
+  this->NumberOfScalarComponents = labelmap->GetNumberOfScalarComponents();
+  unsigned char* scalars = static_cast<unsigned char*>(labelmap->GetScalarPointer());
+
+  if (!baseline || !baseline->IsCompatible(labelmap))
+    {
+    // Store the whole labelmap
+    this->CompressRegion(scalars, this->Extent);
+    this->UncompressedLabelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+    this->UncompressedLabelmap->DeepCopy(labelmap);
+    return;
+    }
+
+  // Store only the region that is different from the baseline
+  vtkSmartPointer<vtkOrientedImageData> baselineLabelmap = baseline->UncompressedLabelmap;
+  if (!baselineLabelmap)
+    {
+    baselineLabelmap = baseline->Restore();
+    }
+  baseline->RemoveUncompressedLabelmap();
+  this->Base = baseline;
+  if (GetChangedExtent(labelmap, baselineLabelmap, this->StoredExtent))
+    {
+    this->CompressRegion(scalars, this->StoredExtent);
+    // Update the uncompressed copy of the baseline, which is faster than copying the whole labelmap
+    CopyRegionBetweenImages(labelmap, baselineLabelmap, this->StoredExtent);
+    }
+  this->UncompressedLabelmap = baselineLabelmap;
+}
+
+//----------------------------------------------------------------------------
+void vtkSegmentationHistoryLabelmap::CompressRegion(unsigned char* scalars, const int region[6])
+{
+  vtkIdType voxelSize = vtkDataArray::GetDataTypeSize(this->ScalarType) * this->NumberOfScalarComponents;
+  vtkIdType regionSize = GetNumberOfVoxels(region) * voxelSize;
+  for (int i = 0; i < 6; ++i)
+    {
+    this->StoredExtent[i] = region[i];
+    }
+
+  unsigned char* regionScalars = scalars;
+  std::vector<unsigned char> regionBuffer;
+  if (GetNumberOfVoxels(region) != GetNumberOfVoxels(this->Extent))
+    {
+    regionBuffer.resize(regionSize);
+    regionScalars = regionBuffer.data();
+    CopyImageRegion(scalars, this->Extent, regionScalars, region, voxelSize, true);
+    }
+
+  vtkNew<vtkZLibDataCompressor> compressor;
+  compressor->SetCompressionLevel(1); // corresponds to Z_BEST_SPEED
+  this->CompressedScalars = vtkSmartPointer<vtkUnsignedCharArray>::Take(compressor->Compress(regionScalars, regionSize));
+  if (this->CompressedScalars)
+    {
+    // The compressor allocates a buffer of the uncompressed size, reclaim the unused memory
+    this->CompressedScalars->Squeeze();
+    }
+  else
+    {
+    vtkErrorMacro("CompressRegion: Failed to compress labelmap");
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkSegmentationHistoryLabelmap::RestoreScalars(unsigned char* scalars)
+{
+  if (this->Base)
+    {
+    this->Base->RestoreScalars(scalars);
+    }
+  if (GetNumberOfVoxels(this->StoredExtent) == 0 || !this->CompressedScalars)
+    {
+    return;
+    }
+
+  vtkIdType voxelSize = vtkDataArray::GetDataTypeSize(this->ScalarType) * this->NumberOfScalarComponents;
+  vtkIdType regionSize = GetNumberOfVoxels(this->StoredExtent) * voxelSize;
+  unsigned char* regionScalars = scalars;
+  std::vector<unsigned char> regionBuffer;
+  bool wholeExtentStored = (GetNumberOfVoxels(this->StoredExtent) == GetNumberOfVoxels(this->Extent));
+  if (!wholeExtentStored)
+    {
+    regionBuffer.resize(regionSize);
+    regionScalars = regionBuffer.data();
+    }
+
+  vtkNew<vtkZLibDataCompressor> compressor;
+  compressor->Uncompress(this->CompressedScalars->GetPointer(0), this->CompressedScalars->GetNumberOfTuples(),
+    regionScalars, regionSize);
+
+  if (!wholeExtentStored)
+    {
+    CopyImageRegion(scalars, this->Extent, regionScalars, this->StoredExtent, voxelSize, false);
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkOrientedImageData> vtkSegmentationHistoryLabelmap::Restore()
+{
+  vtkSmartPointer<vtkOrientedImageData> labelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+  labelmap->SetExtent(this->Extent);
+  labelmap->SetImageToWorldMatrix(this->ImageToWorldMatrix);
+  if (this->HasScalars)
+    {
+    labelmap->AllocateScalars(this->ScalarType, this->NumberOfScalarComponents);
+    this->RestoreScalars(static_cast<unsigned char*>(labelmap->GetScalarPointer()));
+    }
+  return labelmap;
+}
+
+//----------------------------------------------------------------------------
+void vtkSegmentationHistoryLabelmap::RemoveBase()
+{
+  if (!this->Base)
+    {
+    return;
+    }
+  vtkSmartPointer<vtkOrientedImageData> labelmap = this->UncompressedLabelmap;
+  if (!labelmap)
+    {
+    labelmap = this->Restore();
+    }
+  this->Base = nullptr;
+  this->CompressRegion(static_cast<unsigned char*>(labelmap->GetScalarPointer()), this->Extent);
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkSegmentationHistoryLabelmap::GetActualMemorySize()
+{
+  unsigned long size = 0;
+  if (this->CompressedScalars)
+    {
+    size += this->CompressedScalars->GetActualMemorySize();
+    }
+  if (this->UncompressedLabelmap)
+    {
+    size += this->UncompressedLabelmap->GetActualMemorySize();
+    }
+  return size;
+}
 
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSegmentationHistory);
@@ -123,6 +518,7 @@ bool vtkSegmentationHistory::SaveState()
   this->Segmentation->GetSegmentIDs(segmentIDs);
   newSegmentationState.SegmentIds = segmentIDs;
   std::map<vtkDataObject*, vtkDataObject*> savedObjects;
+  std::map<vtkOrientedImageData*, vtkSmartPointer<vtkSegmentationHistoryLabelmap> > savedLabelmaps;
   for (std::vector<std::string>::iterator segmentIDIt = segmentIDs.begin(); segmentIDIt != segmentIDs.end(); ++segmentIDIt)
     {
     vtkSegment* segment = this->Segmentation->GetSegment(*segmentIDIt);
@@ -134,17 +530,62 @@ bool vtkSegmentationHistory::SaveState()
     // Previous saved state of the segment
     // (if the new state has exactly the same representation then only a shallow copy will be made)
     vtkSegment* baselineSegment = nullptr;
+    LabelmapsMap* baselineLabelmaps = nullptr;
     if (this->SegmentationStates.size() > 0)
       {
-      SegmentsMap::iterator baselineSegmentIt = this->SegmentationStates.back().Segments.find(*segmentIDIt);
-      if (baselineSegmentIt != this->SegmentationStates.back().Segments.end())
+      SegmentationState& baselineState = this->SegmentationStates.back();
+      SegmentsMap::iterator baselineSegmentIt = baselineState.Segments.find(*segmentIDIt);
+      if (baselineSegmentIt != baselineState.Segments.end())
         {
         baselineSegment = baselineSegmentIt->second.GetPointer();
+        baselineLabelmaps = &baselineState.Labelmaps[*segmentIDIt];
+        }
+      }
+
+    // Labelmaps are stored separately in compressed form, other representations are copied
+    vtkNew<vtkSegment> segmentWithoutLabelmaps;
+    segmentWithoutLabelmaps->DeepCopyMetadata(segment);
+    LabelmapsMap& segmentLabelmaps = newSegmentationState.Labelmaps[*segmentIDIt];
+    std::vector<std::string> representationNames;
+    segment->GetContainedRepresentationNames(representationNames);
+    for (std::vector<std::string>::iterator representationNameIt = representationNames.begin();
+      representationNameIt != representationNames.end(); ++representationNameIt)
+      {
+      vtkDataObject* representation = segment->GetRepresentation(*representationNameIt);
+      vtkOrientedImageData* labelmap = vtkOrientedImageData::SafeDownCast(representation);
+      if (!labelmap)
+        {
+        segmentWithoutLabelmaps->AddRepresentation(*representationNameIt, representation);
+        continue;
+        }
+      if (savedLabelmaps.find(labelmap) != savedLabelmaps.end())
+        {
+        // Shared labelmap has already been stored for a previous segment
+        segmentLabelmaps[*representationNameIt] = savedLabelmaps[labelmap];
+        continue;
+        }
+      vtkSegmentationHistoryLabelmap* baselineLabelmap = nullptr;
+      if (baselineLabelmaps && baselineLabelmaps->find(*representationNameIt) != baselineLabelmaps->end())
+        {
+        baselineLabelmap = (*baselineLabelmaps)[*representationNameIt];
+        }
+      vtkSmartPointer<vtkSegmentationHistoryLabelmap> savedLabelmap;
+      if (baselineLabelmap && baselineLabelmap->IsCurrentLabelmap(labelmap))
+        {
+        // Labelmap has not changed since the previous state
+        savedLabelmap = baselineLabelmap;
+        }
+      else
+        {
+        savedLabelmap = vtkSmartPointer<vtkSegmentationHistoryLabelmap>::New();
+        savedLabelmap->Store(labelmap, baselineLabelmap);
         }
+      savedLabelmaps[labelmap] = savedLabelmap;
+      segmentLabelmaps[*representationNameIt] = savedLabelmap;
       }
 
     vtkSmartPointer<vtkSegment> segmentClone = vtkSmartPointer<vtkSegment>::New();
-    vtkSegmentation::CopySegment(segmentClone, segment, baselineSegment, savedObjects);
+    vtkSegmentation::CopySegment(segmentClone, segmentWithoutLabelmaps, baselineSegment, savedObjects);
     newSegmentationState.Segments[*segmentIDIt] = segmentClone;
     }
   this->SegmentationStates.push_back(newSegmentationState);
@@ -152,6 +593,7 @@ bool vtkSegmentationHistory::SaveState()
   // Set the current state as last restored state
   this->LastRestoredState = (unsigned int)this->SegmentationStates.size();
   this->RemoveAllObsoleteStates();
+  this->UpdateStoredLabelmaps();
 
   this->Modified();
   return true;
@@ -213,6 +655,7 @@ bool vtkSegmentationHistory::RestoreState(unsigned int stateIndex)
 
   std::set<std::string> segmentIDsToKeep;
   std::map<vtkDataObject*, vtkDataObject*> restoredRepresentations;
+  std::map<vtkSegmentationHistoryLabelmap*, vtkSmartPointer<vtkOrientedImageData> > restoredLabelmaps;
   for (SegmentsMap::iterator restoredSegmentsIt = restoredState.Segments.begin();
     restoredSegmentsIt != restoredState.Segments.end(); ++restoredSegmentsIt)
     {
@@ -225,19 +668,33 @@ bool vtkSegmentationHistory::RestoreState(unsigned int stateIndex)
       this->Segmentation->AddSegment(segment, restoredSegmentsIt->first);
       }
 
-    vtkSegmentation::CopySegment(segment, segmentToRestore, nullptr, restoredRepresentations);
-
-    std::vector<std::string> restoredRepresentationNames;
-    segmentToRestore->GetContainedRepresentationNames(restoredRepresentationNames);
-    std::vector<std::string> currentRepresentationNames;
-    segment->GetContainedRepresentationNames(currentRepresentationNames);
-    // Remove representations that are not in the restoring segment
-    for (std::string representationName : currentRepresentationNames)
+    // Get labelmaps before the current representations are removed from the segment.
+    // Labelmaps are only decompressed if they have changed since they were stored or restored.
+    LabelmapsMap& labelmapsToRestore = restoredState.Labelmaps[restoredSegmentsIt->first];
+    std::map<std::string, vtkSmartPointer<vtkOrientedImageData> > segmentLabelmaps;
+    for (LabelmapsMap::iterator labelmapIt = labelmapsToRestore.begin(); labelmapIt != labelmapsToRestore.end(); ++labelmapIt)
       {
-      if (std::find(restoredRepresentationNames.begin(), restoredRepresentationNames.end(), representationName) == restoredRepresentationNames.end())
+      vtkSegmentationHistoryLabelmap* labelmapToRestore = labelmapIt->second;
+      if (restoredLabelmaps.find(labelmapToRestore) == restoredLabelmaps.end())
         {
-        segment->RemoveRepresentation(representationName);
+        vtkSmartPointer<vtkOrientedImageData> currentLabelmap = vtkOrientedImageData::SafeDownCast(
+          segment->GetRepresentation(labelmapIt->first));
+        if (!labelmapToRestore->IsCurrentLabelmap(currentLabelmap))
+          {
+          currentLabelmap = labelmapToRestore->Restore();
+          labelmapToRestore->SetCurrentLabelmap(currentLabelmap);
+          }
+        restoredLabelmaps[labelmapToRestore] = currentLabelmap;
         }
+      segmentLabelmaps[labelmapIt->first] = restoredLabelmaps[labelmapToRestore];
+      }
+
+    // Copy the segment, which removes representations that are not in the restoring segment
+    vtkSegmentation::CopySegment(segment, segmentToRestore, nullptr, restoredRepresentations);
+    for (std::map<std::string, vtkSmartPointer<vtkOrientedImageData> >::iterator labelmapIt = segmentLabelmaps.begin();
+      labelmapIt != segmentLabelmaps.end(); ++labelmapIt)
+      {
+      segment->AddRepresentation(labelmapIt->first, labelmapIt->second);
       }
     }
 
@@ -322,6 +779,7 @@ void vtkSegmentationHistory::SetMaximumNumberOfStates(unsigned int maximumNumber
     }
   this->MaximumNumberOfStates = maximumNumberOfStates;
   this->RemoveAllObsoleteStates();
+  this->UpdateStoredLabelmaps();
   this->Modified();
 }
 
@@ -363,3 +821,81 @@ int vtkSegmentationHistory::GetNumberOfStates()
 {
   return this->SegmentationStates.size();
 }
+
+//---------------------------------------------------------------------------
+void vtkSegmentationHistory::UpdateStoredLabelmaps()
+{
+  if (this->SegmentationStates.empty())
+    {
+    return;
+    }
+
+  // Labelmaps of the oldest state must not depend on labelmaps of removed states
+  std::map<std::string, LabelmapsMap>& oldestLabelmaps = this->SegmentationStates.front().Labelmaps;
+  for (std::map<std::string, LabelmapsMap>::iterator segmentIt = oldestLabelmaps.begin(); segmentIt != oldestLabelmaps.end(); ++segmentIt)
+    {
+    for (LabelmapsMap::iterator labelmapIt = segmentIt->second.begin(); labelmapIt != segmentIt->second.end(); ++labelmapIt)
+      {
+      labelmapIt->second->RemoveBase();
+      }
+    }
+
+  // Uncompressed copies are only needed for the labelmaps of the most recent state
+  std::set<vtkSegmentationHistoryLabelmap*> recentLabelmaps;
+  std::map<std::string, LabelmapsMap>& newestLabelmaps = this->SegmentationStates.back().Labelmaps;
+  for (std::map<std::string, LabelmapsMap>::iterator segmentIt = newestLabelmaps.begin(); segmentIt != newestLabelmaps.end(); ++segmentIt)
+    {
+    for (LabelmapsMap::iterator labelmapIt = segmentIt->second.begin(); labelmapIt != segmentIt->second.end(); ++labelmapIt)
+      {
+      recentLabelmaps.insert(labelmapIt->second);
+      }
+    }
+  for (std::deque<SegmentationState>::iterator stateIt = this->SegmentationStates.begin(); stateIt != this->SegmentationStates.end(); ++stateIt)
+    {
+    for (std::map<std::string, LabelmapsMap>::iterator segmentIt = stateIt->Labelmaps.begin(); segmentIt != stateIt->Labelmaps.end(); ++segmentIt)
+      {
+      for (LabelmapsMap::iterator labelmapIt = segmentIt->second.begin(); labelmapIt != segmentIt->second.end(); ++labelmapIt)
+        {
+        if (recentLabelmaps.find(labelmapIt->second) == recentLabelmaps.end())
+          {
+          labelmapIt->second->RemoveUncompressedLabelmap();
+          }
+        }
+      }
+    }
+}
+
+//---------------------------------------------------------------------------
+unsigned long vtkSegmentationHistory::GetActualMemorySize()
+{
+  unsigned long size = 0;
+  std::set<vtkObject*> countedObjects;
+  for (std::deque<SegmentationState>::iterator stateIt = this->SegmentationStates.begin(); stateIt != this->SegmentationStates.end(); ++stateIt)
+    {
+    for (SegmentsMap::iterator segmentIt = stateIt->Segments.begin(); segmentIt != stateIt->Segments.end(); ++segmentIt)
+      {
+      std::vector<std::string> representationNames;
+      segmentIt->second->GetContainedRepresentationNames(representationNames);
+      for (std::vector<std::string>::iterator representationNameIt = representationNames.begin();
+        representationNameIt != representationNames.end(); ++representationNameIt)
+        {
+        vtkDataObject* representation = segmentIt->second->GetRepresentation(*representationNameIt);
+        if (countedObjects.insert(representation).second)
+          {
+          size += representation->GetActualMemorySize();
+          }
+        }
+      }
+    for (std::map<std::string, LabelmapsMap>::iterator segmentIt = stateIt->Labelmaps.begin(); segmentIt != stateIt->Labelmaps.end(); ++segmentIt)
+      {
+      for (LabelmapsMap::iterator labelmapIt = segmentIt->second.begin(); labelmapIt != segmentIt->second.end(); ++labelmapIt)
+        {
+        if (countedObjects.insert(labelmapIt->second).second)
+          {
+          size += labelmapIt->second->GetActualMemorySize();
+          }
+        }
+      }
+    }
+  return size;
+}
@@ -36,8 +36,14 @@ class vtkCallbackCommand;
 class vtkDataObject;
 class vtkSegment;
 class vtkSegmentation;
+class vtkSegmentationHistoryLabelmap;
 
 /// \ingroup SegmentationCore
+/// \brief Stores and restores states of a segmentation for undo/redo.
+///
+/// Labelmap representations are stored compressed. If a labelmap has the same geometry as in
+/// the previous state then only the region that has changed since the previous state is stored.
+/// Labelmaps are only decompressed when restoring them is necessary.
 class vtkSegmentationCore_EXPORT vtkSegmentationHistory : public vtkObject
 {
 public:
@@ -86,6 +92,10 @@ public:
   /// Get the current number of states.
   int GetNumberOfStates();
 
+  /// Get the memory used by the stored states in kibibytes (1024 bytes).
+  /// Representation objects shared between states or segments are only counted once.
+  unsigned long GetActualMemorySize();
+
 protected:
   /// Callback function called when the segmentation has been modified.
   /// It clears all states that are more recent than the last restored state.
@@ -106,13 +116,19 @@ protected:
   void operator=(const vtkSegmentationHistory&);
 
   typedef std::map<std::string, vtkSmartPointer<vtkSegment> > SegmentsMap;
+  typedef std::map<std::string, vtkSmartPointer<vtkSegmentationHistoryLabelmap> > LabelmapsMap;
 
   struct SegmentationState
     {
-    SegmentsMap Segments;
+    SegmentsMap Segments; // segment metadata and non-labelmap representations
+    std::map<std::string, LabelmapsMap> Labelmaps; // labelmap representations by segment ID and representation name
     std::vector<std::string> SegmentIds; // order of segments
     };
 
+  /// Make sure that the labelmaps of the oldest stored state do not depend on removed states
+  /// and that uncompressed labelmap copies are only kept for the most recent state.
+  void UpdateStoredLabelmaps();
+
   vtkSegmentation* Segmentation;
   vtkCallbackCommand* SegmentationModifiedCallbackCommand;
   std::deque<SegmentationState> SegmentationStates;
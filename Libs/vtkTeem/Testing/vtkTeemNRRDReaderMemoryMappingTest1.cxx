@@ -0,0 +1,184 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// vtkTeem includes
+#include <vtkTeemNRRDReader.h>
+#include <vtkTeemNRRDWriter.h>
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkInformation.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkTimerLog.h>
+#include <vtksys/SystemInformation.hxx>
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// If \a mappingRequired is false, the data may be read instead of mapped.
+bool CheckReadImage(vtkImageData* expectedImage, const std::string& fileName, bool memoryMapping,
+  bool mappingRequired)
+{
+  int* dimensions = expectedImage->GetDimensions();
+  vtkDataArray* expectedScalars = expectedImage->GetPointData()->GetScalars();
+  size_t dataSize = expectedScalars->GetNumberOfValues() * expectedScalars->GetDataTypeSize();
+  size_t sliceSize = dataSize / dimensions[2];
+
+  vtksys::SystemInformation systemInformation;
+  long long memoryBefore = systemInformation.GetProcMemoryUsed();
+
+  vtkNew<vtkTeemNRRDReader> reader;
+  reader->SetFileName(fileName.c_str());
+  reader->SetUseMemoryMapping(memoryMapping);
+  vtkNew<vtkTimerLog> timerLog;
+  timerLog->StartTimer();
+  reader->Update();
+  // access the middle slice, as a slice view would
+  vtkDataArray* scalars = reader->GetOutput()->GetPointData()->GetScalars();
+  if (!scalars || scalars->GetNumberOfValues() != expectedScalars->GetNumberOfValues())
+    {
+    std::cerr << "Line " << __LINE__ << ": failed to read " << fileName << std::endl;
+    return false;
+    }
+  bool mapped = scalars->GetInformation()->Get(vtkTeemNRRDReader::MEMORY_MAPPED()) != 0;
+  if ((!memoryMapping && mapped) || (memoryMapping && mappingRequired && !mapped))
+    {
+    std::cerr << "Line " << __LINE__ << ": " << fileName << " was " << (mapped ? "" : "not ")
+              << "memory mapped" << std::endl;
+    return false;
+    }
+  size_t sliceOffset = sliceSize * (dimensions[2] / 2);
+  bool sliceMatches = memcmp(static_cast<char*>(scalars->GetVoidPointer(0)) + sliceOffset,
+    static_cast<char*>(expectedScalars->GetVoidPointer(0)) + sliceOffset, sliceSize) == 0;
+  timerLog->StopTimer();
+  long long memoryAfterFirstSlice = systemInformation.GetProcMemoryUsed();
+
+  std::cout << (mapped ? "Memory mapped" : "Read") << " " << fileName
+            << ": time to first slice " << timerLog->GetElapsedTime() << "s, memory increase "
+            << (memoryAfterFirstSlice - memoryBefore) / 1024. << " MB" << std::endl;
+
+  if (!sliceMatches
+    || memcmp(scalars->GetVoidPointer(0), expectedScalars->GetVoidPointer(0), dataSize) != 0)
+    {
+    std::cerr << "Line " << __LINE__ << ": voxels read from " << fileName
+              << " do not match the written voxels" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool CheckMemoryMapping(vtkImageData* image, const std::string& fileName, bool mappingRequired)
+{
+  vtkNew<vtkTeemNRRDWriter> writer;
+  writer->SetInputData(image);
+  writer->SetFileName(fileName.c_str());
+  writer->SetUseCompression(false);
+  writer->Write();
+  if (writer->GetWriteError())
+    {
+    std::cerr << "Line " << __LINE__ << ": failed to write " << fileName << std::endl;
+    return false;
+    }
+
+  if (!CheckReadImage(image, fileName, false, false)
+    || !CheckReadImage(image, fileName, true, mappingRequired))
+    {
+    return false;
+    }
+
+  // A mapped volume can be modified without changing the file.
+  vtkNew<vtkTeemNRRDReader> reader;
+  reader->SetFileName(fileName.c_str());
+  reader->UseMemoryMappingOn();
+  reader->Update();
+  vtkDataArray* scalars = reader->GetOutput()->GetPointData()->GetScalars();
+  scalars->SetComponent(0, 0, -1.);
+  reader->GetOutput()->Initialize();
+  return CheckReadImage(image, fileName, true, mappingRequired);
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkTeemNRRDReaderMemoryMappingTest1(int argc, char* argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: vtkTeemNRRDReaderMemoryMappingTest1 temporaryDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::string temporaryDirectory = argv[1];
+
+  // 4MB volume
+  int dimensions[3] = { 128, 128, 64 };
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(dimensions);
+  image->AllocateScalars(VTK_FLOAT, 1);
+  float* voxels = static_cast<float*>(image->GetScalarPointer());
+  for (int k = 0; k < dimensions[2]; ++k)
+    {
+    for (int j = 0; j < dimensions[1]; ++j)
+      {
+      for (int i = 0; i < dimensions[0]; ++i)
+        {
+        *(voxels++) = static_cast<float>(i + j * 0.5 - k * 0.25);
+        }
+      }
+    }
+
+  // Detached header: the data starts at the beginning of the .raw file.
+  std::string fileName = temporaryDirectory + "/vtkTeemNRRDReaderMemoryMappingTest1.nhdr";
+  if (!CheckMemoryMapping(image, fileName, true))
+    {
+    return EXIT_FAILURE;
+    }
+  vtksys::SystemTools::RemoveFile(fileName);
+  vtksys::SystemTools::RemoveFile(temporaryDirectory + "/vtkTeemNRRDReaderMemoryMappingTest1.raw");
+
+  // Attached header: the data follows the header in the .nrrd file.
+  // Float values are mapped only if the header size is a multiple of 4,
+  // unsigned char values are always mapped.
+  fileName = temporaryDirectory + "/vtkTeemNRRDReaderMemoryMappingTest1.nrrd";
+  if (!CheckMemoryMapping(image, fileName, false))
+    {
+    return EXIT_FAILURE;
+    }
+  vtkNew<vtkImageData> charImage;
+  charImage->SetDimensions(dimensions);
+  charImage->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  unsigned char* charVoxels = static_cast<unsigned char*>(charImage->GetScalarPointer());
+  vtkIdType numberOfVoxels = charImage->GetNumberOfPoints();
+  for (vtkIdType voxelIndex = 0; voxelIndex < numberOfVoxels; ++voxelIndex)
+    {
+    charVoxels[voxelIndex] = static_cast<unsigned char>(voxelIndex % 251);
+    }
+  if (!CheckMemoryMapping(charImage, fileName, true))
+    {
+    return EXIT_FAILURE;
+    }
+  vtksys::SystemTools::RemoveFile(fileName);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,154 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// vtkTeem includes
+#include <vtkTeemNRRDReader.h>
+#include <vtkTeemNRRDWriter.h>
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkShortArray.h>
+#include <vtkTimerLog.h>
+#include <vtksys/SystemTools.hxx>
+
+// Teem includes
+#include <teem/nrrd.h>
+
+// STD includes
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+bool WriteImage(vtkImageData* image, const std::string& fileName, bool parallelCompression)
+{
+  double megaBytes = image->GetPointData()->GetScalars()->GetActualMemorySize() / 1024.;
+  vtkNew<vtkTeemNRRDWriter> writer;
+  writer->SetInputData(image);
+  writer->SetFileName(fileName.c_str());
+  writer->SetUseParallelCompression(parallelCompression);
+  vtkNew<vtkTimerLog> timerLog;
+  timerLog->StartTimer();
+  writer->Write();
+  timerLog->StopTimer();
+  if (writer->GetWriteError())
+    {
+    std::cerr << "Line " << __LINE__ << ": failed to write " << fileName << std::endl;
+    return false;
+    }
+  std::cout << "Write " << (parallelCompression ? "parallel" : "serial") << " gzip: "
+            << timerLog->GetElapsedTime() << "s, "
+            << megaBytes / timerLog->GetElapsedTime() << " MB/s, "
+            << vtksys::SystemTools::FileLength(fileName) / (1024. * 1024.) << " MB on disk" << std::endl;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool CheckReadImage(vtkImageData* expectedImage, const std::string& fileName)
+{
+  vtkDataArray* expectedScalars = expectedImage->GetPointData()->GetScalars();
+  size_t dataSize = expectedScalars->GetNumberOfValues() * expectedScalars->GetDataTypeSize();
+
+  vtkNew<vtkTeemNRRDReader> reader;
+  reader->SetFileName(fileName.c_str());
+  vtkNew<vtkTimerLog> timerLog;
+  timerLog->StartTimer();
+  reader->Update();
+  timerLog->StopTimer();
+  std::cout << "Read " << fileName << ": " << timerLog->GetElapsedTime() << "s, "
+            << dataSize / (1024. * 1024.) / timerLog->GetElapsedTime() << " MB/s" << std::endl;
+
+  vtkDataArray* scalars = reader->GetOutput()->GetPointData()->GetScalars();
+  if (!scalars
+    || scalars->GetDataType() != expectedScalars->GetDataType()
+    || scalars->GetNumberOfValues() != expectedScalars->GetNumberOfValues()
+    || memcmp(scalars->GetVoidPointer(0), expectedScalars->GetVoidPointer(0), dataSize) != 0)
+    {
+    std::cerr << "Line " << __LINE__ << ": voxels read from " << fileName
+              << " do not match the written voxels" << std::endl;
+    return false;
+    }
+
+  // The file must remain readable by teem alone.
+  Nrrd* nrrd = nrrdNew();
+  bool success = (nrrdLoad(nrrd, fileName.c_str(), nullptr) == 0
+    && nrrdElementSize(nrrd) * nrrdElementNumber(nrrd) == dataSize
+    && memcmp(nrrd->data, expectedScalars->GetVoidPointer(0), dataSize) == 0);
+  nrrdNuke(nrrd);
+  if (!success)
+    {
+    std::cerr << "Line " << __LINE__ << ": teem failed to read " << fileName << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkTeemNRRDReaderWriterTest1(int argc, char* argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: vtkTeemNRRDReaderWriterTest1 temporaryDirectory" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::string temporaryDirectory = argv[1];
+
+  // Parallel compression writes several gzip members, it must be requested explicitly
+  vtkNew<vtkTeemNRRDWriter> defaultWriter;
+  if (defaultWriter->GetUseParallelCompression())
+    {
+    std::cerr << "Line " << __LINE__ << ": parallel compression is enabled by default" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Labelmap-like volume of 64MB, spanning many compression blocks
+  int dimensions[3] = { 512, 512, 128 };
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(dimensions);
+  image->AllocateScalars(VTK_SHORT, 1);
+  short* voxels = static_cast<short*>(image->GetScalarPointer());
+  for (int k = 0; k < dimensions[2]; ++k)
+    {
+    for (int j = 0; j < dimensions[1]; ++j)
+      {
+      for (int i = 0; i < dimensions[0]; ++i)
+        {
+        *(voxels++) = static_cast<short>(((i / 16) ^ (j / 8) ^ k) % 7 + (i * j) % 3);
+        }
+      }
+    }
+
+  std::string serialFileName = temporaryDirectory + "/vtkTeemNRRDReaderWriterTest1_serial.nrrd";
+  std::string parallelFileName = temporaryDirectory + "/vtkTeemNRRDReaderWriterTest1_parallel.nrrd";
+  if (!WriteImage(image, serialFileName, false)
+    || !WriteImage(image, parallelFileName, true)
+    || !CheckReadImage(image, serialFileName)
+    || !CheckReadImage(image, parallelFileName))
+    {
+    return EXIT_FAILURE;
+    }
+
+  vtksys::SystemTools::RemoveFile(serialFileName);
+  vtksys::SystemTools::RemoveFile(parallelFileName);
+  return EXIT_SUCCESS;
+}
@@ -35,24 +35,335 @@
 #include "vtkFloatArray.h"
 #include "vtkImageData.h"
 #include <vtkInformation.h>
+#include <vtkInformationIntegerKey.h>
 #include <vtkInformationVector.h>
 #include "vtkIntArray.h"
 #include "vtkLongArray.h"
 #include "vtkMath.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
+#include <vtkSMPTools.h>
 #include "vtkShortArray.h"
 #include <vtkStreamingDemandDrivenPipeline.h>
 #include "vtkUnsignedCharArray.h"
 #include "vtkUnsignedShortArray.h"
 #include "vtkUnsignedIntArray.h"
 #include "vtkUnsignedLongArray.h"
+#include <vtk_zlib.h>
+#include <vtksys/Encoding.hxx>
 #include <vtksys/SystemTools.hxx>
 
 // Teem includes
 #include "teem/ten.h"
 
+// STD includes
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#ifdef _WIN32
+# ifndef NOMINMAX
+#  define NOMINMAX
+# endif
+# include <windows.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <unistd.h>
+#endif
+
 vtkStandardNewMacro(vtkTeemNRRDReader);
+vtkInformationKeyMacro(vtkTeemNRRDReader, MEMORY_MAPPED, Integer);
+
+namespace
+{
+
+/// Identifier of the gzip extra subfield in which vtkTeemNRRDWriter
+/// stores the compressed size of each gzip member.
+const unsigned char GzipMemberSizeSubfieldId[2] = { 'S', 'l' };
+
+//----------------------------------------------------------------------------
+size_t GetLittleEndianUInt16(const unsigned char* buffer)
+{
+  return static_cast<size_t>(buffer[0]) | (static_cast<size_t>(buffer[1]) << 8);
+}
+
+//----------------------------------------------------------------------------
+size_t GetLittleEndianUInt32(const unsigned char* buffer)
+{
+  return static_cast<size_t>(buffer[0]) | (static_cast<size_t>(buffer[1]) << 8)
+    | (static_cast<size_t>(buffer[2]) << 16) | (static_cast<size_t>(buffer[3]) << 24);
+}
+
+//----------------------------------------------------------------------------
+struct GzipMember
+{
+  size_t Offset;
+  size_t Size;
+  size_t UncompressedOffset;
+  size_t UncompressedSize;
+};
+
+//----------------------------------------------------------------------------
+/// Find the gzip members written by vtkTeemNRRDWriter.
+/// Returns false if any member does not record its compressed size.
+bool FindGzipMembers(const unsigned char* data, size_t dataSize, std::vector<GzipMember>& members)
+{
+  members.clear();
+  size_t offset = 0;
+  size_t uncompressedOffset = 0;
+  while (offset < dataSize)
+    {
+    const unsigned char* header = data + offset;
+    const size_t fixedHeaderSize = 12; // including XLEN
+    if (dataSize - offset < fixedHeaderSize
+      || header[0] != 0x1f || header[1] != 0x8b || header[2] != Z_DEFLATED
+      || (header[3] & 0x04) == 0) // FEXTRA
+      {
+      return false;
+      }
+    size_t extraFieldSize = GetLittleEndianUInt16(header + 10);
+    if (dataSize - offset < fixedHeaderSize + extraFieldSize)
+      {
+      return false;
+      }
+    size_t memberSize = 0;
+    const unsigned char* subfield = header + fixedHeaderSize;
+    const unsigned char* extraFieldEnd = subfield + extraFieldSize;
+    while (subfield + 4 <= extraFieldEnd)
+      {
+      size_t subfieldSize = GetLittleEndianUInt16(subfield + 2);
+      if (subfield[0] == GzipMemberSizeSubfieldId[0] && subfield[1] == GzipMemberSizeSubfieldId[1]
+        && subfieldSize == 4 && subfield + 8 <= extraFieldEnd)
+        {
+        memberSize = GetLittleEndianUInt32(subfield + 4);
+        break;
+        }
+      subfield += 4 + subfieldSize;
+      }
+    // the member ends with CRC32 and ISIZE
+    if (memberSize < fixedHeaderSize + extraFieldSize + 8 || memberSize > dataSize - offset)
+      {
+      return false;
+      }
+    GzipMember member;
+    member.Offset = offset;
+    member.Size = memberSize;
+    member.UncompressedOffset = uncompressedOffset;
+    member.UncompressedSize = GetLittleEndianUInt32(header + memberSize - 4);
+    members.push_back(member);
+    offset += memberSize;
+    uncompressedOffset += member.UncompressedSize;
+    }
+  return !members.empty();
+}
+
+//----------------------------------------------------------------------------
+/// Inflate a gzip stream, possibly made of several members, into a buffer
+/// that must be filled exactly.
+bool InflateGzipStream(const unsigned char* input, size_t inputSize,
+  unsigned char* output, size_t outputSize)
+{
+  z_stream stream = {};
+  // add 16 to the window bits to decode (and check) the gzip header and trailer
+  if (inflateInit2(&stream, MAX_WBITS + 16) != Z_OK)
+    {
+    return false;
+    }
+  size_t inputOffset = 0;
+  size_t outputOffset = 0;
+  bool success = false;
+  while (true)
+    {
+    // sizes are processed in chunks that fit in the zlib counters
+    uInt availableInput = static_cast<uInt>(std::min<size_t>(inputSize - inputOffset, UINT_MAX));
+    uInt availableOutput = static_cast<uInt>(std::min<size_t>(outputSize - outputOffset, UINT_MAX));
+    stream.next_in = const_cast<Bytef*>(input + inputOffset);
+    stream.avail_in = availableInput;
+    stream.next_out = output + outputOffset;
+    stream.avail_out = availableOutput;
+    int result = inflate(&stream, Z_NO_FLUSH);
+    inputOffset += availableInput - stream.avail_in;
+    outputOffset += availableOutput - stream.avail_out;
+    if (result == Z_STREAM_END)
+      {
+      if (inputSize - inputOffset >= 2 && input[inputOffset] == 0x1f && input[inputOffset + 1] == 0x8b)
+        {
+        // concatenated gzip member
+        if (inflateReset(&stream) != Z_OK)
+          {
+          break;
+          }
+        continue;
+        }
+      success = (outputOffset == outputSize);
+      break;
+      }
+    if (result != Z_OK)
+      {
+      // corrupted or truncated stream, or more data than expected
+      break;
+      }
+    }
+  inflateEnd(&stream);
+  return success;
+}
+
+//----------------------------------------------------------------------------
+/// Inflate independent gzip members into their location in the output buffer.
+class InflateGzipMembersFunctor
+{
+public:
+  InflateGzipMembersFunctor(const unsigned char* input, unsigned char* output,
+    const std::vector<GzipMember>& members)
+    : Input(input), Output(output), Members(members), Failed(false)
+    {
+    }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType memberIndex = begin; memberIndex < end && !this->Failed; ++memberIndex)
+      {
+      const GzipMember& member = this->Members[memberIndex];
+      if (!InflateGzipStream(this->Input + member.Offset, member.Size,
+        this->Output + member.UncompressedOffset, member.UncompressedSize))
+        {
+        this->Failed = true;
+        }
+      }
+    }
+
+  const unsigned char* Input;
+  unsigned char* Output;
+  const std::vector<GzipMember>& Members;
+  std::atomic<bool> Failed;
+};
+
+//----------------------------------------------------------------------------
+/// Read the header of a NRRD file and check that the data it describes is
+/// laid out as the output of the reader, i.e. that it can be copied as is
+/// without axis permutation, tensor processing or byte swapping.
+/// The file is left positioned at the end of the header, which is the
+/// beginning of the data if it is attached.
+bool ReadHeaderWithOutputLayout(FILE* file, NrrdIoState* nio, size_t outputSize)
+{
+  Nrrd* header = nrrdNew();
+  bool compatible = false;
+  if (nrrdRead(header, file, nio) == 0)
+    {
+    unsigned int rangeAxisIdx[NRRD_DIM_MAX] = { 0 };
+    unsigned int rangeAxisNum = nrrdRangeAxesGet(header, rangeAxisIdx);
+    compatible = nio->format == nrrdFormatNRRD
+      && (nrrdElementSize(header) == 1 || nio->endian == airMyEndian())
+      && nrrdElementSize(header) * nrrdElementNumber(header) == outputSize
+      // same conditions as in ExecuteDataWithInformation for a plain copy
+      && (rangeAxisNum == 0 || (rangeAxisNum == 1 && rangeAxisIdx[0] == 0))
+      && header->axis[0].kind != nrrdKind3DMaskedSymMatrix
+      && header->axis[0].kind != nrrdKind3DSymMatrix;
+    }
+  else
+    {
+    // the error is reported when the file is read by teem
+    free(biffGetDone(NRRD));
+    }
+  nrrdNuke(header);
+  return compatible;
+}
+
+//----------------------------------------------------------------------------
+/// Mapped file regions, indexed by the data pointer given to the arrays.
+struct MappedFileRegion
+{
+  void* Address;
+  size_t Size;
+};
+std::mutex MappedFileRegionsMutex;
+std::map<void*, MappedFileRegion> MappedFileRegions;
+
+//----------------------------------------------------------------------------
+/// Map a region of a file in memory, copy-on-write: the pages are read
+/// from the file when accessed, and modifications are not written back.
+/// Returns nullptr if the file cannot be mapped.
+void* MapFileData(const std::string& fileName, vtkTypeUInt64 offset, size_t size)
+{
+  MappedFileRegion region;
+#ifdef _WIN32
+  SYSTEM_INFO systemInfo;
+  GetSystemInfo(&systemInfo);
+  vtkTypeUInt64 alignedOffset = offset - offset % systemInfo.dwAllocationGranularity;
+  region.Size = static_cast<size_t>(offset - alignedOffset) + size;
+  HANDLE fileHandle = CreateFileW(vtksys::Encoding::ToWide(fileName).c_str(), GENERIC_READ,
+    FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+    return nullptr;
+    }
+  HANDLE mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+  CloseHandle(fileHandle);
+  if (!mappingHandle)
+    {
+    return nullptr;
+    }
+  region.Address = MapViewOfFile(mappingHandle, FILE_MAP_COPY,
+    static_cast<DWORD>(alignedOffset >> 32), static_cast<DWORD>(alignedOffset & 0xffffffff), region.Size);
+  // the view keeps a reference to the mapping
+  CloseHandle(mappingHandle);
+  if (!region.Address)
+    {
+    return nullptr;
+    }
+#else
+  vtkTypeUInt64 pageSize = static_cast<vtkTypeUInt64>(sysconf(_SC_PAGESIZE));
+  vtkTypeUInt64 alignedOffset = offset - offset % pageSize;
+  region.Size = static_cast<size_t>(offset - alignedOffset) + size;
+  int fileDescriptor = open(fileName.c_str(), O_RDONLY);
+  if (fileDescriptor < 0)
+    {
+    return nullptr;
+    }
+  region.Address = mmap(nullptr, region.Size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+    fileDescriptor, static_cast<off_t>(alignedOffset));
+  // the mapping keeps a reference to the file
+  close(fileDescriptor);
+  if (region.Address == MAP_FAILED)
+    {
+    return nullptr;
+    }
+#endif
+  void* data = static_cast<char*>(region.Address) + (offset - alignedOffset);
+  std::lock_guard<std::mutex> lock(MappedFileRegionsMutex);
+  MappedFileRegions[data] = region;
+  return data;
+}
+
+//----------------------------------------------------------------------------
+/// Free function of the arrays created by MapFileData()
+void UnmapFileData(void* data)
+{
+  MappedFileRegion region;
+  {
+  std::lock_guard<std::mutex> lock(MappedFileRegionsMutex);
+  std::map<void*, MappedFileRegion>::iterator regionIt = MappedFileRegions.find(data);
+  if (regionIt == MappedFileRegions.end())
+    {
+    return;
+    }
+  region = regionIt->second;
+  MappedFileRegions.erase(regionIt);
+  }
+#ifdef _WIN32
+  UnmapViewOfFile(region.Address);
+#else
+  munmap(region.Address, region.Size);
+#endif
+}
+
+} // end of anonymous namespace
 
 //----------------------------------------------------------------------------
 vtkTeemNRRDReader::vtkTeemNRRDReader()
@@ -66,6 +377,7 @@ vtkTeemNRRDReader::vtkTeemNRRDReader()
   this->PointDataType = -1;
   this->DataType = -1;
   this->NumberOfComponents = -1;
+  this->UseMemoryMapping = false;
 }
 
 //----------------------------------------------------------------------------
@@ -892,6 +1204,169 @@ int vtkTeemNRRDReader::tenSpaceDirectionReduce(Nrrd *nout, const Nrrd *nin, doub
 }
 
 
+//----------------------------------------------------------------------------
+bool vtkTeemNRRDReader::ReadGzipDataDirectly(void* buffer, size_t bufferSize)
+{
+  if (!nrrdEncodingGzip->available() || bufferSize == 0)
+    {
+    return false;
+    }
+  FILE* file = vtksys::SystemTools::Fopen(this->GetFileName(), "rb");
+  if (!file)
+    {
+    return false;
+    }
+
+  NrrdIoState* nio = nrrdIoStateNew();
+  nrrdIoStateSet(nio, nrrdIoStateSkipData, 1);
+  bool canReadDirectly = ReadHeaderWithOutputLayout(file, nio, bufferSize)
+    && nio->encoding == nrrdEncodingGzip
+    && nio->dataFNArr->len == 0 && nio->dataFNFormat == nullptr
+    && nio->lineSkip == 0 && nio->byteSkip == 0;
+  nio = nrrdIoStateNix(nio);
+
+  std::vector<unsigned char> compressedData;
+  if (canReadDirectly)
+    {
+    size_t dataOffset = static_cast<size_t>(ftell(file));
+    size_t fileSize = static_cast<size_t>(vtksys::SystemTools::FileLength(this->GetFileName()));
+    canReadDirectly = (fileSize > dataOffset);
+    if (canReadDirectly)
+      {
+      compressedData.resize(fileSize - dataOffset);
+      canReadDirectly = (fread(compressedData.data(), 1, compressedData.size(), file) == compressedData.size());
+      }
+    }
+  fclose(file);
+  if (!canReadDirectly)
+    {
+    return false;
+    }
+
+  unsigned char* output = static_cast<unsigned char*>(buffer);
+  std::vector<GzipMember> members;
+  if (FindGzipMembers(compressedData.data(), compressedData.size(), members)
+    && members.back().UncompressedOffset + members.back().UncompressedSize == bufferSize)
+    {
+    vtkDebugMacro("Read: Inflating " << members.size() << " gzip members in parallel");
+    InflateGzipMembersFunctor inflater(compressedData.data(), output, members);
+    vtkSMPTools::For(0, static_cast<vtkIdType>(members.size()), inflater);
+    return !inflater.Failed;
+    }
+  return InflateGzipStream(compressedData.data(), compressedData.size(), output, bufferSize);
+}
+
+//----------------------------------------------------------------------------
+bool vtkTeemNRRDReader::MapDataIntoOutput(vtkImageData* imageData, vtkInformation* outInfo)
+{
+  if (this->GetFileName() == nullptr || this->DataType == VTK_VOID)
+    {
+    return false;
+    }
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  memcpy(extent, this->GetUpdateExtent(), sizeof(extent));
+  vtkIdType numberOfValues = vtkIdType(extent[1] - extent[0] + 1)
+    * vtkIdType(extent[3] - extent[2] + 1)
+    * vtkIdType(extent[5] - extent[4] + 1)
+    * this->GetNumberOfComponents();
+  int valueSize = vtkDataArray::GetDataTypeSize(this->DataType);
+  size_t dataSize = static_cast<size_t>(numberOfValues) * valueSize;
+  if (numberOfValues <= 0 || valueSize <= 0)
+    {
+    return false;
+    }
+
+  FILE* file = vtksys::SystemTools::Fopen(this->GetFileName(), "rb");
+  if (!file)
+    {
+    return false;
+    }
+  NrrdIoState* nio = nrrdIoStateNew();
+  nrrdIoStateSet(nio, nrrdIoStateSkipData, 1);
+  bool canMap = ReadHeaderWithOutputLayout(file, nio, dataSize)
+    && nio->encoding == nrrdEncodingRaw
+    && nio->dataFNFormat == nullptr
+    && nio->dataFNArr->len <= 1
+    && nio->lineSkip == 0;
+  // byte skip of -1 means that the data is at the end of the file
+  std::string dataFileName;
+  vtkTypeUInt64 dataOffset = 0;
+  if (canMap && nio->dataFNArr->len == 0)
+    {
+    // attached data
+    dataFileName = this->GetFileName();
+    dataOffset = static_cast<vtkTypeUInt64>(ftell(file)) + (nio->byteSkip > 0 ? nio->byteSkip : 0);
+    }
+  else if (canMap)
+    {
+    // detached data, relative to the header
+    dataFileName = nio->dataFN[0];
+    if (vtksys::SystemTools::FileIsFullPath(dataFileName))
+      {
+      dataFileName = vtksys::SystemTools::CollapseFullPath(dataFileName);
+      }
+    else
+      {
+      dataFileName = vtksys::SystemTools::CollapseFullPath(dataFileName,
+        vtksys::SystemTools::GetFilenamePath(this->GetFileName()));
+      }
+    dataOffset = nio->byteSkip > 0 ? nio->byteSkip : 0;
+    }
+  if (canMap)
+    {
+    vtkTypeUInt64 dataFileSize = vtksys::SystemTools::FileLength(dataFileName);
+    if (nio->byteSkip < 0 && dataFileSize >= dataSize)
+      {
+      dataOffset = dataFileSize - dataSize;
+      }
+    // the values must be aligned in memory
+    canMap = dataOffset + dataSize <= dataFileSize && dataOffset % valueSize == 0;
+    }
+  nio = nrrdIoStateNix(nio);
+  fclose(file);
+  if (!canMap)
+    {
+    return false;
+    }
+
+  void* data = MapFileData(dataFileName, dataOffset, dataSize);
+  if (!data)
+    {
+    vtkDebugMacro("Read: Failed to map " << dataFileName << ", reading it instead");
+    return false;
+    }
+  vtkSmartPointer<vtkDataArray> array = vtkSmartPointer<vtkDataArray>::Take(
+    vtkDataArray::CreateDataArray(this->DataType));
+  array->SetNumberOfComponents(this->GetNumberOfComponents());
+  array->SetVoidArray(data, numberOfValues, 0, vtkAbstractArray::VTK_DATA_ARRAY_USER_DEFINED);
+  array->SetArrayFreeFunction(UnmapFileData);
+  array->SetName("NRRDImage");
+  array->GetInformation()->Set(vtkTeemNRRDReader::MEMORY_MAPPED(), 1);
+
+  imageData->SetExtent(extent);
+  switch (this->PointDataType)
+    {
+    case vtkDataSetAttributes::SCALARS:
+      imageData->GetPointData()->SetScalars(array);
+      vtkDataObject::SetPointDataActiveScalarInfo(outInfo, this->DataType, this->GetNumberOfComponents());
+      break;
+    case vtkDataSetAttributes::VECTORS:
+      imageData->GetPointData()->SetVectors(array);
+      break;
+    case vtkDataSetAttributes::NORMALS:
+      imageData->GetPointData()->SetNormals(array);
+      break;
+    case vtkDataSetAttributes::TENSORS:
+      imageData->GetPointData()->SetTensors(array);
+      break;
+    default:
+      vtkErrorMacro("Unknown PointData Type.");
+      return false;
+    }
+  this->ComputeDataIncrements();
+  return true;
+}
+
 //----------------------------------------------------------------------------
 // This function reads a data from a file.  The datas extent/axes
 // are assumed to be the same as the file extent/order.
@@ -905,6 +1380,17 @@ void vtkTeemNRRDReader::ExecuteDataWithInformation(vtkDataObject *output, vtkInf
         vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT()), 6);
     }
 
+  if (this->UseMemoryMapping)
+    {
+    // the header information is needed to know if the data can be mapped
+    this->ExecuteInformation();
+    vtkImageData *mappedImageData = vtkImageData::SafeDownCast(output);
+    if (mappedImageData && this->MapDataIntoOutput(mappedImageData, outInfo))
+      {
+      return;
+      }
+    }
+
   vtkImageData *imageData = this->AllocateOutputData(output, outInfo);
 
   if (this->GetFileName() == nullptr)
@@ -913,6 +1399,38 @@ void vtkTeemNRRDReader::ExecuteDataWithInformation(vtkDataObject *output, vtkInf
     return;
     }
 
+  vtkDataArray *array = nullptr;
+  switch(this->PointDataType)
+    {
+    case vtkDataSetAttributes::SCALARS:
+      array = imageData->GetPointData()->GetScalars();
+      break;
+    case vtkDataSetAttributes::VECTORS:
+      array = imageData->GetPointData()->GetVectors();
+      break;
+    case vtkDataSetAttributes::NORMALS:
+      array = imageData->GetPointData()->GetNormals();
+      break;
+    case vtkDataSetAttributes::TENSORS:
+      array = imageData->GetPointData()->GetTensors();
+      break;
+    }
+  void *ptr = nullptr;
+  if (array)
+    {
+    array->SetName("NRRDImage");
+    //get pointer
+    ptr = array->GetVoidPointer(0);
+    }
+  this->ComputeDataIncrements();
+
+  // Compressed data that does not need to be reordered is inflated directly
+  // into the output, without going through this->nrrd.
+  if (ptr && this->ReadGzipDataDirectly(ptr, static_cast<size_t>(array->GetNumberOfValues()) * array->GetDataTypeSize()))
+    {
+    return;
+    }
+
   // Read in the this->nrrd.  Yes, this means that the header is being read
   // twice: once by ExecuteInformation, and once here
   if ( nrrdLoad(this->nrrd, this->GetFileName(), nullptr) != 0 )
@@ -928,30 +1446,6 @@ void vtkTeemNRRDReader::ExecuteDataWithInformation(vtkDataObject *output, vtkInf
     return;
     }
 
-  void *ptr = nullptr;
-  switch(this->PointDataType)
-    {
-    case vtkDataSetAttributes::SCALARS:
-      imageData->GetPointData()->GetScalars()->SetName("NRRDImage");
-      //get pointer
-      ptr = imageData->GetPointData()->GetScalars()->GetVoidPointer(0);
-      break;
-    case vtkDataSetAttributes::VECTORS:
-      imageData->GetPointData()->GetVectors()->SetName("NRRDImage");
-      //get pointer
-      ptr = imageData->GetPointData()->GetVectors()->GetVoidPointer(0);
-      break;
-    case vtkDataSetAttributes::NORMALS:
-      imageData->GetPointData()->GetNormals()->SetName("NRRDImage");
-      ptr = imageData->GetPointData()->GetNormals()->GetVoidPointer(0);
-      break;
-    case vtkDataSetAttributes::TENSORS:
-      imageData->GetPointData()->GetTensors()->SetName("NRRDImage");
-      ptr = imageData->GetPointData()->GetTensors()->GetVoidPointer(0);
-      break;
-    }
-  this->ComputeDataIncrements();
-
   unsigned int rangeAxisIdx[NRRD_DIM_MAX] = { 0 };
   unsigned int rangeAxisNum = nrrdRangeAxesGet(this->nrrd, rangeAxisIdx);
   if (rangeAxisNum > 1)
@@ -1102,4 +1596,5 @@ void vtkTeemNRRDReader::ExecuteDataWithInformation(vtkDataObject *output, vtkInf
 void vtkTeemNRRDReader::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
+  os << indent << "UseMemoryMapping: " << this->UseMemoryMapping << "\n";
 }
@@ -46,6 +46,8 @@
 
 #include "teem/nrrd.h"
 
+class vtkInformationIntegerKey;
+
 /// \brief Reads Nearly Raw Raster Data files.
 ///
 /// Reads Nearly Raw Raster Data files using the nrrdio library as used in ITK
@@ -147,6 +149,23 @@ public:
     UseNativeOrigin = false;
   }
 
+  ///
+  /// Map uncompressed (raw) data into memory instead of reading it: the
+  /// output scalars point to the file contents, which are only read from
+  /// disk when accessed. Modified voxels are not written back to the file.
+  /// The data is read as usual if it is compressed, if its byte order or
+  /// axis order differs from the output, or if attached data is not aligned
+  /// on the scalar size in the file.
+  /// Disabled by default.
+  vtkSetMacro(UseMemoryMapping, bool);
+  vtkGetMacro(UseMemoryMapping, bool);
+  vtkBooleanMacro(UseMemoryMapping, bool);
+
+  /// Key set to 1 in the information of the output array when its values
+  /// are mapped from the file instead of being read.
+  /// \sa UseMemoryMapping
+  static vtkInformationIntegerKey* MEMORY_MAPPED();
+
   int NrrdToVTKScalarType( const int nrrdPixelType ) const
   {
   switch( nrrdPixelType )
@@ -256,6 +275,7 @@ protected:
   int DataType;
   int NumberOfComponents;
   bool UseNativeOrigin;
+  bool UseMemoryMapping;
 
   std::map <std::string, std::string> HeaderKeyValue;
   std::string HeaderKeys; // buffer for returning key list
@@ -268,6 +288,18 @@ protected:
 
   int tenSpaceDirectionReduce(Nrrd *nout, const Nrrd *nin, double SD[9]);
 
+  /// Inflate gzip-compressed data attached to the header directly into
+  /// the given buffer, in parallel if the data was written in independent
+  /// blocks by vtkTeemNRRDWriter.
+  /// Returns false if the data is not stored in a way that can be decoded
+  /// as is into the output (detached data, other encoding, other endianness
+  /// or axes that need to be reordered) or if it could not be inflated.
+  bool ReadGzipDataDirectly(void* buffer, size_t bufferSize);
+
+  /// Set the output scalars to the raw data of the file mapped in memory.
+  /// Returns false if the data cannot be mapped, see UseMemoryMapping.
+  bool MapDataIntoOutput(vtkImageData* imageData, vtkInformation* outInfo);
+
 private:
   vtkTeemNRRDReader(const vtkTeemNRRDReader&) = delete;
   void operator=(const vtkTeemNRRDReader&) = delete;
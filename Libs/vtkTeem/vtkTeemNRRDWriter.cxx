@@ -7,19 +7,138 @@
 #include "vtkPointData.h"
 #include "vtkObjectFactory.h"
 #include "vtkInformation.h"
+#include <vtkSMPTools.h>
 #include <vtkVersion.h>
+#include <vtk_zlib.h>
+#include <vtksys/SystemTools.hxx>
 
 #include <vnl/vnl_math.h>
 #include <vnl/vnl_double_3.h>
 
 #include "itkNumberToString.h"
 
+// STD includes
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
 
 class AttributeMapType: public std::map<std::string, std::string> {};
 class AxisInfoMapType : public std::map<unsigned int, std::string> {};
 
 vtkStandardNewMacro(vtkTeemNRRDWriter);
 
+namespace
+{
+
+/// Size of the blocks of voxel data that are compressed independently.
+const size_t GzipBlockSize = 1 << 20;
+
+/// Number of blocks compressed before being written to the file. It bounds
+/// the amount of compressed data kept in memory.
+const size_t GzipBlocksPerBatch = 256;
+
+/// Size of the header of the gzip members: fixed header (10 bytes), extra
+/// field length (2 bytes) and a single subfield (4 bytes) holding the
+/// compressed size of the member (4 bytes).
+/// The subfield identifier must match the one expected by vtkTeemNRRDReader.
+const size_t GzipMemberHeaderSize = 20;
+const unsigned char GzipMemberSizeSubfieldId[2] = { 'S', 'l' };
+
+//----------------------------------------------------------------------------
+void SetLittleEndianUInt32(unsigned char* buffer, uLong value)
+{
+  buffer[0] = static_cast<unsigned char>(value & 0xff);
+  buffer[1] = static_cast<unsigned char>((value >> 8) & 0xff);
+  buffer[2] = static_cast<unsigned char>((value >> 16) & 0xff);
+  buffer[3] = static_cast<unsigned char>((value >> 24) & 0xff);
+}
+
+//----------------------------------------------------------------------------
+/// Compress blocks of data into separate gzip members (RFC 1952).
+/// Concatenated gzip members form a valid gzip stream.
+class CompressGzipMembersFunctor
+{
+public:
+  CompressGzipMembersFunctor(const unsigned char* data, size_t dataSize,
+    int compressionLevel, std::vector<std::vector<unsigned char> >& members)
+    : Data(data), DataSize(dataSize), CompressionLevel(compressionLevel),
+      FirstBlock(0), Members(members), Failed(false)
+    {
+    }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+    {
+    for (vtkIdType memberIndex = begin; memberIndex < end; ++memberIndex)
+      {
+      size_t blockOffset = (this->FirstBlock + memberIndex) * GzipBlockSize;
+      const unsigned char* block = this->Data + blockOffset;
+      uLong blockSize = static_cast<uLong>(std::min(GzipBlockSize, this->DataSize - blockOffset));
+      std::vector<unsigned char>& member = this->Members[memberIndex];
+
+      z_stream stream = {};
+      // negative window bits: raw deflate stream, the gzip header and
+      // trailer are written here
+      if (deflateInit2(&stream, this->CompressionLevel, Z_DEFLATED,
+        -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        {
+        this->Failed = true;
+        return;
+        }
+      uLong bound = deflateBound(&stream, blockSize);
+      member.resize(GzipMemberHeaderSize + bound + 8);
+
+      unsigned char* header = member.data();
+      header[0] = 0x1f; // ID1
+      header[1] = 0x8b; // ID2
+      header[2] = Z_DEFLATED; // CM
+      header[3] = 0x04; // FLG: FEXTRA
+      SetLittleEndianUInt32(header + 4, 0); // MTIME
+      header[8] = 0; // XFL
+      header[9] = 0xff; // OS: unknown
+      header[10] = 8; // XLEN
+      header[11] = 0;
+      header[12] = GzipMemberSizeSubfieldId[0];
+      header[13] = GzipMemberSizeSubfieldId[1];
+      header[14] = 4; // subfield length
+      header[15] = 0;
+      // header[16-19]: member size, set once compressed
+
+      stream.next_in = const_cast<Bytef*>(block);
+      stream.avail_in = static_cast<uInt>(blockSize);
+      stream.next_out = header + GzipMemberHeaderSize;
+      stream.avail_out = static_cast<uInt>(bound);
+      int result = deflate(&stream, Z_FINISH);
+      uLong compressedSize = stream.total_out;
+      deflateEnd(&stream);
+      if (result != Z_STREAM_END)
+        {
+        this->Failed = true;
+        return;
+        }
+
+      size_t memberSize = GzipMemberHeaderSize + compressedSize + 8;
+      unsigned char* trailer = header + GzipMemberHeaderSize + compressedSize;
+      SetLittleEndianUInt32(trailer, crc32(crc32(0L, Z_NULL, 0), block, static_cast<uInt>(blockSize))); // CRC32
+      SetLittleEndianUInt32(trailer + 4, blockSize); // ISIZE
+      SetLittleEndianUInt32(header + 16, static_cast<uLong>(memberSize));
+      member.resize(memberSize);
+      }
+    }
+
+  const unsigned char* Data;
+  size_t DataSize;
+  int CompressionLevel;
+  /// Index of the block compressed in the first member
+  size_t FirstBlock;
+  std::vector<std::vector<unsigned char> >& Members;
+  std::atomic<bool> Failed;
+};
+
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 vtkTeemNRRDWriter::vtkTeemNRRDWriter()
 {
@@ -31,6 +150,7 @@ vtkTeemNRRDWriter::vtkTeemNRRDWriter()
   this->UseCompression = 1;
   // use default CompressionLevel
   this->CompressionLevel = -1;
+  this->UseParallelCompression = false;
   this->DiffusionWeightedData = 0;
   this->FileType = VTK_BINARY;
   this->WriteErrorOff();
@@ -412,12 +532,21 @@ void vtkTeemNRRDWriter::WriteData()
 
   NrrdIoState *nio = nrrdIoStateNew();
 
+  bool parallelCompression = false;
   // set encoding for data: compressed (raw), (uncompressed) raw, or ascii
   if ( this->GetUseCompression() && nrrdEncodingGzip->available() )
     {
     // this is necessarily gzip-compressed *raw* data
     nio->encoding = nrrdEncodingGzip;
     nio->zlibLevel = this->CompressionLevel;
+
+    // Only the data of attached headers is compressed in parallel. Small
+    // volumes are written by teem in a single gzip member.
+    std::string extension = vtksys::SystemTools::LowerCase(
+      vtksys::SystemTools::GetFilenameLastExtension(this->GetFileName()));
+    parallelCompression = this->UseParallelCompression
+      && extension == ".nrrd"
+      && nrrdElementSize(nrrd) * nrrdElementNumber(nrrd) > GzipBlockSize;
     }
   else
     {
@@ -438,7 +567,14 @@ void vtkTeemNRRDWriter::WriteData()
   nio->endian = airEndianUnknown;
 
   // Write the nrrd to file.
-  if (nrrdSave(this->GetFileName(), nrrd, nio))
+  if (parallelCompression)
+    {
+    if (!this->WriteParallelCompressedData(nrrd, nio))
+      {
+      this->WriteErrorOn();
+      }
+    }
+  else if (nrrdSave(this->GetFileName(), nrrd, nio))
     {
     char *err = biffGetDone(NRRD); // would be nice to free(err)
     vtkErrorMacro("Write: Error writing "
@@ -451,10 +587,76 @@ void vtkTeemNRRDWriter::WriteData()
   return;
 }
 
+//----------------------------------------------------------------------------
+bool vtkTeemNRRDWriter::WriteParallelCompressedData(Nrrd* nrrd, NrrdIoState* nio)
+{
+  // Let teem write the header, with "encoding: gzip", but not the data.
+  nio->format = nrrdFormatNRRD;
+  nio->skipData = AIR_TRUE;
+  char* headerBuffer = nullptr;
+  if (nrrdStringWrite(&headerBuffer, nrrd, nio))
+    {
+    char *err = biffGetDone(NRRD); // would be nice to free(err)
+    vtkErrorMacro("Write: Error writing header of "
+                      << this->GetFileName() << ":\n" << err);
+    return false;
+    }
+  std::string header(headerBuffer ? headerBuffer : "");
+  free(headerBuffer);
+  // attached data starts after an empty line
+  if (header.size() < 2 || header.compare(header.size() - 2, 2, "\n\n") != 0)
+    {
+    header += "\n";
+    }
+
+  FILE* file = vtksys::SystemTools::Fopen(this->GetFileName(), "wb");
+  if (!file)
+    {
+    vtkErrorMacro("Write: Cannot open " << this->GetFileName() << " for writing");
+    return false;
+    }
+  bool success = (fwrite(header.c_str(), 1, header.size(), file) == header.size());
+
+  const unsigned char* data = static_cast<const unsigned char*>(nrrd->data);
+  size_t dataSize = nrrdElementSize(nrrd) * nrrdElementNumber(nrrd);
+  size_t numberOfBlocks = (dataSize + GzipBlockSize - 1) / GzipBlockSize;
+  std::vector<std::vector<unsigned char> > members(std::min(numberOfBlocks, GzipBlocksPerBatch));
+  CompressGzipMembersFunctor compressor(data, dataSize, this->CompressionLevel, members);
+  for (size_t firstBlock = 0; success && firstBlock < numberOfBlocks; firstBlock += GzipBlocksPerBatch)
+    {
+    size_t numberOfMembers = std::min(GzipBlocksPerBatch, numberOfBlocks - firstBlock);
+    compressor.FirstBlock = firstBlock;
+    vtkSMPTools::For(0, static_cast<vtkIdType>(numberOfMembers), compressor);
+    if (compressor.Failed)
+      {
+      vtkErrorMacro("Write: Error compressing data of " << this->GetFileName());
+      success = false;
+      break;
+      }
+    for (size_t memberIndex = 0; success && memberIndex < numberOfMembers; ++memberIndex)
+      {
+      const std::vector<unsigned char>& member = members[memberIndex];
+      success = (fwrite(member.data(), 1, member.size(), file) == member.size());
+      }
+    }
+  if (fclose(file) != 0)
+    {
+    success = false;
+    }
+  if (!success)
+    {
+    vtkErrorMacro("Write: Error writing " << this->GetFileName());
+    }
+  return success;
+}
+
+//----------------------------------------------------------------------------
 void vtkTeemNRRDWriter::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
 
+  os << indent << "UseParallelCompression: " << this->UseParallelCompression << "\n";
+
   os << indent << "RAS to IJK Matrix: ";
      this->IJKToRASMatrix->PrintSelf(os,indent);
   os << indent << "Measurement frame: ";
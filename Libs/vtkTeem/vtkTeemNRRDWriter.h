@@ -58,6 +58,17 @@ public:
   vtkSetClampMacro(CompressionLevel, int, 0, 9);
   vtkGetMacro(CompressionLevel, int);
 
+  /// Compress the data of attached-header (.nrrd) files in independent
+  /// blocks on all threads. The data is written as a series of gzip members,
+  /// and each member records its compressed size so that vtkTeemNRRDReader
+  /// can also inflate the blocks in parallel.
+  /// Readers that only decode the first gzip member (e.g. pynrrd) get
+  /// truncated data from these files, therefore this is disabled by default.
+  /// Ignored if UseCompression is disabled.
+  vtkSetMacro(UseParallelCompression, bool);
+  vtkGetMacro(UseParallelCompression, bool);
+  vtkBooleanMacro(UseParallelCompression, bool);
+
   vtkSetClampMacro(FileType,int,VTK_ASCII,VTK_BINARY);
   vtkGetMacro(FileType,int);
   void SetFileTypeToASCII() {this->SetFileType(VTK_ASCII);};
@@ -122,6 +133,7 @@ protected:
 
   int UseCompression;
   int CompressionLevel;
+  bool UseParallelCompression;
   int FileType;
 
   AttributeMapType *Attributes;
@@ -135,6 +147,9 @@ private:
   void operator=(const vtkTeemNRRDWriter&) = delete;
   void vtkImageDataInfoToNrrdInfo(vtkImageData *in, int &nrrdKind, size_t &numComp, int &vtkType, void **buffer);
   int VTKToNrrdPixelType( const int vtkPixelType );
+  /// Write the header with teem then the data compressed in parallel.
+  /// Returns false if the file could not be written.
+  bool WriteParallelCompressedData(Nrrd* nrrd, NrrdIoState* nio);
   int DiffusionWeightedData;
 };
 
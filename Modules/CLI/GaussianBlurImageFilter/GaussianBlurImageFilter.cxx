@@ -1,5 +1,3 @@
-#include "itkImageFileWriter.h"
-
 #include "itkSmoothingRecursiveGaussianImageFilter.h"
 
 #include "itkPluginUtilities.h"
@@ -25,25 +23,22 @@ int DoIt( int argc, char * argv[], T )
   typedef itk::Image<InputPixelType,  3> InputImageType;
   typedef itk::Image<OutputPixelType, 3> OutputImageType;
 
-  typedef itk::ImageFileReader<InputImageType>  ReaderType;
-  typedef itk::ImageFileWriter<OutputImageType> WriterType;
-
   typedef itk::SmoothingRecursiveGaussianImageFilter<
     InputImageType, OutputImageType>  FilterType;
 
-  typename ReaderType::Pointer reader = ReaderType::New();
-
-  reader->SetFileName( inputVolume.c_str() );
+  // When run as a shared object module, the input voxels are shared with
+  // the scene and the output voxels are handed over to it, without copies.
+  typename InputImageType::Pointer inputImage =
+    itk::ReadPluginImage<InputImageType>( inputVolume );
 
   typename FilterType::Pointer filter = FilterType::New();
-  filter->SetInput( reader->GetOutput() );
+  filter->SetInput( inputImage );
   filter->SetSigma( sigma );
+  // The input may be the voxels of the scene node, never overwrite them
+  filter->InPlaceOff();
+  filter->Update();
 
-  typename WriterType::Pointer writer = WriterType::New();
-  writer->SetFileName( outputVolume.c_str() );
-  writer->SetInput( filter->GetOutput() );
-  writer->SetUseCompression(1);
-  writer->Update();
+  itk::WritePluginImage<OutputImageType>( filter->GetOutput(), outputVolume, true );
 
   return EXIT_SUCCESS;
 }
@@ -41,8 +41,14 @@
 // VTK includes
 #include <vtkBoundingBox.h>
 #include <vtkGeneralTransform.h>
+#include <vtkImageBSplineCoefficients.h>
+#include <vtkImageBSplineInterpolator.h>
 #include <vtkImageConstantPad.h>
 #include <vtkImageData.h>
+#include <vtkImageInterpolator.h>
+#include <vtkImageReslice.h>
+#include <vtkImageSincInterpolator.h>
+#include <vtkMath.h>
 #include <vtkNew.h>
 #include <vtkMatrix4x4.h>
 #include <vtkMatrix3x3.h>
@@ -54,9 +60,16 @@
 #include <vtkAddonMathUtilities.h>
 
 // STD includes
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 
+namespace
+{
+// Interpolated outputs larger than this are computed slab by slab
+const vtkIdType CropStreamingSlabSizeInBytes = 64 * 1024 * 1024;
+}
+
 //----------------------------------------------------------------------------
 class vtkSlicerCropVolumeLogic::vtkInternal
 {
@@ -428,12 +441,6 @@ int vtkSlicerCropVolumeLogic::CropInterpolated(vtkMRMLAnnotationROINode* roi, vt
     return -1;
     }
 
-  if (this->Internal->ResampleLogic == nullptr)
-    {
-    vtkErrorMacro("CropVolume: resample logic is not set");
-    return -3;
-    }
-
   int outputExtent[6] = { 0, -1, 0, -1, 0, -1 };
   double outputSpacing[3] = { 0 };
   this->GetInterpolatedCropOutputGeometry(roi, inputVolume, isotropicResampling, spacingScale, outputExtent, outputSpacing);
@@ -473,15 +480,210 @@ int vtkSlicerCropVolumeLogic::CropInterpolated(vtkMRMLAnnotationROINode* roi, vt
   outputIJKToRAS->Multiply4x4(roiMatrix.GetPointer(), outputIJKToRAS.GetPointer(),
     outputIJKToRAS.GetPointer());
 
+  // Output voxel size, including the scaling of the ROI transform
+  for (int column = 0; column < 3; column++)
+    {
+    double axisDirection[3] =
+      {
+      outputIJKToRAS->GetElement(0, column),
+      outputIJKToRAS->GetElement(1, column),
+      outputIJKToRAS->GetElement(2, column)
+      };
+    outputSpacing[column] = vtkMath::Norm(axisDirection);
+    }
+
+  // Center the output image in the ROI. For that, compute the size difference between
+  // the ROI and the output image.
+  double sizeDifference_IJK[3] =
+    {
+    roiRadius[0] * 2 / outputSpacing[0] - (outputExtent[1] - outputExtent[0] + 1),
+    roiRadius[1] * 2 / outputSpacing[1] - (outputExtent[3] - outputExtent[2] + 1),
+    roiRadius[2] * 2 / outputSpacing[2] - (outputExtent[5] - outputExtent[4] + 1)
+    };
+  // Origin is in the voxel's center. Shift the origin by half voxel
+  // to have the ROI edge at the output image voxel edge.
+  double outputOrigin_IJK[4] =
+    {
+    0.5 + sizeDifference_IJK[0] / 2,
+    0.5 + sizeDifference_IJK[1] / 2,
+    0.5 + sizeDifference_IJK[2] / 2,
+    1.0
+    };
+  double outputOrigin_RAS[4] = { 0.0, 0.0, 0.0, 1.0 };
+  outputIJKToRAS->MultiplyPoint(outputOrigin_IJK, outputOrigin_RAS);
+  for (int row = 0; row < 3; row++)
+    {
+    outputIJKToRAS->SetElement(row, 3, outputOrigin_RAS[row]);
+    }
+
+  if (vtkMRMLDiffusionWeightedVolumeNode::SafeDownCast(inputVolume))
+    {
+    // Gradient directions must be transformed along with the voxels
+    return this->CropInterpolatedUsingResampleCLI(inputVolume, outputVolume,
+      outputIJKToRAS.GetPointer(), outputExtent, interpolationMode, fillValue);
+    }
+  return this->CropInterpolatedUsingReslice(inputVolume, outputVolume,
+    outputIJKToRAS.GetPointer(), outputExtent, interpolationMode, fillValue);
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCropVolumeLogic::CropInterpolatedUsingReslice(vtkMRMLVolumeNode* inputVolume, vtkMRMLVolumeNode* outputVolume,
+  vtkMatrix4x4* outputIJKToRAS, int outputExtent[6], int interpolationMode, double fillValue)
+{
+  if (!inputVolume->GetImageData())
+    {
+    vtkWarningMacro("vtkSlicerCropVolumeLogic::CropInterpolated: input image is empty");
+    outputVolume->SetAndObserveImageData(nullptr);
+    return 0;
+    }
+
+  // The geometry of the voxels is defined by the IJK to RAS matrix of the nodes
+  vtkNew<vtkImageData> inputImageData;
+  inputImageData->ShallowCopy(inputVolume->GetImageData());
+  inputImageData->SetOrigin(0.0, 0.0, 0.0);
+  inputImageData->SetSpacing(1.0, 1.0, 1.0);
+
+  vtkNew<vtkImageReslice> reslice;
+  reslice->SetInputData(inputImageData.GetPointer());
+  reslice->SetOutputOrigin(0.0, 0.0, 0.0);
+  reslice->SetOutputSpacing(1.0, 1.0, 1.0);
+  reslice->SetOutputExtent(outputExtent);
+  reslice->SetOutputScalarType(inputImageData->GetScalarType());
+  reslice->SetBackgroundLevel(fillValue);
+
+  // Map output voxels to input voxels
+  vtkNew<vtkGeneralTransform> outputToInputTransform;
+  vtkMRMLTransformNode::GetTransformBetweenNodes(outputVolume->GetParentTransformNode(),
+    inputVolume->GetParentTransformNode(), outputToInputTransform.GetPointer());
+  vtkNew<vtkMatrix4x4> inputRASToIJK;
+  inputVolume->GetRASToIJKMatrix(inputRASToIJK.GetPointer());
+  vtkNew<vtkTransform> outputToInputTransformLinear;
+  if (vtkMRMLTransformNode::IsGeneralTransformLinear(outputToInputTransform.GetPointer(), outputToInputTransformLinear.GetPointer()))
+    {
+    // Oriented resampling, the fastest path of vtkImageReslice
+    vtkNew<vtkMatrix4x4> outputIJKToInputRAS;
+    vtkMatrix4x4::Multiply4x4(outputToInputTransformLinear->GetMatrix(), outputIJKToRAS, outputIJKToInputRAS.GetPointer());
+    vtkNew<vtkMatrix4x4> outputIJKToInputIJK;
+    vtkMatrix4x4::Multiply4x4(inputRASToIJK.GetPointer(), outputIJKToInputRAS.GetPointer(), outputIJKToInputIJK.GetPointer());
+    reslice->SetResliceAxes(outputIJKToInputIJK.GetPointer());
+    }
+  else
+    {
+    vtkNew<vtkGeneralTransform> outputIJKToInputIJK;
+    outputIJKToInputIJK->PostMultiply();
+    outputIJKToInputIJK->Concatenate(outputIJKToRAS);
+    outputIJKToInputIJK->Concatenate(outputToInputTransform.GetPointer());
+    outputIJKToInputIJK->Concatenate(inputRASToIJK.GetPointer());
+    reslice->SetResliceTransform(outputIJKToInputIJK.GetPointer());
+    }
+
+  vtkSmartPointer<vtkAbstractImageInterpolator> interpolator;
+  vtkNew<vtkImageBSplineCoefficients> bSplineCoefficients;
+  switch (interpolationMode)
+    {
+    case vtkMRMLCropVolumeParametersNode::InterpolationNearestNeighbor:
+      {
+      vtkNew<vtkImageInterpolator> nearestInterpolator;
+      nearestInterpolator->SetInterpolationModeToNearest();
+      interpolator = nearestInterpolator.GetPointer();
+      }
+      break;
+    case vtkMRMLCropVolumeParametersNode::InterpolationWindowedSinc:
+      {
+      vtkNew<vtkImageSincInterpolator> sincInterpolator;
+      sincInterpolator->SetWindowFunctionToHamming();
+      interpolator = sincInterpolator.GetPointer();
+      }
+      break;
+    case vtkMRMLCropVolumeParametersNode::InterpolationBSpline:
+      {
+      vtkNew<vtkImageBSplineInterpolator> bSplineInterpolator;
+      bSplineCoefficients->SetInputData(inputImageData.GetPointer());
+      bSplineCoefficients->SetSplineDegree(bSplineInterpolator->GetSplineDegree());
+      reslice->SetInputConnection(bSplineCoefficients->GetOutputPort());
+      interpolator = bSplineInterpolator.GetPointer();
+      }
+      break;
+    case vtkMRMLCropVolumeParametersNode::InterpolationLinear:
+    default:
+      {
+      vtkNew<vtkImageInterpolator> linearInterpolator;
+      linearInterpolator->SetInterpolationModeToLinear();
+      interpolator = linearInterpolator.GetPointer();
+      }
+      break;
+    }
+  reslice->SetInterpolator(interpolator);
+
+  double progress = 0.0;
+  this->InvokeEvent(vtkCommand::ProgressEvent, &progress);
+
+  // Large outputs are computed in slabs of slices to report progress and
+  // to keep the temporary buffers of the pipeline small.
+  vtkIdType sliceSizeInBytes = static_cast<vtkIdType>(outputExtent[1] - outputExtent[0] + 1)
+    * (outputExtent[3] - outputExtent[2] + 1)
+    * inputImageData->GetNumberOfScalarComponents() * inputImageData->GetScalarSize();
+  int numberOfSlices = outputExtent[5] - outputExtent[4] + 1;
+  int slabThickness = static_cast<int>(std::max<vtkIdType>(1,
+    CropStreamingSlabSizeInBytes / std::max<vtkIdType>(sliceSizeInBytes, 1)));
+  vtkSmartPointer<vtkImageData> outputImageData;
+  if (slabThickness >= numberOfSlices)
+    {
+    reslice->Update();
+    outputImageData = reslice->GetOutput();
+    }
+  else
+    {
+    outputImageData = vtkSmartPointer<vtkImageData>::New();
+    outputImageData->SetExtent(outputExtent);
+    outputImageData->AllocateScalars(inputImageData->GetScalarType(), inputImageData->GetNumberOfScalarComponents());
+    for (int firstSlice = outputExtent[4]; firstSlice <= outputExtent[5]; firstSlice += slabThickness)
+      {
+      int slabExtent[6] =
+        {
+        outputExtent[0], outputExtent[1],
+        outputExtent[2], outputExtent[3],
+        firstSlice, std::min(firstSlice + slabThickness - 1, outputExtent[5])
+        };
+      reslice->UpdateExtent(slabExtent);
+      outputImageData->CopyAndCastFrom(reslice->GetOutput(), slabExtent);
+      progress = static_cast<double>(slabExtent[5] - outputExtent[4] + 1) / numberOfSlices;
+      this->InvokeEvent(vtkCommand::ProgressEvent, &progress);
+      }
+    }
+
+  int wasModified = outputVolume->StartModify();
+  outputVolume->SetAndObserveImageData(outputImageData);
+  outputVolume->SetIJKToRASMatrix(outputIJKToRAS);
+  outputVolume->EndModify(wasModified);
+
+  progress = 1.0;
+  this->InvokeEvent(vtkCommand::ProgressEvent, &progress);
+
+  // success
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCropVolumeLogic::CropInterpolatedUsingResampleCLI(vtkMRMLVolumeNode* inputVolume, vtkMRMLVolumeNode* outputVolume,
+  vtkMatrix4x4* outputIJKToRAS, int outputExtent[6], int interpolationMode, double fillValue)
+{
+  if (this->Internal->ResampleLogic == nullptr)
+    {
+    vtkErrorMacro("CropVolume: resample logic is not set");
+    return -3;
+    }
+
   vtkNew<vtkMatrix4x4> rasToLPS;
   rasToLPS->SetElement(0, 0, -1);
   rasToLPS->SetElement(1, 1, -1);
   vtkNew<vtkMatrix4x4> outputIJKToLPS;
-  vtkMatrix4x4::Multiply4x4(rasToLPS.GetPointer(), outputIJKToRAS.GetPointer(), outputIJKToLPS.GetPointer());
+  vtkMatrix4x4::Multiply4x4(rasToLPS.GetPointer(), outputIJKToRAS, outputIJKToLPS.GetPointer());
 
   // contains axis directions, in unconventional indexing (column, row)
   // so that it can be conveniently normalized
   double outputDirectionColRow[3][3] = {{ 0 }};
+  double outputSpacing[3] = { 0 };
   for (int column = 0; column < 3; column++)
     {
     for (int row = 0; row < 3; row++)
@@ -507,29 +709,10 @@ int vtkSlicerCropVolumeLogic::CropInterpolated(vtkMRMLAnnotationROINode* roi, vt
     << (outputExtent[5] - outputExtent[4] + 1);
   cmdNode->SetParameterAsString("outputImageSize", sizeStream.str());
 
-  // Center the output image in the ROI. For that, compute the size difference between
-  // the ROI and the output image.
-  double sizeDifference_IJK[3] =
-    {
-    roiRadius[0] * 2 / outputSpacing[0] - (outputExtent[1] - outputExtent[0] + 1),
-    roiRadius[1] * 2 / outputSpacing[1] - (outputExtent[3] - outputExtent[2] + 1),
-    roiRadius[2] * 2 / outputSpacing[2] - (outputExtent[5] - outputExtent[4] + 1)
-    };
-  // Origin is in the voxel's center. Shift the origin by half voxel
-  // to have the ROI edge at the output image voxel edge.
-  double outputOrigin_IJK[4] =
-    {
-    0.5 + sizeDifference_IJK[0] / 2,
-    0.5 + sizeDifference_IJK[1] / 2,
-    0.5 + sizeDifference_IJK[2] / 2,
-    1.0
-    };
-  double outputOrigin_RAS[4] = { 0.0, 0.0, 0.0, 1.0 };
-  outputIJKToRAS->MultiplyPoint(outputOrigin_IJK, outputOrigin_RAS);
-
   vtkNew<vtkMRMLMarkupsFiducialNode> originMarkupNode;
   // Markups are transformed from RAS to LPS by the CLI infrastructure, so we pass them in RAS
-  originMarkupNode->AddFiducial(outputOrigin_RAS[0], outputOrigin_RAS[1], outputOrigin_RAS[2]);
+  originMarkupNode->AddFiducial(outputIJKToRAS->GetElement(0, 3),
+    outputIJKToRAS->GetElement(1, 3), outputIJKToRAS->GetElement(2, 3));
   this->GetMRMLScene()->AddNode(originMarkupNode.GetPointer());
   cmdNode->SetParameterAsString("outputImageOrigin", originMarkupNode->GetID());
 
@@ -53,7 +53,14 @@ class vtkMRMLCropVolumeParametersNode;
 /// almost no extra memory.
 ///
 /// If interpolation is enabled, then both the size and resolution
-/// of the volume can be changed.
+/// of the volume can be changed. Scalar, labelmap and vector volumes
+/// are resampled in-process by a multi-threaded vtkImageReslice, in
+/// slabs for large outputs. Diffusion weighted volumes are resampled by
+/// the resample CLI (see SetResampleLogic), which also updates the
+/// gradient directions.
+///
+/// vtkCommand::ProgressEvent is invoked during interpolated cropping,
+/// with a pointer to the progress (double, between 0 and 1) as call data.
 ///
 /// Limitations:
 /// * Region of interes (ROI) node cannot be under non-linear transform
@@ -112,6 +119,16 @@ protected:
   vtkSlicerCropVolumeLogic();
   ~vtkSlicerCropVolumeLogic() override;
 
+  /// Interpolated cropping using vtkImageReslice.
+  /// \sa CropInterpolated
+  int CropInterpolatedUsingReslice(vtkMRMLVolumeNode* inputVolume, vtkMRMLVolumeNode* outputVolume,
+    vtkMatrix4x4* outputIJKToRAS, int outputExtent[6], int interpolationMode, double fillValue);
+
+  /// Interpolated cropping using the resample CLI.
+  /// \sa CropInterpolated
+  int CropInterpolatedUsingResampleCLI(vtkMRMLVolumeNode* inputVolume, vtkMRMLVolumeNode* outputVolume,
+    vtkMatrix4x4* outputIJKToRAS, int outputExtent[6], int interpolationMode, double fillValue);
+
 private:
   vtkSlicerCropVolumeLogic(const vtkSlicerCropVolumeLogic&) = delete;
   void operator=(const vtkSlicerCropVolumeLogic&) = delete;
@@ -0,0 +1,162 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// CropVolume includes
+#include "vtkMRMLCropVolumeParametersNode.h"
+#include "vtkSlicerCropVolumeLogic.h"
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include <vtkMRMLAnnotationROINode.h>
+#include <vtkMRMLLinearTransformNode.h>
+#include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLScene.h>
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkTimerLog.h>
+#include <vtkTransform.h>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+void CountProgressEvents(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eid),
+  void* clientData, void* vtkNotUsed(callData))
+{
+  ++(*static_cast<int*>(clientData));
+}
+
+//----------------------------------------------------------------------------
+// Input voxel values are i+j+k and the input IJK to RAS matrix is identity,
+// therefore the expected value at any position is the sum of its coordinates.
+int CheckCenterVoxel(vtkMRMLVolumeNode* outputVolume)
+{
+  CHECK_NOT_NULL(outputVolume->GetImageData());
+  int* extent = outputVolume->GetImageData()->GetExtent();
+  int center_IJK[3] = { (extent[0] + extent[1]) / 2, (extent[2] + extent[3]) / 2, (extent[4] + extent[5]) / 2 };
+  double center_IJK_Homogeneous[4] = { double(center_IJK[0]), double(center_IJK[1]), double(center_IJK[2]), 1.0 };
+  vtkNew<vtkMatrix4x4> ijkToRAS;
+  outputVolume->GetIJKToRASMatrix(ijkToRAS.GetPointer());
+  double center_RAS[4] = { 0.0, 0.0, 0.0, 1.0 };
+  ijkToRAS->MultiplyPoint(center_IJK_Homogeneous, center_RAS);
+  double value = outputVolume->GetImageData()->GetScalarComponentAsDouble(center_IJK[0], center_IJK[1], center_IJK[2], 0);
+  CHECK_DOUBLE_TOLERANCE(value, center_RAS[0] + center_RAS[1] + center_RAS[2], 1.0);
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkSlicerCropVolumeLogicTest1(int , char * [] )
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkSlicerCropVolumeLogic> logic;
+  logic->SetMRMLScene(scene.GetPointer());
+
+  int progressEventCount = 0;
+  vtkNew<vtkCallbackCommand> progressCallback;
+  progressCallback->SetCallback(CountProgressEvents);
+  progressCallback->SetClientData(&progressEventCount);
+  logic->AddObserver(vtkCommand::ProgressEvent, progressCallback.GetPointer());
+
+  const int inputSize = 192;
+  vtkNew<vtkImageData> inputImageData;
+  inputImageData->SetDimensions(inputSize, inputSize, inputSize);
+  inputImageData->AllocateScalars(VTK_SHORT, 1);
+  short* voxels = static_cast<short*>(inputImageData->GetScalarPointer());
+  for (int k = 0; k < inputSize; ++k)
+    {
+    for (int j = 0; j < inputSize; ++j)
+      {
+      for (int i = 0; i < inputSize; ++i)
+        {
+        *(voxels++) = static_cast<short>(i + j + k);
+        }
+      }
+    }
+  vtkNew<vtkMRMLScalarVolumeNode> inputVolume;
+  inputVolume->SetAndObserveImageData(inputImageData.GetPointer());
+  scene->AddNode(inputVolume.GetPointer());
+
+  vtkNew<vtkMRMLScalarVolumeNode> outputVolume;
+  scene->AddNode(outputVolume.GetPointer());
+
+  vtkNew<vtkMRMLAnnotationROINode> roi;
+  scene->AddNode(roi.GetPointer());
+  vtkNew<vtkMRMLLinearTransformNode> roiTransform;
+  scene->AddNode(roiTransform.GetPointer());
+  vtkNew<vtkTransform> rotation;
+  rotation->Translate(inputSize / 2., inputSize / 2., inputSize / 2.);
+  rotation->RotateZ(30.0);
+  rotation->Translate(-inputSize / 2., -inputSize / 2., -inputSize / 2.);
+  roiTransform->SetMatrixTransformToParent(rotation->GetMatrix());
+
+  // ROI boundaries are placed half-way between voxel centers
+  double roiCenter = inputSize / 2. - 0.5;
+  vtkNew<vtkTimerLog> timer;
+  double roiRadii[3] = { 8.0, 32.0, 64.0 };
+  for (double roiRadius : roiRadii)
+    {
+    roi->SetAndObserveTransformNodeID(nullptr);
+    roi->SetXYZ(roiCenter, roiCenter, roiCenter);
+    roi->SetRadiusXYZ(roiRadius, roiRadius, roiRadius);
+
+    timer->StartTimer();
+    CHECK_INT(vtkSlicerCropVolumeLogic::CropVoxelBased(roi.GetPointer(), inputVolume.GetPointer(), outputVolume.GetPointer()), 0);
+    timer->StopTimer();
+    double voxelBasedTime = timer->GetElapsedTime();
+    int* dimensions = outputVolume->GetImageData()->GetDimensions();
+    CHECK_INT(dimensions[0], static_cast<int>(2 * roiRadius));
+    CHECK_INT(dimensions[2], static_cast<int>(2 * roiRadius));
+    CHECK_EXIT_SUCCESS(CheckCenterVoxel(outputVolume.GetPointer()));
+
+    timer->StartTimer();
+    CHECK_INT(logic->CropInterpolated(roi.GetPointer(), inputVolume.GetPointer(), outputVolume.GetPointer(),
+      false, 1.0, vtkMRMLCropVolumeParametersNode::InterpolationLinear, 0.0), 0);
+    timer->StopTimer();
+    double alignedTime = timer->GetElapsedTime();
+    CHECK_EXIT_SUCCESS(CheckCenterVoxel(outputVolume.GetPointer()));
+
+    roi->SetAndObserveTransformNodeID(roiTransform->GetID());
+    timer->StartTimer();
+    CHECK_INT(logic->CropInterpolated(roi.GetPointer(), inputVolume.GetPointer(), outputVolume.GetPointer(),
+      false, 1.0, vtkMRMLCropVolumeParametersNode::InterpolationLinear, 0.0), 0);
+    timer->StopTimer();
+    double orientedTime = timer->GetElapsedTime();
+    CHECK_EXIT_SUCCESS(CheckCenterVoxel(outputVolume.GetPointer()));
+
+    std::cout << "ROI size " << 2 * roiRadius << ": voxel based " << voxelBasedTime
+              << "s, interpolated " << alignedTime << "s, interpolated oriented "
+              << orientedTime << "s" << std::endl;
+    }
+
+  // Output larger than a slab: computed in several steps, each reporting progress
+  // (in addition to the start and end notifications)
+  roi->SetAndObserveTransformNodeID(roiTransform->GetID());
+  roi->SetRadiusXYZ(inputSize / 2., inputSize / 2., inputSize / 2.);
+  progressEventCount = 0;
+  timer->StartTimer();
+  CHECK_INT(logic->CropInterpolated(roi.GetPointer(), inputVolume.GetPointer(), outputVolume.GetPointer(),
+    false, 0.5, vtkMRMLCropVolumeParametersNode::InterpolationLinear, 0.0), 0);
+  timer->StopTimer();
+  std::cout << "ROI size " << inputSize << " with spacing scale 0.5 (streamed): "
+            << timer->GetElapsedTime() << "s" << std::endl;
+  CHECK_INT(outputVolume->GetImageData()->GetDimensions()[2], 2 * inputSize);
+  CHECK_BOOL(progressEventCount > 3, true);
+  CHECK_EXIT_SUCCESS(CheckCenterVoxel(outputVolume.GetPointer()));
+
+  return EXIT_SUCCESS;
+}
@@ -1361,6 +1361,18 @@ WriteCLI(std::vector<std::string>& commandLine, std::string prefix,
     }
 }
 
+//---------------------------------------------------------------------------
+vtkMTimeType vtkMRMLMarkupsNode::GetContentMTime()
+{
+  vtkMTimeType contentMTime = this->Superclass::GetContentMTime();
+  vtkPoints* points = this->CurveInputPoly->GetPoints();
+  if (points != nullptr)
+    {
+    contentMTime = std::max(contentMTime, points->GetMTime());
+    }
+  return contentMTime;
+}
+
 //---------------------------------------------------------------------------
 bool vtkMRMLMarkupsNode::GetModifiedSinceRead()
 {
@@ -502,6 +502,10 @@ public:
   /// \sa vtkMRMLStorableNode::GetModifiedSinceRead()
   bool GetModifiedSinceRead() override;
 
+  /// Reimplemented to take into account the modified time of the control points.
+  /// \sa vtkMRMLNode::GetContentMTime()
+  vtkMTimeType GetContentMTime() override;
+
   /// Reset the id of the Nth control point according to the local policy
   /// Called after an already initialised markup has been added to the
   /// scene. Returns false if n out of bounds, true on success.
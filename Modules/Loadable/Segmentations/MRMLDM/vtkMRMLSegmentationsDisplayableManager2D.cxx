@@ -30,6 +30,7 @@
 #include <vtkMRMLTransformNode.h>
 
 // MRML logic includes
+#include "vtkImageLabelMapToRGBA.h"
 #include "vtkImageLabelOutline.h"
 
 // SegmentationCore includes
@@ -206,6 +207,8 @@ public:
       this->Reslice = vtkSmartPointer<vtkImageReslice>::New();
       this->SliceToImageTransform = vtkSmartPointer<vtkGeneralTransform>::New();
       this->LabelOutline = vtkSmartPointer<vtkImageLabelOutline>::New();
+      this->FillColorMapper = vtkSmartPointer<vtkImageMapToRGBA>::New();
+      this->LabelMapToRGBA = vtkSmartPointer<vtkImageLabelMapToRGBA>::New();
       this->LookupTableOutline = vtkSmartPointer<vtkLookupTable>::New();
       this->LookupTableFill = vtkSmartPointer<vtkLookupTable>::New();
       this->ImageThreshold = vtkSmartPointer<vtkImageThreshold>::New();
@@ -239,16 +242,18 @@ public:
       this->ImageOutlineActor->SetVisibility(0);
 
       // Image fill
-      vtkSmartPointer<vtkImageMapToRGBA> fillColorMapper = vtkSmartPointer<vtkImageMapToRGBA>::New();
-      fillColorMapper->SetInputConnection(this->Reslice->GetOutputPort());
-      fillColorMapper->SetOutputFormatToRGBA();
-      fillColorMapper->SetLookupTable(this->LookupTableFill);
+      this->FillColorMapper->SetInputConnection(this->Reslice->GetOutputPort());
+      this->FillColorMapper->SetOutputFormatToRGBA();
+      this->FillColorMapper->SetLookupTable(this->LookupTableFill);
       vtkSmartPointer<vtkImageMapper> imageFillMapper = vtkSmartPointer<vtkImageMapper>::New();
-      imageFillMapper->SetInputConnection(fillColorMapper->GetOutputPort());
+      imageFillMapper->SetInputConnection(this->FillColorMapper->GetOutputPort());
       imageFillMapper->SetColorWindow(255);
       imageFillMapper->SetColorLevel(127.5);
       this->ImageFillActor->SetMapper(imageFillMapper);
       this->ImageFillActor->SetVisibility(0);
+
+      // Binary labelmap fill and outline (drawn by the image fill actor)
+      this->LabelMapToRGBA->SetInputConnection(this->Reslice->GetOutputPort());
       }
 
     vtkSmartPointer<vtkTransform> WorldToSliceTransform;
@@ -273,6 +278,8 @@ public:
     vtkSmartPointer<vtkImageReslice> Reslice;
     vtkSmartPointer<vtkGeneralTransform> SliceToImageTransform;
     vtkSmartPointer<vtkImageLabelOutline> LabelOutline;
+    vtkSmartPointer<vtkImageMapToRGBA> FillColorMapper;
+    vtkSmartPointer<vtkImageLabelMapToRGBA> LabelMapToRGBA;
     vtkSmartPointer<vtkLookupTable> LookupTableOutline;
     vtkSmartPointer<vtkLookupTable> LookupTableFill;
     vtkSmartPointer<vtkImageThreshold> ImageThreshold;
@@ -800,6 +807,11 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayNodePip
     for (std::string segmentId : sharedSegmentIds)
       {
       pipelineVisiblity |= this->IsSegmentVisibleInCurrentSlice(displayNode, pipeline, segmentId);
+      if (pipelineVisiblity || imageData)
+        {
+        // Segments that share a labelmap have the same bounds, checking one is enough
+        break;
+        }
       }
 
     if (!pipelineVisiblity)
@@ -944,10 +956,15 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayNodePip
           }
         }
 
+      // Binary labelmaps are mapped to colors in one pass: fill and outline of all segments
+      // in the layer are drawn by the image fill actor.
+      bool fractionalLabelmap =
+        (shownRepresenatationName == vtkSegmentationConverter::GetSegmentationFractionalLabelmapRepresentationName());
+
       // Update pipeline actors
-      pipeline->ImageOutlineActor->SetVisibility(outlineVisible);
+      pipeline->ImageOutlineActor->SetVisibility(fractionalLabelmap && outlineVisible);
       pipeline->ImageOutlineActor->SetPosition(0, 0);
-      pipeline->ImageFillActor->SetVisibility(fillVisible);
+      pipeline->ImageFillActor->SetVisibility(fillVisible || (!fractionalLabelmap && outlineVisible));
       pipeline->ImageFillActor->SetPosition(0, 0);
 
       if (!outlineVisible && !fillVisible)
@@ -956,7 +973,7 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayNodePip
         }
 
       // Set outline properties and turn it off if not shown
-      if (outlineVisible)
+      if (fractionalLabelmap && outlineVisible)
         {
         pipeline->LabelOutline->SetOutline(genericDisplayNode->GetSliceIntersectionThickness());
         }
@@ -964,6 +981,7 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayNodePip
         {
         pipeline->LabelOutline->SetInputConnection(nullptr);
         }
+      pipeline->LabelMapToRGBA->SetOutline(outlineVisible ? genericDisplayNode->GetSliceIntersectionThickness() : 0);
 
       // Set the range of the scalars in the image data from the ScalarRange field if it exists
       // Default to the scalar range of 0.0 to 1.0 otherwise
@@ -978,39 +996,14 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayNodePip
         }
 
       // Set segment color
-      int minLabelmapValue = 0;
-      int maxLabelmapValue = 0;
-
-      for (std::string segmentId : sharedSegmentIds)
-        {
-        vtkSegment* segment = segmentation->GetSegment(segmentId);
-        int labelmapValue = segment->GetLabelValue();
-        minLabelmapValue = std::min(minLabelmapValue, labelmapValue);
-        maxLabelmapValue = std::max(maxLabelmapValue, labelmapValue);
-        }
-
-      if (displayNode->GetDisplayRepresentationName2D() == vtkSegmentationConverter::GetFractionalLabelmapRepresentationName())
+      if (fractionalLabelmap)
         {
         pipeline->LookupTableFill->SetNumberOfTableValues(maximumValue - minimumValue + 1);
         pipeline->LookupTableFill->SetTableRange(minimumValue, maximumValue);
         }
       else
         {
-        int numberOfValues = maxLabelmapValue - minLabelmapValue + 1;
-        pipeline->LookupTableOutline->SetNumberOfTableValues(numberOfValues);
-        pipeline->LookupTableOutline->SetRange(minLabelmapValue, maxLabelmapValue);
-        pipeline->LookupTableOutline->IndexedLookupOff();
-        pipeline->LookupTableOutline->Build();
-
-        pipeline->LookupTableFill->SetNumberOfTableValues(numberOfValues);
-        pipeline->LookupTableFill->SetRange(minLabelmapValue, maxLabelmapValue);
-        pipeline->LookupTableFill->IndexedLookupOff();
-        pipeline->LookupTableFill->Build();
-
-        int index = pipeline->LookupTableOutline->GetIndex(0.0);
-        pipeline->LookupTableOutline->SetTableValue(index, 0, 0, 0, 0);
-        index = pipeline->LookupTableFill->GetIndex(0.0);
-        pipeline->LookupTableFill->SetTableValue(index, 0, 0, 0, 0);
+        pipeline->LabelMapToRGBA->RemoveAllLabelColors();
         }
 
       for (std::string segmentId : sharedSegmentIds)
@@ -1049,7 +1042,7 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayNodePip
           displayNode->GetSegmentColor(segmentId, color);
           }
 
-        if (displayNode->GetDisplayRepresentationName2D() == vtkSegmentationConverter::GetFractionalLabelmapRepresentationName())
+        if (fractionalLabelmap)
           {
           pipeline->LookupTableFill->SetRampToLinear();
           if (!this->SmoothFractionalLabelMapBorder)
@@ -1079,10 +1072,9 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayNodePip
           }
         else
           {
-          int index = pipeline->LookupTableFill->GetIndex(labelmapValue);
-          pipeline->LookupTableOutline->SetTableValue(index, color[0], color[1], color[2], outlineOpacity);
-          index = pipeline->LookupTableFill->GetIndex(labelmapValue);
-          pipeline->LookupTableFill->SetTableValue(index, color[0], color[1], color[2], fillOpacity);
+          double fillColor[4] = { color[0], color[1], color[2], fillOpacity };
+          double outlineColor[4] = { color[0], color[1], color[2], outlineOpacity };
+          pipeline->LabelMapToRGBA->SetLabelColor(labelmapValue, fillColor, outlineColor);
           }
         }
       pipeline->Reslice->SetBackgroundLevel(minimumValue);
@@ -1137,11 +1129,16 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayNodePip
       int sliceOutputExtent[6] = { 0, dimensions[0] - 1, 0, dimensions[1] - 1, 0, dimensions[2] - 1 };
       pipeline->Reslice->SetOutputExtent(sliceOutputExtent);
 
-      // Smooth the border of fractional labelmaps
-      pipeline->LabelOutline->SetInputConnection(pipeline->Reslice->GetOutputPort());
-      pipeline->ImageFillActor->GetMapper()->GetInputAlgorithm()->SetInputConnection(pipeline->Reslice->GetOutputPort());
-      if (shownRepresenatationName == vtkSegmentationConverter::GetSegmentationFractionalLabelmapRepresentationName())
+      if (!fractionalLabelmap)
+        {
+        pipeline->ImageFillActor->GetMapper()->SetInputConnection(pipeline->LabelMapToRGBA->GetOutputPort());
+        }
+      else
         {
+        // Smooth the border of fractional labelmaps
+        pipeline->LabelOutline->SetInputConnection(pipeline->Reslice->GetOutputPort());
+        pipeline->FillColorMapper->SetInputConnection(pipeline->Reslice->GetOutputPort());
+        pipeline->ImageFillActor->GetMapper()->SetInputConnection(pipeline->FillColorMapper->GetOutputPort());
         // If ThresholdValue is not specified, then do not perform thresholding
         vtkDoubleArray* thresholdValue = vtkDoubleArray::SafeDownCast(
           imageData->GetFieldData()->GetAbstractArray(vtkSegmentationConverter::GetThresholdValueFieldName()));
@@ -1149,7 +1146,7 @@ void vtkMRMLSegmentationsDisplayableManager2D::vtkInternal::UpdateDisplayNodePip
           {
           if (!this->SmoothFractionalLabelMapBorder && thresholdValue && thresholdValue->GetNumberOfValues() == 1)
             {
-            pipeline->ImageFillActor->GetMapper()->GetInputAlgorithm()->SetInputConnection(pipeline->ImageThreshold->GetOutputPort());
+            pipeline->FillColorMapper->SetInputConnection(pipeline->ImageThreshold->GetOutputPort());
             }
           pipeline->ImageThreshold->ThresholdByLower(thresholdValue->GetValue(0));
           pipeline->LabelOutline->SetInputConnection(pipeline->ImageThreshold->GetOutputPort());
@@ -14,6 +14,7 @@
 
 // STD includes
 #include <algorithm>
+#include <iterator>
 
 // Volumes includes
 #include "vtkSlicerVolumesLogic.h"
@@ -58,6 +59,10 @@
 #include <vtkImageReslice.h>
 #include <vtkTransform.h>
 
+// ITK includes
+#include <itkImageIOFactory.h>
+#include <itkMetaDataObject.h>
+
 /// CTK includes
 /// to avoid CTK includes which pull in a dependency on Qt, rehome some CTK
 /// core utility methods here in the anonymous namespace until they get ported
@@ -389,6 +394,28 @@ ArchetypeVolumeNodeSet ScalarVolumeNodeSetFactory(std::string& volumeName, vtkMR
   return nodeSet;
 }
 
+//----------------------------------------------------------------------------
+/// Return true if the volume node of \a nodeSet can store the content of a file
+/// classified as \a fileVolumeClassName by GetVolumeNodeClassNameFromFileHeader().
+/// Volume node classes that the classification does not know about are always
+/// considered matching: only reading the file can tell.
+bool IsNodeSetMatchingFileHeader(const ArchetypeVolumeNodeSet& nodeSet, const std::string& fileVolumeClassName)
+{
+  std::string nodeClassName = nodeSet.Node->GetClassName();
+  if (nodeClassName == "vtkMRMLLabelMapVolumeNode")
+    {
+    nodeClassName = "vtkMRMLScalarVolumeNode";
+    }
+  if (nodeClassName != "vtkMRMLDiffusionWeightedVolumeNode"
+    && nodeClassName != "vtkMRMLDiffusionTensorVolumeNode"
+    && nodeClassName != "vtkMRMLVectorVolumeNode"
+    && nodeClassName != "vtkMRMLScalarVolumeNode")
+    {
+    return true;
+    }
+  return nodeClassName == fileVolumeClassName;
+}
+
 } // end of anonymous namespace
 
 //----------------------------------------------------------------------------
@@ -542,6 +569,48 @@ vtkMRMLVolumeNode* vtkSlicerVolumesLogic::AddArchetypeVolume(
   return this->AddArchetypeVolume(this->VolumeRegistry, filename, volname, loadingOptions, fileList);
 }
 
+//----------------------------------------------------------------------------
+std::string vtkSlicerVolumesLogic::GetVolumeNodeClassNameFromFileHeader(const char* filename)
+{
+  if (filename == nullptr || !vtksys::SystemTools::FileExists(filename, true))
+    {
+    return std::string();
+    }
+  itk::ImageIOBase::Pointer imageIO =
+    itk::ImageIOFactory::CreateImageIO(filename, itk::ImageIOFactory::ReadMode);
+  if (imageIO.IsNull())
+    {
+    return std::string();
+    }
+  try
+    {
+    // only the header is read
+    imageIO->SetFileName(filename);
+    imageIO->ReadImageInformation();
+    }
+  catch (itk::ExceptionObject&)
+    {
+    return std::string();
+    }
+
+  std::string modality;
+  if (itk::ExposeMetaData<std::string>(imageIO->GetMetaDataDictionary(), "modality", modality)
+    && modality == "DWMRI")
+    {
+    return "vtkMRMLDiffusionWeightedVolumeNode";
+    }
+  if (imageIO->GetPixelType() == itk::ImageIOBase::DIFFUSIONTENSOR3D
+    || imageIO->GetPixelType() == itk::ImageIOBase::SYMMETRICSECONDRANKTENSOR)
+    {
+    return "vtkMRMLDiffusionTensorVolumeNode";
+    }
+  if (imageIO->GetNumberOfComponents() > 1)
+    {
+    return "vtkMRMLVectorVolumeNode";
+    }
+  return "vtkMRMLScalarVolumeNode";
+}
+
 //----------------------------------------------------------------------------
 vtkMRMLScalarVolumeNode* vtkSlicerVolumesLogic::AddArchetypeScalarVolume(
     const char* filename, const char* volname, int loadingOptions, vtkStringArray *fileList)
@@ -586,38 +655,63 @@ vtkMRMLVolumeNode* vtkSlicerVolumesLogic::AddArchetypeVolume (
 
   vtkNew<vtkErrorSink> errorSink;
 
+  bool useURI = this->GetMRMLScene()->GetCacheManager()
+    && this->GetMRMLScene()->GetCacheManager()->IsRemoteReference(filename);
+
   // set up a mini scene to avoid adding and removing nodes from the main scene
   vtkNew<vtkMRMLScene> testScene;
   // associate default nodes with mini scene
   this->GetMRMLScene()->CopyDefaultNodesToScene(testScene.GetPointer());
-  // set it up for remote io, the constructor creates a cache and data io manager
   vtkSmartPointer<vtkMRMLRemoteIOLogic> remoteIOLogic;
-  remoteIOLogic = vtkSmartPointer<vtkMRMLRemoteIOLogic>::New();
-  if (this->GetMRMLScene()->GetCacheManager())
+  if (useURI)
     {
+    // set it up for remote io, the constructor creates a cache and data io manager
+    remoteIOLogic = vtkSmartPointer<vtkMRMLRemoteIOLogic>::New();
     // update the temp remote cache dir from the main one
     remoteIOLogic->GetCacheManager()->SetRemoteCacheDirectory(this->GetMRMLScene()->GetCacheManager()->GetRemoteCacheDirectory());
+    // set up the data io manager logic to handle remote downloads
+    vtkSmartPointer<vtkDataIOManagerLogic> dataIOManagerLogic;
+    dataIOManagerLogic = vtkSmartPointer<vtkDataIOManagerLogic>::New();
+    dataIOManagerLogic->SetMRMLApplicationLogic(this->GetApplicationLogic());
+    dataIOManagerLogic->SetAndObserveDataIOManager(
+      remoteIOLogic->GetDataIOManager());
+
+    // and link up everything for the test scene
+    this->GetApplicationLogic()->SetMRMLSceneDataIO(testScene.GetPointer(),
+                                                    remoteIOLogic, dataIOManagerLogic);
     }
-  // set up the data io manager logic to handle remote downloads
-  vtkSmartPointer<vtkDataIOManagerLogic> dataIOManagerLogic;
-  dataIOManagerLogic = vtkSmartPointer<vtkDataIOManagerLogic>::New();
-  dataIOManagerLogic->SetMRMLApplicationLogic(this->GetApplicationLogic());
-  dataIOManagerLogic->SetAndObserveDataIOManager(
-    remoteIOLogic->GetDataIOManager());
 
-  // and link up everything for the test scene
-  this->GetApplicationLogic()->SetMRMLSceneDataIO(testScene.GetPointer(),
-                                                  remoteIOLogic, dataIOManagerLogic);
+  // Classify the file from its header, so that factories creating nodes
+  // that cannot store its content do not read it.
+  std::string fileVolumeClassName;
+  if (!useURI)
+    {
+    fileVolumeClassName = vtkSlicerVolumesLogic::GetVolumeNodeClassNameFromFileHeader(filename);
+    vtkDebugMacro("File header indicates a volume of type " << fileVolumeClassName
+                  << " [filename = " << filename << "]");
+    }
 
-  // Run through the factory list and test each factory until success
-  for (NodeSetFactoryRegistry::const_iterator fit = volumeRegistry.begin();
-       fit != volumeRegistry.end(); ++fit)
+  // Run through the factory list and test each factory until success.
+  // Factories that do not match the file header are only tried after all
+  // the others failed, in case the header was misleading.
+  NodeSetFactoryRegistry factories(volumeRegistry);
+  NodeSetFactoryRegistry deferredFactories;
+  bool checkFileHeader = !fileVolumeClassName.empty();
+  for (NodeSetFactoryRegistry::const_iterator fit = factories.begin();
+       fit != factories.end(); ++fit)
     {
     ArchetypeVolumeNodeSet nodeSet( (*fit)(volumeName, testScene.GetPointer(), loadingOptions) );
 
     // if the labelMap flags for reader and factory are consistent
     // (both true or both false)
-    if (labelMap == nodeSet.LabelMap)
+    if (labelMap == nodeSet.LabelMap && checkFileHeader
+      && !IsNodeSetMatchingFileHeader(nodeSet, fileVolumeClassName))
+      {
+      vtkDebugMacro("Defer reading file as a volume of type " << nodeSet.Node->GetNodeTagName()
+                    << ", file header does not match [filename = " << filename << "]");
+      deferredFactories.push_back(*fit);
+      }
+    else if (labelMap == nodeSet.LabelMap)
       {
 
       // connect the observers
@@ -656,6 +750,12 @@ vtkMRMLVolumeNode* vtkSlicerVolumesLogic::AddArchetypeVolume (
     testScene->RemoveNode(nodeSet.DisplayNode);
     testScene->RemoveNode(nodeSet.StorageNode);
     testScene->RemoveNode(nodeSet.Node);
+
+    if (std::next(fit) == factories.end() && !deferredFactories.empty())
+      {
+      factories.splice(factories.end(), deferredFactories);
+      checkFileHeader = false;
+      }
     }
 
   // display any errors
@@ -692,7 +792,10 @@ vtkMRMLVolumeNode* vtkSlicerVolumesLogic::AddArchetypeVolume (
     }
 
   // clean up the test scene
-  remoteIOLogic->RemoveDataIOFromScene();
+  if (remoteIOLogic)
+    {
+    remoteIOLogic->RemoveDataIOFromScene();
+    }
   if (testScene->GetCacheManager())
     {
     testScene->SetCacheManager(nullptr);
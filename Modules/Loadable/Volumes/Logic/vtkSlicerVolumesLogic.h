@@ -133,6 +133,18 @@ public:
     return this->AddArchetypeVolume( filename, volname, 0, nullptr);
     }
 
+  /// Determine from the header of a volume file, without reading the voxels, the class of
+  /// the volume node that can store its content:
+  /// - vtkMRMLDiffusionWeightedVolumeNode for NRRD files of DWMRI modality,
+  /// - vtkMRMLDiffusionTensorVolumeNode for tensor pixels (e.g. NRRD symmetric matrix kinds,
+  ///   NIfTI symmetric matrix intent),
+  /// - vtkMRMLVectorVolumeNode for other multi-component pixels (vector kinds or intent, RGB...),
+  /// - vtkMRMLScalarVolumeNode for single component pixels.
+  /// Return an empty string if the file cannot be read by any registered ITK image IO.
+  /// AddArchetypeVolume() uses it to try first the factories creating that class of node,
+  /// so that the file is not read by factories that would reject it after reading it.
+  static std::string GetVolumeNodeClassNameFromFileHeader(const char* filename);
+
   /// Load a scalar volume function directly, bypassing checks of all factories done in AddArchetypeVolume.
   /// \sa AddArchetypeVolume(const NodeSetFactoryRegistry& volumeRegistry, const char* filename, const char* volname, int loadingOptions, vtkStringArray *fileList)
   vtkMRMLScalarVolumeNode* AddArchetypeScalarVolume(const char* filename, const char* volname, int loadingOptions, vtkStringArray *fileList);
@@ -38,12 +38,17 @@
 #include <vtkImageAlgorithm.h>
 #include <vtkInformation.h>
 #include <vtkNew.h>
+#include <vtkTimerLog.h>
 #include <vtkTrivialProducer.h>
 
 // ITK includes
 #include <itkConfigure.h>
 #include <itkFactoryRegistration.h>
 
+// STD includes
+#include <fstream>
+#include <string>
+
 //-----------------------------------------------------------------------------
 bool isImageDataValid(int line, vtkAlgorithmOutput* imageDataConnection);
 vtkMRMLScalarVolumeNode * TestScalarVolumeLoading( const char* volumeName,
@@ -56,6 +61,7 @@ int TestCheckForLabelVolumeValidity( vtkMRMLScalarVolumeNode* scalarVolume,
 int TestCloneVolume( vtkMRMLScalarVolumeNode* scalarVolume,
                      vtkMRMLScene* scene,
                      vtkSlicerVolumesLogic *logic);
+int TestVolumeNodeClassNameFromFileHeader( const std::string& tempDir );
 
 //-----------------------------------------------------------------------------
 int vtkSlicerVolumesLogicTest1( int argc, char * argv[] )
@@ -65,11 +71,11 @@ int vtkSlicerVolumesLogicTest1( int argc, char * argv[] )
   vtkNew<vtkMRMLScene> scene;
   vtkNew<vtkSlicerVolumesLogic> logic;
 
-  if (argc < 2)
+  if (argc < 3)
     {
     std::cerr << "Line " << __LINE__
               << " - Missing parameters !\n"
-              << "Usage: vtkSlicerVolumesLogicTest1 volumeName [-I]"
+              << "Usage: vtkSlicerVolumesLogicTest1 volumeName /path/to/temp [-I]"
               << std::endl;
     return EXIT_FAILURE;
     }
@@ -77,8 +83,18 @@ int vtkSlicerVolumesLogicTest1( int argc, char * argv[] )
   logic->SetMRMLScene(scene.GetPointer());
   const char* volumeName = argv[1];
 
+  // Volume type is found from the header only
+  CHECK_STD_STRING(vtkSlicerVolumesLogic::GetVolumeNodeClassNameFromFileHeader(volumeName),
+    "vtkMRMLScalarVolumeNode");
+  CHECK_STD_STRING(vtkSlicerVolumesLogic::GetVolumeNodeClassNameFromFileHeader("nonexistent.nrrd"), "");
+  CHECK_EXIT_SUCCESS(TestVolumeNodeClassNameFromFileHeader(argv[2]));
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
   vtkMRMLScalarVolumeNode * scalarVolume = TestScalarVolumeLoading(volumeName, logic.GetPointer());
+  timer->StopTimer();
   CHECK_NOT_NULL(scalarVolume);
+  std::cout << "AddArchetypeVolume: " << timer->GetElapsedTime() << " s" << std::endl;
 
   vtkMRMLLabelMapVolumeNode * labelMapVolume = TestLabelMapVolumeLoading(volumeName, logic.GetPointer());
   CHECK_NOT_NULL(labelMapVolume);
@@ -290,3 +306,80 @@ int TestCloneVolume( vtkMRMLScalarVolumeNode* scalarVolume,
 
   return EXIT_SUCCESS;
 }
+
+//-----------------------------------------------------------------------------
+bool WriteNrrdFile(const std::string& fileName, const std::string& header, size_t dataSize)
+{
+  std::ofstream file(fileName.c_str(), std::ios::binary);
+  file << "NRRD0004\n" << header
+       << "encoding: raw\n"
+       << "endian: little\n"
+       << "\n";
+  file << std::string(dataSize, '\0');
+  return file.good();
+}
+
+//-----------------------------------------------------------------------------
+int TestVolumeNodeClassNameFromFileHeader( const std::string& tempDir )
+{
+  std::string dwiFileName = tempDir + "/vtkSlicerVolumesLogicTest1_dwi.nrrd";
+  CHECK_BOOL(WriteNrrdFile(dwiFileName,
+    "type: short\n"
+    "dimension: 4\n"
+    "space: left-posterior-superior\n"
+    "sizes: 2 2 2 3\n"
+    "space directions: (1,0,0) (0,1,0) (0,0,1) none\n"
+    "kinds: space space space list\n"
+    "space origin: (0,0,0)\n"
+    "measurement frame: (1,0,0) (0,1,0) (0,0,1)\n"
+    "modality:=DWMRI\n"
+    "DWMRI_b-value:=1000\n"
+    "DWMRI_gradient_0000:=0 0 0\n"
+    "DWMRI_gradient_0001:=1 0 0\n"
+    "DWMRI_gradient_0002:=0 1 0\n",
+    2 * 2 * 2 * 3 * sizeof(short)), true);
+  CHECK_STD_STRING(vtkSlicerVolumesLogic::GetVolumeNodeClassNameFromFileHeader(dwiFileName.c_str()),
+    "vtkMRMLDiffusionWeightedVolumeNode");
+
+  std::string dtiFileName = tempDir + "/vtkSlicerVolumesLogicTest1_dti.nrrd";
+  CHECK_BOOL(WriteNrrdFile(dtiFileName,
+    "type: float\n"
+    "dimension: 4\n"
+    "space: left-posterior-superior\n"
+    "sizes: 6 2 2 2\n"
+    "space directions: none (1,0,0) (0,1,0) (0,0,1)\n"
+    "kinds: 3D-symmetric-matrix space space space\n"
+    "space origin: (0,0,0)\n"
+    "measurement frame: (1,0,0) (0,1,0) (0,0,1)\n",
+    6 * 2 * 2 * 2 * sizeof(float)), true);
+  CHECK_STD_STRING(vtkSlicerVolumesLogic::GetVolumeNodeClassNameFromFileHeader(dtiFileName.c_str()),
+    "vtkMRMLDiffusionTensorVolumeNode");
+
+  std::string vectorFileName = tempDir + "/vtkSlicerVolumesLogicTest1_vector.nrrd";
+  CHECK_BOOL(WriteNrrdFile(vectorFileName,
+    "type: float\n"
+    "dimension: 4\n"
+    "space: left-posterior-superior\n"
+    "sizes: 3 2 2 2\n"
+    "space directions: none (1,0,0) (0,1,0) (0,0,1)\n"
+    "kinds: vector space space space\n"
+    "space origin: (0,0,0)\n",
+    3 * 2 * 2 * 2 * sizeof(float)), true);
+  CHECK_STD_STRING(vtkSlicerVolumesLogic::GetVolumeNodeClassNameFromFileHeader(vectorFileName.c_str()),
+    "vtkMRMLVectorVolumeNode");
+
+  std::string rgbFileName = tempDir + "/vtkSlicerVolumesLogicTest1_rgb.nrrd";
+  CHECK_BOOL(WriteNrrdFile(rgbFileName,
+    "type: unsigned char\n"
+    "dimension: 4\n"
+    "space: left-posterior-superior\n"
+    "sizes: 3 2 2 2\n"
+    "space directions: none (1,0,0) (0,1,0) (0,0,1)\n"
+    "kinds: RGB-color space space space\n"
+    "space origin: (0,0,0)\n",
+    3 * 2 * 2 * 2), true);
+  CHECK_STD_STRING(vtkSlicerVolumesLogic::GetVolumeNodeClassNameFromFileHeader(rgbFileName.c_str()),
+    "vtkMRMLVectorVolumeNode");
+
+  return EXIT_SUCCESS;
+}
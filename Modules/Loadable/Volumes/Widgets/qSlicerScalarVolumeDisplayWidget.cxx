@@ -23,6 +23,7 @@
 #include <vtkImageData.h>
 #include <vtkPointData.h>
 #include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
 
 // STD includes
 #include <limits>
@@ -42,6 +43,12 @@ public:
 
   ctkVTKHistogram* Histogram;
   vtkSmartPointer<vtkColorTransferFunction> ColorTransferFunction;
+
+  /// Voxels the histogram was last built from, to build it again only
+  /// when they are modified.
+  vtkWeakPointer<vtkDataArray> HistogramVoxelValues;
+  vtkMTimeType HistogramVoxelValuesMTime;
+  int HistogramBinCount;
 };
 
 //-----------------------------------------------------------------------------
@@ -51,6 +58,8 @@ qSlicerScalarVolumeDisplayWidgetPrivate::qSlicerScalarVolumeDisplayWidgetPrivate
 {
   this->Histogram = new ctkVTKHistogram();
   this->ColorTransferFunction = vtkSmartPointer<vtkColorTransferFunction>::New();
+  this->HistogramVoxelValuesMTime = 0;
+  this->HistogramBinCount = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -231,10 +240,18 @@ void qSlicerScalarVolumeDisplayWidget::updateHistogram()
 {
   Q_D(qSlicerScalarVolumeDisplayWidget);
 
-  // Get voxel array
+  // Get voxel array. The display node provides the same (possibly
+  // subsampled) voxels it uses for the automatic window/level, so that
+  // large volumes are not scanned again.
   vtkMRMLScalarVolumeNode* volumeNode = this->volumeNode();
   vtkImageData* imageData = volumeNode ? volumeNode->GetImageData() : nullptr;
-  vtkPointData* pointData = imageData ? imageData->GetPointData() : nullptr;
+  vtkMRMLScalarVolumeDisplayNode* volumeDisplayNode = this->volumeDisplayNode();
+  vtkImageData* histogramImageData = volumeDisplayNode ? volumeDisplayNode->GetHistogramImageData() : nullptr;
+  if (!histogramImageData)
+    {
+    histogramImageData = imageData;
+    }
+  vtkPointData* pointData = histogramImageData ? histogramImageData->GetPointData() : nullptr;
   vtkDataArray* voxelValues = pointData ? pointData->GetScalars() : nullptr;
 
   // If there are no voxel values then we completely hide the histogram section
@@ -256,14 +273,11 @@ void qSlicerScalarVolumeDisplayWidget::updateHistogram()
   // Screen resolution is limited, therefore it does not make sense to compute
   // many bin counts.
   const int maxBinCount = 1000;
-  if (voxelValues->GetArrayType() == VTK_FLOAT || voxelValues->GetArrayType() == VTK_DOUBLE)
-    {
-    d->Histogram->setNumberOfBins(maxBinCount);
-    }
-  else
+  int binCount = maxBinCount;
+  if (voxelValues->GetArrayType() != VTK_FLOAT && voxelValues->GetArrayType() != VTK_DOUBLE)
     {
     double* range = voxelValues->GetRange();
-    int binCount = static_cast<int>(range[1] - range[0] + 1);
+    binCount = static_cast<int>(range[1] - range[0] + 1);
     if (binCount > maxBinCount)
       {
       binCount = maxBinCount;
@@ -272,9 +286,18 @@ void qSlicerScalarVolumeDisplayWidget::updateHistogram()
       {
       binCount = 1;
       }
+    }
+  // Window/level and threshold changes only update the background
+  if (voxelValues != d->HistogramVoxelValues
+      || voxelValues->GetMTime() != d->HistogramVoxelValuesMTime
+      || binCount != d->HistogramBinCount)
+    {
     d->Histogram->setNumberOfBins(binCount);
+    d->Histogram->build();
+    d->HistogramVoxelValues = voxelValues;
+    d->HistogramVoxelValuesMTime = voxelValues->GetMTime();
+    d->HistogramBinCount = binCount;
     }
-  d->Histogram->build();
 
   // Update histogram background
 